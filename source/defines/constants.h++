@@ -19,6 +19,9 @@ namespace defines
     constexpr ChrPString ucdDataFile = "ucd.all.grouped.xml";
     constexpr ChrPString ucdDataPath = "./data/unicode/";
     constexpr ChrPString ucdDataName = "./data/unicode/ucd.all.grouped.xml";
+    // the UCD, compiled down to what we actually use from it.
+    constexpr ChrPString ucdTableFile = "ucd.properties.bin";
+    constexpr ChrPString ucdTableName = "./data/unicode/ucd.properties.bin";
 
     constexpr ChrPString forwardSlash  = "/";
     constexpr ChrPString backwardSlash = "\\";
@@ -16,6 +16,7 @@
 
 #include <io/console/conmanip.h++>
 #include <io/console/console.h++>
+#include <io/unicode/character.h++>
 
 #include <ux/serialization/screens.h++>
 #include <ux/serialization/strings.h++>
@@ -41,6 +42,33 @@ int main ( int const argc, char const *const *const argv )
             ux::serialization::TransliterationLevel::NOT;
     defines::IString locale = "en-US";
 
+    bool runUnittests    = false;
+    bool dumpInformation = false;
+    bool compileUCD      = false;
+    for ( int i = 0; i < argc; i++ )
+    {
+        if ( std::string ( argv [ i ] ) == "--unittest" )
+        {
+            runUnittests = true;
+        } else if ( std::string ( argv [ i ] ) == "--dump-information" )
+        {
+            dumpInformation = true;
+        } else if ( std::string ( argv [ i ] ) == "--compile-ucd" )
+        {
+            compileUCD = true;
+        }
+    }
+
+    if ( compileUCD )
+    {
+        io::unicode::compileProperties ( );
+        return 0;
+    }
+
+    // load the character properties while the assets are parsed, since
+    // everything we output needs them.
+    io::unicode::prewarmProperties ( );
+
     std::shared_ptr< ux::serialization::ExternalizedStrings > strings =
             std::shared_ptr< ux::serialization::ExternalizedStrings > (
                     new ux::serialization::ExternalizedStrings ( ) );
@@ -67,19 +95,6 @@ int main ( int const argc, char const *const *const argv )
                 std::shared_ptr< ExternalID > ( new ExternalID ( key ) ) );
     };
 
-    bool runUnittests    = false;
-    bool dumpInformation = false;
-    for ( int i = 0; i < argc; i++ )
-    {
-        if ( std::string ( argv [ i ] ) == "--unittest" )
-        {
-            runUnittests = true;
-        } else if ( std::string ( argv [ i ] ) == "--dump-information" )
-        {
-            dumpInformation = true;
-        }
-    }
-
     if ( runUnittests )
     {
         if ( test::runUnittests ( std::cout ) )
@@ -99,30 +114,41 @@ int main ( int const argc, char const *const *const argv )
 
     using namespace io::console;
     Console con;
+    // the screens' palettes all loop, so they need not be worked out live.
+    con << doPrecomputePalette;
     // TODO #53 should get implemented here.
-    auto    chooseNext = [ & ] ( ux::console::Screen const &current ) {
+    auto    chooseNext = [ & ] ( defines::IString const &key ) {
         // screen choosing logic, potentially moved eventually
         // to Screen as a member function.
         //
         // also eventually fleshed out into more than choosing the first
         // option if available.
+        ux::console::Screen const current = getScreen ( key );
         if ( current == getScreen ( "Exit" ) )
         {
             std::exit ( 0 );
         } else if ( current.nextScreen.empty ( ) )
         {
             // exit screen.
-            return getScreen ( "Exit" );
+            return defines::IString ( "Exit" );
         } else
         {
-            return getScreen ( current.nextScreen.front ( ).key );
+            return current.nextScreen.front ( ).key;
         }
     };
 
-    for ( ux::console::Screen screen = getScreen ( "Title" );;
-          screen                     = chooseNext ( screen ) )
+    // screens come back around, so each is only compiled once for as long as
+    // the console keeps its width.
+    ux::console::ScreenCache cache;
+    con.addResizeListener ( [ & ] ( auto const &, auto const & ) {
+        cache.clear ( );
+    } );
+    for ( defines::IString key = "Title";; key = chooseNext ( key ) )
     {
-        con << screen.output ( *strings, locale, translit );
+        ux::console::Screen const screen = getScreen ( key );
+        cache.get ( con, key, screen, *strings, locale, translit )
+                ->play ( con );
+        screen.ask ( con );
     }
     // set up some (hopefully) flashing text
     // con << setDirectColor ( 8, 1, 1, 1 );
@@ -0,0 +1,151 @@
+/**
+ * @file mappedfile.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of MappedFile
+ * @version 1
+ * @date 2022-03-03
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/base/mappedfile.h++>
+
+#include <defines/macros.h++>
+#include <defines/types.h++>
+
+#include <sstream>
+#include <stdexcept>
+
+#ifdef WINDOWS
+#    include "windows.h"
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+struct io::base::MappedFile::impl_s
+{
+    void       *address = nullptr;
+    std::size_t length  = 0;
+#ifdef WINDOWS
+    HANDLE file    = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    void map ( std::filesystem::path const & );
+    void unmap ( ) noexcept;
+};
+
+void io::base::MappedFile::impl_s::map ( std::filesystem::path const &path )
+{
+#ifdef WINDOWS
+    file = CreateFileW ( path.c_str ( ),
+                         GENERIC_READ,
+                         FILE_SHARE_READ,
+                         nullptr,
+                         OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL,
+                         nullptr );
+    if ( file == INVALID_HANDLE_VALUE )
+    {
+        RUNTIME_ERROR ( "Could not open ", path.string ( ) )
+    }
+    LARGE_INTEGER size;
+    if ( !GetFileSizeEx ( file, &size ) )
+    {
+        RUNTIME_ERROR ( "Could not get the size of ", path.string ( ) )
+    }
+    length = std::size_t ( size.QuadPart );
+    if ( !length )
+    {
+        return;
+    }
+    mapping = CreateFileMappingW (
+            file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if ( !mapping )
+    {
+        RUNTIME_ERROR ( "Could not map ", path.string ( ) )
+    }
+    address = MapViewOfFile ( mapping, FILE_MAP_READ, 0, 0, 0 );
+    if ( !address )
+    {
+        RUNTIME_ERROR ( "Could not map ", path.string ( ) )
+    }
+#else
+    int descriptor = open ( path.c_str ( ), O_RDONLY );
+    if ( descriptor < 0 )
+    {
+        RUNTIME_ERROR ( "Could not open ", path.string ( ) )
+    }
+    struct stat status;
+    if ( fstat ( descriptor, &status ) )
+    {
+        close ( descriptor );
+        RUNTIME_ERROR ( "Could not get the size of ", path.string ( ) )
+    }
+    length = std::size_t ( status.st_size );
+    if ( !length )
+    {
+        close ( descriptor );
+        return;
+    }
+    address = mmap ( nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0 );
+    // the mapping keeps its own reference to the file.
+    close ( descriptor );
+    if ( address == MAP_FAILED )
+    {
+        address = nullptr;
+        RUNTIME_ERROR ( "Could not map ", path.string ( ) )
+    }
+#endif
+}
+
+void io::base::MappedFile::impl_s::unmap ( ) noexcept
+{
+#ifdef WINDOWS
+    if ( address )
+    {
+        UnmapViewOfFile ( address );
+    }
+    if ( mapping )
+    {
+        CloseHandle ( mapping );
+    }
+    if ( file != INVALID_HANDLE_VALUE )
+    {
+        CloseHandle ( file );
+    }
+    mapping = nullptr;
+    file    = INVALID_HANDLE_VALUE;
+#else
+    if ( address )
+    {
+        munmap ( address, length );
+    }
+#endif
+    address = nullptr;
+    length  = 0;
+}
+
+io::base::MappedFile::MappedFile ( std::filesystem::path const &path ) :
+        pimpl ( new impl_s ( ) )
+{
+    try
+    {
+        pimpl->map ( path );
+    } catch ( ... )
+    {
+        pimpl->unmap ( );
+        throw;
+    }
+}
+
+io::base::MappedFile::~MappedFile ( ) { pimpl->unmap ( ); }
+
+std::string_view io::base::MappedFile::contents ( ) const noexcept
+{
+    return std::string_view ( ( char const * ) pimpl->address, pimpl->length );
+}
@@ -0,0 +1,38 @@
+/**
+ * @file mappedfile.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief A read-only file mapped into memory
+ * @version 1
+ * @date 2022-03-03
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <defines/macros.h++>
+#include <defines/types.h++>
+
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+namespace io::base
+{
+    /**
+     * @brief Maps a whole file into memory for reading. The contents stay
+     * valid as long as the MappedFile lives. Throws if the file cannot be
+     * opened or mapped.
+     */
+    class MappedFile
+    {
+        struct impl_s;
+        std::unique_ptr< impl_s > pimpl;
+    public:
+        MappedFile ( std::filesystem::path const & );
+        virtual ~MappedFile ( );
+
+        std::string_view contents ( ) const noexcept;
+    };
+} // namespace io::base
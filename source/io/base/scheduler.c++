@@ -0,0 +1,285 @@
+/**
+ * @file scheduler.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of the scheduler
+ * @version 1
+ * @date 2022-03-05
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/base/scheduler.h++>
+
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <test/unittester.h++>
+
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+
+using namespace io::base;
+
+struct io::base::Scheduler::impl_s
+{
+    std::mutex                                mutex;
+    // signalled when the queue changes and when a task finishes running.
+    std::condition_variable                   changed;
+    std::map< TaskID, std::pair< Task, TimePoint > > tasks;
+    // the tasks in order of their deadlines. Sleeping tasks are not here.
+    std::set< std::pair< TimePoint, TaskID > > queue;
+    TaskID                                    nextID  = 1;
+    // the task running right now, if any, and whether something tried to
+    // wake or rush it while it ran.
+    TaskID                                    running = 0;
+    bool                                      woken   = false;
+    bool                                      rushed  = false;
+    bool                                      stop    = false;
+    // last, so that everything it uses is there before it starts.
+    std::thread                               thread;
+
+    void loop ( );
+
+    impl_s ( ) : thread ( [ & ] ( ) { loop ( ); } ) { }
+    ~impl_s ( )
+    {
+        {
+            std::scoped_lock< std::mutex > lock ( mutex );
+            stop = true;
+        }
+        changed.notify_all ( );
+        thread.join ( );
+    }
+};
+
+void io::base::Scheduler::impl_s::loop ( )
+{
+    std::unique_lock< std::mutex > lock ( mutex );
+    while ( !stop )
+    {
+        if ( queue.empty ( ) )
+        {
+            changed.wait ( lock );
+            continue;
+        }
+        auto const [ deadline, id ] = *queue.begin ( );
+        if ( Clock::now ( ) < deadline )
+        {
+            changed.wait_until ( lock, deadline );
+            continue;
+        }
+        queue.erase ( queue.begin ( ) );
+        // run the task without the lock so that it may use the scheduler.
+        Task task = tasks.at ( id ).first;
+        running   = id;
+        woken     = false;
+        rushed    = false;
+        lock.unlock ( );
+        TimePoint next = never;
+        try
+        {
+            next = task ( deadline );
+        } catch ( ... )
+        {
+            // a task that throws sleeps until woken, since there is nobody
+            // here to tell.
+        }
+        lock.lock ( );
+        running    = 0;
+        auto found = tasks.find ( id );
+        if ( found != tasks.end ( ) )
+        {
+            // otherwise, whatever woke it would be lost.
+            if ( ( next == never && woken ) || rushed )
+            {
+                next = Clock::now ( );
+            }
+            found->second.second = next;
+            if ( next != never )
+            {
+                queue.emplace ( next, id );
+            }
+        }
+        changed.notify_all ( );
+    }
+}
+
+io::base::Scheduler::Scheduler ( ) : pimpl ( new impl_s ( ) ) { }
+io::base::Scheduler::~Scheduler ( ) = default;
+
+io::base::Scheduler &io::base::Scheduler::shared ( )
+{
+    static Scheduler scheduler;
+    return scheduler;
+}
+
+io::base::Scheduler::TaskID
+        io::base::Scheduler::add ( Task const &task, TimePoint const &first )
+{
+    TaskID id;
+    {
+        std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+        id = pimpl->nextID++;
+        pimpl->tasks.emplace ( id, std::make_pair ( task, first ) );
+        if ( first != never )
+        {
+            pimpl->queue.emplace ( first, id );
+        }
+    }
+    pimpl->changed.notify_all ( );
+    return id;
+}
+
+void io::base::Scheduler::wake ( TaskID const &id ) noexcept
+{
+    {
+        std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+        auto found = pimpl->tasks.find ( id );
+        if ( pimpl->running == id )
+        {
+            // it runs again if it goes to sleep.
+            pimpl->woken = true;
+            return;
+        }
+        if ( found == pimpl->tasks.end ( ) || found->second.second != never )
+        {
+            return;
+        }
+        found->second.second = Clock::now ( );
+        pimpl->queue.emplace ( found->second.second, id );
+    }
+    pimpl->changed.notify_all ( );
+}
+
+void io::base::Scheduler::rush ( TaskID const &id ) noexcept
+{
+    {
+        std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+        auto found = pimpl->tasks.find ( id );
+        if ( pimpl->running == id )
+        {
+            // it runs again as soon as it returns, whenever it asks for.
+            pimpl->rushed = true;
+            return;
+        }
+        if ( found == pimpl->tasks.end ( ) )
+        {
+            return;
+        }
+        pimpl->queue.erase ( std::make_pair ( found->second.second, id ) );
+        found->second.second = Clock::now ( );
+        pimpl->queue.emplace ( found->second.second, id );
+    }
+    pimpl->changed.notify_all ( );
+}
+
+void io::base::Scheduler::remove ( TaskID const &id ) noexcept
+{
+    std::unique_lock< std::mutex > lock ( pimpl->mutex );
+    auto found = pimpl->tasks.find ( id );
+    if ( found == pimpl->tasks.end ( ) )
+    {
+        return;
+    }
+    pimpl->queue.erase ( std::make_pair ( found->second.second, id ) );
+    pimpl->tasks.erase ( found );
+    // a task removing itself cannot wait on itself.
+    if ( std::this_thread::get_id ( ) != pimpl->thread.get_id ( ) )
+    {
+        pimpl->changed.wait ( lock, [ & ] ( ) {
+            return pimpl->running != id;
+        } );
+    }
+}
+
+bool testScheduler ( std::ostream &stream )
+{
+    using namespace std::chrono_literals;
+    stream << "Beginning scheduler unittest.\n";
+    Scheduler               scheduler;
+    std::mutex              mutex;
+    std::condition_variable recorded;
+    std::string             order;
+    std::atomic_int         ticks = 0;
+    auto const              start = Scheduler::Clock::now ( );
+    // records the task, in capitals if it ran before it was due.
+    auto record = [ & ] ( char const &c, Scheduler::TimePoint const &due ) {
+        std::scoped_lock< std::mutex > lock ( mutex );
+        order += Scheduler::Clock::now ( ) < due ? char ( c - 'a' + 'A' ) : c;
+        recorded.notify_all ( );
+    };
+    // waits for as many tasks as expected to have run, for long enough that
+    // a busy machine does not matter, then checks which ran.
+    auto reaches = [ & ] ( std::string const &expected ) {
+        std::unique_lock< std::mutex > lock ( mutex );
+        recorded.wait_for ( lock, 5s, [ & ] ( ) {
+            return order.size ( ) >= expected.size ( );
+        } );
+        return order == expected;
+    };
+    stream << "Ensuring that tasks run in the order of their deadlines...\n";
+    scheduler.add (
+            [ & ] ( auto const &due ) {
+                record ( 'b', due );
+                return Scheduler::never;
+            },
+            start + 20ms );
+    scheduler.add (
+            [ & ] ( auto const &due ) {
+                record ( 'a', due );
+                return Scheduler::never;
+            },
+            start + 10ms );
+    auto sleeper = scheduler.add (
+            [ & ] ( auto const & ) {
+                record ( 'c', start );
+                return Scheduler::never;
+            },
+            Scheduler::never );
+    auto ticker = scheduler.add ( [ & ] ( auto const &deadline ) {
+        ticks++;
+        return deadline + 1ms;
+    } );
+    if ( !reaches ( "ab" ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Tasks ran out of order or too soon" )
+    }
+    stream << "Ensuring that waking runs a sleeping task...\n";
+    scheduler.wake ( sleeper );
+    if ( !reaches ( "abc" ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "A woken task did not run" )
+    }
+    stream << "Ensuring that rushing cuts a delay short...\n";
+    auto waiter = scheduler.add (
+            [ & ] ( auto const & ) {
+                record ( 'd', start );
+                return Scheduler::never;
+            },
+            Scheduler::Clock::now ( ) + 1h );
+    scheduler.rush ( waiter );
+    if ( !reaches ( "abcd" ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "A rushed task did not run" )
+    }
+    stream << "Ensuring that a removed task stops running...\n";
+    // the ticker was due before either of the first two tasks, so it has
+    // run by now.
+    scheduler.remove ( ticker );
+    int const after = ticks.load ( );
+    std::this_thread::sleep_for ( 10ms );
+    if ( !after || ticks.load ( ) != after )
+    {
+        BASIC_UNIT_FAIL ( stream, "A periodic task did not run or stop" )
+    }
+    return true;
+}
+
+test::Unittest schedulerTest { &testScheduler };
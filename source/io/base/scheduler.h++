@@ -0,0 +1,70 @@
+/**
+ * @file scheduler.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Runs timed tasks on one shared thread
+ * @version 1
+ * @date 2022-03-05
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <defines/macros.h++>
+#include <defines/types.h++>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace io::base
+{
+    /**
+     * @brief Runs tasks at their deadlines on a single thread, which sleeps
+     * until the earliest deadline or until something wakes a task. Tasks run
+     * one at a time, so a task that blocks holds up every other task.
+     */
+    class Scheduler
+    {
+        struct impl_s;
+        std::unique_ptr< impl_s > pimpl;
+    public:
+        using Clock     = std::chrono::steady_clock;
+        using TimePoint = Clock::time_point;
+        using TaskID    = std::uint64_t;
+        /**
+         * @brief Given the deadline it ran for, returns the next one. A task
+         * returning never sleeps until it is woken.
+         */
+        using Task      = std::function< TimePoint ( TimePoint const & ) >;
+
+        static constexpr TimePoint never = TimePoint::max ( );
+
+        Scheduler ( );
+        virtual ~Scheduler ( );
+
+        /**
+         * @brief The scheduler that the console's threads share.
+         */
+        static Scheduler &shared ( );
+
+        TaskID add ( Task const &, TimePoint const &first = Clock::now ( ) );
+        /**
+         * @brief Runs a sleeping task right away. Does nothing to a task that
+         * is waiting on a deadline, so waking never cuts a delay short.
+         */
+        void   wake ( TaskID const & ) noexcept;
+        /**
+         * @brief Runs the task right away, sleeping or not, cutting short the
+         * delay it was waiting on.
+         */
+        void   rush ( TaskID const & ) noexcept;
+        /**
+         * @brief Removes the task, waiting for it to finish if it is running.
+         * Once this returns, the task will never run again.
+         */
+        void   remove ( TaskID const & ) noexcept;
+    };
+} // namespace io::base
@@ -0,0 +1,324 @@
+/**
+ * @file backend.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief The standard backend
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/console/backend.h++>
+
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <io/base/syncstream.h++>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#ifdef WINDOWS
+#    include "windows.h"
+#else
+#    include <cerrno>
+#    include <csignal>
+#    include <fcntl.h>
+#    include <poll.h>
+#    include <sys/ioctl.h>
+#    include <termios.h>
+#    include <unistd.h>
+#endif // ifdef windows
+
+#ifndef WINDOWS
+// raised by SIGWINCH, so it must never need a lock.
+std::atomic_bool standardResized = true;
+static_assert ( std::atomic_bool::is_always_lock_free );
+// the end of the pipe that wakes a read, which SIGWINCH writes to so that
+// whoever reads hears of the new size at once.
+std::atomic_int  standardWakeFd = -1;
+static_assert ( std::atomic_int::is_always_lock_free );
+
+void standardResizeHandler ( int )
+{
+    standardResized.store ( true );
+    int const fd = standardWakeFd.load ( );
+    if ( fd >= 0 )
+    {
+        // write may change errno, which the code the signal cut into may
+        // be about to look at.
+        int const  saved = errno;
+        char const byte  = 0;
+        [[maybe_unused]] ssize_t const written = ::write ( fd, &byte, 1 );
+        errno = saved;
+    }
+}
+
+// how the terminal was before raw mode, which the handlers below put back,
+// so they must never need a lock either.
+termios          standardCooked = { };
+std::atomic_bool standardIsRaw  = false;
+
+void standardRestore ( )
+{
+    if ( standardIsRaw.exchange ( false ) )
+    {
+        tcsetattr ( STDIN_FILENO, TCSANOW, &standardCooked );
+    }
+}
+
+// a signal that ends the program would leave the shell in raw mode, so put
+// the terminal back before letting the signal do what it would have done.
+void standardRestoreHandler ( int number )
+{
+    standardRestore ( );
+    std::signal ( number, SIG_DFL );
+    std::raise ( number );
+}
+#endif
+
+// what the environment says the terminal can show. Windows' own terminal
+// understands true color wherever it understands escape sequences at all.
+io::console::ColorDepth standardColorDepth ( )
+{
+    using io::console::ColorDepth;
+#ifdef WINDOWS
+    return ColorDepth::TRUECOLOR;
+#else
+    std::string_view const colorterm = std::getenv ( "COLORTERM" )
+                                             ? std::getenv ( "COLORTERM" )
+                                             : "";
+    std::string_view const term      = std::getenv ( "TERM" )
+                                             ? std::getenv ( "TERM" )
+                                             : "";
+    if ( colorterm == "truecolor" || colorterm == "24bit" )
+    {
+        return ColorDepth::TRUECOLOR;
+    } else if ( term.find ( "256color" ) != std::string_view::npos )
+    {
+        return ColorDepth::XTERM_256;
+    } else if ( term.empty ( ) || term == "dumb" || term == "linux"
+                || term.starts_with ( "vt" ) || term == "ansi" )
+    {
+        return ColorDepth::EIGHT;
+    } else
+    {
+        return ColorDepth::SIXTEEN;
+    }
+#endif
+}
+
+class StandardBackend : public io::console::Backend
+{
+#ifdef WINDOWS
+    HANDLE wake = CreateEvent ( nullptr, FALSE, FALSE, nullptr );
+#else
+    // interrupt writes to one end to wake the poll waiting on the other.
+    int    wake [ 2 ] = { -1, -1 };
+#endif
+    io::console::ColorDepth const depth = standardColorDepth ( );
+public:
+    StandardBackend ( )
+    {
+#ifndef WINDOWS
+        struct sigaction action = { };
+        action.sa_handler       = &standardResizeHandler;
+        sigemptyset ( &action.sa_mask );
+        // so that a resize does not cut short a read of standard input.
+        action.sa_flags = SA_RESTART;
+        sigaction ( SIGWINCH, &action, nullptr );
+        action.sa_handler = &standardRestoreHandler;
+        action.sa_flags   = 0;
+        for ( int const number : { SIGINT, SIGTERM, SIGHUP, SIGQUIT } )
+        {
+            // a signal we were told to ignore stays ignored.
+            struct sigaction previous = { };
+            sigaction ( number, nullptr, &previous );
+            if ( previous.sa_handler != SIG_IGN )
+            {
+                sigaction ( number, &action, nullptr );
+            }
+        }
+        std::atexit ( &standardRestore );
+        if ( pipe2 ( wake, O_NONBLOCK | O_CLOEXEC ) != 0 )
+        {
+            RUNTIME_ERROR ( "Could not make the input pipe!" )
+        }
+        standardWakeFd.store ( wake [ 1 ] );
+#endif
+    }
+
+    void write ( std::string_view const &bytes ) override
+    {
+        // each write synchronizes on its own, like the channels used to.
+        io::base::osyncstream stream { std::cout.rdbuf ( ) };
+        stream.write ( bytes.data ( ), std::streamsize ( bytes.size ( ) ) );
+        stream.emit ( );
+    }
+
+    bool read ( std::string                     &bytes,
+                std::chrono::milliseconds const &timeout ) override
+    {
+        char buffer [ 256 ];
+#ifdef WINDOWS
+        HANDLE const hcin      = GetStdHandle ( STD_INPUT_HANDLE );
+        HANDLE       waits [ 2 ] = { hcin, wake };
+        DWORD const  wait        = timeout.count ( ) < 0
+                                         ? INFINITE
+                                         : DWORD ( timeout.count ( ) );
+        if ( WaitForMultipleObjects ( 2, waits, FALSE, wait )
+             != WAIT_OBJECT_0 )
+        {
+            return true;
+        }
+        DWORD got = 0;
+        if ( !ReadFile ( hcin, buffer, sizeof ( buffer ), &got, nullptr )
+             || !got )
+        {
+            return false;
+        }
+        bytes.append ( buffer, got );
+        return true;
+#else
+        pollfd waits [ 2 ] = { { STDIN_FILENO, POLLIN, 0 },
+                               { wake [ 0 ], POLLIN, 0 } };
+        int const wait     = timeout.count ( ) < 0
+                                   ? -1
+                                   : int ( std::min< std::int64_t > (
+                                           timeout.count ( ),
+                                           INT_MAX ) );
+        if ( poll ( waits, 2, wait ) < 0 )
+        {
+            // a signal, such as SIGWINCH, cut the wait short.
+            return errno == EINTR;
+        }
+        if ( waits [ 1 ].revents & POLLIN )
+        {
+            while ( ::read ( wake [ 0 ], buffer, sizeof ( buffer ) ) > 0 ) { }
+        }
+        if ( waits [ 0 ].revents & ( POLLIN | POLLHUP | POLLERR ) )
+        {
+            ssize_t const got =
+                    ::read ( STDIN_FILENO, buffer, sizeof ( buffer ) );
+            if ( got <= 0 )
+            {
+                return got < 0 && errno == EINTR;
+            }
+            bytes.append ( buffer, std::size_t ( got ) );
+        }
+        return true;
+#endif
+    }
+
+    void interrupt ( ) noexcept override
+    {
+#ifdef WINDOWS
+        SetEvent ( wake );
+#else
+        char const byte = 0;
+        // a full pipe already holds a wake-up, so a write that fails is fine.
+        [[maybe_unused]] ssize_t const written =
+                ::write ( wake [ 1 ], &byte, 1 );
+#endif
+    }
+
+    void setRaw ( bool const &raw ) override
+    {
+#ifdef WINDOWS
+        HANDLE const hcin = GetStdHandle ( STD_INPUT_HANDLE );
+        DWORD        mode = 0;
+        GetConsoleMode ( hcin, &mode );
+        if ( raw )
+        {
+            mode &= ~( ENABLE_LINE_INPUT | ENABLE_ECHO_INPUT );
+            mode |= ENABLE_VIRTUAL_TERMINAL_INPUT;
+        } else
+        {
+            mode |= ENABLE_LINE_INPUT | ENABLE_ECHO_INPUT;
+        }
+        SetConsoleMode ( hcin, mode );
+#else
+        if ( !raw )
+        {
+            standardRestore ( );
+            return;
+        }
+        // piped input has no modes to change.
+        if ( standardIsRaw.load ( ) || !isatty ( STDIN_FILENO )
+             || tcgetattr ( STDIN_FILENO, &standardCooked ) != 0 )
+        {
+            return;
+        }
+        termios rawMode = standardCooked;
+        // keys come one at a time without echoing, and enter comes as a
+        // return. The signal keys still work, as does turning newlines into
+        // returns and line feeds on output.
+        rawMode.c_lflag &= ~( ICANON | ECHO | IEXTEN );
+        rawMode.c_iflag &= ~( ICRNL | IXON );
+        rawMode.c_cc [ VMIN ]  = 1;
+        rawMode.c_cc [ VTIME ] = 0;
+        standardIsRaw.store ( true );
+        tcsetattr ( STDIN_FILENO, TCSANOW, &rawMode );
+#endif
+    }
+
+    bool size ( std::uint32_t &rows, std::uint32_t &cols ) override
+    {
+#ifdef WINDOWS
+        HANDLE                     hcout = GetStdHandle ( STD_OUTPUT_HANDLE );
+        CONSOLE_SCREEN_BUFFER_INFO info;
+        GetConsoleScreenBufferInfo ( hcout, &info );
+        rows = info.dwSize.Y;
+        cols = info.dwSize.X;
+#else
+        winsize window = { };
+        if ( ioctl ( STDOUT_FILENO, TIOCGWINSZ, &window ) == 0
+             && window.ws_row && window.ws_col )
+        {
+            rows = window.ws_row;
+            cols = window.ws_col;
+            return true;
+        }
+        // not a terminal, so fall back on the environment variables.
+        defines::ChrChar *_rows = std::getenv ( "ROWS" );
+        defines::ChrChar *_cols = std::getenv ( "COLUMNS" );
+
+        defines::ChrStringStream rowStream { _rows ? _rows : "25" };
+        defines::ChrStringStream colStream { _cols ? _cols : "80" };
+        rowStream >> rows;
+        colStream >> cols;
+#endif
+        return true;
+    }
+
+    bool resized ( ) noexcept override
+    {
+#ifdef WINDOWS
+        // nothing tells us, but asking is cheap.
+        return true;
+#else
+        return standardResized.exchange ( false );
+#endif
+    }
+
+    io::console::ColorDepth colorDepth ( ) const noexcept override
+    {
+        return depth;
+    }
+};
+
+std::shared_ptr< io::console::Backend > io::console::standardBackend ( )
+{
+    // never destroyed, since a console's threads may still be using it while
+    // the program exits.
+    static auto const *const backend = new std::shared_ptr< Backend > (
+            std::make_shared< StandardBackend > ( ) );
+    return *backend;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file backend.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Where the console's bytes go and where its replies come from
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace io::console
+{
+    /**
+     * @brief How many colors a terminal can show, from fewest to most.
+     */
+    enum class ColorDepth : std::uint8_t
+    {
+        // the eight CGA colors.
+        EIGHT,
+        // the CGA colors and their bright versions, as aixterm added.
+        SIXTEEN,
+        // the xterm 256-color palette.
+        XTERM_256,
+        // any 24-bit color.
+        TRUECOLOR,
+    };
+
+    /**
+     * @brief The terminal as the console sees it. Both of the console's
+     * channels write to it from the shared scheduler, so a backend must take
+     * writes from more than one thread.
+     */
+    class Backend
+    {
+    public:
+        virtual ~Backend ( ) = default;
+
+        /**
+         * @brief Writes the bytes all together, never mixing them with the
+         * bytes of another write.
+         */
+        virtual void        write ( std::string_view const & ) = 0;
+        /**
+         * @brief Waits up to the timeout, or for as long as it takes if the
+         * timeout is negative, for the terminal to say something, such as a
+         * key or a cursor report, and appends whatever it said. Only one
+         * thread may read at a time.
+         *
+         * @return false once the terminal will never say anything more.
+         */
+        virtual bool        read ( std::string                     &bytes,
+                                   std::chrono::milliseconds const &timeout ) =
+                0;
+        /**
+         * @brief Makes a read waiting on another thread return early, or the
+         * next read if none is waiting.
+         */
+        virtual void        interrupt ( ) noexcept = 0;
+        /**
+         * @brief Puts the terminal in raw mode, where it hands over each key as
+         * it is pressed instead of a line at a time and does not echo them,
+         * or takes it out again.
+         */
+        virtual void        setRaw ( bool const & ) = 0;
+        /**
+         * @brief The size of the terminal.
+         *
+         * @return false, leaving the arguments alone, if it is not known.
+         */
+        virtual bool        size ( std::uint32_t &rows,
+                                   std::uint32_t &cols ) = 0;
+        /**
+         * @brief Whether the terminal may have changed size since the last
+         * call, which is always so for the first call. A backend that learns
+         * of a change by itself also wakes a read waiting on another thread,
+         * so that the reader can pass it on.
+         */
+        virtual bool        resized ( ) noexcept = 0;
+        /**
+         * @brief How many colors the terminal can show, which the console
+         * brings every color it sends down to.
+         */
+        virtual ColorDepth  colorDepth ( ) const noexcept = 0;
+    };
+
+    /**
+     * @brief The backend for the process's own terminal, on standard output
+     * and standard input. On Linux it learns of changes in size from SIGWINCH
+     * and asks the terminal for its size with TIOCGWINSZ, and it waits for
+     * input with poll, which interrupt and SIGWINCH wake through a pipe. The
+     * terminal leaves raw mode when the program exits, even on a signal. It
+     * takes the terminal's colors from COLORTERM and TERM.
+     */
+    std::shared_ptr< Backend > standardBackend ( );
+} // namespace io::console
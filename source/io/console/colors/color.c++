@@ -19,8 +19,10 @@
 #include <cmath>
 #include <functional>
 #include <iostream>
+#include <span>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 using namespace io::console::colors;
 
@@ -42,44 +44,44 @@ defines::BoundColor const
     }
 }
 
-defines::UnboundColor const io::console::colors::IColor::normalizeColor (
-        defines::UnboundColor *const &color ) noexcept
-{
-    defines::UnboundColor magnitude =
-            std::hypot ( color [ 0 ], color [ 1 ], color [ 2 ] );
-    if ( magnitude == 0 )
-    {
-        return 0.0;
-    }
-    for ( std::size_t i = 0; i < 3; i++ ) { color [ i ] /= magnitude; }
-    return magnitude;
-}
-
 io::console::colors::IColor::IColor ( ) noexcept :
-        cache { 0, 0, 0, 0 }, color { 0, 0, 0, 0 }, basic { 0, 0, 0, 0 }
+        cache { 0, 0, 0, 0 }, color ( ), basic { 0, 0, 0, 0 }
 { }
 
-defines::UnboundColor const *const
+ColorValue
         io::console::colors::IColor::rgba ( double const &time ) const noexcept
 {
     refresh ( time );
     return rgbaRaw ( );
 }
 
-defines::UnboundColor const *const
+ColorValue
         io::console::colors::IColor::cmyk ( double const &time ) const noexcept
 {
     refresh ( time );
     return cmykRaw ( );
 }
 
-defines::UnboundColor const *const
+ColorValue
         io::console::colors::IColor::cmya ( double const &time ) const noexcept
 {
     refresh ( time );
     return cmyaRaw ( );
 }
 
+std::vector< IColor::Parameter >
+        io::console::colors::IColor::parameters ( ) const
+{
+    return { };
+}
+
+ColorValue io::console::colors::IColor::evaluate (
+        double const &time,
+        std::span< ColorValue const > const & ) const noexcept
+{
+    return rgba ( time );
+}
+
 defines::UnboundColor const &io::console::colors::IColor::getBasicComponent (
         std::size_t const &i ) const
 {
@@ -11,6 +11,8 @@
  */
 #pragma once
 
+#include <io/console/colors/value.h++>
+
 #include <defines/constants.h++>
 #include <defines/macros.h++>
 #include <defines/types.h++>
@@ -18,8 +20,11 @@
 #include <cmath>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <span>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 namespace io::console::colors
 {
@@ -31,21 +36,14 @@ namespace io::console::colors
         // cache for any use by some subclass
         defines::UnboundColor mutable cache [ 4 ];
         // the color for current use
-        defines::UnboundColor mutable color [ 4 ];
+        ColorValue mutable            color;
         // blend arguments we receive, these are what's written to the
         // color
         defines::UnboundColor mutable basic [ 4 ];
-        // the raw-getter functions are expected to allocate a new buffer.
         // a call to refresh always preceeds these functions.
-        virtual defines::UnboundColor const *const
-                rgbaRaw ( ) const noexcept = 0;
-        virtual defines::UnboundColor const *const
-                cmykRaw ( ) const noexcept = 0;
-        virtual defines::UnboundColor const *const
-                cmyaRaw ( ) const noexcept = 0;
-
-        static defines::UnboundColor const
-                normalizeColor ( defines::UnboundColor *const &color ) noexcept;
+        virtual ColorValue rgbaRaw ( ) const noexcept = 0;
+        virtual ColorValue cmykRaw ( ) const noexcept = 0;
+        virtual ColorValue cmyaRaw ( ) const noexcept = 0;
     public:
         POLYMORPHIC_IDENTIFIER ( IColor )
 
@@ -56,16 +54,36 @@ namespace io::console::colors
         IColor &operator= ( IColor const & ) noexcept = default;
         IColor &operator= ( IColor && ) noexcept = default;
 
-        defines::UnboundColor const *const
-                rgba ( double const & = 0 ) const noexcept;
-        defines::UnboundColor const *const
-                cmyk ( double const & = 0 ) const noexcept;
-        defines::UnboundColor const *const
-                cmya ( double const & = 0 ) const noexcept;
+        ColorValue rgba ( double const & = 0 ) const noexcept;
+        ColorValue cmyk ( double const & = 0 ) const noexcept;
+        ColorValue cmya ( double const & = 0 ) const noexcept;
 
         virtual void refresh ( double const &time = 0 ) const noexcept   = 0;
         virtual bool references ( IColor const *const & ) const noexcept = 0;
 
+        /**
+         * @brief A color this one is calculated from, and how far from the
+         * time it is looked at.
+         */
+        struct Parameter
+        {
+            std::shared_ptr< IColor > color;
+            double                    offset = 0;
+        };
+        /**
+         * @brief The colors this one is calculated from, in the order that
+         * evaluate takes them. A color with none does not change with time.
+         */
+        virtual std::vector< Parameter > parameters ( ) const;
+        /**
+         * @brief The color in RGBA at the time, as rgba gives it, but from
+         * its parameters' colors in RGBA instead of asking them.
+         */
+        virtual ColorValue
+                evaluate ( double const                        &time,
+                           std::span< ColorValue const > const &parameters )
+                        const noexcept;
+
         defines::UnboundColor const &
                 getBasicComponent ( std::size_t const & ) const;
 
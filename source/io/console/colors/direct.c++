@@ -13,6 +13,7 @@
 #include <io/console/colors/direct.h++>
 
 #include <io/console/colors/color.h++>
+#include <io/console/colors/value.h++>
 
 #include <defines/constants.h++>
 #include <defines/macros.h++>
@@ -30,7 +31,7 @@ void io::console::colors::DirectColor::baseRefresh ( ) const noexcept
 {
     for ( std::size_t i = 0; i < 4; i++ )
     {
-        this->color [ i ] = this->basic [ i ];
+        this->color.set ( i, this->basic [ i ] );
     }
 }
 
@@ -41,10 +42,11 @@ io::console::colors::DirectColor::DirectColor (
         defines::UnboundColor const &_4 ) noexcept :
         DirectColor ( )
 {
-    this->color [ 0 ] = _1;
-    this->color [ 1 ] = _2;
-    this->color [ 2 ] = _3;
-    this->color [ 3 ] = _4;
+    // the blend arguments are the color, and refresh copies them over.
+    this->basic [ 0 ] = _1;
+    this->basic [ 1 ] = _2;
+    this->basic [ 2 ] = _3;
+    this->basic [ 3 ] = _4;
     baseRefresh ( );
 }
 
@@ -60,169 +62,47 @@ bool io::console::colors::DirectColor::references (
     return color == this;
 }
 
-defines::UnboundColor const *const
-        io::console::colors::RGBAColor::rgbaRaw ( ) const noexcept
+ColorValue io::console::colors::RGBAColor::rgbaRaw ( ) const noexcept
 {
-    defines::UnboundColor *result = new defines::UnboundColor [ 4 ];
-    for ( std::size_t i = 0; i < 4; i++ ) { result [ i ] = this->color [ i ]; }
-    return result;
+    return this->color;
 }
 
-defines::UnboundColor const *const
-        io::console::colors::RGBAColor::cmykRaw ( ) const noexcept
+ColorValue io::console::colors::RGBAColor::cmykRaw ( ) const noexcept
 {
-    defines::UnboundColor *result    = ( defines::UnboundColor    *) rgbaRaw ( );
-    defines::UnboundColor  magnitude = DirectColor::normalizeColor ( result );
-    if ( magnitude == 0 )
-    {
-        result [ 0 ] = result [ 1 ] = result [ 2 ] = 0;
-        result [ 3 ]                               = 255;
-    } else
-    {
-        result [ 3 ] = 1
-                     - std::max ( {
-                             result [ 0 ],
-                             result [ 1 ],
-                             result [ 2 ],
-                     } );
-        for ( std::size_t i = 0; i < 3; i++ )
-        {
-            result [ i ] =
-                    ( 1 - result [ i ] - result [ 3 ] ) / ( 1 - result [ 3 ] );
-            result [ i ] *= magnitude;
-        }
-        result [ 3 ] *= magnitude;
-    }
-    return result;
+    return rgbaToCMYK ( this->color );
 }
 
-defines::UnboundColor const *const
-        io::console::colors::RGBAColor::cmyaRaw ( ) const noexcept
+ColorValue io::console::colors::RGBAColor::cmyaRaw ( ) const noexcept
 {
-    defines::UnboundColor *result    = ( defines::UnboundColor    *) rgbaRaw ( );
-    defines::UnboundColor  magnitude = DirectColor::normalizeColor ( result );
-    if ( magnitude == 0 )
-    {
-        result [ 0 ] = result [ 1 ] = result [ 2 ] = 255;
-    } else
-    {
-        for ( std::size_t i = 0; i < 3; i++ )
-        {
-            result [ i ] = 1 - result [ i ];
-            result [ i ] *= magnitude;
-        }
-    }
-    return result;
+    return rgbaToCMYA ( this->color );
 }
 
-defines::UnboundColor const *const
-        io::console::colors::CMYAColor::rgbaRaw ( ) const noexcept
+ColorValue io::console::colors::CMYAColor::rgbaRaw ( ) const noexcept
 {
-    defines::UnboundColor *result    = ( defines::UnboundColor    *) cmyaRaw ( );
-    defines::UnboundColor  magnitude = DirectColor::normalizeColor ( result );
-    if ( magnitude == 0 )
-    {
-        result [ 0 ] = result [ 1 ] = result [ 2 ] = 255;
-    } else
-    {
-        for ( std::size_t i = 0; i < 3; i++ )
-        {
-            result [ i ] = 1 - result [ i ];
-            result [ i ] *= magnitude;
-        }
-    }
-    return result;
+    return cmyaToRGBA ( this->color );
 }
 
-defines::UnboundColor const *const
-        io::console::colors::CMYAColor::cmykRaw ( ) const noexcept
+ColorValue io::console::colors::CMYAColor::cmykRaw ( ) const noexcept
 {
-    defines::UnboundColor *result    = ( defines::UnboundColor    *) cmyaRaw ( );
-    defines::UnboundColor  magnitude = DirectColor::normalizeColor ( result );
-    if ( magnitude == 0 )
-    {
-        result [ 0 ] = result [ 1 ] = result [ 2 ] = 0;
-        result [ 3 ]                               = 255;
-    } else
-    {
-        for ( std::size_t i = 0; i < 3; i++ )
-        {
-            result [ i ] =
-                    ( result [ i ] - result [ 3 ] ) / ( 1 - result [ 3 ] );
-            result [ i ] *= magnitude;
-        }
-        result [ 3 ] *= magnitude;
-    }
-    return result;
+    return cmyaToCMYK ( this->color );
 }
 
-defines::UnboundColor const *const io::console::colors::CMYAColor::cmyaRaw() const noexcept
+ColorValue io::console::colors::CMYAColor::cmyaRaw ( ) const noexcept
 {
-    defines::UnboundColor *result = new defines::UnboundColor [ 4 ];
-    for ( std::size_t i = 0; i < 4; i++ ) { result [ i ] = this->color [ i ]; }
-    return result;
+    return this->color;
 }
 
-defines::UnboundColor const *const io::console::colors::CMYKColor::rgbaRaw() const noexcept
+ColorValue io::console::colors::CMYKColor::rgbaRaw ( ) const noexcept
 {
-    defines::UnboundColor *result    = ( defines::UnboundColor    *) cmykRaw ( );
-    // more unique: hypot 4. Because of how the colors work,
-    // all valid cmyk colors have a magnitude != 0.
-    defines::UnboundColor  magnitude = 0;
-    for ( std::size_t i = 0; i < 4; i++ )
-    {
-        magnitude += result [ i ] * result [ i ];
-    }
-    magnitude = std::sqrt ( magnitude );
-    for ( std::size_t i = 0; i < 4; i++ ) { result [ i ] /= magnitude; }
-
-    // cmyk formaula for a color component n solved for rgba
-    // a = 0
-    // n_k = (1 - n_a - k) / (1 - k)
-    // n_k * (1 - k ) = 1 - n_a - k
-    // n_k * (1 - k ) + k - 1 = -n_a
-    // 1 - k - n_k * (1 - k ) = n_a
-    // (1 - k)(1 - n_k) = n_a
-
-    for ( std::size_t i = 0; i < 3; i++ )
-    {
-        result [ i ] = ( 1 - result [ 3 ] ) * ( 1 - result [ i ] );
-        result [ i ] *= magnitude;
-    }
-    result [ 3 ] = 0;
-    return result;
+    return cmykToRGBA ( this->color );
 }
 
-defines::UnboundColor const *const io::console::colors::CMYKColor::cmykRaw() const noexcept
+ColorValue io::console::colors::CMYKColor::cmykRaw ( ) const noexcept
 {
-    defines::UnboundColor *result = new defines::UnboundColor [ 4 ];
-    for ( std::size_t i = 0; i < 4; i++ ) { result [ i ] = this->color [ i ]; }
-    return result;
+    return this->color;
 }
 
-defines::UnboundColor const *const io::console::colors::CMYKColor::cmyaRaw() const noexcept
+ColorValue io::console::colors::CMYKColor::cmyaRaw ( ) const noexcept
 {
-    defines::UnboundColor *result    = ( defines::UnboundColor    *) cmykRaw ( );
-    // more unique: hypot 4. Because of how the colors work,
-    // all valid cmyk colors have a magnitude != 0.
-    defines::UnboundColor  magnitude = 0;
-    for ( std::size_t i = 0; i < 4; i++ )
-    {
-        magnitude += result [ i ] * result [ i ];
-    }
-    magnitude = std::sqrt ( magnitude );
-    for ( std::size_t i = 0; i < 4; i++ ) { result [ i ] /= magnitude; }
-
-    // cmyk formaula for a color component n solved for cmya
-    // a = 0
-    // n_k = (n_a - k) / (1 - k)
-    // n_k(1 - k) + k = n_a
-
-    for ( std::size_t i = 0; i < 3; i++ )
-    {
-        result [ i ] = result [ i ] * ( 1 - result [ 3 ] ) + result [ 3 ];
-        result [ i ] *= magnitude;
-    }
-    result [ 3 ] = 0;
-    return result;
-}
\ No newline at end of file
+    return cmykToCMYA ( this->color );
+}
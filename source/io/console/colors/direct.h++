@@ -58,14 +58,9 @@ namespace io::console::colors
     class RGBAColor : public DirectColor
     {
     protected:
-        virtual defines::UnboundColor const *const
-                rgbaRaw ( ) const noexcept override final;
-
-        virtual defines::UnboundColor const *const
-                cmykRaw ( ) const noexcept override final;
-
-        virtual defines::UnboundColor const *const
-                cmyaRaw ( ) const noexcept override final;
+        virtual ColorValue rgbaRaw ( ) const noexcept override final;
+        virtual ColorValue cmykRaw ( ) const noexcept override final;
+        virtual ColorValue cmyaRaw ( ) const noexcept override final;
     public:
         POLYMORPHIC_IDENTIFIER ( RGBAColor )
         RGBAColor ( ) noexcept = default;
@@ -85,14 +80,9 @@ namespace io::console::colors
     class CMYAColor : public DirectColor
     {
     protected:
-        virtual defines::UnboundColor const *const
-                rgbaRaw ( ) const noexcept override final;
-
-        virtual defines::UnboundColor const *const
-                cmykRaw ( ) const noexcept override final;
-
-        virtual defines::UnboundColor const *const
-                cmyaRaw ( ) const noexcept override final;
+        virtual ColorValue rgbaRaw ( ) const noexcept override final;
+        virtual ColorValue cmykRaw ( ) const noexcept override final;
+        virtual ColorValue cmyaRaw ( ) const noexcept override final;
     public:
         POLYMORPHIC_IDENTIFIER ( CMYAColor )
         CMYAColor ( ) noexcept = default;
@@ -112,13 +102,9 @@ namespace io::console::colors
     class CMYKColor : public DirectColor
     {
     protected:
-        virtual defines::UnboundColor const *const
-                rgbaRaw ( ) const noexcept override final;
-        virtual defines::UnboundColor const *const
-                cmykRaw ( ) const noexcept override final;
-
-        virtual defines::UnboundColor const *const
-                cmyaRaw ( ) const noexcept override final;
+        virtual ColorValue rgbaRaw ( ) const noexcept override final;
+        virtual ColorValue cmykRaw ( ) const noexcept override final;
+        virtual ColorValue cmyaRaw ( ) const noexcept override final;
     public:
         POLYMORPHIC_IDENTIFIER ( CMYKColor )
         CMYKColor ( ) noexcept = default;
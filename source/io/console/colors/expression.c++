@@ -0,0 +1,467 @@
+/**
+ * @file expression.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Compiling and evaluating blend expressions
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/console/colors/expression.h++>
+
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <io/console/colors/indirect.h++>
+#include <io/console/colors/value.h++>
+#include <test/unittester.h++>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iostream>
+#include <numbers>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using io::console::colors::BlendExpression;
+using io::console::colors::ColorValue;
+
+// a recursive descent parser, which writes the code as it goes. Every
+// operator comes after its operands, so the code runs on a stack.
+class io::console::colors::BlendExpression::Compiler
+{
+    std::string_view source;
+    std::size_t      at = 0;
+    BlendExpression &out;
+    // how much would be on the stack at this point in the code.
+    int              depth   = 0;
+    // how many factors the parser is inside of. Parentheses and signs put
+    // nothing on the stack, so they are counted here instead, before they
+    // can run the parser out of its own stack.
+    std::size_t      nesting = 0;
+
+    [[noreturn]] void fail ( std::string_view const &what )
+    {
+        RUNTIME_ERROR ( what << " at " << at << " in \"" << source << "\"" )
+    }
+
+    // whether the next character is, as the C library sees it.
+    bool next ( int ( *is ) ( int ) ) const noexcept
+    {
+        return at < source.size ( ) && is ( ( unsigned char ) source [ at ] );
+    }
+
+    bool startsNumber ( ) const noexcept
+    {
+        return next ( std::isdigit )
+            || ( at < source.size ( ) && source [ at ] == '.' );
+    }
+
+    void skipSpace ( ) noexcept
+    {
+        while ( next ( std::isspace ) ) { at++; }
+    }
+
+    bool accept ( char const &c ) noexcept
+    {
+        skipSpace ( );
+        if ( at < source.size ( ) && source [ at ] == c )
+        {
+            at++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect ( char const &c )
+    {
+        if ( !accept ( c ) )
+        {
+            fail ( std::string ( "Expected '" ) + c + "'" );
+        }
+    }
+
+    // pushes is how much the operation puts on the stack, less what it takes
+    // off.
+    void emit ( Op const &op, int const &pushes )
+    {
+        out.code.push_back ( op );
+        depth += pushes;
+        if ( depth > int ( maxDepth ) )
+        {
+            fail ( "Nested too deeply" );
+        }
+    }
+
+    void sum ( )
+    {
+        product ( );
+        while ( true )
+        {
+            if ( accept ( '+' ) )
+            {
+                product ( );
+                emit ( Op::ADD, -1 );
+            } else if ( accept ( '-' ) )
+            {
+                product ( );
+                emit ( Op::SUBTRACT, -1 );
+            } else
+            {
+                return;
+            }
+        }
+    }
+
+    void product ( )
+    {
+        factor ( );
+        while ( true )
+        {
+            if ( accept ( '*' ) )
+            {
+                factor ( );
+                emit ( Op::MULTIPLY, -1 );
+            } else if ( accept ( '/' ) )
+            {
+                factor ( );
+                emit ( Op::DIVIDE, -1 );
+            } else
+            {
+                return;
+            }
+        }
+    }
+
+    void factor ( )
+    {
+        if ( ++nesting > maxDepth )
+        {
+            fail ( "Nested too deeply" );
+        }
+        if ( accept ( '-' ) )
+        {
+            factor ( );
+            emit ( Op::NEGATE, 0 );
+        } else if ( accept ( '(' ) )
+        {
+            sum ( );
+            expect ( ')' );
+        } else if ( startsNumber ( ) )
+        {
+            number ( );
+        } else
+        {
+            name ( );
+        }
+        nesting--;
+    }
+
+    void number ( )
+    {
+        std::size_t const start = at;
+        while ( startsNumber ( ) ) { at++; }
+        // an exponent, with its sign. Nothing else can follow a number, so
+        // a letter e without digits after it is a bad number.
+        if ( at < source.size ( )
+             && ( source [ at ] == 'e' || source [ at ] == 'E' ) )
+        {
+            at++;
+            if ( at < source.size ( )
+                 && ( source [ at ] == '+' || source [ at ] == '-' ) )
+            {
+                at++;
+            }
+            while ( next ( std::isdigit ) ) { at++; }
+        }
+        std::string const     digits ( source.substr ( start, at - start ) );
+        std::size_t           used  = 0;
+        defines::UnboundColor value = 0;
+        try
+        {
+            value = std::stod ( digits, &used );
+        } catch ( std::logic_error const & )
+        { }
+        if ( used != digits.size ( ) )
+        {
+            at = start;
+            fail ( "Expected a number" );
+        }
+        constant ( value );
+    }
+
+    void constant ( defines::UnboundColor const &value )
+    {
+        out.constants.push_back ( ColorValue ( value, value, value, value ) );
+        emit ( Op::CONSTANT, 1 );
+    }
+
+    // the arguments to a function, in order, and then the function.
+    void call ( Op const &op, std::size_t const &arguments )
+    {
+        expect ( '(' );
+        for ( std::size_t i = 0; i < arguments; i++ )
+        {
+            if ( i )
+            {
+                expect ( ',' );
+            }
+            sum ( );
+        }
+        expect ( ')' );
+        emit ( op, 1 - int ( arguments ) );
+    }
+
+    void name ( )
+    {
+        std::size_t const start = at;
+        while ( next ( std::isalpha ) ) { at++; }
+        std::string_view const word = source.substr ( start, at - start );
+        if ( word == "time" )
+        {
+            emit ( Op::TIME, 1 );
+        } else if ( word == "pi" )
+        {
+            constant ( std::numbers::pi );
+        } else if ( word == "basic" )
+        {
+            emit ( Op::BASIC, 1 );
+        } else if ( word == "amplitude" )
+        {
+            emit ( Op::AMPLITUDE, 1 );
+        } else if ( word == "fm" )
+        {
+            emit ( Op::FM, 1 );
+        } else if ( word == "am" )
+        {
+            emit ( Op::AM, 1 );
+        } else if ( word == "frequency" )
+        {
+            emit ( Op::FREQUENCY, 1 );
+        } else if ( word == "sin" )
+        {
+            call ( Op::SIN, 1 );
+        } else if ( word == "cos" )
+        {
+            call ( Op::COS, 1 );
+        } else if ( word == "clamp" )
+        {
+            call ( Op::CLAMP, 3 );
+        } else if ( word == "lerp" )
+        {
+            call ( Op::LERP, 3 );
+        } else
+        {
+            at = start;
+            fail ( "Expected a number or name" );
+        }
+    }
+public:
+    Compiler ( std::string_view const &source, BlendExpression &out ) :
+            source ( source ), out ( out )
+    { }
+
+    void compile ( )
+    {
+        sum ( );
+        skipSpace ( );
+        if ( at != source.size ( ) )
+        {
+            fail ( "Expected the end" );
+        }
+    }
+};
+
+io::console::colors::BlendExpression::BlendExpression (
+        std::string_view const &source )
+{
+    Compiler ( source, *this ).compile ( );
+}
+
+ColorValue io::console::colors::BlendExpression::evaluate (
+        double const                        &time,
+        ColorValue const                    &basic,
+        std::span< ColorValue const > const &parameters ) const noexcept
+{
+    ColorValue const now ( time, time, time, time );
+    auto const       parameter = [ & ] ( std::size_t const &i ) {
+        return i < parameters.size ( ) ? parameters [ i ] : ColorValue ( );
+    };
+    // the compiler made sure that nothing goes deeper than this.
+    ColorValue       stack [ maxDepth ];
+    std::size_t      top      = 0;
+    std::size_t      constant = 0;
+    for ( Op const &op : code )
+    {
+        switch ( op )
+        {
+            case Op::CONSTANT:
+                stack [ top++ ] = constants [ constant++ ];
+                break;
+            case Op::TIME: stack [ top++ ] = now; break;
+            case Op::BASIC: stack [ top++ ] = basic; break;
+            case Op::AMPLITUDE: stack [ top++ ] = parameter ( 0 ); break;
+            case Op::FM: stack [ top++ ] = parameter ( 1 ); break;
+            case Op::AM: stack [ top++ ] = parameter ( 2 ); break;
+            case Op::FREQUENCY: stack [ top++ ] = parameter ( 3 ); break;
+            case Op::ADD:
+                top--;
+                stack [ top - 1 ].lanes =
+                        stack [ top - 1 ].lanes + stack [ top ].lanes;
+                break;
+            case Op::SUBTRACT:
+                top--;
+                stack [ top - 1 ].lanes =
+                        stack [ top - 1 ].lanes - stack [ top ].lanes;
+                break;
+            case Op::MULTIPLY:
+                top--;
+                stack [ top - 1 ].lanes =
+                        stack [ top - 1 ].lanes * stack [ top ].lanes;
+                break;
+            case Op::DIVIDE:
+                top--;
+                stack [ top - 1 ].lanes =
+                        stack [ top - 1 ].lanes / stack [ top ].lanes;
+                break;
+            case Op::NEGATE:
+                stack [ top - 1 ].lanes =
+                        defines::UnboundColor ( 0 ) - stack [ top - 1 ].lanes;
+                break;
+            case Op::SIN:
+                for ( std::size_t i = 0; i < 4; i++ )
+                {
+                    ColorValue &value = stack [ top - 1 ];
+                    value.set ( i, std::sin ( value [ i ] ) );
+                }
+                break;
+            case Op::COS:
+                for ( std::size_t i = 0; i < 4; i++ )
+                {
+                    ColorValue &value = stack [ top - 1 ];
+                    value.set ( i, std::cos ( value [ i ] ) );
+                }
+                break;
+            case Op::CLAMP:
+                top -= 2;
+                for ( std::size_t i = 0; i < 4; i++ )
+                {
+                    stack [ top - 1 ].set (
+                            i,
+                            std::min ( std::max ( stack [ top - 1 ][ i ],
+                                                  stack [ top ][ i ] ),
+                                       stack [ top + 1 ][ i ] ) );
+                }
+                break;
+            case Op::LERP:
+                top -= 2;
+                stack [ top - 1 ].lanes =
+                        stack [ top - 1 ].lanes
+                        + ( stack [ top ].lanes - stack [ top - 1 ].lanes )
+                                  * stack [ top + 1 ].lanes;
+                break;
+        }
+    }
+    return stack [ 0 ];
+}
+
+bool testBlendExpression ( std::ostream &stream )
+{
+    using namespace io::console::colors;
+    stream << "Beginning blend expression unittest.\n";
+    ColorValue const basic ( 128, 64, 32, 0 );
+    ColorValue const parameters [] = { { 100, 50, 25, 0 },
+                                       { 0.25, 0, 0.5, 0 },
+                                       { 0.1, 0.2, 0.3, 0 },
+                                       { 1, 2, 0.5, 0 } };
+
+    stream << "Ensuring that the default blending can be written out...\n";
+    BlendExpression const waveform (
+            "basic + amplitude * sin(2 * pi * frequency * time - 2 * pi * fm)"
+            " + amplitude * am" );
+    for ( double const time : { 0.0, 0.3, 1.7 } )
+    {
+        ColorValue const result = waveform.evaluate ( time, basic, parameters );
+        for ( std::size_t i = 0; i < 4; i++ )
+        {
+            defines::UnboundColor const expected =
+                    blend_functions::defaultBlending ( time,
+                                                       basic [ i ],
+                                                       parameters [ 0 ][ i ],
+                                                       parameters [ 3 ][ i ],
+                                                       parameters [ 1 ][ i ],
+                                                       parameters [ 2 ][ i ] );
+            if ( std::abs ( result [ i ] - expected ) > 1e-9 )
+            {
+                BASIC_UNIT_FAIL ( stream, "Got " << result [ i ] )
+            }
+        }
+    }
+
+    stream << "Ensuring that the functions work...\n";
+    ColorValue const clamped =
+            BlendExpression ( "clamp(basic - 50, 0, 40) + -lerp(1, 3, .5)" )
+                    .evaluate ( 0, basic, parameters );
+    if ( !( clamped == ColorValue ( 38, 12, -2, -2 ) ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Clamped to " << clamped [ 0 ] << ", "
+                                                << clamped [ 1 ] << ", "
+                                                << clamped [ 2 ] )
+    }
+
+    stream << "Ensuring that numbers can have exponents...\n";
+    ColorValue const scaled = BlendExpression ( "1e-3 * 2E+1 + 5e1 + .5E0" )
+                                      .evaluate ( 0, basic, parameters );
+    if ( std::abs ( scaled [ 0 ] - 50.52 ) > 1e-9 )
+    {
+        BASIC_UNIT_FAIL ( stream, "Got " << scaled [ 0 ] )
+    }
+
+    stream << "Ensuring that bad expressions are refused...\n";
+    for ( auto const &bad : { "", "basic +", "sin(time", "clamp(1, 2)",
+                              "colour", "1..2", "(1) 2", "1e", "2e+",
+                              "3e1.5" } )
+    {
+        try
+        {
+            BlendExpression const refused ( bad );
+            BASIC_UNIT_FAIL ( stream, "Accepted \"" << bad << "\"" )
+        } catch ( std::runtime_error const & )
+        { }
+    }
+    std::string deep = "time";
+    for ( std::size_t i = 0; i < BlendExpression::maxDepth; i++ )
+    {
+        deep = "1 + (" + deep + ")";
+    }
+    // nothing on the stack, but far more than the parser could recurse into.
+    std::string const parenthesized =
+            std::string ( 100000, '(' ) + "time" + std::string ( 100000, ')' );
+    for ( auto const &tooDeep :
+          { deep, parenthesized, std::string ( 100000, '-' ) + "time" } )
+    {
+        try
+        {
+            BlendExpression const refused ( tooDeep );
+            BASIC_UNIT_FAIL ( stream, "Accepted an expression nested too deep" )
+        } catch ( std::runtime_error const & )
+        { }
+    }
+    stream << "Ensuring that one nested as deep as allowed works...\n";
+    std::size_t const levels  = BlendExpression::maxDepth - 1;
+    std::string const allowed = std::string ( levels, '(' ) + "time"
+                              + std::string ( levels, ')' );
+    if ( !( BlendExpression ( allowed ).evaluate ( 2, basic, parameters )
+            == BlendExpression ( "time" ).evaluate ( 2, basic, parameters ) ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "The deepest expression came out wrong" )
+    }
+    return true;
+}
+
+test::Unittest blendExpressionTest { &testBlendExpression };
@@ -0,0 +1,88 @@
+/**
+ * @file expression.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Blend functions written out as text, for the screens to give
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <io/console/colors/value.h++>
+
+#include <defines/types.h++>
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace io::console::colors
+{
+    /**
+     * @brief A blend function compiled from an expression, which works out
+     * all four components of an indirect color at once.
+     * @details Expressions have numbers, which may have an exponent as in
+     * 1e-3, + - * / and parentheses, and the names:
+     * - time, which is the same in every component, and pi
+     * - basic, which is the color's own components
+     * - amplitude, fm, am and frequency, which are its parameters' colors
+     * - sin ( x ), cos ( x ), clamp ( x, low, high ) and lerp ( a, b, t )
+     * Everything else works component by component, so amplitude * basic
+     * multiplies the reds, the greens, and so on. The default blending is
+     * basic + amplitude * sin ( 2 * pi * frequency * time - 2 * pi * fm )
+     * + amplitude * am.
+     */
+    class BlendExpression
+    {
+        enum class Op : std::uint8_t
+        {
+            // pushes the next constant, in the order they were compiled.
+            CONSTANT,
+            TIME,
+            BASIC,
+            AMPLITUDE,
+            FM,
+            AM,
+            FREQUENCY,
+            ADD,
+            SUBTRACT,
+            MULTIPLY,
+            DIVIDE,
+            NEGATE,
+            SIN,
+            COS,
+            CLAMP,
+            LERP,
+        };
+        std::vector< Op >         code;
+        std::vector< ColorValue > constants;
+
+        class Compiler;
+    public:
+        // how deep an expression may nest, in parentheses, signs and calls or
+        // in values waiting on the stack, before it is refused.
+        static constexpr std::size_t maxDepth = 16;
+
+        /**
+         * @brief Compiles the expression.
+         *
+         * @throw std::runtime_error if it is not one, or it nests too deep,
+         * however little the nesting puts on the stack.
+         */
+        explicit BlendExpression ( std::string_view const & );
+
+        /**
+         * @brief The color at the time, from its own components and its
+         * parameters' colors in the order that IndirectColor::parameters
+         * gives them.
+         */
+        ColorValue evaluate ( double const                        &time,
+                              ColorValue const                    &basic,
+                              std::span< ColorValue const > const &parameters )
+                const noexcept;
+    };
+} // namespace io::console::colors
@@ -13,6 +13,8 @@
 
 #include <io/console/colors/color.h++>
 #include <io/console/colors/direct.h++>
+#include <io/console/colors/expression.h++>
+#include <io/console/colors/value.h++>
 
 #include <defines/constants.h++>
 #include <defines/macros.h++>
@@ -23,38 +25,27 @@
 #include <iostream>
 #include <memory>
 #include <numbers>
+#include <span>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 using namespace io::console::colors;
 using namespace io::console::colors::blend_functions;
 
-defines::UnboundColor const *const
-        io::console::colors::IndirectColor::rgbaRaw ( ) const noexcept
+ColorValue io::console::colors::IndirectColor::rgbaRaw ( ) const noexcept
 {
-    defines::UnboundColor *temp = new defines::UnboundColor [ 4 ];
-    for ( std::size_t i = 0; i < 4; i++ ) { temp [ i ] = this->color [ i ]; }
-    return temp;
+    return this->color;
 }
 
-defines::UnboundColor const *const
-        io::console::colors::IndirectColor::cmyaRaw ( ) const noexcept
+ColorValue io::console::colors::IndirectColor::cmyaRaw ( ) const noexcept
 {
-    return RGBAColor ( this->color [ 0 ],
-                       this->color [ 1 ],
-                       this->color [ 2 ],
-                       this->color [ 3 ] )
-            .cmya ( );
+    return rgbaToCMYA ( this->color );
 }
 
-defines::UnboundColor const *const
-        io::console::colors::IndirectColor::cmykRaw ( ) const noexcept
+ColorValue io::console::colors::IndirectColor::cmykRaw ( ) const noexcept
 {
-    return RGBAColor ( this->color [ 0 ],
-                       this->color [ 1 ],
-                       this->color [ 2 ],
-                       this->color [ 3 ] )
-            .cmyk ( );
+    return rgbaToCMYK ( this->color );
 }
 
 io::console::colors::IndirectColor::IndirectColor (
@@ -93,31 +84,59 @@ io::console::colors::IndirectColor::IndirectColor (
 void io::console::colors::IndirectColor::refresh (
         double const &time ) const noexcept
 {
-    auto deltas = delta->rgba ( time );
-    auto fmMods = fmMod->rgba ( time - std::numbers::pi / 2 );
-    auto amMods = amMod->rgba ( time );
-    auto cfreqs = freqs->rgba ( time );
+    auto const value = [ & ] ( std::shared_ptr< IColor > const &color,
+                               double const                    &at ) {
+        return color ? color->rgba ( at ) : ColorValue ( );
+    };
+    // at the offsets that parameters gives.
+    ColorValue const values [] = { value ( delta, time ),
+                                   value ( fmMod, time - std::numbers::pi / 2 ),
+                                   value ( amMod, time ),
+                                   value ( freqs, time ) };
+
+    this->color = evaluate ( time, values );
+}
+
+std::vector< IColor::Parameter >
+        io::console::colors::IndirectColor::parameters ( ) const
+{
+    // offsetting fmMod by pi / 2 allows the default blend function to
+    // get closer to frequency modulation. Since we don't ever actually
+    // take the integral (something really only reserved for software
+    // defined radios!), this is about as close as I'm willing to get to
+    // phase modulation for now.
+    return { { delta, 0 },
+             { fmMod, -std::numbers::pi / 2 },
+             { amMod, 0 },
+             { freqs, 0 } };
+}
 
+ColorValue io::console::colors::IndirectColor::evaluate (
+        double const                        &time,
+        std::span< ColorValue const > const &parameters ) const noexcept
+{
+    if ( expression )
+    {
+        ColorValue const own (
+                basic [ 0 ], basic [ 1 ], basic [ 2 ], basic [ 3 ] );
+        return expression->evaluate ( time, own, parameters );
+    }
+    ColorValue const &deltas = parameters [ 0 ];
+    ColorValue const &fmMods = parameters [ 1 ];
+    ColorValue const &amMods = parameters [ 2 ];
+    ColorValue const &cfreqs = parameters [ 3 ];
+    ColorValue        result;
     for ( std::size_t i = 0; i < 4; i++ )
     {
-        // offsetting fmMod by pi / 2 allows the default blend function to
-        // get closer to frequency modulation. Since we don't ever actually
-        // take the integral (something really only reserved for software
-        // defined radios!), this is about as close as I'm willing to get to
-        // phase modulation for now.
-        this->color [ i ] = blender ( time,
-                                      this->basic [ i ],
-                                      deltas [ i ],
-                                      cfreqs [ i ],
-                                      fmMods [ i ],
-                                      amMods [ i ] );
+        result.set ( i,
+                     blender ( time,
+                               this->basic [ i ],
+                               deltas [ i ],
+                               cfreqs [ i ],
+                               fmMods [ i ],
+                               amMods [ i ] ) );
     }
-
-    // remove the arrays
-    delete [] deltas;
-    delete [] fmMods;
-    delete [] amMods;
-    delete [] cfreqs;
+    return result;
 }
 
 bool io::console::colors::IndirectColor::references (
@@ -183,6 +202,20 @@ void io::console::colors::IndirectColor::setBlendFunction (
         BlendFunction const &blender ) noexcept
 {
     this->blender = blender;
+    expression    = nullptr;
+}
+
+std::shared_ptr< BlendExpression const > const &
+        io::console::colors::IndirectColor::getBlendExpression ( )
+                const noexcept
+{
+    return expression;
+}
+
+void io::console::colors::IndirectColor::setBlendExpression (
+        std::shared_ptr< BlendExpression const > const &expression ) noexcept
+{
+    this->expression = expression;
 }
 
 void io::console::colors::IndirectColor::setParam (
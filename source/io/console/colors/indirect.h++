@@ -13,6 +13,7 @@
 
 #include <io/console/colors/color.h++>
 #include <io/console/colors/direct.h++>
+#include <io/console/colors/expression.h++>
 
 #include <defines/constants.h++>
 #include <defines/macros.h++>
@@ -23,8 +24,10 @@
 #include <iostream>
 #include <memory>
 #include <numbers>
+#include <span>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 namespace io::console::colors
 {
@@ -107,13 +110,12 @@ namespace io::console::colors
 
         blend_functions::BlendFunction blender =
                 blend_functions::defaultBlending;
+        // used instead of the blender when there is one.
+        std::shared_ptr< BlendExpression const > expression;
     protected:
-        virtual defines::UnboundColor const *const
-                rgbaRaw ( ) const noexcept override final;
-        virtual defines::UnboundColor const *const
-                cmyaRaw ( ) const noexcept override final;
-        virtual defines::UnboundColor const *const
-                cmykRaw ( ) const noexcept override final;
+        virtual ColorValue rgbaRaw ( ) const noexcept override final;
+        virtual ColorValue cmyaRaw ( ) const noexcept override final;
+        virtual ColorValue cmykRaw ( ) const noexcept override final;
     public:
         POLYMORPHIC_IDENTIFIER ( IndirectColor )
 
@@ -142,12 +144,29 @@ namespace io::console::colors
 
         bool references ( IColor const *const &color ) const noexcept;
 
+        // amplitude, frequency modulation, amplitude modulation, then
+        // frequency. Null parameters count as black.
+        std::vector< Parameter > parameters ( ) const override final;
+        ColorValue               evaluate (
+                              double const                        &time,
+                              std::span< ColorValue const > const &parameters )
+                const noexcept override final;
+
         blend_functions::BlendFunction const &
                 getBlendFunction ( ) const noexcept;
 
         void setBlendFunction (
                 blend_functions::BlendFunction const & ) noexcept;
 
+        std::shared_ptr< BlendExpression const > const &
+                getBlendExpression ( ) const noexcept;
+        /**
+         * @brief Blends with the expression instead of the blend function,
+         * until a blend function is set or the expression is null.
+         */
+        void setBlendExpression (
+                std::shared_ptr< BlendExpression const > const & ) noexcept;
+
         void setParam ( std::uint8_t const &,
                         std::shared_ptr< IColor > const & );
     };
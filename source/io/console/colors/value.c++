@@ -0,0 +1,271 @@
+/**
+ * @file value.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Color math on colors held by value
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/console/colors/value.h++>
+
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <test/unittester.h++>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <span>
+
+using io::console::colors::ColorValue;
+using io::console::colors::Lanes;
+
+// the length of all four components, which CMYK colors are scaled by.
+defines::UnboundColor fullMagnitude ( ColorValue const &color ) noexcept
+{
+    Lanes const squared = color.lanes * color.lanes;
+    return std::sqrt ( squared [ 0 ] + squared [ 1 ] + squared [ 2 ]
+                       + squared [ 3 ] );
+}
+
+defines::UnboundColor
+        io::console::colors::magnitude ( ColorValue const &color ) noexcept
+{
+    Lanes const squared = color.lanes * color.lanes;
+    return std::sqrt ( squared [ 0 ] + squared [ 1 ] + squared [ 2 ] );
+}
+
+defines::UnboundColor
+        io::console::colors::normalize ( ColorValue &color ) noexcept
+{
+    defines::UnboundColor const length = magnitude ( color );
+    if ( length == 0 )
+    {
+        return 0.0;
+    }
+    color.lanes = color.lanes / Lanes { length, length, length, 1 };
+    return length;
+}
+
+ColorValue io::console::colors::rgbaToCMYK ( ColorValue const &color ) noexcept
+{
+    ColorValue                  normal = color;
+    defines::UnboundColor const length = normalize ( normal );
+    if ( length == 0 )
+    {
+        return ColorValue ( 0, 0, 0, 255 );
+    }
+    defines::UnboundColor const key =
+            1 - std::max ( { normal [ 0 ], normal [ 1 ], normal [ 2 ] } );
+    ColorValue result ( ( 1 - normal.lanes - key ) / ( 1 - key ) * length );
+    result.set ( 3, key * length );
+    return result;
+}
+
+ColorValue io::console::colors::rgbaToCMYA ( ColorValue const &color ) noexcept
+{
+    ColorValue                  normal = color;
+    defines::UnboundColor const length = normalize ( normal );
+    if ( length == 0 )
+    {
+        return ColorValue ( 255, 255, 255, color [ 3 ] );
+    }
+    ColorValue result ( ( 1 - normal.lanes ) * length );
+    result.set ( 3, color [ 3 ] );
+    return result;
+}
+
+ColorValue io::console::colors::cmyaToRGBA ( ColorValue const &color ) noexcept
+{
+    // the same flip either way.
+    return rgbaToCMYA ( color );
+}
+
+ColorValue io::console::colors::cmyaToCMYK ( ColorValue const &color ) noexcept
+{
+    ColorValue                  normal = color;
+    defines::UnboundColor const length = normalize ( normal );
+    if ( length == 0 )
+    {
+        return ColorValue ( 0, 0, 0, 255 );
+    }
+    defines::UnboundColor const alpha = color [ 3 ];
+    ColorValue result ( ( normal.lanes - alpha ) / ( 1 - alpha ) * length );
+    result.set ( 3, alpha * length );
+    return result;
+}
+
+// cmyk formaula for a color component n solved for rgba
+// a = 0
+// n_k = (1 - n_a - k) / (1 - k)
+// n_k * (1 - k ) = 1 - n_a - k
+// n_k * (1 - k ) + k - 1 = -n_a
+// 1 - k - n_k * (1 - k ) = n_a
+// (1 - k)(1 - n_k) = n_a
+ColorValue io::console::colors::cmykToRGBA ( ColorValue const &color ) noexcept
+{
+    // all valid cmyk colors have a magnitude != 0.
+    defines::UnboundColor const length = fullMagnitude ( color );
+    Lanes const                 normal = color.lanes / length;
+    ColorValue result ( ( 1 - normal [ 3 ] ) * ( 1 - normal ) * length );
+    result.set ( 3, 0 );
+    return result;
+}
+
+// cmyk formaula for a color component n solved for cmya
+// a = 0
+// n_k = (n_a - k) / (1 - k)
+// n_k(1 - k) + k = n_a
+ColorValue io::console::colors::cmykToCMYA ( ColorValue const &color ) noexcept
+{
+    defines::UnboundColor const length = fullMagnitude ( color );
+    Lanes const                 normal = color.lanes / length;
+    ColorValue result ( ( normal * ( 1 - normal [ 3 ] ) + normal [ 3 ] )
+                        * length );
+    result.set ( 3, 0 );
+    return result;
+}
+
+void io::console::colors::bind (
+        std::span< ColorValue const > const    &colors,
+        std::span< defines::BoundColor > const &out ) noexcept
+{
+    Lanes const floor   = { 0x00, 0x00, 0x00, 0x00 };
+    Lanes const ceiling = { 0xff, 0xff, 0xff, 0xff };
+    for ( std::size_t i = 0; i < colors.size ( ); i++ )
+    {
+#ifdef COLORS_LANES
+        Lanes const raised = colors [ i ].lanes > floor ? colors [ i ].lanes
+                                                        : floor;
+        Lanes const bound  = raised < ceiling ? raised : ceiling;
+        using Whole = std::int64_t __attribute__ ( (
+                vector_size ( 4 * sizeof ( std::int64_t ) ) ) );
+        Whole const whole = __builtin_convertvector ( bound, Whole );
+#else
+        Lanes whole;
+        for ( std::size_t j = 0; j < 4; j++ )
+        {
+            whole [ j ] = std::clamp ( colors [ i ].lanes [ j ], 0.0, 255.0 );
+        }
+#endif
+        for ( std::size_t j = 0; j < 4; j++ )
+        {
+            out [ 4 * i + j ] = defines::BoundColor ( whole [ j ] );
+        }
+    }
+}
+
+void io::console::colors::normalize (
+        std::span< ColorValue > const            &colors,
+        std::span< defines::UnboundColor > const &magnitudes ) noexcept
+{
+    for ( std::size_t i = 0; i < colors.size ( ); i++ )
+    {
+        magnitudes [ i ] = normalize ( colors [ i ] );
+    }
+}
+
+// runs a conversion over every color, where it can be inlined.
+template < ColorValue ( *convert ) ( ColorValue const & ) noexcept >
+void convertColors ( std::span< ColorValue const > const &colors,
+                     std::span< ColorValue > const       &out ) noexcept
+{
+    for ( std::size_t i = 0; i < colors.size ( ); i++ )
+    {
+        out [ i ] = convert ( colors [ i ] );
+    }
+}
+
+void io::console::colors::rgbaToCMYK (
+        std::span< ColorValue const > const &colors,
+        std::span< ColorValue > const       &out ) noexcept
+{
+    convertColors< rgbaToCMYK > ( colors, out );
+}
+
+void io::console::colors::rgbaToCMYA (
+        std::span< ColorValue const > const &colors,
+        std::span< ColorValue > const       &out ) noexcept
+{
+    convertColors< rgbaToCMYA > ( colors, out );
+}
+
+void io::console::colors::cmyaToRGBA (
+        std::span< ColorValue const > const &colors,
+        std::span< ColorValue > const       &out ) noexcept
+{
+    convertColors< cmyaToRGBA > ( colors, out );
+}
+
+void io::console::colors::cmykToRGBA (
+        std::span< ColorValue const > const &colors,
+        std::span< ColorValue > const       &out ) noexcept
+{
+    convertColors< cmykToRGBA > ( colors, out );
+}
+
+bool testColorValue ( std::ostream &stream )
+{
+    using namespace io::console::colors;
+    stream << "Beginning color value unittest.\n";
+    auto near = [] ( ColorValue const &a, ColorValue const &b ) {
+        for ( std::size_t i = 0; i < 4; i++ )
+        {
+            if ( std::abs ( a [ i ] - b [ i ] ) > 1e-9 )
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    stream << "Ensuring that colors bind and normalize...\n";
+    ColorValue const   wild [] = { { -5, 0.5, 300, 128.9 }, { 1, 2, 3, 4 } };
+    defines::BoundColor bound [ 8 ];
+    bind ( wild, bound );
+    defines::BoundColor const expected [] = { 0, 0, 255, 128, 1, 2, 3, 4 };
+    if ( !std::equal ( bound, bound + 8, expected ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Bound " << int ( bound [ 0 ] ) << ", "
+                                           << int ( bound [ 2 ] ) << ", "
+                                           << int ( bound [ 3 ] ) )
+    }
+    ColorValue            normal [] = { { 3, 4, 0, 7 }, { 0, 0, 0, 1 } };
+    defines::UnboundColor lengths [ 2 ];
+    normalize ( normal, lengths );
+    if ( !near ( normal [ 0 ], { 0.6, 0.8, 0, 7 } ) || lengths [ 0 ] != 5
+         || !( normal [ 1 ] == ColorValue ( 0, 0, 0, 1 ) ) || lengths [ 1 ] )
+    {
+        BASIC_UNIT_FAIL ( stream, "Normalized wrongly" )
+    }
+
+    stream << "Ensuring that colors convert...\n";
+    ColorValue const red ( 255, 0, 0, 1 );
+    if ( !near ( rgbaToCMYA ( red ), { 0, 255, 255, 1 } )
+         || !near ( rgbaToCMYK ( red ), { 0, 255, 255, 0 } )
+         || !near ( rgbaToCMYK ( { 0, 0, 0, 1 } ), { 0, 0, 0, 255 } )
+         || !near ( cmykToRGBA ( { 0, 0, 0, 255 } ), { 0, 0, 0, 0 } )
+         || !near ( cmykToRGBA ( { 255, 0, 0, 0 } ), { 0, 255, 255, 0 } )
+         || !near ( cmykToCMYA ( { 255, 0, 0, 0 } ), { 255, 0, 0, 0 } )
+         || !near ( cmyaToCMYK ( { 0, 255, 255, 0 } ), { 0, 255, 255, 0 } ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "A conversion went wrong" )
+    }
+    ColorValue const mixed [] = { red, { 10, 200, 30, 0.5 }, { 0, 0, 0, 0 } };
+    ColorValue       batch [ 3 ];
+    rgbaToCMYK ( mixed, batch );
+    for ( std::size_t i = 0; i < 3; i++ )
+    {
+        if ( !( batch [ i ] == rgbaToCMYK ( mixed [ i ] ) ) )
+        {
+            BASIC_UNIT_FAIL ( stream, "A batch differed at " << i )
+        }
+    }
+    return true;
+}
+
+test::Unittest colorValueTest { &testColorValue };
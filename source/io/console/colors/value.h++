@@ -0,0 +1,161 @@
+/**
+ * @file value.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief A color held by value
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <defines/types.h++>
+
+#include <cstddef>
+#include <span>
+
+// GCC keeps the four lanes in vector registers: two SSE2 registers on any
+// x86-64, or one AVX register when built for it. Anything else gets plain
+// arrays.
+#if defined( __GNUC__ )
+#    define COLORS_LANES
+#endif
+
+namespace io::console::colors
+{
+#ifdef COLORS_LANES
+    using Lanes = defines::UnboundColor __attribute__ ( (
+            vector_size ( 4 * sizeof ( defines::UnboundColor ) ) ) );
+#else
+    struct Lanes
+    {
+        defines::UnboundColor lane [ 4 ];
+
+        defines::UnboundColor &operator[] ( std::size_t const &i ) noexcept
+        {
+            return lane [ i ];
+        }
+        defines::UnboundColor const &
+                operator[] ( std::size_t const &i ) const noexcept
+        {
+            return lane [ i ];
+        }
+    };
+
+#    define COLORS_LANEWISE( OP )                                              \
+        inline Lanes operator OP ( Lanes a, Lanes const &b ) noexcept          \
+        {                                                                      \
+            for ( std::size_t i = 0; i < 4; i++ )                              \
+            {                                                                  \
+                a [ i ] = a [ i ] OP b [ i ];                                  \
+            }                                                                  \
+            return a;                                                          \
+        }                                                                      \
+        inline Lanes operator OP ( Lanes                        a,             \
+                                   defines::UnboundColor const &b ) noexcept   \
+        {                                                                      \
+            for ( std::size_t i = 0; i < 4; i++ ) { a [ i ] = a [ i ] OP b; }  \
+            return a;                                                          \
+        }                                                                      \
+        inline Lanes operator OP ( defines::UnboundColor const &a,             \
+                                   Lanes                        b ) noexcept   \
+        {                                                                      \
+            for ( std::size_t i = 0; i < 4; i++ ) { b [ i ] = a OP b [ i ]; }  \
+            return b;                                                          \
+        }
+    COLORS_LANEWISE ( + )
+    COLORS_LANEWISE ( - )
+    COLORS_LANEWISE ( * )
+    COLORS_LANEWISE ( / )
+#    undef COLORS_LANEWISE
+#endif
+
+    /**
+     * @brief Four components of a color, one to a lane, so that math on a
+     * color works on all four at once and nothing needs allocating. Which
+     * four components they are is up to whoever holds it.
+     */
+    struct ColorValue
+    {
+        Lanes lanes;
+
+        constexpr ColorValue ( ) noexcept : lanes { 0, 0, 0, 0 } { }
+        constexpr ColorValue ( defines::UnboundColor const &_1,
+                               defines::UnboundColor const &_2,
+                               defines::UnboundColor const &_3,
+                               defines::UnboundColor const &_4 ) noexcept :
+                lanes { _1, _2, _3, _4 }
+        { }
+        explicit constexpr ColorValue ( Lanes const &lanes ) noexcept :
+                lanes ( lanes )
+        { }
+
+        defines::UnboundColor operator[] ( std::size_t const &i ) const noexcept
+        {
+            return lanes [ i ];
+        }
+        void set ( std::size_t const &i, defines::UnboundColor const &value )
+        {
+            lanes [ i ] = value;
+        }
+
+        bool operator== ( ColorValue const &other ) const noexcept
+        {
+            for ( std::size_t i = 0; i < 4; i++ )
+            {
+                if ( lanes [ i ] != other.lanes [ i ] )
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    /**
+     * @brief The length of the first three components.
+     */
+    defines::UnboundColor magnitude ( ColorValue const & ) noexcept;
+    /**
+     * @brief Scales the first three components to a length of one, unless they
+     * are all zero, leaving the fourth alone.
+     *
+     * @return their length before.
+     */
+    defines::UnboundColor normalize ( ColorValue & ) noexcept;
+
+    // conversions between the three ways a direct color can hold itself.
+    ColorValue rgbaToCMYK ( ColorValue const & ) noexcept;
+    ColorValue rgbaToCMYA ( ColorValue const & ) noexcept;
+    ColorValue cmyaToRGBA ( ColorValue const & ) noexcept;
+    ColorValue cmyaToCMYK ( ColorValue const & ) noexcept;
+    ColorValue cmykToRGBA ( ColorValue const & ) noexcept;
+    ColorValue cmykToCMYA ( ColorValue const & ) noexcept;
+
+    /**
+     * @brief Binds every component of every color, four to a color, as bind
+     * does but without checking for NaN.
+     */
+    void bind ( std::span< ColorValue const > const    &colors,
+                std::span< defines::BoundColor > const &out ) noexcept;
+    /**
+     * @brief Normalizes every color, writing down their lengths before.
+     */
+    void normalize (
+            std::span< ColorValue > const            &colors,
+            std::span< defines::UnboundColor > const &magnitudes ) noexcept;
+    /**
+     * @brief Converts every color between RGBA and CMYA or CMYK, which may be
+     * done in place.
+     */
+    void rgbaToCMYK ( std::span< ColorValue const > const &colors,
+                      std::span< ColorValue > const       &out ) noexcept;
+    void rgbaToCMYA ( std::span< ColorValue const > const &colors,
+                      std::span< ColorValue > const       &out ) noexcept;
+    void cmyaToRGBA ( std::span< ColorValue const > const &colors,
+                      std::span< ColorValue > const       &out ) noexcept;
+    void cmykToRGBA ( std::span< ColorValue const > const &colors,
+                      std::span< ColorValue > const       &out ) noexcept;
+} // namespace io::console::colors
@@ -19,25 +19,30 @@
 #include <io/console/colors/indirect.h++>
 #include <io/console/console.h++>
 
+#include <chrono>
 #include <functional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 
 io::console::ConsoleManipulator
-        io::console::textDelay ( unsigned long long int const &milliseconds )
+        io::console::textDelay ( double const &milliseconds )
 {
+    auto const delay = std::chrono::duration_cast< std::chrono::nanoseconds > (
+            std::chrono::duration< double, std::milli > ( milliseconds ) );
     return [ = ] ( Console &console ) -> Console & {
-        console.setTxtRate ( milliseconds );
+        console.setTxtRate ( delay );
         return console;
     };
 }
 
 io::console::ConsoleManipulator
-        io::console::commandDelay ( unsigned long long int const &milliseconds )
+        io::console::commandDelay ( double const &milliseconds )
 {
+    auto const delay = std::chrono::duration_cast< std::chrono::nanoseconds > (
+            std::chrono::duration< double, std::milli > ( milliseconds ) );
     return [ = ] ( Console &console ) -> Console & {
-        console.setCmdRate ( milliseconds );
+        console.setCmdRate ( delay );
         return console;
     };
 }
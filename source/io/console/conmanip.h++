@@ -23,8 +23,10 @@
 
 namespace io::console
 {
-    ConsoleManipulator textDelay ( unsigned long long int const & );
-    ConsoleManipulator commandDelay ( unsigned long long int const & );
+    // delays are in milliseconds, and may be fractions of one down to the
+    // nanosecond.
+    ConsoleManipulator textDelay ( double const & );
+    ConsoleManipulator commandDelay ( double const & );
 
     ConsoleManipulator setDirectColor ( std::size_t const &,
                                         defines::UnboundColor const &,
@@ -58,6 +60,28 @@ namespace io::console
         return console;
     }
 
+    inline Console &doSkipOnKey ( Console &console )
+    {
+        console.setSkipOnKey ( true );
+        return console;
+    }
+    inline Console &noSkipOnKey ( Console &console )
+    {
+        console.setSkipOnKey ( false );
+        return console;
+    }
+
+    inline Console &doPrecomputePalette ( Console &console )
+    {
+        console.setPrecomputedPalette ( true );
+        return console;
+    }
+    inline Console &noPrecomputePalette ( Console &console )
+    {
+        console.setPrecomputedPalette ( false );
+        return console;
+    }
+
     inline Console &doTextWrapping ( Console &console )
     {
         console.setWrapping ( true );
@@ -101,10 +125,7 @@ namespace io::console
 
     inline Console &resetSGR ( Console &console )
     {
-        for ( std::size_t i = 0; i < std::size_t ( SGRCommand::_MAX ); i++ )
-        {
-            console << noSGR ( ( SGRCommand ) i );
-        }
+        console.resetSGR ( );
         return console;
     }
 
@@ -128,8 +149,9 @@ namespace io::console
                                                   std::uint8_t const &b )
     {
         return [ & ] ( Console &console ) -> Console & {
-            console.setForeground ( ( r << 24 ) + ( g << 16 ) + ( b << 8 )
-                                    + 10 );
+            console.setForeground ( std::uint32_t ( r ) << 24
+                                    | std::uint32_t ( g ) << 16
+                                    | std::uint32_t ( b ) << 8 | 10 );
             return console;
         };
     }
@@ -139,8 +161,9 @@ namespace io::console
                                                   std::uint8_t const &b )
     {
         return [ & ] ( Console &console ) -> Console & {
-            console.setBackground ( ( r << 24 ) + ( g << 16 ) + ( b << 8 )
-                                    + 10 );
+            console.setBackground ( std::uint32_t ( r ) << 24
+                                    | std::uint32_t ( g ) << 16
+                                    | std::uint32_t ( b ) << 8 | 10 );
             return console;
         };
     }
@@ -14,18 +14,34 @@
 #include <defines/constants.h++>
 #include <defines/macros.h++>
 #include <defines/types.h++>
+#include <io/base/scheduler.h++>
 #include <io/base/syncstream.h++>
 #include <io/console/colors/color.h++>
 #include <io/console/colors/direct.h++>
 #include <io/console/colors/indirect.h++>
+#include <io/console/colors/value.h++>
+#include <io/console/internal/buffer.h++>
 #include <io/console/internal/channel.h++>
+#include <io/console/internal/colorgraph.h++>
+#include <io/console/internal/keyframes.h++>
+#include <io/console/internal/palette.h++>
+#include <io/console/internal/sgr.h++>
 #include <io/console/manip/stringfunctions.h++>
+#include <io/console/manip/tokenizer.h++>
+#include <io/console/virtualterminal.h++>
 #include <io/unicode/character.h++>
+#include <test/unittester.h++>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <functional>
+#include <future>
+#include <map>
 #include <mutex>
 #include <queue>
+#include <span>
 #include <stack>
 #include <string>
 #include <thread>
@@ -35,65 +51,96 @@
 #    include "windows.h"
 #endif // ifdef windows
 
+// how far the palette's time moves each tick.
+constexpr double      paletteStep   = 0.1;
+// the longest loop kept as keyframes, a minute at ten ticks a second.
+constexpr std::size_t keyframeLimit = 600;
+
 struct io::console::Console::impl_s
 {
     // our implementation of splitting by code point opened th door
     // to a race condition where text may be interleaved if sent to
     // the text channel.
     std::mutex sending;
+    // holds onto whatever the last string sent cut off.
+    manip::Tokenizer tokenizer;
     std::atomic_bool mutable readySignal = false;
-    internal::TextChannel txt {
-            internal::TextChannel::SharedFlag ( &readySignal ) };
-    internal::TextChannel cmd {
-            internal::TextChannel::SharedFlag ( &readySignal ) };
-
-    // data for managing the two channels.
-    std::chrono::milliseconds maxDelay ( ) const noexcept;
-    void                      ensureStopped ( ) const noexcept;
-    // data for managing the text channel
-    struct ConsolePoint
-    {
-        std::uint32_t row;
-        std::uint32_t col;
-    };
-
-    using ConsolePosition = ConsolePoint;
-    using ConsoleSize     = ConsolePoint;
-    using CursorPosition  = ConsolePoint;
+    // where everything goes, before the channels that write to it.
+    std::shared_ptr< Backend > backend;
+    // the channels share the flag but never own it.
+    internal::TextChannel txt { internal::TextChannel::SharedFlag (
+                                        &readySignal,
+                                        [] ( auto ) { } ),
+                                backend };
+    internal::TextChannel cmd { internal::TextChannel::SharedFlag (
+                                        &readySignal,
+                                        [] ( auto ) { } ),
+                                backend };
+    // raises the ready flag and wakes everything waiting on it.
+    void                  signalReady ( ) noexcept;
 
-    std::stack< CursorPosition >      positionStack;
-    void                              pushCursorPosition ( );
-    void                              pullCursorPosition ( );
+    // data for managing the text channel. The positions are reports the
+    // terminal may not have sent yet, and both functions need the sending
+    // lock.
+    std::stack< std::shared_future< CursorPosition > > positionStack;
+    void                                               pushCursorPosition ( );
+    void                                               pullCursorPosition ( );
     // data for managing the command channel
     // mutex to prevent reading invalid colors
-    // std::mutex                        changingColors;
+    std::mutex                        changingColors;
     // colors onscreen.
     std::shared_ptr< colors::IColor > screen [ 8 ];
+    // everything the colors onscreen are calculated from, flattened so that
+    // each tick works out each color once. Rebuilt whenever a color changes.
+    internal::ColorGraph              graph;
+    // the colors onscreen worked out ahead of time, if asked for and if they
+    // loop, which each tick then only looks up.
+    bool                              precomputePalette = false;
+    internal::Keyframes               keyframes;
+    // ticks of the palette so far, which says where in the keyframes it is.
+    std::size_t                       tick              = 0;
+    // rebuilds the graph and the keyframes from the screen colors, or from
+    // the ones given, which needs the lock on changingColors. If it throws,
+    // both stay as they were.
+    void                              flattenColors ( );
+    void                              flattenColors (
+            std::span< std::shared_ptr< colors::IColor > const > const & );
     // colors used for calculating those onscreen.
     // this value is a map to allow random access and fast addition / removal
     // without reallocating the entire system.
     std::map< std::size_t, std::shared_ptr< colors::IColor > > colors;
     // "now" so-to-speak.
     double                                                     time = 0;
-    // thread which feeds the cmd channel with the commands.
-    std::jthread                                               commands;
-    // boolean to tell the jthread that it's time to shut down when
-    // the console is destructed
-    std::atomic_bool mutable stopSignal = false;
+    // task which feeds the cmd channel with the commands.
+    io::base::Scheduler::TaskID                                commands = 0;
+    // the last command fed to the cmd channel.
+    internal::TextChannel::Sequence                            lastCommand = 0;
+    // what the palette was last set to, so that only changes go out.
+    internal::Palette                                          palette;
+    // set when the terminal may have lost the palette, so that all of it
+    // goes out again.
+    std::atomic_bool                                           paletteLost =
+            false;
+    // what each tick sends, kept so that its buffer is reused.
+    std::string                                                paletteCommand;
     // the function which performs the text-feeding. Internally uses the same
     // delay between ticks as the cmd channel
-    void commandGenerator ( );
+    io::base::Scheduler::TimePoint
+            commandGenerator ( io::base::Scheduler::TimePoint const & );
 
-    // just some general data
-    ConsoleSize                              consoleSize = { 25, 80 };
-    // thread which holds a function to regularly update the size of the
-    // console.
-    std::jthread                             sizeUpdater;
-    // time between updates.
-    std::atomic< std::chrono::milliseconds > updateRate =
-            std::chrono::milliseconds ( 500 );
-
-    void sizeUpdateFunction ( );
+    // the size of the console, which checkSize keeps up with the backend.
+    std::atomic< std::uint32_t >           rows = 25;
+    std::atomic< std::uint32_t >           cols = 80;
+    // held while finding out the size, so that it is never read half done.
+    std::mutex                             sizing;
+    // who to tell when the size changes.
+    std::mutex                             listening;
+    std::map< std::size_t, ResizeListener > listeners;
+    std::size_t                            nextListener = 1;
+    // asks the backend for the size if it may have changed, and tells the
+    // listeners if it did. Never call it holding the sending lock, since the
+    // listeners may use the console.
+    void                                   checkSize ( );
 
     // internal flag to block a thread until the text channel has caught up.
     bool                waitOnTextChannel = false;
@@ -101,18 +148,45 @@ struct io::console::Console::impl_s
     bool                wrapText          = false;
     // internal flag to (attempt to) center text.
     bool                centerText        = false;
-    // internal flags corresponding to the SGR attributes
-    std::vector< bool > sgrMap;
-    // internal colors corresponding to the current color
-    // for the foreground / background. Handled separately
-    // from the CGA colors, but since the console asserts
-    // these foreground / background colors after setting
-    // the CGA colors, these override the CGA values when
-    // they indicate a 256 or true color
-    std::uint32_t       foreground = 0;
-    std::uint32_t       background = 0;
-
-    impl_s ( ) noexcept
+    // the attributes and colors that text goes out with.
+    internal::Pen       pen;
+    // the ones that text sent so far leaves the terminal with, so that the
+    // next string only sends what changed. Only known after we reset them.
+    internal::Pen       sent;
+    bool                sentKnown         = false;
+    // what the terminal can show, which colors are brought down to.
+    ColorDepth          depth             = backend->colorDepth ( );
+
+    // what should be on screen, which draw writes to and present sends.
+    internal::ScreenBuffer buffer { 25, 80 };
+    // resizes the screen buffer if the console changed size.
+    void                   fitBuffer ( );
+
+    // whether a key skips text being waited on, whether one has, and the last
+    // unit of the text being waited on, if there is any.
+    std::atomic_bool                               skipOnKey = false;
+    std::atomic_bool                               skipped   = false;
+    std::atomic< internal::TextChannel::Sequence > revealing = 0;
+    // waits for the text channel to send the unit, if we wait on text.
+    void waitForText ( internal::TextChannel::Sequence const & );
+    // hurries the text being waited on, if a key should skip it.
+    bool skipText ( ) noexcept;
+    // echoes what is typed straight onto the text channel.
+    void echo ( std::string const & );
+
+    // cuts the string into units for the text channel as send would, calling
+    // lineDone (if there is one) each time a line's units are appended.
+    void encode ( std::string const &,
+                  manip::Tokenizer &,
+                  EncodedText &,
+                  std::function< void ( ) > const &lineDone );
+
+    // reads the terminal, declared last so that it stops reading before
+    // anything its hook uses goes away.
+    Input input { backend };
+
+    impl_s ( std::shared_ptr< Backend > const &backend ) noexcept :
+            backend ( backend )
     {
         // txt.setReady ( std::shared_ptr< std::atomic_bool > ( &readySignal )
         // ); std::cout << "here\n"; cmd.setReady ( std::shared_ptr<
@@ -136,14 +210,7 @@ struct io::console::Console::impl_s
                         defines::defaultConsoleColors [ i ][ j ] );
             }
         }
-        for ( std::size_t i = 0; i < ( std::size_t ) SGRCommand::_MAX; i++ )
-        {
-            sgrMap.push_back ( false );
-        }
-        sgrMap.shrink_to_fit ( );
-
-        commands = std::jthread ( [ & ] ( ) { commandGenerator ( ); } );
-        commands.detach ( );
+        flattenColors ( );
 #ifdef WINDOWS
         SetConsoleOutputCP ( 65001 );
         HANDLE hcout = GetStdHandle ( STD_OUTPUT_HANDLE );
@@ -156,362 +223,541 @@ struct io::console::Console::impl_s
         mode |= ENABLE_VIRTUAL_TERMINAL_INPUT;
         SetConsoleMode ( hcout, mode );
 #endif
-        std::cout << "\u001b[3J\u001b[2J\u001b[0m\u001b[H";
-        std::cout.flush ( );
-        readySignal.store ( true );
-        sizeUpdater = std::jthread ( [ & ] ( ) { sizeUpdateFunction ( ); } );
-        sizeUpdater.detach ( );
+        // the buffer follows the cursor from the top left of the cleared
+        // screen, which it can only do at the screen's size.
+        checkSize ( );
+        fitBuffer ( );
+        constexpr std::string_view clearing =
+                "\u001b[3J\u001b[2J\u001b[0m\u001b[H";
+        backend->write ( clearing );
+        buffer.follow ( clearing );
+        sentKnown = true;
+        input.setHook ( [ this ] ( Key const & ) { return skipText ( ); } );
+        // a resize wakes the reader, so listeners hear of it even while
+        // nothing asks the console for its size.
+        input.setWakeHook ( [ this ] ( ) { checkSize ( ); } );
+        signalReady ( );
+        auto &scheduler = io::base::Scheduler::shared ( );
+        commands        = scheduler.add ( [ & ] ( auto const &deadline ) {
+            return commandGenerator ( deadline );
+        } );
     }
 
     ~impl_s ( )
     {
+        // once removed, the tasks never run again, so nothing is left
+        // running on a console that is gone.
         readySignal.store ( false );
-        stopSignal.store ( true );
-        ensureStopped ( );
-        while ( commands.joinable ( ) ) { commands.join ( ); }
+        // whoever is still pushing text gives up instead of waiting on
+        // channels that will never send it.
+        txt.close ( );
+        cmd.close ( );
+        auto &scheduler = io::base::Scheduler::shared ( );
+        scheduler.remove ( commands );
     }
 };
 
-std::chrono::milliseconds
-        io::console::Console::impl_s::maxDelay ( ) const noexcept
+void io::console::Console::impl_s::fitBuffer ( )
 {
-    if ( txt.getDelay ( ) > cmd.getDelay ( ) )
+    if ( buffer.rows ( ) != rows.load ( ) || buffer.cols ( ) != cols.load ( ) )
     {
-        return std::chrono::milliseconds ( txt.getDelay ( ) );
-    } else
-        return std::chrono::milliseconds ( cmd.getDelay ( ) );
+        buffer.resize ( rows.load ( ), cols.load ( ) );
+    }
 }
 
-void io::console::Console::impl_s::ensureStopped ( ) const noexcept
+void io::console::Console::impl_s::signalReady ( ) noexcept
 {
     readySignal.store ( true );
-    std::this_thread::sleep_for ( maxDelay ( ) );
+    txt.wake ( );
+    cmd.wake ( );
+    io::base::Scheduler::shared ( ).wake ( commands );
 }
 
 void io::console::Console::impl_s::pushCursorPosition ( )
 {
-    ensureStopped ( );
-    std::cout << "\u001b[6n";
-    std::cout.flush ( );
-    // maximum size of the command response is actually
-    // 2+10+1+10+1 bytes
-    // or 24 bytes. However, we want to account for a maximum row and
-    // column size of 140 4 - 2 / (RPN) or 136 / 2 or 68 digit number.
-    char buffer [ 140 ];
-    std::cin.get ( buffer, 140, 'R' );
-    char              esc, openBracket, semicolon;
-    std::stringstream temp ( buffer );
-    CursorPosition    current;
-    temp >> esc >> openBracket >> current.row >> semicolon >> current.col;
-    positionStack.push ( current );
-    readySignal.store ( true );
+    // the report comes once the text before it has gone out, and nothing
+    // waits for it until the position is pulled.
+    positionStack.push ( input.expectCursor ( ).share ( ) );
+    txt.pushString ( "\u001b[6n" );
 }
 
 void io::console::Console::impl_s::pullCursorPosition ( )
 {
-    ensureStopped ( );
-    std::cout << "\u001b[" << positionStack.top ( ).row << ";"
-              << positionStack.top ( ).col << "H";
-    std::cout.flush ( );
+    CursorPosition const position = positionStack.top ( ).get ( );
     positionStack.pop ( );
-    readySignal.store ( true );
+    txt.pushString ( "\u001b[" + std::to_string ( position.row ) + ";"
+                     + std::to_string ( position.col ) + "H" );
 }
 
-void io::console::Console::impl_s::commandGenerator ( )
+void io::console::Console::impl_s::waitForText (
+        internal::TextChannel::Sequence const &last )
 {
-    using namespace std::chrono_literals;
-    while ( !this->stopSignal.load ( ) )
-    {
-        this->time += 0.1;
-
-        std::stringstream command;
-        auto generateCommand = [ & ] ( std::size_t color ) -> std::string {
-            this->screen [ color ]->refresh ( time );
-            defines::UnboundColor const *rawColor =
-                    this->screen [ color ]->rgba ( time );
-            defines::BoundColor bound [ 4 ] = {
-                    colors::bind ( rawColor [ 0 ] ),
-                    colors::bind ( rawColor [ 1 ] ),
-                    colors::bind ( rawColor [ 2 ] ),
-                    colors::bind ( rawColor [ 3 ] ),
-            };
-
-            defines::SentColor sent [ 4 ] = {
-                    defines::SentColor ( bound [ 0 ] ),
-                    defines::SentColor ( bound [ 1 ] ),
-                    defines::SentColor ( bound [ 2 ] ),
-                    defines::SentColor ( bound [ 3 ] ),
-            };
-
-            auto toHex = [ & ] ( std::size_t i ) -> defines::ChrString {
-                defines::ChrStringStream temp { "" };
-                temp << std::hex << i;
-                return temp.str ( );
-            };
-
-            // TODO #63 This code works on VS-Code's integrated terminal to its
-            // full effect, but for some reason fails on the Windows Terminal.
-            defines::ChrString result = "";
-            result += "\u001b]";
-            result += defines::paletteChangePrefix;
-            result += toHex ( color );
-            result += defines::paletteChangeSpecif;
-            result += toHex ( sent [ 0 ] );
-            result += defines::paletteChangeDelimt;
-            result += toHex ( sent [ 1 ] );
-            result += defines::paletteChangeDelimt;
-            result += toHex ( sent [ 2 ] );
-            result += "\u001b\\";
-
-            return result;
-        };
-
-        for ( std::size_t i = 0; i < 8; i++ )
+    if ( !waitOnTextChannel )
+    {
+        return;
+    }
+    if ( skipOnKey.load ( ) )
+    {
+        revealing.store ( last );
+        if ( skipped.load ( ) )
         {
-            command << generateCommand ( i );
+            txt.hurry ( last );
         }
-        this->cmd.pushString ( command.str ( ) );
+    }
+    txt.waitFor ( last );
+    revealing.store ( 0 );
+}
+
+bool io::console::Console::impl_s::skipText ( ) noexcept
+{
+    internal::TextChannel::Sequence const waiting = revealing.load ( );
+    if ( !skipOnKey.load ( ) || !waiting || txt.serviced ( waiting ) )
+    {
+        return false;
+    }
+    skipped.store ( true );
+    txt.hurry ( waiting );
+    return true;
+}
+
+void io::console::Console::impl_s::echo ( std::string const &text )
+{
+    std::scoped_lock< std::mutex > lock ( sending );
+    txt.pushString ( text );
+    fitBuffer ( );
+    buffer.follow ( text );
+}
 
-        auto now   = [ & ] ( ) { return std::chrono::steady_clock::now ( ); };
-        auto start = now ( );
-        while ( now ( ) - start < operator""ms ( this->cmd.getDelay ( ) ) )
+io::base::Scheduler::TimePoint
+        io::console::Console::impl_s::commandGenerator (
+                io::base::Scheduler::TimePoint const &deadline )
+{
+    auto const now    = io::base::Scheduler::Clock::now ( );
+    auto const period = cmd.getDelay ( );
+    // the next tick is a whole period after this one was due, so the time
+    // spent generating does not add up. A tick that runs a whole period late
+    // drops the ones it missed.
+    auto const next   = std::max ( deadline + period, now );
+    // sleep until the channels are ready again.
+    if ( !readySignal.load ( ) )
+    {
+        return io::base::Scheduler::never;
+    }
+    // the colors only matter as they are now, so wait out a channel that has
+    // fallen behind instead of queueing up stale ones.
+    if ( !cmd.serviced ( lastCommand ) )
+    {
+        return next;
+    }
+    this->time += paletteStep;
+    tick++;
+
+    if ( paletteLost.exchange ( false ) )
+    {
+        palette.forget ( );
+    }
+
+    defines::BoundColor bound [ defines::consolePaletteLength * 4 ];
+    {
+        std::scoped_lock< std::mutex > lock ( changingColors );
+        if ( keyframes.periodic ( ) )
         {
-            if ( this->stopSignal.load ( ) )
-            {
-                return;
-            } else
-            {
-                std::this_thread::sleep_for ( 1ms );
-            }
-        }
-        // wait again, but this time for the ready signal, if that is low
-        // choosing to wait here ensures that we have a buffer of around one
-        // cycle, which gives us some wiggle room.
-        while ( !this->readySignal.load ( ) )
+            auto const frame = keyframes.frame ( tick );
+            std::copy ( frame.begin ( ), frame.end ( ), bound );
+        } else
         {
-            auto now = [ & ] ( ) { return std::chrono::steady_clock::now ( ); };
-            auto start = now ( );
-            while ( now ( ) - start < operator""ms ( this->cmd.getDelay ( ) ) )
-            {
-                if ( this->stopSignal.load ( ) )
-                {
-                    return;
-                } else
-                {
-                    std::this_thread::sleep_for ( 1ms );
-                }
-            }
+            std::array< colors::ColorValue, defines::consolePaletteLength >
+                    raw;
+            graph.evaluate ( time, raw );
+            colors::bind ( raw, bound );
         }
     }
+    paletteCommand.clear ( );
+    for ( std::size_t i = 0; i < defines::consolePaletteLength; i++ )
+    {
+        palette.change ( paletteCommand,
+                         i,
+                         bound [ 4 * i + 0 ],
+                         bound [ 4 * i + 1 ],
+                         bound [ 4 * i + 2 ] );
+    }
+    // a palette that holds still leaves the terminal to the text.
+    if ( !paletteCommand.empty ( ) )
+    {
+        lastCommand = cmd.pushString ( paletteCommand );
+    }
+    return next;
 }
 
-void io::console::Console::impl_s::sizeUpdateFunction ( )
+void io::console::Console::impl_s::flattenColors ( )
 {
-    using namespace std::chrono_literals;
-    while ( !this->stopSignal.load ( ) )
+    flattenColors ( screen );
+}
+
+void io::console::Console::impl_s::flattenColors (
+        std::span< std::shared_ptr< colors::IColor > const > const &roots )
+{
+    internal::ColorGraph flattened ( roots );
+    internal::Keyframes  looped;
+    if ( precomputePalette )
     {
-#ifdef WINDOWS
-        HANDLE                     hcout = GetStdHandle ( STD_OUTPUT_HANDLE );
-        CONSOLE_SCREEN_BUFFER_INFO info;
-        GetConsoleScreenBufferInfo ( hcout, &info );
-        consoleSize.row = info.dwSize.Y;
-        consoleSize.col = info.dwSize.X;
-#else
-        // use the linux environment variables
-        defines::ChrChar *_rows = std::getenv ( "ROWS" );
-        defines::ChrChar *_cols = std::getenv ( "COLUMNS" );
-
-        defines::ChrStringStream rows { _rows ? _rows : "25" };
-        defines::ChrStringStream cols { _cols ? _cols : "80" };
-        rows >> consoleSize.row;
-        cols >> consoleSize.col;
-#endif
+        looped = internal::Keyframes ( flattened,
+                                       defines::consolePaletteLength,
+                                       paletteStep,
+                                       keyframeLimit );
+    }
+    graph     = std::move ( flattened );
+    keyframes = std::move ( looped );
+}
 
-        auto now   = [ & ] ( ) { return std::chrono::steady_clock::now ( ); };
-        auto start = now ( );
-        while ( now ( ) - start < this->updateRate.load ( ) )
+void io::console::Console::impl_s::checkSize ( )
+{
+    std::uint32_t newRows;
+    std::uint32_t newCols;
+    {
+        // whoever comes second waits for the size the first one found.
+        std::scoped_lock< std::mutex > lock ( sizing );
+        if ( !backend->resized ( ) )
         {
-            if ( this->stopSignal.load ( ) )
-            {
-                return;
-            } else
-            {
-                std::this_thread::sleep_for ( 1ms );
-            }
+            return;
+        }
+        newRows = rows.load ( );
+        newCols = cols.load ( );
+        if ( !backend->size ( newRows, newCols ) )
+        {
+            return;
+        }
+        std::uint32_t const oldRows = rows.exchange ( newRows );
+        std::uint32_t const oldCols = cols.exchange ( newCols );
+        if ( oldRows == newRows && oldCols == newCols )
+        {
+            return;
         }
     }
+    std::vector< ResizeListener > toTell;
+    {
+        std::scoped_lock< std::mutex > lock ( listening );
+        for ( auto const &[ id, listener ] : listeners )
+        {
+            toTell.push_back ( listener );
+        }
+    }
+    for ( auto const &listener : toTell )
+    {
+        listener ( newRows, newCols );
+    }
 }
 
-io::console::Console::Console ( ) : pimpl ( new impl_s ( ) ) { }
+io::console::Console::Console ( std::shared_ptr< Backend > const &backend ) :
+        pimpl ( new impl_s ( backend ) )
+{ }
 io::console::Console::~Console ( ) = default;
 
 std::uint32_t io::console::Console::getCols ( ) const noexcept
 {
-    return pimpl->consoleSize.col;
+    pimpl->checkSize ( );
+    return pimpl->cols.load ( );
 }
 
 void io::console::Console::setCols ( std::uint32_t const &value ) noexcept
 {
-    pimpl->consoleSize.col = value;
+    pimpl->cols.store ( value );
 }
 
 std::uint32_t io::console::Console::getRows ( ) const noexcept
 {
-    return pimpl->consoleSize.row;
+    pimpl->checkSize ( );
+    return pimpl->rows.load ( );
 }
 
 void io::console::Console::setRows ( std::uint32_t const &value ) noexcept
 {
-    pimpl->consoleSize.row = value;
+    pimpl->rows.store ( value );
 }
 
-void io::console::Console::send ( std::string const &str ) noexcept
+std::size_t io::console::Console::addResizeListener (
+        ResizeListener const &listener )
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->listening );
+    std::size_t const              id = pimpl->nextListener++;
+    pimpl->listeners.emplace ( id, listener );
+    return id;
+}
+
+void io::console::Console::removeResizeListener (
+        std::size_t const &id ) noexcept
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->listening );
+    pimpl->listeners.erase ( id );
+}
+
+void io::console::Console::impl_s::encode (
+        std::string const               &str,
+        manip::Tokenizer                &tokenizer,
+        EncodedText                     &out,
+        std::function< void ( ) > const &lineDone )
 {
-    std::shared_ptr< bool > lastToken;
-    std::string             line = str;
-    if ( pimpl->wrapText )
+    std::string line;
+    // a sequence (or character) cut off at the end of the string waits for
+    // the rest of it in the next call.
+    tokenizer.feed ( str, [ & ] ( manip::Token const &token ) {
+        line.append ( token.bytes );
+        if ( token.type == manip::TokenType::CSI && token.bytes.size ( ) > 2
+             && token.bytes.back ( ) == 'm' )
+        {
+            out.afterKnown = out.afterKnown
+                          && out.after.apply ( token.bytes.substr (
+                                  2,
+                                  token.bytes.size ( ) - 3 ) );
+        }
+    } );
+    if ( line.empty ( ) )
     {
-        std::vector< std::string > joinables =
-                manip::generateTextInseperables ( line );
-        std::vector< std::string > lines           = { "" };
-        std::string                joined          = "";
-        std::uint32_t              currentPosition = 0;
+        return;
+    }
 
-        auto lengthOf = [] ( std::string text ) -> std::uint32_t {
-            std::uint32_t result = 0;
-            for ( auto &cp : manip::splitByCodePoint ( text ) )
+    // cuts text into units with each code point as its own unit.
+    auto push = [ & ] ( std::string const &text ) {
+        std::u32string widened;
+        for ( auto const &codePoint : manip::CodePoints ( text ) )
+        {
+            widened += codePoint.value;
+        }
+        std::vector< unicode::CharacterProperties > properties (
+                widened.size ( ) );
+        unicode::characterProperties ( ).lookup ( widened, properties );
+        std::size_t i = 0;
+        for ( auto const &codePoint : manip::CodePoints ( text ) )
+        {
+            std::size_t const before = out.units.size ( );
+            out.units.append ( codePoint.bytes );
+            // check for emoji. Their graphical representation is two
+            // columns wide on windows-systems, the cursor only moves one
+            // column across.
+            if ( properties [ i++ ].emoji )
             {
-                auto props = unicode::characterProperties ( ).at (
-                        manip::widen ( cp.c_str ( ) ) );
-                if ( !props.control )
-                {
-                    result += 1 + props.columns;
-                }
+                // command that moves the cursor one unit forwards.
+                out.units += "\u001b[C";
             }
-            return result;
+            out.lengths.push_back (
+                    std::uint32_t ( out.units.size ( ) - before ) );
+        }
+        if ( lineDone )
+        {
+            lineDone ( );
+        }
+    };
+
+    if ( !wrapText )
+    {
+        push ( line );
+    } else
+    {
+        // the line being built and how many columns it takes so far
+        std::string   current         = "";
+        std::uint32_t currentPosition = 0;
+        // sends the line being built on its way.
+        auto emit = [ & ] ( ) {
+            push ( centerText ? manip::centerTextOn ( current, cols.load ( ) )
+                              : current );
+            current.clear ( );
         };
+
         // TODO #61 It shows up here.
 
-        // for each joinable string in joinables:
-        // 1. if it's a hard line break, reset the current position since a
-        // line break will occur automatically.
-        // 2. if adding the next joinable would cause a screen wrap and we are
-        // not at the beginning of a line, insert a newline then add the
-        // joinable.
+        // for each joinable string:
+        // 1. if it's a hard line break, the line is done since a line break
+        // will occur automatically.
+        // 2. if adding the joinable would cause a screen wrap and we are
+        // not at the beginning of a line, end the line with a newline, then
+        // start the next one with the joinable.
         // 3. if we uncontrollably wrapped the previous line and we have another
         // joinable to add, unconditionally break between the two.
-        for ( auto &joinable : joinables )
-        {
-            std::uint32_t itsLength = lengthOf ( joinable );
-            // if we would uncontrollably wrap the screen by adding the sequence
-            if ( currentPosition && itsLength + currentPosition > getCols ( ) )
+        auto place = [ & ] ( manip::Inseperable const &joinable ) {
+            std::uint32_t itsLength = 0;
+            for ( auto const &codePoint : manip::CodePoints ( joinable.text ) )
             {
-                lines.back ( ).append ( "\n" );
-                lines.push_back ( joinable );
-                currentPosition = itsLength;
-                // no need to check again for the uncontrolled screen wrap
-                // since currentPosition != 0.
-            } else
-            {
-                lines.back ( ) += joinable;
-                currentPosition += itsLength;
-                // check if joinable ends in a hard line break
-                char32_t lastCodePoint =
-                        manip::widen ( manip::splitByCodePoint ( joinable )
-                                               .back ( )
-                                               .c_str ( ) );
-                auto properties =
-                        unicode::characterProperties ( ).at ( lastCodePoint );
-                unicode::BreakingProperties breaking =
-                        ( unicode::BreakingProperties ) properties.lineBreaking;
-                switch ( breaking )
+                auto props = unicode::characterProperties ( ).lookup (
+                        codePoint.value );
+                if ( !props.control )
                 {
-                    case unicode::BreakingProperties::BK:
-                    case unicode::BreakingProperties::CR:
-                    case unicode::BreakingProperties::LF:
-                    case unicode::BreakingProperties::NL:
-                        // we have a hard line break
-                        currentPosition = 0;
-                        break;
-                    default: break;
+                    itsLength += 1 + props.columns;
                 }
             }
-        }
-        for ( auto &aLine : lines )
-        {
-            if ( pimpl->centerText )
+            // if we would uncontrollably wrap the screen by adding the sequence
+            if ( currentPosition
+                 && itsLength + currentPosition > cols.load ( ) )
             {
-                // each line has a newline already, so we don't need to check
-                // for that.
-                joined += manip::centerTextOn ( aLine, getCols ( ) );
-            } else
+                current.append ( "\n" );
+                emit ( );
+                currentPosition = 0;
+            }
+            current += joinable.text;
+            currentPosition += itsLength;
+            if ( joinable.mandatory )
             {
-                joined += aLine;
+                emit ( );
+                currentPosition = 0;
+            }
+        };
+
+        // lines go out as soon as they are known, so the first line of a long
+        // string does not wait on the rest of it.
+        constexpr std::size_t chunk = 256;
+        manip::LineBreaker    breaker;
+        manip::Inseperable    joinable;
+        for ( std::size_t at = 0; at < line.size ( ); at += chunk )
+        {
+            breaker.feed ( std::string_view ( line ).substr ( at, chunk ) );
+            while ( breaker.pull ( joinable ) )
+            {
+                place ( joinable );
             }
         }
-        // final step: set line to joined
-        line = joined;
-    }
-    // assert our SGR attributes for this line
-    // send all attributes.
-    std::string command = "\u001b[m";
-    for ( std::size_t i = 0; i < pimpl->sgrMap.size ( ); i++ )
-    {
-        if ( pimpl->sgrMap.at ( i ) )
+        breaker.finish ( );
+        while ( breaker.pull ( joinable ) )
+        {
+            place ( joinable );
+        }
+        if ( !current.empty ( ) )
         {
-            command += "\u001b[" + std::to_string ( i ) + "m";
+            emit ( );
         }
     }
-    if ( ( pimpl->foreground & 0xff ) == 9 )
-    {
-        command += "\u001b[38;5;" + std::to_string ( pimpl->foreground >> 8 )
-                 + "m";
-    } else if ( ( pimpl->foreground & 0xff ) == 10 )
+}
+
+io::console::Console::EncodedText
+        io::console::Console::encode ( std::string const &str )
+{
+    pimpl->checkSize ( );
+    std::scoped_lock< std::mutex > lock ( pimpl->sending );
+    EncodedText                    out;
+    out.pen   = pimpl->pen;
+    out.after = pimpl->pen;
+    // a string encoded on its own has nothing to continue.
+    manip::Tokenizer tokenizer;
+    pimpl->encode ( str, tokenizer, out, nullptr );
+    // a sequence the string cuts off goes out as it is, as one unit.
+    tokenizer.flush ( [ & ] ( manip::Token const &token ) {
+        out.units.append ( token.bytes );
+        out.lengths.push_back ( std::uint32_t ( token.bytes.size ( ) ) );
+    } );
+    return out;
+}
+
+void io::console::Console::push ( EncodedText const &text ) noexcept
+{
+    if ( text.lengths.empty ( ) )
     {
-        command += "\u001b[38;2;"
-                 + std::to_string ( ( 0xff & pimpl->foreground ) >> 24 ) + ";"
-                 + std::to_string ( ( 0xff & pimpl->foreground ) >> 16 ) + ";"
-                 + std::to_string ( ( 0xff & pimpl->foreground ) >> 8 ) + "m";
+        return;
     }
-
-    if ( ( pimpl->background & 0xff ) == 9 )
+    std::unique_lock< std::mutex > lock ( pimpl->sending );
+    std::string                    command;
+    if ( pimpl->sentKnown )
     {
-        command += "\u001b[48;5;" + std::to_string ( pimpl->background >> 8 )
-                 + "m";
-    } else if ( ( pimpl->background & 0xff ) == 10 )
+        internal::appendTransition (
+                command, pimpl->sent, text.pen, pimpl->depth );
+    } else
     {
-        command += "\u001b[48;2;"
-                 + std::to_string ( ( 0xff & pimpl->background ) >> 24 ) + ";"
-                 + std::to_string ( ( 0xff & pimpl->background ) >> 16 ) + ";"
-                 + std::to_string ( ( 0xff & pimpl->background ) >> 8 ) + "m";
+        internal::appendPen ( command, text.pen, pimpl->depth );
     }
-    line = command + line;
+    if ( !command.empty ( ) )
     {
-        // iterate through the SGR attributes and assert the appropriate ones.
-        std::scoped_lock< std::mutex > lock ( pimpl->sending );
-        for ( auto &cp : manip::splitByCodePoint ( line ) )
+        pimpl->txt.pushString ( command );
+    }
+    auto const last  = pimpl->txt.pushUnits ( text.units, text.lengths );
+    // the text went around the screen buffer.
+    pimpl->fitBuffer ( );
+    pimpl->buffer.follow ( text.units );
+    pimpl->pen       = text.pen;
+    pimpl->sent      = text.after;
+    pimpl->sentKnown = text.afterKnown;
+    lock.unlock ( );
+    pimpl->waitForText ( last );
+}
+
+void io::console::Console::send ( std::string const &str ) noexcept
+{
+    pimpl->checkSize ( );
+    internal::TextChannel::Sequence last = 0;
+    // the whole string goes out under the lock so that text sent from two
+    // threads does not interleave, even though it goes out a line at a time.
+    std::unique_lock< std::mutex > lock ( pimpl->sending );
+    pimpl->fitBuffer ( );
+    EncodedText                    out;
+    out.pen   = pimpl->pen;
+    out.after = pimpl->pen;
+    // lines go out as soon as they are known, after whatever takes the
+    // terminal from the last string's attributes to ours.
+    bool started = false;
+    pimpl->encode ( str, pimpl->tokenizer, out, [ & ] ( ) {
+        if ( !started )
         {
-            // check for emoji. Their graphical representation is two
-            // columns wide on windows-systems, the cursor only moves one
-            // column across.
-            std::string temp = cp;
-            char32_t    c    = manip::widen ( temp.c_str ( ) );
-            if ( unicode::characterProperties ( ).at ( c ).emoji )
+            std::string command;
+            if ( pimpl->sentKnown )
             {
-                // command that moves the cursor one unit forwards.
-                temp += "\u001b[C";
+                internal::appendTransition (
+                        command, pimpl->sent, out.pen, pimpl->depth );
+            } else
+            {
+                internal::appendPen ( command, out.pen, pimpl->depth );
             }
-
-            lastToken = pimpl->txt.pushString ( temp );
+            if ( !command.empty ( ) )
+            {
+                pimpl->txt.pushString ( command );
+            }
+            started = true;
         }
+        last = pimpl->txt.pushUnits ( out.units, out.lengths );
+        // the text goes around the screen buffer, so the rows it writes on
+        // are not what the buffer thinks is on screen.
+        pimpl->buffer.follow ( out.units );
+        out.units.clear ( );
+        out.lengths.clear ( );
+    } );
+    if ( !started )
+    {
+        return;
     }
-    if ( pimpl->waitOnTextChannel )
+    pimpl->sent      = out.after;
+    pimpl->sentKnown = out.afterKnown;
+    lock.unlock ( );
+    pimpl->waitForText ( last );
+}
+
+std::uint32_t io::console::Console::draw ( std::uint32_t const &row,
+                                           std::uint32_t const &col,
+                                           std::string const   &text )
+{
+    pimpl->checkSize ( );
+    std::scoped_lock< std::mutex > lock ( pimpl->sending );
+    pimpl->fitBuffer ( );
+    internal::Cell style;
+    style.pen = pimpl->pen;
+    return pimpl->buffer.draw ( row, col, text, style );
+}
+
+void io::console::Console::present ( )
+{
+    pimpl->checkSize ( );
+    std::unique_lock< std::mutex > lock ( pimpl->sending );
+    pimpl->fitBuffer ( );
+    std::string const frame = pimpl->buffer.present ( pimpl->depth );
+    if ( frame.empty ( ) )
     {
-        while ( !*lastToken )
-        {
-            std::this_thread::sleep_for ( std::chrono::milliseconds ( 1 ) );
-        }
+        return;
     }
+    // a frame goes out all at once, however slow the text is.
+    auto const last = pimpl->txt.pushString ( frame );
+    lock.unlock ( );
+    pimpl->waitForText ( last );
+}
+
+void io::console::Console::invalidate ( ) noexcept
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->sending );
+    pimpl->buffer.invalidate ( );
+    pimpl->paletteLost.store ( true );
 }
 
 std::shared_ptr< io::console::colors::IColor >
@@ -547,38 +793,211 @@ void io::console::Console::setScreenColor (
         std::uint8_t const                      &index,
         std::shared_ptr< colors::IColor > const &color )
 {
-    pimpl->screen [ index & 7 ] = color;
+    std::scoped_lock< std::mutex > lock ( pimpl->changingColors );
+    auto const                     old = pimpl->screen [ index & 7 ];
+    pimpl->screen [ index & 7 ]        = color;
+    try
+    {
+        pimpl->flattenColors ( );
+    } catch ( std::runtime_error const & )
+    {
+        pimpl->screen [ index & 7 ] = old;
+        throw;
+    }
 }
 
 void io::console::Console::setCalculationColor (
         std::size_t const                       &index,
         std::shared_ptr< colors::IColor > const &color )
 {
+    std::scoped_lock< std::mutex > lock ( pimpl->changingColors );
     pimpl->colors.insert_or_assign ( index, color );
+    // the screen's colors hold onto their own parameters, so this changes
+    // nothing onscreen by itself, but picks up parameters set in place.
+    pimpl->flattenColors ( );
 }
 
-std::uint64_t io::console::Console::getTxtRate ( ) const noexcept
+io::console::Console::CompiledPalette io::console::Console::compilePalette (
+        CompiledPalette::Colors const &colors )
+{
+    CompiledPalette out;
+    {
+        std::scoped_lock< std::mutex > lock ( pimpl->changingColors );
+        std::copy ( std::begin ( pimpl->screen ),
+                    std::end ( pimpl->screen ),
+                    out.screen.begin ( ) );
+        out.precomputed = pimpl->precomputePalette;
+    }
+    for ( auto const &[ index, color ] : colors )
+    {
+        if ( index > 7 )
+        {
+            out.calculation.insert_or_assign ( index, color );
+        } else
+        {
+            out.screen [ index ] = color;
+            out.sets |= std::uint8_t ( 1 << index );
+        }
+    }
+    // the long part, which the lock is not held for.
+    out.graph = internal::ColorGraph ( out.screen );
+    if ( out.precomputed )
+    {
+        out.keyframes = internal::Keyframes ( out.graph,
+                                              defines::consolePaletteLength,
+                                              paletteStep,
+                                              keyframeLimit );
+    }
+    return out;
+}
+
+void io::console::Console::setPalette ( CompiledPalette const &palette )
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->changingColors );
+    // the screen colors the console ends up with, which are only set once
+    // they are known to flatten, so a refused palette sets nothing.
+    bool current = palette.precomputed == pimpl->precomputePalette;
+    std::array< std::shared_ptr< colors::IColor >, 8 > next;
+    for ( std::size_t i = 0; i < 8; i++ )
+    {
+        next [ i ] = pimpl->screen [ i ];
+        if ( palette.sets & ( 1 << i ) )
+        {
+            next [ i ] = palette.screen [ i ];
+        } else if ( pimpl->screen [ i ] != palette.screen [ i ] )
+        {
+            current = false;
+        }
+    }
+    if ( current )
+    {
+        pimpl->graph     = palette.graph;
+        pimpl->keyframes = palette.keyframes;
+    } else
+    {
+        pimpl->flattenColors ( next );
+    }
+    std::copy ( next.begin ( ), next.end ( ), pimpl->screen );
+    for ( auto const &[ index, color ] : palette.calculation )
+    {
+        pimpl->colors.insert_or_assign ( index, color );
+    }
+}
+
+std::chrono::nanoseconds io::console::Console::getTxtRate ( ) const noexcept
 {
     return pimpl->txt.getDelay ( );
 }
-void io::console::Console::setTxtRate ( std::uint64_t const &value ) noexcept
+void io::console::Console::setTxtRate (
+        std::chrono::nanoseconds const &value ) noexcept
 {
     pimpl->txt.setDelay ( value );
 }
-std::uint64_t io::console::Console::getCmdRate ( ) const noexcept
+std::chrono::nanoseconds io::console::Console::getCmdRate ( ) const noexcept
 {
     return pimpl->cmd.getDelay ( );
 }
-void io::console::Console::setCmdRate ( std::uint64_t const &value ) noexcept
+void io::console::Console::setCmdRate (
+        std::chrono::nanoseconds const &value ) noexcept
 {
     pimpl->cmd.setDelay ( value );
 }
 
+double io::console::Console::getAchievedTxtRate ( ) const noexcept
+{
+    return pimpl->txt.achievedRate ( );
+}
+double io::console::Console::getAchievedCmdRate ( ) const noexcept
+{
+    return pimpl->cmd.achievedRate ( );
+}
+
 void io::console::Console::setWaitOnText ( bool const &value ) noexcept
 {
     pimpl->waitOnTextChannel = value;
 }
 
+void io::console::Console::setPrecomputedPalette ( bool const &value )
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->changingColors );
+    pimpl->precomputePalette = value;
+    pimpl->flattenColors ( );
+}
+
+void io::console::Console::setColorDepth ( ColorDepth const &depth ) noexcept
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->sending );
+    pimpl->depth = depth;
+    // what is on screen went out at the old depth.
+    pimpl->sentKnown = false;
+    pimpl->buffer.invalidate ( );
+}
+
+io::console::ColorDepth io::console::Console::getColorDepth ( ) noexcept
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->sending );
+    return pimpl->depth;
+}
+
+void io::console::Console::setSkipOnKey ( bool const &value ) noexcept
+{
+    pimpl->skipOnKey.store ( value );
+    pimpl->skipped.store ( false );
+}
+
+bool io::console::Console::getKey ( Key                             &key,
+                                    std::chrono::milliseconds const &timeout )
+{
+    return pimpl->input.next ( key, timeout );
+}
+
+std::string io::console::Console::getLine ( )
+{
+    std::string                line;
+    // how many bytes each character took, to take them back.
+    std::vector< std::size_t > sizes;
+    while ( true )
+    {
+        Key key;
+        getKey ( key );
+        switch ( key.code )
+        {
+        case Key::Code::ENTER: pimpl->echo ( "\r\n" ); return line;
+        case Key::Code::CLOSED: return line;
+        case Key::Code::CHARACTER:
+            if ( key.modifiers & ( Key::ALT | Key::CONTROL ) )
+            {
+                break;
+            }
+            line += key.text;
+            sizes.push_back ( key.text.size ( ) );
+            pimpl->echo ( key.text );
+            break;
+        case Key::Code::BACKSPACE:
+            if ( sizes.empty ( ) )
+            {
+                break;
+            }
+            line.erase ( line.size ( ) - sizes.back ( ) );
+            sizes.pop_back ( );
+            pimpl->echo ( "\b \b" );
+            break;
+        default: break;
+        }
+    }
+}
+
+std::future< io::console::CursorPosition >
+        io::console::Console::getCursorPosition ( )
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->sending );
+    auto report = pimpl->input.expectCursor ( );
+    // asking through the text channel puts the question after the text
+    // before it, without stopping the channel to wait for the answer.
+    pimpl->txt.pushString ( "\u001b[6n" );
+    return report;
+}
+
 void io::console::Console::setWrapping ( bool const &value ) noexcept
 {
     pimpl->wrapText = value;
@@ -589,180 +1008,321 @@ void io::console::Console::setCentering ( bool const &value ) noexcept
     pimpl->centerText = value;
 }
 
+io::console::Console::Style io::console::Console::getStyle ( ) const noexcept
+{
+    return Style { pimpl->pen, pimpl->wrapText, pimpl->centerText };
+}
+
+void io::console::Console::setStyle ( Style const &style ) noexcept
+{
+    pimpl->pen        = style.pen;
+    pimpl->wrapText   = style.wrap;
+    pimpl->centerText = style.center;
+}
+
 void io::console::Console::sgrCommand ( SGRCommand const &command,
                                         bool const        value ) noexcept
 {
-    // if we're setting a color, clear all other color attributes
-    // check if we're setting a foreground
-    std::uint8_t           cmd  = ( std::uint8_t ) command;
-    constexpr std::uint8_t minF = ( std::uint8_t ) SGRCommand::CGA_FOREGROUND_0;
-    constexpr std::uint8_t maxF =
-            ( std::uint8_t ) SGRCommand::FOREGROUND_DEFAULT;
-    constexpr std::uint8_t minB = ( std::uint8_t ) SGRCommand::CGA_BACKGROUND_0;
-    constexpr std::uint8_t maxB =
-            ( std::uint8_t ) SGRCommand::BACKGROUND_DEFAULT;
-    if ( cmd >= minF && cmd <= maxF )
-    {
-        // set all foreground attributes to false
-        for ( std::size_t i = minF;
-              i <= ( std::size_t ) SGRCommand::CGA_FOREGROUND_7;
-              i++ )
-        {
-            pimpl->sgrMap.at ( i ) = false;
-        }
-        pimpl->sgrMap.at ( maxF ) = false;
-    } else if ( cmd >= minB && cmd <= maxB )
+    pimpl->pen.set ( std::uint32_t ( command ), value );
+}
+
+void io::console::Console::resetSGR ( ) noexcept
+{
+    pimpl->pen = internal::Pen ( );
+}
+
+void io::console::Console::setForeground ( std::uint32_t const &color ) noexcept
+{
+    pimpl->pen.foreground = internal::canonicalColor ( color );
+}
+
+void io::console::Console::setBackground ( std::uint32_t const &color ) noexcept
+{
+    pimpl->pen.background = internal::canonicalColor ( color );
+}
+
+bool testResize ( std::ostream &stream )
+{
+    using namespace io::console;
+    using namespace std::chrono_literals;
+    stream << "Beginning console resize unittest.\n";
+    auto    terminal = std::make_shared< VirtualTerminal > ( 5, 20 );
+    Console console ( terminal );
+    stream << "Ensuring that the console starts at the terminal's size...\n";
+    if ( console.getRows ( ) != 5 || console.getCols ( ) != 20 )
     {
-        // set all background attributes to false
-        for ( std::size_t i = minB;
-              i <= ( std::size_t ) SGRCommand::CGA_BACKGROUND_7;
-              i++ )
+        BASIC_UNIT_FAIL ( stream, "The console started out as "
+                                          << console.getRows ( ) << " by "
+                                          << console.getCols ( ) )
+    }
+
+    stream << "Ensuring that listeners hear of a resize by themselves...\n";
+    // the listener runs on whichever thread noticed, which is usually the
+    // one reading keys.
+    std::atomic< std::uint32_t > heardRows = 0;
+    std::atomic< std::uint32_t > heardCols = 0;
+    std::atomic_size_t           heard     = 0;
+    auto const                   id        = console.addResizeListener (
+            [ & ] ( auto const &rows, auto const &cols ) {
+                heardRows.store ( rows );
+                heardCols.store ( cols );
+                heard++;
+            } );
+    auto const hears = [ & ] ( std::size_t const &times ) {
+        auto const until = std::chrono::steady_clock::now ( ) + 2s;
+        while ( heard.load ( ) < times
+                && std::chrono::steady_clock::now ( ) < until )
         {
-            pimpl->sgrMap.at ( i ) = false;
+            std::this_thread::sleep_for ( 1ms );
         }
-        pimpl->sgrMap.at ( maxB ) = false;
+        return heard.load ( ) == times;
+    };
+    terminal->resize ( 7, 30 );
+    if ( !hears ( 1 ) || heardRows != 7 || heardCols != 30 )
+    {
+        BASIC_UNIT_FAIL ( stream, "The resize went unheard" )
+    }
+    if ( console.getCols ( ) != 30 || console.getRows ( ) != 7 )
+    {
+        BASIC_UNIT_FAIL ( stream, "The console did not take the new size" )
     }
 
-    pimpl->sgrMap.at ( std::size_t ( command ) ) = value;
+    stream << "Ensuring that listeners hear of a resize once...\n";
+    terminal->resize ( 7, 30 );
+    console.getCols ( );
+    console.removeResizeListener ( id );
+    terminal->resize ( 8, 31 );
+    // long enough for the reader to have told anyone it was going to.
+    std::this_thread::sleep_for ( 50ms );
+    if ( console.getCols ( ) != 31 || heard != 1 )
+    {
+        BASIC_UNIT_FAIL ( stream, "A listener heard what it should not have" )
+    }
+    return true;
 }
 
-void io::console::Console::setForeground ( std::uint32_t const &color ) noexcept
+test::Unittest resizeTest { &testResize };
+
+bool testConsoleInput ( std::ostream &stream )
 {
-    if ( ( color & 0xff ) < 9 )
+    using namespace io::console;
+    using namespace std::chrono_literals;
+    stream << "Beginning console input unittest.\n";
+    auto    terminal = std::make_shared< VirtualTerminal > ( 5, 20 );
+    Console console ( terminal );
+    console.setTxtRate ( 0s );
+
+    stream << "Ensuring that a line is read and echoed...\n";
+    terminal->type ( "hx\u007fi!\r" );
+    std::string const line = console.getLine ( );
+    // the report comes once the echo has gone out.
+    CursorPosition const after = console.getCursorPosition ( ).get ( );
+    if ( line != "hi!" || terminal->text ( 0 ) != "hi!"
+         || !( after == CursorPosition { 2, 1 } ) )
     {
-        // set sgr color accordingly
-        for ( std::size_t i = 0; i < 8; i++ )
-        {
-            pimpl->sgrMap.at ( std::size_t ( SGRCommand::CGA_FOREGROUND_0 )
-                               + i ) = false;
-        }
-        pimpl->sgrMap.at ( std::size_t ( SGRCommand::FOREGROUND_DEFAULT ) ) =
-                false;
-        switch ( color & 0x7 )
-        {
-            case 7:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_FOREGROUND_7 ) ) = true;
-                break;
-            case 6:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_FOREGROUND_6 ) ) = true;
-                break;
-            case 5:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_FOREGROUND_5 ) ) = true;
-                break;
-            case 4:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_FOREGROUND_4 ) ) = true;
-                break;
-            case 3:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_FOREGROUND_3 ) ) = true;
-                break;
-            case 2:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_FOREGROUND_2 ) ) = true;
-                break;
-            case 1:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_FOREGROUND_1 ) ) = true;
-                break;
-            case 0:
-                if ( color & 8 )
-                {
-                    pimpl->sgrMap.at ( std::size_t (
-                            SGRCommand::FOREGROUND_DEFAULT ) ) = true;
-                } else
-                {
-                    pimpl->sgrMap.at ( std::size_t (
-                            SGRCommand::CGA_FOREGROUND_0 ) ) = true;
-                }
-                break;
-            default:
-                if ( color & 8 )
-                {
-                    pimpl->sgrMap.at ( std::size_t (
-                            SGRCommand::FOREGROUND_DEFAULT ) ) = true;
-                } else
-                {
-                    pimpl->sgrMap.at ( std::size_t (
-                            SGRCommand::CGA_FOREGROUND_0 ) ) = true;
-                }
-        }
-    } else
+        BASIC_UNIT_FAIL ( stream,
+                          "Read \"" << line << "\" and showed \""
+                                    << terminal->text ( 0 ) << "\"" )
+    }
+
+    stream << "Ensuring that a key skips slow text...\n";
+    console.setTxtRate ( 1s );
+    console.setWaitOnText ( true );
+    console.setSkipOnKey ( true );
+    std::thread typist ( [ & ] ( ) {
+        std::this_thread::sleep_for ( 50ms );
+        terminal->type ( "k" );
+    } );
+    auto const start = std::chrono::steady_clock::now ( );
+    console << "abcdef";
+    typist.join ( );
+    // once skipped, the rest of the text goes out at once too.
+    console << "gh";
+    Key key;
+    if ( std::chrono::steady_clock::now ( ) - start > 2s
+         || terminal->text ( 1 ) != "abcdefgh" || console.getKey ( key, 0ms ) )
     {
-        // set internal color accordingly.
-        pimpl->foreground = color;
+        BASIC_UNIT_FAIL ( stream,
+                          "The text showed \"" << terminal->text ( 1 )
+                                               << "\" after skipping" )
     }
+    return true;
 }
-void io::console::Console::setBackground ( std::uint32_t const &color ) noexcept
+
+test::Unittest consoleInputTest { &testConsoleInput };
+
+bool testColorDepth ( std::ostream &stream )
 {
-    if ( ( color & 0xff ) < 9 )
+    using namespace io::console;
+    using namespace std::chrono_literals;
+    stream << "Beginning console color depth unittest.\n";
+    auto terminal = std::make_shared< VirtualTerminal > ( 5, 20 );
+    terminal->setColorDepth ( ColorDepth::SIXTEEN );
+    Console console ( terminal );
+    console.setTxtRate ( 0s );
+
+    stream << "Ensuring that the console starts at the terminal's depth...\n";
+    if ( console.getColorDepth ( ) != ColorDepth::SIXTEEN )
     {
-        // set sgr color accordingly
-        for ( std::size_t i = 0; i < 8; i++ )
-        {
-            pimpl->sgrMap.at ( std::size_t ( SGRCommand::CGA_BACKGROUND_0 )
-                               + i ) = false;
-        }
-        pimpl->sgrMap.at ( std::size_t ( SGRCommand::BACKGROUND_DEFAULT ) ) =
-                false;
-        switch ( color & 0x7 )
+        BASIC_UNIT_FAIL ( stream, "The console started at another depth" )
+    }
+
+    stream << "Ensuring that colors go out as the depth has them...\n";
+    console.setForeground ( 0xff00000a );
+    console.setBackground ( 0x00007f0a );
+    console << "a";
+    console.setColorDepth ( ColorDepth::EIGHT );
+    console << "b";
+    console.setColorDepth ( ColorDepth::TRUECOLOR );
+    console << "c";
+    // the report comes once the text has gone out.
+    console.getCursorPosition ( ).get ( );
+    std::pair< std::uint32_t, std::uint32_t > const expected [] = {
+            { terminal->cell ( 0, 0 ).pen.foreground, 0x0909 },
+            { terminal->cell ( 0, 0 ).pen.background, 4 },
+            { terminal->cell ( 0, 1 ).pen.foreground, 1 },
+            { terminal->cell ( 0, 2 ).pen.foreground, 0xff00000a },
+    };
+    for ( auto const &[ got, want ] : expected )
+    {
+        if ( got != want )
         {
-            case 7:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_BACKGROUND_7 ) ) = true;
-                break;
-            case 6:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_BACKGROUND_6 ) ) = true;
-                break;
-            case 5:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_BACKGROUND_5 ) ) = true;
-                break;
-            case 4:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_BACKGROUND_4 ) ) = true;
-                break;
-            case 3:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_BACKGROUND_3 ) ) = true;
-                break;
-            case 2:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_BACKGROUND_2 ) ) = true;
-                break;
-            case 1:
-                pimpl->sgrMap.at (
-                        std::size_t ( SGRCommand::CGA_BACKGROUND_1 ) ) = true;
-                break;
-            case 0:
-                if ( color & 8 )
-                {
-                    pimpl->sgrMap.at ( std::size_t (
-                            SGRCommand::FOREGROUND_DEFAULT ) ) = true;
-                } else
-                {
-                    pimpl->sgrMap.at ( std::size_t (
-                            SGRCommand::CGA_FOREGROUND_0 ) ) = true;
-                }
-                break;
-            default:
-                if ( color & 8 )
-                {
-                    pimpl->sgrMap.at ( std::size_t (
-                            SGRCommand::BACKGROUND_DEFAULT ) ) = true;
-                } else
-                {
-                    pimpl->sgrMap.at ( std::size_t (
-                            SGRCommand::CGA_BACKGROUND_0 ) ) = true;
-                }
+            BASIC_UNIT_FAIL ( stream,
+                              "Expected " << std::hex << want << " but got "
+                                          << got << std::dec )
         }
-    } else
+    }
+    return true;
+}
+
+test::Unittest colorDepthTest { &testColorDepth };
+
+bool testConsoleFrames ( std::ostream &stream )
+{
+    using namespace io::console;
+    using namespace std::chrono_literals;
+    stream << "Beginning console frame unittest.\n";
+    auto    terminal = std::make_shared< VirtualTerminal > ( 3, 10 );
+    Console console ( terminal );
+    console.setTxtRate ( 0s );
+    console.setWaitOnText ( true );
+
+    stream << "Ensuring that a frame shows what was drawn...\n";
+    console.draw ( 0, 0, "hello" );
+    console.draw ( 1, 2, "world" );
+    console.present ( );
+    if ( terminal->text ( 0 ) != "hello" || terminal->text ( 1 ) != "  world" )
     {
-        // set internal color accordingly.
-        pimpl->background = color;
+        BASIC_UNIT_FAIL ( stream, "The frame showed \"" << terminal->text ( 0 )
+                                                        << "\"" )
     }
+
+    stream << "Ensuring that text sent over a frame does not stay...\n";
+    // the frame put the cursor back where it found it, at the top left.
+    console << "XY";
+    if ( terminal->text ( 0 ) != "XYllo" )
+    {
+        BASIC_UNIT_FAIL ( stream, "The text showed \"" << terminal->text ( 0 )
+                                                       << "\"" )
+    }
+    console.present ( );
+    if ( terminal->text ( 0 ) != "hello" || terminal->text ( 1 ) != "  world"
+         || terminal->wraps ( ) || terminal->surprises ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "The next frame showed \""
+                                          << terminal->text ( 0 ) << "\"" )
+    }
+
+    stream << "Ensuring that a frame leaves rows the text missed alone...\n";
+    // behind the console's back, so only a frame that redraws the row fixes
+    // it.
+    terminal->write ( "\u001b7\u001b[2;1HZZZZ\u001b8" );
+    console << "AB";
+    console.present ( );
+    if ( terminal->text ( 0 ) != "hello" || terminal->text ( 1 ) != "ZZZZrld" )
+    {
+        BASIC_UNIT_FAIL ( stream, "The frame showed \"" << terminal->text ( 1 )
+                                                        << "\"" )
+    }
+
+    stream << "Ensuring that a frame keeps up with text scrolling...\n";
+    console.invalidate ( );
+    console.present ( );
+    console << "\r\n\n\nQ";
+    if ( terminal->text ( 0 ) != "  world" || terminal->text ( 2 ) != "Q" )
+    {
+        BASIC_UNIT_FAIL ( stream, "The text showed \"" << terminal->text ( 2 )
+                                                       << "\"" )
+    }
+    console.present ( );
+    if ( terminal->text ( 0 ) != "hello" || terminal->text ( 1 ) != "  world"
+         || terminal->text ( 2 ) != "" || terminal->surprises ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "The frame showed \"" << terminal->text ( 0 )
+                                                        << "\"" )
+    }
+    return true;
 }
+
+test::Unittest consoleFramesTest { &testConsoleFrames };
+
+bool testCompiledPalette ( std::ostream &stream )
+{
+    using namespace io::console;
+    stream << "Beginning compiled palette unittest.\n";
+    auto    terminal = std::make_shared< VirtualTerminal > ( 3, 10 );
+    Console console ( terminal );
+    auto    red   = std::make_shared< colors::RGBAColor > ( 200, 0, 0, 0 );
+    auto    green = std::make_shared< colors::RGBAColor > ( 0, 200, 0, 0 );
+    auto    blue  = std::make_shared< colors::RGBAColor > ( 0, 0, 200, 0 );
+    auto const untouched = console.getScreenColor ( 2 );
+
+    stream << "Ensuring that a palette sets only its own colors...\n";
+    auto const palette = console.compilePalette ( { { 1, red }, { 9, blue } } );
+    console.setScreenColor ( 3, green );
+    console.setPalette ( palette );
+    if ( console.getScreenColor ( 1 ) != red
+         || console.getScreenColor ( 2 ) != untouched
+         || console.getScreenColor ( 3 ) != green
+         || console.getCalculationColor ( 9 ) != blue )
+    {
+        BASIC_UNIT_FAIL ( stream, "The palette set the wrong colors" )
+    }
+
+    stream << "Ensuring that a palette calculated from itself is refused...\n";
+    using colors::IndirectColor;
+    auto loop = std::make_shared< IndirectColor > ( red, red, red, red );
+    auto back = std::make_shared< IndirectColor > ( loop, red, red, red );
+    *loop     = IndirectColor ( back, red, red, red );
+    try
+    {
+        console.compilePalette ( { { 4, loop } } );
+        BASIC_UNIT_FAIL ( stream, "The loop was let through" )
+    } catch ( std::runtime_error const & )
+    { }
+
+    stream << "Ensuring that a palette refused when set sets nothing...\n";
+    // compiled before the loop, then worked out again once it is there.
+    *loop = IndirectColor ( red, red, red, red );
+    auto const looping = console.compilePalette (
+            { { 1, green }, { 4, loop }, { 9, green } } );
+    console.setScreenColor ( 5, blue );
+    *loop = IndirectColor ( back, red, red, red );
+    try
+    {
+        console.setPalette ( looping );
+        BASIC_UNIT_FAIL ( stream, "The loop was let through" )
+    } catch ( std::runtime_error const & )
+    { }
+    if ( console.getScreenColor ( 1 ) != red
+         || console.getScreenColor ( 4 ) == loop
+         || console.getCalculationColor ( 9 ) != blue )
+    {
+        BASIC_UNIT_FAIL ( stream, "The refused palette set some colors" )
+    }
+    // breaks the loop, so the colors can go away.
+    *loop = IndirectColor ( );
+    return true;
+}
+
+test::Unittest compiledPaletteTest { &testCompiledPalette };
@@ -14,16 +14,27 @@
 #include <defines/constants.h++>
 #include <defines/macros.h++>
 #include <defines/types.h++>
+#include <io/console/backend.h++>
 #include <io/console/colors/color.h++>
 #include <io/console/colors/direct.h++>
 #include <io/console/colors/indirect.h++>
+#include <io/console/input.h++>
+#include <io/console/internal/buffer.h++>
 #include <io/console/internal/channel.h++>
+#include <io/console/internal/colorgraph.h++>
+#include <io/console/internal/keyframes.h++>
 #include <io/console/manip/stringfunctions.h++>
 
+#include <array>
+#include <chrono>
 #include <functional>
+#include <future>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace io::console
 {
@@ -120,20 +131,118 @@ namespace io::console
 
         void send ( std::string const &str ) noexcept;
     public:
-        Console ( );
+        /**
+         * @brief Text cut into units for the text channel ahead of time, so
+         * that it can go out again and again without being split, wrapped or
+         * centered each time.
+         */
+        struct EncodedText
+        {
+            // the units one after the other, and how long each one is.
+            std::string                  units;
+            std::vector< std::uint32_t > lengths;
+            // the attributes the text goes out with, and the ones it leaves
+            // the terminal with once sequences in the text have had their say.
+            internal::Pen                pen;
+            internal::Pen                after;
+            bool                         afterKnown = true;
+        };
+
+        /**
+         * @brief Takes over the terminal behind the backend, clearing it.
+         */
+        explicit Console ( std::shared_ptr< Backend > const & =
+                                   standardBackend ( ) );
         virtual ~Console ( );
 
+        /**
+         * @brief Cuts the text into units as sending it would right now, with
+         * the current attributes, wrapping, centering and width.
+         */
+        EncodedText encode ( std::string const & );
+        /**
+         * @brief Sends text encoded earlier, which also makes its attributes
+         * the current ones.
+         */
+        void        push ( EncodedText const & ) noexcept;
+
         void setWaitOnText ( bool const & ) noexcept;
+        /**
+         * @brief Whether a key pressed while waiting on text sends the rest of
+         * the text at once, instead of going to whoever reads keys. Once a key
+         * has skipped text, text waited on afterwards goes out at once too,
+         * until this is set again.
+         */
+        void setSkipOnKey ( bool const & ) noexcept;
+        /**
+         * @brief Whether the palette is worked out ahead of time, whenever a
+         * color is set, for as long as it takes to loop. Each tick then only
+         * looks its colors up. A palette that takes over a minute to loop is
+         * still worked out each tick, and so is one changed in place, which
+         * only shows once a color is next set.
+         */
+        void setPrecomputedPalette ( bool const & );
+        /**
+         * @brief How many colors the terminal can show, which starts as what
+         * the backend says. Colors that text and frames go out with are
+         * brought down to the nearest the terminal has, and the next frame
+         * redraws the screen.
+         */
+        void       setColorDepth ( ColorDepth const & ) noexcept;
+        ColorDepth getColorDepth ( ) noexcept;
+
+        /**
+         * @brief Waits up to the timeout, or for as long as it takes if the
+         * timeout is negative, for a key. Once the terminal has gone away, the
+         * key is always CLOSED.
+         *
+         * @return false if no key came in time.
+         */
+        bool        getKey ( Key &,
+                             std::chrono::milliseconds const &timeout =
+                                     std::chrono::milliseconds ( -1 ) );
+        /**
+         * @brief Reads a line, echoing it as it is typed and taking back a
+         * character for each backspace, without the enter that ends it.
+         */
+        std::string getLine ( );
+        /**
+         * @brief Asks where the cursor will be once the text sent so far has
+         * gone out. Nothing waits for the answer until the future is asked
+         * for it.
+         */
+        std::future< CursorPosition > getCursorPosition ( );
 
         std::uint32_t getCols ( ) const noexcept;
         void          setCols ( std::uint32_t const &value ) noexcept;
         std::uint32_t getRows ( ) const noexcept;
         void          setRows ( std::uint32_t const &value ) noexcept;
 
-        std::uint64_t getTxtRate ( ) const noexcept;
-        void          setTxtRate ( std::uint64_t const &value ) noexcept;
-        std::uint64_t getCmdRate ( ) const noexcept;
-        void          setCmdRate ( std::uint64_t const &value ) noexcept;
+        using ResizeListener =
+                std::function< void ( std::uint32_t const &rows,
+                                      std::uint32_t const &cols ) >;
+        /**
+         * @brief Calls the listener with the new size whenever the terminal
+         * changes size. The console hears of it on the thread reading keys,
+         * unless another thread needs the size first, and the listener runs
+         * on that thread. It must not throw, and must not wait on keys.
+         *
+         * @return an ID to remove the listener with.
+         */
+        std::size_t addResizeListener ( ResizeListener const & );
+        void        removeResizeListener ( std::size_t const & ) noexcept;
+
+        std::chrono::nanoseconds getTxtRate ( ) const noexcept;
+        void setTxtRate ( std::chrono::nanoseconds const &value ) noexcept;
+        std::chrono::nanoseconds getCmdRate ( ) const noexcept;
+        void setCmdRate ( std::chrono::nanoseconds const &value ) noexcept;
+
+        /**
+         * @brief How many units per second the channel actually sends, to
+         * compare against the rate that its delay asks for.
+         */
+        double getAchievedTxtRate ( ) const noexcept;
+        double getAchievedCmdRate ( ) const noexcept;
 
         std::shared_ptr< io::console::colors::IColor >
                 getScreenColor ( std::uint8_t const &index );
@@ -149,10 +258,93 @@ namespace io::console
                 std::size_t const                       &index,
                 std::shared_ptr< colors::IColor > const &color );
 
+        /**
+         * @brief Colors set all together and worked out ahead of time, so
+         * that setting them again only swaps them in.
+         */
+        struct CompiledPalette
+        {
+            // colors by index as a screen gives them: under 8 for the screen,
+            // and from 8 on for calculating.
+            using Colors =
+                    std::map< std::size_t, std::shared_ptr< colors::IColor > >;
+            // every screen color, where those the palette does not set are
+            // the ones the console had, and which of them it sets.
+            std::array< std::shared_ptr< colors::IColor >, 8 > screen;
+            std::uint8_t                                        sets = 0;
+            Colors                                              calculation;
+            // whether it was compiled with keyframes, and the screen colors
+            // flattened and (if so) worked out ahead of time.
+            bool                 precomputed = false;
+            internal::ColorGraph graph;
+            internal::Keyframes  keyframes;
+        };
+        /**
+         * @brief Works the colors out with the rest of the screen colors as
+         * they are now, without setting any of them.
+         *
+         * @throw std::runtime_error if a color is calculated from itself.
+         */
+        CompiledPalette compilePalette ( CompiledPalette::Colors const & );
+        /**
+         * @brief Sets every color the palette has at once. Nothing is worked
+         * out again unless the screen colors it leaves alone, or whether the
+         * palette is precomputed, changed since it was compiled.
+         *
+         * @throw std::runtime_error if, worked out again, a color is
+         * calculated from itself, in which case it sets nothing.
+         */
+        void            setPalette ( CompiledPalette const & );
+
         void setWrapping ( bool const & ) noexcept;
         void setCentering ( bool const & ) noexcept;
 
+        /**
+         * @brief The attributes, wrapping and centering that text goes out
+         * with, so that they can be put back after being borrowed.
+         */
+        struct Style
+        {
+            internal::Pen pen;
+            bool          wrap   = false;
+            bool          center = false;
+
+            bool operator== ( Style const & ) const noexcept = default;
+        };
+        Style getStyle ( ) const noexcept;
+        void  setStyle ( Style const & ) noexcept;
+
         void sgrCommand ( SGRCommand const &, bool const = true ) noexcept;
+        /**
+         * @brief Turns off every attribute and sets both colors to the
+         * default.
+         */
+        void resetSGR ( ) noexcept;
+
+        /**
+         * @brief Draws text into the screen buffer with the current attributes,
+         * from the row and column (counting from zero) to at most the end of
+         * the row. Nothing shows until the next present.
+         *
+         * @return the column after the text.
+         */
+        std::uint32_t draw ( std::uint32_t const &row,
+                             std::uint32_t const &col,
+                             std::string const   &text );
+        /**
+         * @brief Sends the cells of the screen buffer that changed since the
+         * last present, all as one unit on the text channel. Text sent any
+         * other way goes around the buffer, so the present after it blanks
+         * and redraws the rows that text wrote on, or the whole screen if the
+         * console lost track of the cursor.
+         */
+        void          present ( );
+        /**
+         * @brief Makes the next present redraw the screen buffer from scratch,
+         * and the palette go out again, for when something else has written
+         * over them.
+         */
+        void          invalidate ( ) noexcept;
 
         // different from adjusting the palette, this color allows setting a
         // direct color for the foreground. This color is interpreted similarly
@@ -185,18 +377,12 @@ namespace io::console
         Console &operator<< ( T const &t ) requires (
                 std::is_same_v< T, std::u8string > )
         {
-            auto codePoints = manip::splitByCodePoint ( t );
-            for ( auto &cp : codePoints )
+            std::string_view bytes ( ( char const * ) t.data ( ), t.size ( ) );
+            if ( manip::validateUTF08 ( bytes ) != bytes.size ( ) )
             {
-                // check here since a direct call to widen would appear too
-                // hacky even though validUTF08 just checks if the call to widen
-                // throws.
-                if ( !manip::validUTF08 ( cp ) )
-                {
-                    RUNTIME_ERROR ( "Invalid UTF-8 Sequence!" )
-                }
-                *this << cp;
+                RUNTIME_ERROR ( "Invalid UTF-8 Sequence!" )
             }
+            send ( std::string ( bytes ) );
             return *this;
         }
 
@@ -212,18 +398,9 @@ namespace io::console
         Console &operator<< ( T const &t ) requires (
                 std::is_same_v< T, std::u32string > )
         {
-            std::string translated = u"";
-
-            for ( auto &cp : t )
-            {
-                // no try / catch here since we would just rethrow. No call to
-                // validUTF32 since we need temp and we would just throw a
-                // runtime_error if the sequence weren't valid anyways
-                char *temp = narrow ( cp );
-                translated += temp;
-                // narrow allocates
-                delete [] temp;
-            }
+            // no try / catch here since we would just rethrow.
+            std::string translated =
+                    manip::convert< defines::ChrChar, defines::U32Char > ( t );
             return *this << translated;
         }
 
@@ -0,0 +1,271 @@
+/**
+ * @file input.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of the input reader
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/console/input.h++>
+
+#include <io/console/internal/keydecoder.h++>
+#include <io/console/virtualterminal.h++>
+#include <test/unittester.h++>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+// how long a lone escape waits for the rest of a sequence before it counts
+// as the escape key. Terminals send sequences all at once, so this only has
+// to cover a slow connection.
+constexpr std::chrono::milliseconds escapeWait = 25ms;
+
+struct io::console::Input::impl_s
+{
+    std::shared_ptr< Backend >                   backend;
+    std::mutex                                   mutex;
+    // signals a key, or the terminal going away.
+    std::condition_variable                      arrived;
+    std::deque< Key >                            keys;
+    std::deque< std::promise< CursorPosition > > cursors;
+    KeyHook                                      hook;
+    WakeHook                                     wakeHook;
+    bool                                         closed   = false;
+    std::atomic_bool                             stopping = false;
+    // only the reading thread touches the decoder.
+    internal::KeyDecoder                         decoder;
+    // started last, so that everything it uses is there first.
+    std::thread                                  reader;
+
+    void read ( );
+    void deliver ( std::vector< internal::KeyDecoder::Decoded > & );
+
+    impl_s ( std::shared_ptr< Backend > const &backend ) : backend ( backend )
+    {
+        backend->setRaw ( true );
+        reader = std::thread ( [ this ] ( ) { read ( ); } );
+    }
+
+    ~impl_s ( )
+    {
+        stopping.store ( true );
+        backend->interrupt ( );
+        reader.join ( );
+        backend->setRaw ( false );
+    }
+};
+
+void io::console::Input::impl_s::read ( )
+{
+    std::string                                  bytes;
+    std::vector< internal::KeyDecoder::Decoded > decoded;
+    bool                                         open = true;
+    while ( open && !stopping.load ( ) )
+    {
+        bytes.clear ( );
+        bool const waiting = decoder.waiting ( );
+        open = backend->read ( bytes, waiting ? escapeWait : -1ms );
+        WakeHook woken;
+        {
+            std::scoped_lock< std::mutex > lock ( mutex );
+            woken = wakeHook;
+        }
+        if ( woken )
+        {
+            woken ( );
+        }
+        if ( waiting && bytes.empty ( ) )
+        {
+            decoder.flush ( decoded );
+        } else
+        {
+            decoder.feed ( bytes, decoded );
+        }
+        deliver ( decoded );
+        decoded.clear ( );
+    }
+    decoder.flush ( decoded );
+    deliver ( decoded );
+    std::scoped_lock< std::mutex > lock ( mutex );
+    closed = true;
+    // throws out the promises, which breaks them.
+    cursors.clear ( );
+    arrived.notify_all ( );
+}
+
+void io::console::Input::impl_s::deliver (
+        std::vector< internal::KeyDecoder::Decoded > &decoded )
+{
+    KeyHook hook;
+    {
+        std::scoped_lock< std::mutex > lock ( mutex );
+        hook = this->hook;
+    }
+    for ( auto &[ isCursor, key, cursor ] : decoded )
+    {
+        if ( isCursor )
+        {
+            std::scoped_lock< std::mutex > lock ( mutex );
+            if ( !cursors.empty ( ) )
+            {
+                cursors.front ( ).set_value ( cursor );
+                cursors.pop_front ( );
+                continue;
+            }
+            // xterm sends F3 with modifiers as a report of row one.
+            if ( cursor.row != 1 )
+            {
+                continue;
+            }
+            key.code      = Key::Code::FUNCTION;
+            key.number    = 3;
+            key.modifiers = std::uint8_t ( cursor.col - 1 );
+        }
+        if ( hook && hook ( key ) )
+        {
+            continue;
+        }
+        std::scoped_lock< std::mutex > lock ( mutex );
+        keys.push_back ( key );
+        arrived.notify_all ( );
+    }
+}
+
+io::console::Input::Input ( std::shared_ptr< Backend > const &backend ) :
+        pimpl ( new impl_s ( backend ) )
+{ }
+
+io::console::Input::~Input ( ) = default;
+
+bool io::console::Input::next ( Key                             &key,
+                                std::chrono::milliseconds const &timeout )
+{
+    std::unique_lock< std::mutex > lock ( pimpl->mutex );
+    auto const                     ready = [ & ] ( ) {
+        return !pimpl->keys.empty ( ) || pimpl->closed;
+    };
+    if ( timeout.count ( ) < 0 )
+    {
+        pimpl->arrived.wait ( lock, ready );
+    } else if ( !pimpl->arrived.wait_for ( lock, timeout, ready ) )
+    {
+        return false;
+    }
+    if ( pimpl->keys.empty ( ) )
+    {
+        key      = Key ( );
+        key.code = Key::Code::CLOSED;
+        return true;
+    }
+    key = pimpl->keys.front ( );
+    pimpl->keys.pop_front ( );
+    return true;
+}
+
+std::future< io::console::CursorPosition > io::console::Input::expectCursor ( )
+{
+    std::promise< CursorPosition > promise;
+    auto                           future = promise.get_future ( );
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    if ( !pimpl->closed )
+    {
+        pimpl->cursors.push_back ( std::move ( promise ) );
+    }
+    return future;
+}
+
+void io::console::Input::setHook ( KeyHook const &hook )
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    pimpl->hook = hook;
+}
+
+void io::console::Input::setWakeHook ( WakeHook const &hook )
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    pimpl->wakeHook = hook;
+}
+
+bool testInput ( std::ostream &stream )
+{
+    using namespace io::console;
+    stream << "Beginning input unittest.\n";
+    auto terminal = std::make_shared< VirtualTerminal > ( 5, 20 );
+    {
+        Input input ( terminal );
+        if ( !terminal->raw ( ) )
+        {
+            BASIC_UNIT_FAIL ( stream, "The terminal did not go raw" )
+        }
+
+        stream << "Ensuring that keys arrive in order...\n";
+        terminal->type ( "h\u001b[A" );
+        Key first, second, third;
+        if ( !input.next ( first, 1s ) || !input.next ( second, 1s )
+             || first.text != "h" || second.code != Key::Code::UP
+             || input.next ( third, 10ms ) )
+        {
+            BASIC_UNIT_FAIL ( stream, "The keys came wrongly" )
+        }
+
+        stream << "Ensuring that a lone escape is the escape key...\n";
+        terminal->type ( "\u001b" );
+        if ( !input.next ( first, 1s ) || first.code != Key::Code::ESCAPE )
+        {
+            BASIC_UNIT_FAIL ( stream, "The escape key did not come" )
+        }
+
+        stream << "Ensuring that cursor reports answer futures...\n";
+        auto report = input.expectCursor ( );
+        auto other  = input.expectCursor ( );
+        terminal->write ( "\u001b[3;7H\u001b[6n\u001b[1;2H\u001b[6n" );
+        if ( report.wait_for ( 1s ) != std::future_status::ready
+             || !( report.get ( ) == CursorPosition { 3, 7 } )
+             || !( other.get ( ) == CursorPosition { 1, 2 } ) )
+        {
+            BASIC_UNIT_FAIL ( stream, "The reports went wrongly" )
+        }
+
+        stream << "Ensuring that the hook sees keys first...\n";
+        input.setHook ( [] ( Key const &key ) { return key.text == "x"; } );
+        terminal->type ( "xy" );
+        if ( !input.next ( first, 1s ) || first.text != "y" )
+        {
+            BASIC_UNIT_FAIL ( stream, "The hook did not swallow its key" )
+        }
+
+        stream << "Ensuring that the input closes with the terminal...\n";
+        auto orphan = input.expectCursor ( );
+        terminal->hangUp ( );
+        if ( !input.next ( first, 1s ) || first.code != Key::Code::CLOSED )
+        {
+            BASIC_UNIT_FAIL ( stream, "The input did not close" )
+        }
+        try
+        {
+            orphan.get ( );
+            BASIC_UNIT_FAIL ( stream, "An unanswered report was answered" )
+        } catch ( std::future_error const & )
+        { }
+    }
+    if ( terminal->raw ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "The terminal stayed raw" )
+    }
+    return true;
+}
+
+test::Unittest inputTest { &testInput };
@@ -0,0 +1,124 @@
+/**
+ * @file input.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Keys and cursor reports, read as they come
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <io/console/backend.h++>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+
+namespace io::console
+{
+    struct Key
+    {
+        enum class Code : std::uint8_t
+        {
+            CHARACTER,
+            ENTER,
+            TAB,
+            BACKSPACE,
+            ESCAPE,
+            UP,
+            DOWN,
+            RIGHT,
+            LEFT,
+            HOME,
+            END,
+            INSERT,
+            // not DELETE, which windows.h takes for a macro.
+            DEL,
+            PAGE_UP,
+            PAGE_DOWN,
+            FUNCTION,
+            // a sequence we do not know.
+            UNKNOWN,
+            // the terminal has gone away, so no more keys will come.
+            CLOSED,
+        };
+
+        // the bits xterm gives for the modifiers, one less than its number.
+        static constexpr std::uint8_t SHIFT   = 1;
+        static constexpr std::uint8_t ALT     = 2;
+        static constexpr std::uint8_t CONTROL = 4;
+
+        Code         code      = Code::UNKNOWN;
+        // the character as UTF-8, for CHARACTER. Control and a letter gives
+        // the letter.
+        std::string  text      = "";
+        // which function key, from one, for FUNCTION.
+        std::uint8_t number    = 0;
+        std::uint8_t modifiers = 0;
+
+        bool operator== ( Key const & ) const noexcept = default;
+    };
+
+    /**
+     * @brief Where the cursor is, counting from one as the terminal does.
+     */
+    struct CursorPosition
+    {
+        std::uint32_t row = 1;
+        std::uint32_t col = 1;
+
+        bool operator== ( CursorPosition const & ) const noexcept = default;
+    };
+
+    /**
+     * @brief Reads the terminal on a thread of its own, with the terminal in
+     * raw mode, so that nothing ever blocks on the terminal but whoever wants
+     * a key. Keys wait in a queue, and cursor reports answer whoever expected
+     * them. Only one may read a backend at a time.
+     */
+    class Input
+    {
+        struct impl_s;
+        std::unique_ptr< impl_s > pimpl;
+    public:
+        /**
+         * @brief Sees each key on the reading thread before it is queued, and
+         * swallows it by returning true. It must not block.
+         */
+        using KeyHook  = std::function< bool ( Key const & ) >;
+        /**
+         * @brief Runs on the reading thread each time a read of the backend
+         * returns, whatever woke it, such as the terminal changing size. It
+         * must not block, and must never wait on input.
+         */
+        using WakeHook = std::function< void ( ) >;
+
+        explicit Input ( std::shared_ptr< Backend > const & =
+                                 standardBackend ( ) );
+        virtual ~Input ( );
+
+        /**
+         * @brief Waits up to the timeout, or for as long as it takes if the
+         * timeout is negative, for the next key. Once the terminal has gone
+         * away, the next key is always CLOSED.
+         *
+         * @return false if no key came in time.
+         */
+        bool next ( Key &, std::chrono::milliseconds const &timeout );
+        /**
+         * @brief Expects a cursor report, which the future gets. Ask the
+         * terminal for the report only after expecting it. Reports go to the
+         * futures in the order they were expected, and if the terminal goes
+         * away first, the future throws std::future_error.
+         */
+        std::future< CursorPosition > expectCursor ( );
+        void                          setHook ( KeyHook const & );
+        void                          setWakeHook ( WakeHook const & );
+    };
+} // namespace io::console
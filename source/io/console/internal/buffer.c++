@@ -0,0 +1,850 @@
+/**
+ * @file buffer.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of the screen buffer
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/console/internal/buffer.h++>
+
+#include <defines/constants.h++>
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <io/console/internal/sgr.h++>
+#include <io/console/manip/stringfunctions.h++>
+#include <io/console/manip/tokenizer.h++>
+#include <io/console/virtualterminal.h++>
+#include <io/unicode/character.h++>
+#include <test/unittester.h++>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using io::console::internal::Cell;
+using io::console::internal::Pen;
+
+/**
+ * @brief Appends the number in decimal.
+ */
+void appendNumber ( std::string &out, std::uint32_t const &n )
+{
+    char       digits [ 10 ];
+    auto const end = std::to_chars ( digits, digits + 10, n ).ptr;
+    out.append ( digits, end );
+}
+
+/**
+ * @brief Appends a sequence that takes the number and ends in the final byte,
+ * leaving out a number of one when it may.
+ */
+void appendSequence ( std::string         &out,
+                      std::uint32_t const &n,
+                      char const          &final,
+                      bool const          &omitOne = false )
+{
+    out += "\u001b[";
+    if ( n != 1 || !omitOne )
+    {
+        appendNumber ( out, n );
+    }
+    out += final;
+}
+
+struct io::console::internal::ScreenBuffer::impl_s
+{
+    std::uint32_t     rows;
+    std::uint32_t     cols;
+    // what the screen should look like, and what it looked like last frame.
+    std::vector< Cell > back;
+    std::vector< Cell > front;
+    // the columns of each row drawn over since the last frame, first to last
+    // (exclusive).
+    std::vector< std::pair< std::uint32_t, std::uint32_t > > damage;
+    // whether the front buffer is what the terminal shows.
+    bool                                                     valid = false;
+    // rows that text sent around the buffer wrote over, which the next frame
+    // blanks and draws again.
+    std::vector< bool >                                      lost;
+
+    // where text sent around the buffer left the cursor, and whether the
+    // next character it prints wraps first, as the terminal has them.
+    std::uint32_t    cursorRow   = 0;
+    std::uint32_t    cursorCol   = 0;
+    bool             cursorKnown = false;
+    bool             pending     = false;
+    // where the cursor was saved.
+    std::uint32_t    savedRow    = 0;
+    std::uint32_t    savedCol    = 0;
+    bool             savedKnown  = false;
+    manip::Tokenizer tokenizer;
+
+    Cell &backAt ( std::uint32_t const &row, std::uint32_t const &col )
+    {
+        return back [ std::size_t ( row ) * cols + col ];
+    }
+    Cell &frontAt ( std::uint32_t const &row, std::uint32_t const &col )
+    {
+        return front [ std::size_t ( row ) * cols + col ];
+    }
+
+    void check ( std::uint32_t const &row, std::uint32_t const &col ) const;
+    void touch ( std::uint32_t const &row,
+                 std::uint32_t const &first,
+                 std::uint32_t const &last ) noexcept;
+    void split ( std::uint32_t const &row, std::uint32_t const &col ) noexcept;
+    // forgets the terminal from first to last (exclusive), or all of it.
+    void lose ( std::uint32_t const &first, std::uint32_t const &last );
+    void loseAll ( ) noexcept;
+    void lineFeed ( );
+    void follow ( manip::Token const & );
+    void print ( defines::U32Char const & );
+    void controlSequence ( std::string_view const & );
+    void moveCursor ( std::string         &out,
+                      Pen const           &pen,
+                      bool const          &known,
+                      std::uint32_t const &fromRow,
+                      std::uint32_t const &fromCol,
+                      std::uint32_t const &row,
+                      std::uint32_t const &col );
+
+    impl_s ( std::uint32_t const &rows, std::uint32_t const &cols ) :
+            rows ( rows ), cols ( cols ), back ( std::size_t ( rows ) * cols ),
+            front ( back ), damage ( rows, std::make_pair ( cols, 0 ) ),
+            lost ( rows, false )
+    { }
+};
+
+void io::console::internal::ScreenBuffer::impl_s::check (
+        std::uint32_t const &row,
+        std::uint32_t const &col ) const
+{
+    if ( row >= rows || col >= cols )
+    {
+        RUNTIME_ERROR ( "Cell ( " << row << ", " << col
+                                  << " ) is off the screen!" )
+    }
+}
+
+void io::console::internal::ScreenBuffer::impl_s::touch (
+        std::uint32_t const &row,
+        std::uint32_t const &first,
+        std::uint32_t const &last ) noexcept
+{
+    damage [ row ].first  = std::min ( damage [ row ].first, first );
+    damage [ row ].second = std::max ( damage [ row ].second, last );
+}
+
+void io::console::internal::ScreenBuffer::impl_s::split (
+        std::uint32_t const &row,
+        std::uint32_t const &col ) noexcept
+{
+    Cell const &here = backAt ( row, col );
+    // blank the other half of a wide character sitting on the column.
+    std::uint32_t other = cols;
+    if ( here.width == 0 && col > 0 )
+    {
+        other = col - 1;
+    } else if ( here.width == 2 && col + 1 < cols )
+    {
+        other = col + 1;
+    }
+    if ( other != cols )
+    {
+        backAt ( row, other ).codePoint = U' ';
+        backAt ( row, other ).width     = 1;
+        touch ( row, other, other + 1 );
+    }
+}
+
+void io::console::internal::ScreenBuffer::impl_s::moveCursor (
+        std::string         &out,
+        Pen const           &pen,
+        bool const          &known,
+        std::uint32_t const &fromRow,
+        std::uint32_t const &fromCol,
+        std::uint32_t const &row,
+        std::uint32_t const &col )
+{
+    if ( known && row == fromRow && col == fromCol )
+    {
+        return;
+    }
+    std::string best = "\u001b[";
+    if ( row )
+    {
+        appendNumber ( best, row + 1 );
+    }
+    if ( col )
+    {
+        best += ';';
+        appendNumber ( best, col + 1 );
+    }
+    best += 'H';
+    if ( !known )
+    {
+        out += best;
+        return;
+    }
+    auto consider = [ & ] ( std::string const &candidate ) {
+        if ( candidate.size ( ) < best.size ( ) )
+        {
+            best = candidate;
+        }
+    };
+
+    std::string vertical;
+    if ( row != fromRow )
+    {
+        appendSequence ( vertical, row + 1, 'd' );
+        std::string steps;
+        if ( row > fromRow )
+        {
+            appendSequence ( steps, row - fromRow, 'B', true );
+        } else
+        {
+            appendSequence ( steps, fromRow - row, 'A', true );
+        }
+        if ( steps.size ( ) < vertical.size ( ) )
+        {
+            vertical = steps;
+        }
+    }
+    std::string horizontal;
+    if ( col != fromCol )
+    {
+        appendSequence ( horizontal, col + 1, 'G' );
+        std::string steps;
+        if ( col > fromCol )
+        {
+            appendSequence ( steps, col - fromCol, 'C', true );
+        } else
+        {
+            appendSequence ( steps, fromCol - col, 'D', true );
+        }
+        if ( steps.size ( ) < horizontal.size ( ) )
+        {
+            horizontal = steps;
+        }
+        if ( !col )
+        {
+            horizontal.assign ( 1, '\r' );
+        }
+    }
+    consider ( vertical.append ( horizontal ) );
+    // going to the start of a lower row
+    if ( !col && row > fromRow )
+    {
+        consider ( std::string ( 1, '\r' ).append ( row - fromRow, '\n' ) );
+    }
+    // going forwards over cells the terminal already shows with the pen, by
+    // writing them again.
+    if ( row == fromRow && col > fromCol && frontAt ( row, fromCol ).width )
+    {
+        std::string again;
+        for ( std::uint32_t at = fromCol; at < col; at++ )
+        {
+            Cell const &cell = frontAt ( row, at );
+            if ( !( cell.pen == pen ) )
+            {
+                again.clear ( );
+                break;
+            }
+            if ( cell.width )
+            {
+                defines::ChrChar bytes [ 4 ];
+                again.append ( bytes,
+                               manip::encode ( cell.codePoint, bytes ) );
+            }
+        }
+        if ( !again.empty ( ) )
+        {
+            consider ( again );
+        }
+    }
+    out += best;
+}
+
+void io::console::internal::ScreenBuffer::impl_s::lose (
+        std::uint32_t const &first,
+        std::uint32_t const &last )
+{
+    std::fill ( lost.begin ( ) + first, lost.begin ( ) + last, true );
+}
+
+void io::console::internal::ScreenBuffer::impl_s::loseAll ( ) noexcept
+{
+    valid       = false;
+    cursorKnown = false;
+    pending     = false;
+}
+
+void io::console::internal::ScreenBuffer::impl_s::lineFeed ( )
+{
+    if ( cursorRow + 1 < rows )
+    {
+        cursorRow++;
+        return;
+    }
+    // the terminal scrolls up a line, and so does what it shows.
+    std::move ( front.begin ( ) + cols, front.end ( ), front.begin ( ) );
+    std::move ( lost.begin ( ) + 1, lost.end ( ), lost.begin ( ) );
+    std::fill ( front.end ( ) - cols, front.end ( ), Cell ( ) );
+    lost.back ( ) = true;
+    for ( std::uint32_t row = 0; row < rows; row++ )
+    {
+        touch ( row, 0, cols );
+    }
+}
+
+void io::console::internal::ScreenBuffer::impl_s::follow (
+        manip::Token const &token )
+{
+    switch ( token.type )
+    {
+        case manip::TokenType::TEXT:
+            for ( auto const &codePoint : manip::CodePoints ( token.bytes ) )
+            {
+                print ( codePoint.value );
+            }
+            break;
+        case manip::TokenType::CONTROL:
+            if ( token.bytes [ 0 ] == '\a' )
+            {
+                break;
+            }
+            pending = false;
+            switch ( token.bytes [ 0 ] )
+            {
+                case '\b': cursorCol = cursorCol ? cursorCol - 1 : 0; break;
+                case '\t':
+                    cursorCol =
+                            std::min ( cols - 1, ( cursorCol / 8 + 1 ) * 8 );
+                    break;
+                case '\n':
+                case '\v':
+                case '\f':
+                    // whether it scrolls depends on the row it is on.
+                    if ( !cursorKnown )
+                    {
+                        loseAll ( );
+                    } else
+                    {
+                        lineFeed ( );
+                    }
+                    break;
+                case '\r': cursorCol = 0; break;
+                default: break;
+            }
+            break;
+        case manip::TokenType::ESCAPE:
+            if ( token.bytes == "\u001b7" )
+            {
+                savedRow   = cursorRow;
+                savedCol   = cursorCol;
+                savedKnown = cursorKnown;
+            } else if ( token.bytes == "\u001b8" )
+            {
+                pending     = false;
+                cursorRow   = savedRow;
+                cursorCol   = savedCol;
+                cursorKnown = savedKnown;
+            } else
+            {
+                loseAll ( );
+            }
+            break;
+        case manip::TokenType::CSI: controlSequence ( token.bytes ); break;
+        // strings meant for the terminal itself change nothing on screen.
+        default: break;
+    }
+}
+
+void io::console::internal::ScreenBuffer::impl_s::print (
+        defines::U32Char const &codePoint )
+{
+    auto const &properties =
+            unicode::characterProperties ( ).lookup ( codePoint );
+    if ( properties.control )
+    {
+        return;
+    }
+    if ( !cursorKnown )
+    {
+        loseAll ( );
+        return;
+    }
+    std::uint32_t const width = std::min ( 1u + properties.columns, cols );
+    // a character that does not fit goes on the next line.
+    if ( pending || cursorCol + width > cols )
+    {
+        pending   = false;
+        cursorCol = 0;
+        lineFeed ( );
+    }
+    lost [ cursorRow ] = true;
+    cursorCol += width;
+    if ( cursorCol == cols )
+    {
+        cursorCol = cols - 1;
+        pending   = true;
+    }
+}
+
+void io::console::internal::ScreenBuffer::impl_s::controlSequence (
+        std::string_view const &bytes )
+{
+    std::string_view const parameters = bytes.substr ( 2, bytes.size ( ) - 3 );
+    char const             final      = bytes.back ( );
+    // attributes and private modes, such as hiding the cursor, change
+    // nothing on screen, and reports come back without moving anything.
+    if ( final == 'm' || final == 'n'
+         || ( !parameters.empty ( )
+              && std::string_view ( "<=>?" ).find ( parameters [ 0 ] )
+                         != std::string_view::npos ) )
+    {
+        return;
+    }
+    std::uint32_t numbers [ 2 ] = { 0, 0 };
+    std::size_t   count         = 0;
+    for ( char const &c : parameters )
+    {
+        if ( c == ';' && count == 0 )
+        {
+            count++;
+        } else if ( c >= '0' && c <= '9' )
+        {
+            // anything past the screen is as good as the edge of it.
+            numbers [ count ] = std::min ( numbers [ count ] * 10 + ( c - '0' ),
+                                           std::uint32_t ( 0x10000 ) );
+        } else
+        {
+            loseAll ( );
+            return;
+        }
+    }
+    // how far to move, where zero means one, and where to, counting from one.
+    std::uint32_t const n  = std::max ( numbers [ 0 ], 1u );
+    auto const          to = [] ( std::uint32_t const &place,
+                                  std::uint32_t const &limit ) {
+        return std::min ( std::max ( place, 1u ), limit ) - 1;
+    };
+    pending = false;
+    switch ( final )
+    {
+        case 'H':
+        case 'f':
+            cursorRow   = to ( numbers [ 0 ], rows );
+            cursorCol   = to ( numbers [ 1 ], cols );
+            cursorKnown = true;
+            return;
+        case 's':
+            savedRow   = cursorRow;
+            savedCol   = cursorCol;
+            savedKnown = cursorKnown;
+            return;
+        case 'u':
+            cursorRow   = savedRow;
+            cursorCol   = savedCol;
+            cursorKnown = savedKnown;
+            return;
+        default: break;
+    }
+    if ( !cursorKnown )
+    {
+        // moving from nowhere in particular leaves the cursor there, but
+        // erasing around it loses what is on screen.
+        if ( final == 'J' || final == 'K' )
+        {
+            loseAll ( );
+        }
+        return;
+    }
+    switch ( final )
+    {
+        case 'A': cursorRow -= std::min ( n, cursorRow ); break;
+        case 'B': cursorRow = std::min ( cursorRow + n, rows - 1 ); break;
+        case 'C': cursorCol = std::min ( cursorCol + n, cols - 1 ); break;
+        case 'D': cursorCol -= std::min ( n, cursorCol ); break;
+        case 'E':
+            cursorRow = std::min ( cursorRow + n, rows - 1 );
+            cursorCol = 0;
+            break;
+        case 'F':
+            cursorRow -= std::min ( n, cursorRow );
+            cursorCol = 0;
+            break;
+        case 'G': cursorCol = to ( n, cols ); break;
+        case 'd': cursorRow = to ( n, rows ); break;
+        case 'J':
+            switch ( numbers [ 0 ] )
+            {
+                case 0: lose ( cursorRow, rows ); break;
+                case 1: lose ( 0, cursorRow + 1 ); break;
+                default: lose ( 0, rows ); break;
+            }
+            break;
+        case 'K': lose ( cursorRow, cursorRow + 1 ); break;
+        // anything else, such as scrolling or inserting lines, is more than
+        // is worth following.
+        default: loseAll ( ); break;
+    }
+}
+
+io::console::internal::ScreenBuffer::ScreenBuffer (
+        std::uint32_t const &rows,
+        std::uint32_t const &cols ) :
+        pimpl ( new impl_s ( rows, cols ) )
+{ }
+
+io::console::internal::ScreenBuffer::~ScreenBuffer ( ) = default;
+
+std::uint32_t io::console::internal::ScreenBuffer::rows ( ) const noexcept
+{
+    return pimpl->rows;
+}
+
+std::uint32_t io::console::internal::ScreenBuffer::cols ( ) const noexcept
+{
+    return pimpl->cols;
+}
+
+void io::console::internal::ScreenBuffer::resize ( std::uint32_t const &rows,
+                                                   std::uint32_t const &cols )
+{
+    pimpl.reset ( new impl_s ( rows, cols ) );
+}
+
+Cell const &io::console::internal::ScreenBuffer::at (
+        std::uint32_t const &row,
+        std::uint32_t const &col ) const
+{
+    pimpl->check ( row, col );
+    return pimpl->backAt ( row, col );
+}
+
+void io::console::internal::ScreenBuffer::set ( std::uint32_t const &row,
+                                                std::uint32_t const &col,
+                                                Cell const          &cell )
+{
+    pimpl->check ( row, col );
+    Cell placed           = cell;
+    placed.pen.foreground = canonicalColor ( cell.pen.foreground );
+    placed.pen.background = canonicalColor ( cell.pen.background );
+    placed.width          = cell.width > 1 ? 2 : 1;
+    // a wide character that does not fit is a blank instead.
+    if ( placed.width == 2 && col + 1 == pimpl->cols )
+    {
+        placed.codePoint = U' ';
+        placed.width     = 1;
+    }
+    pimpl->split ( row, col );
+    if ( placed.width == 2 )
+    {
+        pimpl->split ( row, col + 1 );
+        Cell covered                  = placed;
+        covered.codePoint             = 0;
+        covered.width                 = 0;
+        pimpl->backAt ( row, col + 1 ) = covered;
+    }
+    pimpl->backAt ( row, col ) = placed;
+    pimpl->touch ( row, col, col + placed.width );
+}
+
+std::uint32_t io::console::internal::ScreenBuffer::draw (
+        std::uint32_t const    &row,
+        std::uint32_t const    &col,
+        std::string_view const &text,
+        Cell const             &style )
+{
+    pimpl->check ( row, 0 );
+    std::uint32_t at   = col;
+    Cell          cell = style;
+    for ( auto const &codePoint : manip::CodePoints ( text ) )
+    {
+        if ( at >= pimpl->cols )
+        {
+            break;
+        }
+        if ( codePoint.type == manip::CodePointType::TERMINAL
+             || codePoint.type == manip::CodePointType::INVALID_ )
+        {
+            continue;
+        }
+        auto const &properties =
+                unicode::characterProperties ( ).lookup ( codePoint.value );
+        if ( properties.control )
+        {
+            continue;
+        }
+        cell.codePoint = codePoint.value;
+        cell.width     = 1 + properties.columns;
+        set ( row, at, cell );
+        at += cell.width;
+    }
+    return std::min ( at, pimpl->cols );
+}
+
+void io::console::internal::ScreenBuffer::clear ( Cell const &blank )
+{
+    Cell placed           = blank;
+    placed.width          = 1;
+    placed.pen.foreground = canonicalColor ( blank.pen.foreground );
+    placed.pen.background = canonicalColor ( blank.pen.background );
+    std::fill ( pimpl->back.begin ( ), pimpl->back.end ( ), placed );
+    for ( std::uint32_t row = 0; row < pimpl->rows; row++ )
+    {
+        pimpl->touch ( row, 0, pimpl->cols );
+    }
+}
+
+void io::console::internal::ScreenBuffer::invalidate ( ) noexcept
+{
+    pimpl->valid = false;
+}
+
+void io::console::internal::ScreenBuffer::follow (
+        std::string_view const &text )
+{
+    pimpl->tokenizer.feed ( text, [ & ] ( manip::Token const &token ) {
+        pimpl->follow ( token );
+    } );
+}
+
+std::string io::console::internal::ScreenBuffer::present (
+        ColorDepth const &depth )
+{
+    std::string   out;
+    Pen           pen;
+    bool          penKnown    = false;
+    std::uint32_t row         = 0;
+    std::uint32_t col         = 0;
+    bool          cursorKnown = false;
+    if ( !pimpl->valid )
+    {
+        // start from a blank screen, where only cells that are not blank need
+        // drawing.
+        out += "\u001b[m\u001b[2J";
+        penKnown = true;
+        std::fill ( pimpl->front.begin ( ), pimpl->front.end ( ), Cell ( ) );
+        std::fill ( pimpl->lost.begin ( ), pimpl->lost.end ( ), false );
+        for ( std::uint32_t at = 0; at < pimpl->rows; at++ )
+        {
+            pimpl->touch ( at, 0, pimpl->cols );
+        }
+        pimpl->valid = true;
+    }
+    for ( std::uint32_t at = 0; at < pimpl->rows; at++ )
+    {
+        if ( pimpl->lost [ at ] )
+        {
+            // blank the row as clearing the screen would, so only cells that
+            // are not blank need drawing.
+            pimpl->lost [ at ] = false;
+            pimpl->moveCursor ( out, pen, cursorKnown, row, col, at, 0 );
+            if ( !penKnown )
+            {
+                appendPen ( out, Pen ( ), depth );
+            } else
+            {
+                appendTransition ( out, pen, Pen ( ), depth );
+            }
+            out += "\u001b[2K";
+            std::fill ( &pimpl->frontAt ( at, 0 ),
+                        &pimpl->frontAt ( at, 0 ) + pimpl->cols,
+                        Cell ( ) );
+            pimpl->touch ( at, 0, pimpl->cols );
+            pen         = Pen ( );
+            penKnown    = true;
+            row         = at;
+            col         = 0;
+            cursorKnown = true;
+        }
+        auto [ first, last ] = pimpl->damage [ at ];
+        pimpl->damage [ at ] = std::make_pair ( pimpl->cols, 0 );
+        // start at the left half of a wide character cut off by the damage.
+        if ( first < last && first && !pimpl->backAt ( at, first ).width )
+        {
+            first--;
+        }
+        for ( std::uint32_t here = first; here < last; here++ )
+        {
+            Cell const &cell = pimpl->backAt ( at, here );
+            if ( !cell.width )
+            {
+                continue;
+            }
+            std::uint32_t const next = here + cell.width;
+            if ( std::equal ( &cell,
+                              &cell + cell.width,
+                              &pimpl->frontAt ( at, here ) ) )
+            {
+                continue;
+            }
+            pimpl->moveCursor ( out, pen, cursorKnown, row, col, at, here );
+            if ( !penKnown )
+            {
+                appendPen ( out, cell.pen, depth );
+            } else
+            {
+                appendTransition ( out, pen, cell.pen, depth );
+            }
+            defines::ChrChar bytes [ 4 ];
+            out.append ( bytes, manip::encode ( cell.codePoint, bytes ) );
+            std::copy ( &cell,
+                        &cell + cell.width,
+                        &pimpl->frontAt ( at, here ) );
+            pen            = cell.pen;
+            penKnown       = true;
+            row            = at;
+            col            = next;
+            // writing the last column leaves the cursor waiting to wrap, which
+            // terminals do not agree on how to move out of.
+            cursorKnown    = next < pimpl->cols;
+        }
+    }
+    if ( out.empty ( ) )
+    {
+        return out;
+    }
+    // save and restore the cursor, which takes the attributes with it.
+    return "\u001b7" + out + "\u001b8";
+}
+
+bool testScreenBuffer ( std::ostream &stream )
+{
+    using io::console::internal::ScreenBuffer;
+    using io::console::internal::sgrAttributes;
+    stream << "Beginning screen buffer unittest.\n";
+    ScreenBuffer                 buffer ( 6, 16 );
+    io::console::VirtualTerminal terminal ( 6, 16 );
+    // fill the terminal so that the first frame has to clear it.
+    for ( std::uint32_t row = 0; row < 6; row++ )
+    {
+        terminal.write ( std::string ( 16, 'X' ) + ( row < 5 ? "\r\n" : "" ) );
+    }
+    terminal.write ( "\u001b[H" );
+    // the terminal only wraps or meets something it does not expect if the
+    // buffer asked for more than it should.
+    auto strict = [ & ] ( ) {
+        return !terminal.wraps ( ) && !terminal.surprises ( );
+    };
+    auto matches = [ & ] ( ) {
+        for ( std::uint32_t row = 0; row < 6; row++ )
+        {
+            for ( std::uint32_t col = 0; col < 16; col++ )
+            {
+                if ( !( buffer.at ( row, col ) == terminal.cell ( row, col ) ) )
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    stream << "Ensuring that frames keep the terminal in step...\n";
+    std::mt19937             random ( 14 );
+    std::vector< std::string > const pieces = {
+            "a", "b", " ", "é", "中", "\u001b[1m", "\t" };
+    std::uint32_t const colors [] = { 0, 3, 7, 8, 0x2a09, 0x10203040 };
+    for ( std::size_t round = 0; round < 0x400; round++ )
+    {
+        auto const operations = random ( ) % 8;
+        for ( std::size_t i = 0; i < operations; i++ )
+        {
+            Cell style;
+            for ( std::size_t set = random ( ) % 6; set; set-- )
+            {
+                style.pen.set ( sgrAttributes [ random ( )
+                                                % std::size ( sgrAttributes ) ],
+                                true );
+            }
+            style.pen.foreground = colors [ random ( ) % 6 ];
+            style.pen.background = colors [ random ( ) % 6 ];
+            std::string text;
+            for ( std::size_t length = random ( ) % 12; length; length-- )
+            {
+                text += pieces [ random ( ) % pieces.size ( ) ];
+            }
+            auto const choice = random ( ) % 32;
+            if ( choice == 0 )
+            {
+                buffer.clear ( style );
+            } else if ( choice == 1 )
+            {
+                buffer.invalidate ( );
+            } else
+            {
+                buffer.draw ( random ( ) % 6, random ( ) % 16, text, style );
+            }
+        }
+        std::uint32_t const row   = terminal.cursorRow ( );
+        std::uint32_t const col   = terminal.cursorCol ( );
+        std::string const   frame = buffer.present ( );
+        terminal.write ( frame );
+        if ( !strict ( ) )
+        {
+            BASIC_UNIT_FAIL ( stream, "A frame sent something unexpected" )
+        }
+        if ( !matches ( ) )
+        {
+            BASIC_UNIT_FAIL ( stream, "The terminal does not match the buffer" )
+        }
+        if ( terminal.cursorRow ( ) != row || terminal.cursorCol ( ) != col )
+        {
+            BASIC_UNIT_FAIL ( stream, "A frame did not put the cursor back" )
+        }
+    }
+
+    stream << "Ensuring that frames only send what changed...\n";
+    buffer.clear ( );
+    for ( std::uint32_t row = 0; row < 6; row++ )
+    {
+        buffer.draw ( row, 0, "0123456789abcdef" );
+    }
+    terminal.write ( buffer.present ( ) );
+    if ( !buffer.present ( ).empty ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "An unchanged frame was not empty" )
+    }
+    buffer.draw ( 3, 7, "7" );
+    if ( !buffer.present ( ).empty ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Drawing what was there changed the frame" )
+    }
+    buffer.draw ( 3, 7, "x" );
+    std::string const frame = buffer.present ( );
+    terminal.write ( frame );
+    // save, move, reset the attributes, the character, and restore.
+    if ( frame.size ( ) > 2 + 6 + 3 + 1 + 2 || !matches ( ) || !strict ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Changing one cell sent "
+                                          << frame.size ( ) << " bytes" )
+    }
+
+    stream << "Ensuring that text sent around the buffer costs its row...\n";
+    std::string const around = "\u001b[5;3Hqq";
+    terminal.write ( around );
+    buffer.follow ( around );
+    std::string const repair = buffer.present ( );
+    terminal.write ( repair );
+    // save, move, reset the attributes, blank the row, the row, and restore.
+    if ( repair.size ( ) > 2 + 4 + 3 + 4 + 16 + 2 || !matches ( )
+         || !strict ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Repairing one row sent "
+                                          << repair.size ( ) << " bytes" )
+    }
+    return true;
+}
+
+test::Unittest screenBufferTest { &testScreenBuffer };
@@ -0,0 +1,115 @@
+/**
+ * @file buffer.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief A grid of cells standing in for the screen
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <io/console/internal/sgr.h++>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace io::console::internal
+{
+    /**
+     * @brief One column on the screen and how it looks.
+     *
+     */
+    struct Cell
+    {
+        defines::U32Char codePoint = U' ';
+        // 1 for a narrow character, 2 for a wide one, and 0 for the column to
+        // the right of a wide character, which that character covers.
+        std::uint8_t     width     = 1;
+        Pen              pen;
+
+        bool operator== ( Cell const & ) const noexcept = default;
+    };
+
+    /**
+     * @brief The screen as it should look (the back buffer) and as it last
+     * went out (the front buffer). Drawing only changes the back buffer and
+     * marks the columns it touched. Presenting compares what was marked and
+     * returns the bytes that bring the terminal up to date, moving the cursor
+     * and changing attributes as cheaply as it can.
+     *
+     * Rows and columns count from zero.
+     */
+    class ScreenBuffer
+    {
+        struct impl_s;
+        std::unique_ptr< impl_s > pimpl;
+    public:
+        ScreenBuffer ( std::uint32_t const &rows, std::uint32_t const &cols );
+        virtual ~ScreenBuffer ( );
+
+        std::uint32_t rows ( ) const noexcept;
+        std::uint32_t cols ( ) const noexcept;
+        /**
+         * @brief Changes the size, blanking the back buffer and forgetting
+         * what the terminal shows.
+         */
+        void          resize ( std::uint32_t const &rows,
+                               std::uint32_t const &cols );
+
+        /**
+         * @throw std::runtime_error if the cell is off the screen.
+         */
+        Cell const   &at ( std::uint32_t const &row,
+                           std::uint32_t const &col ) const;
+        /**
+         * @brief Sets one cell. A wide character that the cell cuts in half
+         * becomes a blank.
+         * @throw std::runtime_error if the cell is off the screen.
+         */
+        void          set ( std::uint32_t const &row,
+                            std::uint32_t const &col,
+                            Cell const          &cell );
+        /**
+         * @brief Draws UTF-8 text from the position in the style of the cell,
+         * stopping at the end of the row. Control characters and terminal
+         * sequences take no room and are dropped.
+         *
+         * @return the column after the last one drawn.
+         */
+        std::uint32_t draw ( std::uint32_t const    &row,
+                             std::uint32_t const    &col,
+                             std::string_view const &text,
+                             Cell const             &style = Cell ( ) );
+        /**
+         * @brief Fills the back buffer with the cell.
+         */
+        void          clear ( Cell const &blank = Cell ( ) );
+        /**
+         * @brief Forgets what the terminal shows, so the next frame clears the
+         * screen and draws every cell that is not blank.
+         */
+        void          invalidate ( ) noexcept;
+        /**
+         * @brief Follows text that went to the terminal around the buffer, so
+         * that the next frame blanks and draws again only the rows it wrote
+         * on, and keeps up with it scrolling the screen. Text that it cannot
+         * follow, such as text written before the cursor was put anywhere in
+         * particular, forgets the whole screen as invalidate does.
+         */
+        void          follow ( std::string_view const & );
+        /**
+         * @brief The bytes that take the terminal from the last frame to this
+         * one, which then becomes the last frame. They put the cursor and the
+         * attributes back the way they found them, and are empty if nothing
+         * changed. Colors go out brought down to the depth.
+         */
+        std::string   present ( ColorDepth const & = ColorDepth::TRUECOLOR );
+    };
+} // namespace io::console::internal
@@ -14,137 +14,526 @@
 #include <defines/constants.h++>
 #include <defines/macros.h++>
 #include <defines/types.h++>
-#include <io/base/syncstream.h++>
+#include <io/base/scheduler.h++>
+#include <test/unittester.h++>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <memory>
-#include <queue>
+#include <span>
 #include <string>
 #include <thread>
+#include <vector>
 
 using namespace std::chrono_literals;
 
-struct Job
+using Sequence = io::console::internal::TextChannel::Sequence;
+using Delay    = io::console::internal::TextChannel::Delay;
+
+// a channel that falls further behind than this, say because another task
+// held up the scheduler, gives up the time it lost instead of sending it all
+// at once.
+constexpr io::console::internal::TextChannel::Delay maxLag = 50ms;
+
+using TimePoint = io::base::Scheduler::TimePoint;
+
+// how many of the waiting units go out on a tick at now, the first of them
+// due at due and the first rushed of them hurried, and moves due on to when
+// the next unit will be. A channel that fell more than maxLag behind gives up
+// the rest of the time it lost. At least one unit goes out, and with no wait
+// at all, all of them do.
+Sequence paceUnits ( TimePoint       &due,
+                     TimePoint const &now,
+                     Delay const     &wait,
+                     Sequence const  &waiting,
+                     Sequence const  &rushed ) noexcept
 {
-    std::string             text;
-    std::shared_ptr< bool > token =
-            std::make_shared< bool > ( new bool ( false ) );
-};
+    if ( now - due > maxLag )
+    {
+        due = now - maxLag;
+    }
+    Sequence count = waiting;
+    if ( wait > Delay::zero ( ) )
+    {
+        Sequence const owed = now < due ? 1 : ( now - due ) / wait + 1;
+        count               = std::min ( count, std::max ( owed, rushed ) );
+    }
+    // the units after a hurried one are paced from when it went out.
+    if ( rushed )
+    {
+        due = now + wait;
+    } else
+    {
+        due += wait * std::int64_t ( count );
+    }
+    return count;
+}
+
+// both rings hold a power of two so that positions wrap with a mask.
+constexpr std::size_t byteCapacity = std::size_t ( 1 ) << 16;
+constexpr std::size_t unitCapacity = std::size_t ( 1 ) << 12;
 
 struct io::console::internal::TextChannel::impl_s
 {
-    io::base::osyncstream                    stream { std::cout.rdbuf ( ) };
-    std::queue< Job >                        queue { };
+    std::shared_ptr< Backend >               backend;
+    // the bytes waiting to be sent, and how many of them make up each unit.
+    std::unique_ptr< char[] >          bytes { new char [ byteCapacity ] };
+    std::unique_ptr< std::uint32_t[] > lengths {
+            new std::uint32_t [ unitCapacity ] };
+    // how many bytes have been pushed, which only the pushing thread touches.
+    std::size_t                        written = 0;
+    // how many bytes have been sent, which only the channel's task changes.
+    std::atomic_size_t                 read    = 0;
+    // how many units have been pushed and sent.
+    std::atomic< Sequence >            pushed  = 0;
+    std::atomic< Sequence >            sent    = 0;
+    // the last unit that should go out without waiting its turn.
+    std::atomic< Sequence >            hurried = 0;
+    // counts units going out and the channel stopping, which is what pushes
+    // and waits sleep on.
+    std::atomic< std::uint32_t >       events  = 0;
+    std::atomic_bool                   closed  = false;
     // default to a bit less than 60 characters per second.
-    std::atomic< std::chrono::milliseconds > delay = 17ms;
-    std::jthread                             thread;
-    std::atomic_bool                         stop;
+    std::atomic< Delay >                     delay { Delay ( 17ms ) };
     SharedFlag                               ready;
+    // when the next unit is due, or never when the channel has run dry, which
+    // only the channel's task touches.
+    io::base::Scheduler::TimePoint           due   = io::base::Scheduler::never;
+    // when the first and latest units since the channel ran dry went out, and
+    // how many units that was.
+    std::atomic< io::base::Scheduler::TimePoint > started;
+    std::atomic< io::base::Scheduler::TimePoint > latest;
+    std::atomic< Sequence >                       burst = 0;
+    // sends the units, sleeping whenever there is nothing to send. Added
+    // last, so that everything it uses is there before it first runs.
+    io::base::Scheduler::TaskID              task;
 
-    // internal functions
-    void spin ( SharedFlag const &watch, bool const &checkStop = true );
-    void wait ( bool const &checkStop = true );
+    Sequence push ( std::string_view const                 &string,
+                    std::span< std::uint32_t const > const &lengths ) noexcept;
+    io::base::Scheduler::TimePoint send ( );
+    // wakes whoever sleeps on the events.
+    void                           notify ( ) noexcept;
 
-    void send ( );
-    void loop ( );
-
-    impl_s ( SharedFlag const & );
+    impl_s ( SharedFlag const &, std::shared_ptr< Backend > const & );
     virtual ~impl_s ( );
 };
 
 io::console::internal::TextChannel::TextChannel ( ) noexcept :
-        TextChannel ( SharedFlag ( &defaultReady ) )
+        TextChannel ( SharedFlag ( &defaultReady, [] ( auto ) { } ) )
 { }
 io::console::internal::TextChannel::TextChannel (
-        SharedFlag const &ready ) noexcept :
-        pimpl ( new impl_s ( ready ) )
+        SharedFlag const                 &ready,
+        std::shared_ptr< Backend > const &backend ) noexcept :
+        pimpl ( new impl_s ( ready, backend ) )
 { }
 
-io::console::internal::TextChannel::~TextChannel ( ) { pimpl.release ( ); }
+io::console::internal::TextChannel::~TextChannel ( ) = default;
 
 void io::console::internal::TextChannel::setDelay (
-        std::uint64_t const &delay ) noexcept
+        Delay const &delay ) noexcept
 {
-    this->pimpl->delay.store ( std::chrono::milliseconds ( delay ) );
+    this->pimpl->delay.store ( delay );
 }
 
-std::uint64_t const
-        io::console::internal::TextChannel::getDelay ( ) const noexcept
+Delay io::console::internal::TextChannel::getDelay ( ) const noexcept
 {
-    return this->pimpl->delay.load ( ).count ( );
+    return this->pimpl->delay.load ( );
 }
 
-std::shared_ptr< bool > io::console::internal::TextChannel::pushString (
-        std::string const &string ) noexcept
+double io::console::internal::TextChannel::targetRate ( ) const noexcept
 {
-    Job job { string };
-    pimpl->queue.push ( job );
-    return job.token;
+    Delay const delay = pimpl->delay.load ( );
+    if ( delay <= Delay::zero ( ) )
+    {
+        return std::numeric_limits< double >::infinity ( );
+    }
+    return std::chrono::duration< double > ( 1s ) / delay;
 }
 
-void io::console::internal::TextChannel::setReady (
-        SharedFlag const &ready ) noexcept
+double io::console::internal::TextChannel::achievedRate ( ) const noexcept
+{
+    Sequence const units = pimpl->burst.load ( );
+    if ( units < 2 )
+    {
+        return 0;
+    }
+    std::chrono::duration< double > const elapsed =
+            pimpl->latest.load ( ) - pimpl->started.load ( );
+    if ( elapsed <= elapsed.zero ( ) )
+    {
+        return std::numeric_limits< double >::infinity ( );
+    }
+    // the first unit starts the clock, so it does not count.
+    return double ( units - 1 ) / elapsed.count ( );
+}
+
+Sequence io::console::internal::TextChannel::pushString (
+        std::string_view const &string ) noexcept
+{
+    std::uint32_t const length = std::uint32_t ( string.size ( ) );
+    return pimpl->push ( string, std::span ( &length, 1 ) );
+}
+
+Sequence io::console::internal::TextChannel::pushUnits (
+        std::string_view const                 &string,
+        std::span< std::uint32_t const > const &lengths ) noexcept
 {
-    this->pimpl->ready = std::shared_ptr< std::atomic_bool > ( ready.get ( ) );
+    return pimpl->push ( string, lengths );
 }
 
-void io::console::internal::TextChannel::impl_s::spin ( SharedFlag const &watch,
-                                                        bool const &checkStop )
+bool io::console::internal::TextChannel::serviced (
+        Sequence const &sequence ) const noexcept
 {
-    while ( !watch->load ( ) ) { wait ( checkStop ); }
+    return pimpl->sent.load ( std::memory_order_acquire ) >= sequence;
 }
 
-void io::console::internal::TextChannel::impl_s::wait ( bool const &checkStop )
+void io::console::internal::TextChannel::waitFor (
+        Sequence const &sequence ) const noexcept
 {
-    auto now   = [ & ] ( ) { return std::chrono::steady_clock::now ( ); };
-    auto start = now ( );
-    while ( now ( ) - start < delay.load ( ) )
+    while ( true )
     {
-        if ( checkStop && stop.load ( ) )
+        std::uint32_t const heard =
+                pimpl->events.load ( std::memory_order_acquire );
+        if ( pimpl->sent.load ( std::memory_order_acquire ) >= sequence
+             || pimpl->closed.load ( ) )
         {
             return;
-        } else
-        {
-            std::this_thread::sleep_for ( 1ms );
         }
+        pimpl->events.wait ( heard, std::memory_order_acquire );
     }
 }
 
-void io::console::internal::TextChannel::impl_s::send ( )
+void io::console::internal::TextChannel::hurry (
+        Sequence const &sequence ) noexcept
+{
+    Sequence seen = pimpl->hurried.load ( );
+    while ( seen < sequence
+            && !pimpl->hurried.compare_exchange_weak ( seen, sequence ) )
+    { }
+    // the task may be waiting out the delay for the next unit.
+    io::base::Scheduler::shared ( ).rush ( pimpl->task );
+}
+
+void io::console::internal::TextChannel::wake ( ) noexcept
+{
+    if ( pimpl->ready->load ( ) )
+    {
+        io::base::Scheduler::shared ( ).wake ( pimpl->task );
+    } else
+    {
+        // a push waiting for room should hear now, not a delay from now,
+        // that the flag went down.
+        io::base::Scheduler::shared ( ).rush ( pimpl->task );
+    }
+}
+
+void io::console::internal::TextChannel::close ( ) noexcept
+{
+    pimpl->closed.store ( true );
+    pimpl->notify ( );
+}
+
+void io::console::internal::TextChannel::setReady (
+        SharedFlag const &ready ) noexcept
+{
+    this->pimpl->ready = ready;
+    wake ( );
+}
+
+Sequence io::console::internal::TextChannel::impl_s::push (
+        std::string_view const                 &string,
+        std::span< std::uint32_t const > const &units ) noexcept
 {
-    spin ( ready );
-    if ( stop.load ( ) || queue.empty ( ) )
+    Sequence    next = pushed.load ( std::memory_order_relaxed );
+    // where we are in the string and how much of the current unit is left. A
+    // unit too big for the ring goes out as several.
+    std::size_t at   = 0;
+    std::size_t unit = 0;
+    std::size_t left = 0;
+    auto        nextUnit = [ & ] ( ) {
+        left = std::min< std::size_t > ( units [ unit ], string.size ( ) - at );
+    };
+    if ( !units.empty ( ) )
     {
-        return;
+        nextUnit ( );
+    }
+    while ( unit < units.size ( ) )
+    {
+        std::size_t const needed = std::min ( left, byteCapacity );
+        std::size_t       roomBytes;
+        std::size_t       roomUnits;
+        // wait until the channel has sent enough for the next piece to fit,
+        // which it never will once it is closed or not ready.
+        while ( true )
+        {
+            std::uint32_t const heard =
+                    events.load ( std::memory_order_acquire );
+            Sequence const seen = sent.load ( std::memory_order_acquire );
+            roomBytes = byteCapacity
+                      - ( written - read.load ( std::memory_order_acquire ) );
+            roomUnits = unitCapacity - ( next - seen );
+            if ( roomUnits && roomBytes >= needed )
+            {
+                break;
+            }
+            if ( closed.load ( ) || !ready->load ( ) )
+            {
+                return 0;
+            }
+            events.wait ( heard, std::memory_order_acquire );
+        }
+        // then take as many units as fit.
+        std::size_t const from = at;
+        while ( unit < units.size ( ) && roomUnits )
+        {
+            std::size_t const piece = std::min ( left, byteCapacity );
+            if ( piece > roomBytes )
+            {
+                break;
+            }
+            lengths [ next++ & ( unitCapacity - 1 ) ] = std::uint32_t ( piece );
+            roomUnits--;
+            roomBytes -= piece;
+            at += piece;
+            left -= piece;
+            if ( !left && ++unit < units.size ( ) )
+            {
+                nextUnit ( );
+            }
+        }
+        // copy their bytes in (at most) two pieces, around the end of the ring
+        std::size_t const size  = at - from;
+        std::size_t const start = written & ( byteCapacity - 1 );
+        std::size_t const first = std::min ( size, byteCapacity - start );
+        std::memcpy ( bytes.get ( ) + start, string.data ( ) + from, first );
+        std::memcpy ( bytes.get ( ), string.data ( ) + from + first,
+                      size - first );
+        written += size;
+        pushed.store ( next, std::memory_order_release );
+        io::base::Scheduler::shared ( ).wake ( task );
     }
-    stream << queue.front ( ).text;
-    stream.emit ( );
-    *queue.front ( ).token = true;
-    queue.pop ( );
+    return next;
 }
 
-void io::console::internal::TextChannel::impl_s::loop ( )
+io::base::Scheduler::TimePoint
+        io::console::internal::TextChannel::impl_s::send ( )
 {
-    spin ( ready );
-    while ( !stop.load ( ) )
+    using io::base::Scheduler;
+    Scheduler::TimePoint const now  = Scheduler::Clock::now ( );
+    Sequence const             next = sent.load ( std::memory_order_relaxed );
+    Sequence const last = pushed.load ( std::memory_order_acquire );
+    // sleep until whoever readies the channel or pushes to it wakes us, and
+    // start the count over then.
+    if ( !ready->load ( ) || next == last )
     {
-        send ( );
-        wait ( );
+        // a push waiting for room gives up on a channel that is not ready.
+        if ( next != last )
+        {
+            notify ( );
+        }
+        due = Scheduler::never;
+        return Scheduler::never;
+    }
+    if ( due == Scheduler::never )
+    {
+        due = now;
+        burst.store ( 0 );
+        started.store ( now );
     }
+    // send every unit that has come due, which is at least one, and every
+    // unit that was hurried.
+    Sequence const rushed = hurried.load ( );
+    Sequence const count  = paceUnits ( due,
+                                       now,
+                                       delay.load ( ),
+                                       last - next,
+                                       rushed > next ? rushed - next : 0 );
+    std::size_t length = 0;
+    for ( Sequence unit = next; unit != next + count; unit++ )
+    {
+        length += lengths [ unit & ( unitCapacity - 1 ) ];
+    }
+    std::size_t const done   = read.load ( std::memory_order_relaxed );
+    std::size_t const start  = done & ( byteCapacity - 1 );
+    std::size_t const first  = std::min ( length, byteCapacity - start );
+    if ( first == length )
+    {
+        if ( length )
+        {
+            backend->write (
+                    std::string_view ( bytes.get ( ) + start, length ) );
+        }
+    } else
+    {
+        // the backend takes one piece, so the end of the ring and its start
+        // go together.
+        std::string joined ( bytes.get ( ) + start, first );
+        joined.append ( bytes.get ( ), length - first );
+        backend->write ( joined );
+    }
+    read.store ( done + length, std::memory_order_release );
+    sent.store ( next + count, std::memory_order_release );
+    notify ( );
+    burst.fetch_add ( count );
+    latest.store ( now );
+    return due;
 }
 
-io::console::internal::TextChannel::impl_s::impl_s ( SharedFlag const &ready ) :
-        thread ( [ & ] ( ) { loop ( ); } ), stop ( false ), ready ( ready )
+void io::console::internal::TextChannel::impl_s::notify ( ) noexcept
 {
-    thread.detach ( );
+    events.fetch_add ( 1, std::memory_order_release );
+    events.notify_all ( );
 }
 
+io::console::internal::TextChannel::impl_s::impl_s (
+        SharedFlag const                 &ready,
+        std::shared_ptr< Backend > const &backend ) :
+        backend ( backend ),
+        ready ( ready ),
+        task ( io::base::Scheduler::shared ( ).add (
+                [ & ] ( auto const & ) { return send ( ); },
+                io::base::Scheduler::never ) )
+{ }
+
 io::console::internal::TextChannel::impl_s::~impl_s ( )
 {
-    stop.store ( true );
-    delay.store ( 0ms );
-    while ( thread.joinable ( ) ) thread.join ( );
-}
\ No newline at end of file
+    closed.store ( true );
+    notify ( );
+    io::base::Scheduler::shared ( ).remove ( task );
+}
+
+bool testPacing ( std::ostream &stream )
+{
+    using io::console::internal::TextChannel;
+    stream << "Beginning text channel pacing unittest.\n";
+    // the arithmetic is checked against a made up clock, so how busy the
+    // machine is does not matter.
+    Delay const     wait   = 250us;
+    TimePoint const start  = TimePoint ( ) + 1h;
+    Sequence const  plenty = 1000000;
+    TimePoint       due    = start;
+
+    stream << "Ensuring that ticks on time send a unit each...\n";
+    for ( std::size_t tick = 0; tick < 8; tick++ )
+    {
+        TimePoint const now = due;
+        if ( paceUnits ( due, now, wait, plenty, 0 ) != 1
+             || due != now + wait )
+        {
+            BASIC_UNIT_FAIL ( stream, "Tick " << tick << " was paced wrongly" )
+        }
+    }
+
+    stream << "Ensuring that late ticks catch up without getting ahead...\n";
+    // a scheduler that wakes a little over every millisecond.
+    due             = start;
+    Sequence sentBy = 0;
+    for ( TimePoint now = start; now < start + 100ms; now += 1ms + 37us )
+    {
+        sentBy += paceUnits ( due, now, wait, plenty, 0 );
+        // every unit due by now went out, and none due after it.
+        if ( sentBy != Sequence ( ( now - start ) / wait ) + 1 )
+        {
+            BASIC_UNIT_FAIL ( stream, "Sent " << sentBy << " units after "
+                                              << ( now - start ).count ( )
+                                              << "ns" )
+        }
+    }
+
+    stream << "Ensuring that a stalled channel gives up the time it lost...\n";
+    due                      = start;
+    TimePoint const stalled  = start + 1s;
+    Sequence const  caughtUp = paceUnits ( due, stalled, wait, plenty, 0 );
+    if ( caughtUp != Sequence ( maxLag / wait ) + 1
+         || due != stalled - maxLag + wait * std::int64_t ( caughtUp ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "A stall sent " << caughtUp << " units" )
+    }
+
+    stream << "Ensuring that pacing sends what it should and no more...\n";
+    due = start + 1s;
+    if ( paceUnits ( due, start, wait, 10, 4 ) != 4 || due != start + wait )
+    {
+        BASIC_UNIT_FAIL ( stream, "Hurried units were paced wrongly" )
+    }
+    due = start;
+    if ( paceUnits ( due, start, Delay::zero ( ), 10, 0 ) != 10
+         || paceUnits ( due, start + 10ms, wait, 3, 0 ) != 3 )
+    {
+        BASIC_UNIT_FAIL ( stream, "The wrong number of units went out" )
+    }
+
+    stream << "Ensuring that a real channel roughly keeps its pace...\n";
+    std::atomic_bool ready = true;
+    // empty units write nothing, so all that shows is when they went out.
+    std::vector< std::uint32_t > const lengths ( 1000, 0 );
+    {
+        TextChannel channel (
+                TextChannel::SharedFlag ( &ready, [] ( auto ) { } ) );
+        channel.setDelay ( wait );
+        channel.waitFor ( channel.pushUnits ( "", lengths ) );
+        double const target   = channel.targetRate ( );
+        double const achieved = channel.achievedRate ( );
+        stream << "Sent " << achieved << " units per second against a target "
+               << "of " << target << ".\n";
+        // the machine may be busy, so only falling far behind fails, but
+        // getting ahead never should.
+        if ( achieved < 0.5 * target || achieved > target )
+        {
+            BASIC_UNIT_FAIL ( stream, "The channel did not keep its pace" )
+        }
+    }
+
+    stream << "Ensuring that hurried units go out at once...\n";
+    TextChannel channel ( TextChannel::SharedFlag ( &ready, [] ( auto ) { } ) );
+    channel.setDelay ( 1s );
+    Sequence const last =
+            channel.pushUnits ( "", std::span ( lengths ).first ( 5 ) );
+    auto const began = std::chrono::steady_clock::now ( );
+    channel.hurry ( last - 1 );
+    channel.waitFor ( last - 1 );
+    // unhurried, they would have taken three whole delays.
+    if ( std::chrono::steady_clock::now ( ) - began > channel.getDelay ( )
+         || channel.serviced ( last ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Hurrying sent the wrong units" )
+    }
+
+    stream << "Ensuring that a push gives up on a channel going nowhere...\n";
+    std::vector< std::uint32_t > const tooMany ( 2 * unitCapacity, 0 );
+    // one that never will be ready, one whose flag goes down and one that is
+    // closed, each while the push waits for room.
+    for ( std::size_t way = 0; way < 3; way++ )
+    {
+        std::atomic_bool going = way != 0;
+        TextChannel      stuck ( TextChannel::SharedFlag ( &going,
+                                                      [] ( auto ) { } ) );
+        stuck.setDelay ( 1s );
+        Sequence    pushedTo = 1;
+        std::thread pusher ( [ & ] ( ) {
+            pushedTo = stuck.pushUnits ( "", tooMany );
+        } );
+        std::this_thread::sleep_for ( 50ms );
+        if ( way == 1 )
+        {
+            going.store ( false );
+            stuck.wake ( );
+        } else if ( way == 2 )
+        {
+            stuck.close ( );
+        }
+        pusher.join ( );
+        if ( pushedTo != 0 )
+        {
+            BASIC_UNIT_FAIL ( stream, "The push did not give up" )
+        }
+    }
+    return true;
+}
+
+test::Unittest pacingTest { &testPacing };
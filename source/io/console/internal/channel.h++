@@ -11,39 +11,108 @@
  */
 #pragma once
 
+#include <io/console/backend.h++>
 #include <io/console/console.h++>
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 
 namespace io::console::internal
 {
+    /**
+     * @brief Sends text to the console one unit at a time, the delay apart.
+     * Each unit is due a whole number of delays after the first unit sent
+     * since the channel last ran dry, so time spent writing does not add up,
+     * and a tick that runs late sends every unit that has come due. Text
+     * waits in a ring of bytes that one thread pushes onto and a task on the
+     * shared scheduler takes from, so pushes must never overlap.
+     */
     class TextChannel
     {
         struct impl_s;
         std::unique_ptr< impl_s > pimpl;
     public:
         using SharedFlag = std::shared_ptr< std::atomic_bool >;
+        /**
+         * @brief Counts units. Units are numbered from one in the order they
+         * are pushed, and the channel has serviced unit n once it has sent n
+         * units.
+         */
+        using Sequence   = std::uint64_t;
+        using Delay      = std::chrono::nanoseconds;
         static inline std::atomic_bool defaultReady = false;
 
         TextChannel ( ) noexcept;
-        TextChannel ( SharedFlag const & ) noexcept;
+        TextChannel ( SharedFlag const &,
+                      std::shared_ptr< Backend > const & =
+                              standardBackend ( ) ) noexcept;
         virtual ~TextChannel ( );
 
-        void                setDelay ( std::uint64_t const &delay ) noexcept;
-        std::uint64_t const getDelay ( ) const noexcept;
+        void  setDelay ( Delay const &delay ) noexcept;
+        Delay getDelay ( ) const noexcept;
 
         /**
-         * @brief Pushes a string onto the internal queue and gives you a token 
-         * that will evaluate to true when the string has been serviced.
-         * 
-         * @param string 
-         * @return std::shared_ptr<bool> 
+         * @brief How many units per second the delay asks for, or infinity for
+         * no delay at all.
+         */
+        double targetRate ( ) const noexcept;
+        /**
+         * @brief How many units per second the channel sent, from the first
+         * unit to the last, since it last ran dry. Zero until it has sent two.
+         */
+        double achievedRate ( ) const noexcept;
+
+        /**
+         * @brief Pushes a string as one unit. Waits for room if the ring is
+         * full, unless the channel closes or its ready flag goes down, since
+         * then the room would never come.
+         *
+         * @return the unit's sequence number, or zero if it gave up waiting
+         */
+        Sequence pushString ( std::string_view const &string ) noexcept;
+
+        /**
+         * @brief Pushes consecutive units of the string, one for each length,
+         * copying as many of them at once as there is room for. Gives up
+         * waiting for room as pushString does, leaving the units it had no
+         * room for unpushed.
+         *
+         * @return the last unit's sequence number, or zero if it gave up
+         */
+        Sequence pushUnits (
+                std::string_view const                &string,
+                std::span< std::uint32_t const > const &lengths ) noexcept;
+
+        /**
+         * @brief Whether the unit has been sent.
+         */
+        bool serviced ( Sequence const & ) const noexcept;
+        /**
+         * @brief Blocks until the unit has been sent, or the channel closes.
+         */
+        void waitFor ( Sequence const & ) const noexcept;
+        /**
+         * @brief Sends every unit up to and including this one as soon as it
+         * can, without the delay between them. The units after it go out at
+         * the usual pace again.
+         */
+        void hurry ( Sequence const & ) noexcept;
+        /**
+         * @brief Tells a channel with nothing to do to look at its ready flag
+         * again. Call after raising or lowering the flag.
+         */
+        void wake ( ) noexcept;
+        /**
+         * @brief Stops the channel for good. Pushes and waits blocked on it
+         * return, and pushes from then on give up as soon as the ring is full.
          */
-        std::shared_ptr<bool> pushString ( std::string const &string ) noexcept;
+        void close ( ) noexcept;
 
         void setReady ( SharedFlag const &ready ) noexcept;
     };
-} // namespace io::console::internal
\ No newline at end of file
+} // namespace io::console::internal
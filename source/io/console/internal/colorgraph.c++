@@ -0,0 +1,199 @@
+/**
+ * @file colorgraph.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of the flattened color graph
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/console/internal/colorgraph.h++>
+
+#include <defines/macros.h++>
+#include <io/console/colors/color.h++>
+#include <io/console/colors/direct.h++>
+#include <io/console/colors/indirect.h++>
+#include <io/console/colors/value.h++>
+#include <test/unittester.h++>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+using io::console::internal::ColorGraph;
+
+std::size_t io::console::internal::ColorGraph::add (
+        std::shared_ptr< colors::IColor const > const &color,
+        double const                                 &offset,
+        std::vector< colors::IColor const * >        &path,
+        Index                                        &index )
+{
+    if ( !color )
+    {
+        return none;
+    }
+    if ( std::find ( path.begin ( ), path.end ( ), color.get ( ) )
+         != path.end ( ) )
+    {
+        RUNTIME_ERROR ( "A color is calculated from itself." )
+    }
+    auto const parameters = color->parameters ( );
+    // a color that does not change with time is the same at every offset.
+    double const at       = parameters.empty ( ) ? 0 : offset;
+    auto const key        = std::pair { color.get ( ), at };
+    if ( index.contains ( key ) )
+    {
+        return index.at ( key );
+    }
+
+    Node node { color, at, { } };
+    path.push_back ( color.get ( ) );
+    for ( auto const &parameter : parameters )
+    {
+        node.parameters.push_back (
+                add ( parameter.color, at + parameter.offset, path, index ) );
+    }
+    path.pop_back ( );
+    // every parameter is in by now, so this comes after all of them.
+    nodes.push_back ( std::move ( node ) );
+    index.insert ( { key, nodes.size ( ) - 1 } );
+    return nodes.size ( ) - 1;
+}
+
+io::console::internal::ColorGraph::ColorGraph (
+        std::span< std::shared_ptr< colors::IColor > const > const &roots )
+{
+    std::vector< colors::IColor const * > path;
+    Index                                 index;
+    std::size_t                           widest = 0;
+    for ( auto const &root : roots )
+    {
+        this->roots.push_back ( add ( root, 0, path, index ) );
+    }
+    for ( auto const &node : nodes )
+    {
+        widest = std::max ( widest, node.parameters.size ( ) );
+    }
+    values.resize ( nodes.size ( ) );
+    gathered.resize ( widest );
+}
+
+void io::console::internal::ColorGraph::evaluate (
+        double const                          &time,
+        std::span< colors::ColorValue > const &out ) noexcept
+{
+    for ( std::size_t i = 0; i < nodes.size ( ); i++ )
+    {
+        Node const &node = nodes [ i ];
+        for ( std::size_t j = 0; j < node.parameters.size ( ); j++ )
+        {
+            std::size_t const at = node.parameters [ j ];
+            gathered [ j ]       = at == none ? colors::ColorValue ( )
+                                              : values [ at ];
+        }
+        values [ i ] = node.color->evaluate (
+                time + node.offset,
+                std::span ( gathered.data ( ), node.parameters.size ( ) ) );
+    }
+    for ( std::size_t i = 0; i < roots.size ( ); i++ )
+    {
+        out [ i ] = roots [ i ] == none ? colors::ColorValue ( )
+                                        : values [ roots [ i ] ];
+    }
+}
+
+std::size_t io::console::internal::ColorGraph::size ( ) const noexcept
+{
+    return nodes.size ( );
+}
+
+// counts how many times it is worked out.
+class CountedColor : public io::console::colors::RGBAColor
+{
+public:
+    std::size_t mutable evaluations = 0;
+
+    CountedColor ( ) noexcept : RGBAColor ( 10, 20, 30, 0 ) { }
+
+    io::console::colors::ColorValue evaluate (
+            double const &time,
+            std::span< io::console::colors::ColorValue const > const
+                    &parameters ) const noexcept override
+    {
+        evaluations++;
+        return RGBAColor::evaluate ( time, parameters );
+    }
+};
+
+bool testColorGraph ( std::ostream &stream )
+{
+    using namespace io::console;
+    using colors::IColor;
+    using colors::IndirectColor;
+    stream << "Beginning color graph unittest.\n";
+    auto shared = std::make_shared< CountedColor > ( );
+    auto black  = std::make_shared< colors::RGBAColor > ( 0, 0, 0, 0 );
+    auto middle = std::make_shared< IndirectColor > (
+            1, 2, 3, 4, shared, shared, shared, shared );
+    std::shared_ptr< IColor > roots [] = {
+            std::make_shared< IndirectColor > (
+                    5, 6, 7, 8, middle, shared, middle, black ),
+            middle,
+            shared,
+    };
+
+    stream << "Ensuring that a shared color is worked out once...\n";
+    internal::ColorGraph graph ( roots );
+    // shared, black, then middle now and a quarter turn behind, and the
+    // first root. shared does not change with time, so it is only there once.
+    if ( graph.size ( ) != 5 )
+    {
+        BASIC_UNIT_FAIL ( stream, "The graph has " << graph.size ( ) )
+    }
+    colors::ColorValue out [ 3 ];
+    graph.evaluate ( 0.5, out );
+    if ( shared->evaluations != 1 )
+    {
+        BASIC_UNIT_FAIL ( stream,
+                          "Worked out " << shared->evaluations << " times" )
+    }
+
+    stream << "Ensuring that it gives what the colors give...\n";
+    for ( std::size_t i = 0; i < 3; i++ )
+    {
+        colors::ColorValue const expected = roots [ i ]->rgba ( 0.5 );
+        for ( std::size_t j = 0; j < 4; j++ )
+        {
+            if ( std::abs ( out [ i ][ j ] - expected [ j ] ) > 1e-9 )
+            {
+                BASIC_UNIT_FAIL ( stream, "Root " << i << " came out wrong" )
+            }
+        }
+    }
+
+    stream << "Ensuring that a color calculated from itself is refused...\n";
+    auto loop = std::make_shared< IndirectColor > (
+            black, black, black, black );
+    auto back = std::make_shared< IndirectColor > ( loop, black, black, black );
+    // setParam refuses this, so it has to go around it.
+    *loop = IndirectColor ( back, black, black, black );
+    std::shared_ptr< IColor > looped [] = { loop };
+    try
+    {
+        internal::ColorGraph bad ( looped );
+        BASIC_UNIT_FAIL ( stream, "The loop was let through" )
+    } catch ( std::runtime_error const & )
+    { }
+    // breaks the loop, so the colors can go away.
+    *loop = IndirectColor ( );
+    return true;
+}
+
+test::Unittest colorGraphTest { &testColorGraph };
@@ -0,0 +1,80 @@
+/**
+ * @file colorgraph.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief The palette's colors, flattened so each is worked out once a tick
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <io/console/colors/color.h++>
+#include <io/console/colors/value.h++>
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace io::console::internal
+{
+    /**
+     * @brief Every color some colors are calculated from, in an order where
+     * each comes after its parameters, so that evaluating them in turn works
+     * each out exactly once however many colors share it. A color looked at
+     * from several offsets in time counts once for each.
+     *
+     */
+    class ColorGraph
+    {
+        // where a node's parameter is, when it has none.
+        static constexpr std::size_t none = std::size_t ( -1 );
+
+        struct Node
+        {
+            std::shared_ptr< colors::IColor const > color;
+            double                                  offset;
+            std::vector< std::size_t >              parameters;
+        };
+        std::vector< Node >               nodes;
+        // where each root's node is.
+        std::vector< std::size_t >        roots;
+        // each node's color this tick, and room for a node's parameters.
+        std::vector< colors::ColorValue > values;
+        std::vector< colors::ColorValue > gathered;
+
+        // where each color is at each offset, while flattening.
+        using Index = std::map< std::pair< colors::IColor const *, double >,
+                                std::size_t >;
+        std::size_t add ( std::shared_ptr< colors::IColor const > const &,
+                          double const                                 &offset,
+                          std::vector< colors::IColor const * >        &path,
+                          Index                                        &index );
+    public:
+        ColorGraph ( ) noexcept = default;
+        /**
+         * @brief Flattens the colors the roots are calculated from.
+         *
+         * @throw std::runtime_error if any is calculated from itself.
+         */
+        explicit ColorGraph (
+                std::span< std::shared_ptr< colors::IColor > const > const
+                        &roots );
+
+        /**
+         * @brief Works out every color at the time, and writes each root's in
+         * RGBA to out, which holds one for every root.
+         */
+        void evaluate ( double const                        &time,
+                        std::span< colors::ColorValue > const &out ) noexcept;
+        /**
+         * @brief How many colors are worked out each time.
+         */
+        std::size_t size ( ) const noexcept;
+    };
+} // namespace io::console::internal
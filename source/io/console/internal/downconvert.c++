@@ -0,0 +1,284 @@
+/**
+ * @file downconvert.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of the color downconversion tables
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/console/internal/downconvert.h++>
+
+#include <defines/macros.h++>
+#include <io/console/backend.h++>
+#include <io/console/internal/sgr.h++>
+#include <test/unittester.h++>
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+using io::console::ColorDepth;
+using io::console::internal::Pen;
+using io::console::internal::xtermColor;
+
+// how many of the top bits of each component pick a color's table entry.
+constexpr std::uint32_t downconvertBits = 5;
+constexpr std::uint32_t downconvertSide = 1 << downconvertBits;
+
+// the nearest color to every box of colors, by index.
+using DownconvertTable =
+        std::array< std::uint8_t,
+                    downconvertSide * downconvertSide * downconvertSide >;
+
+// the levels of each component in xterm's 6x6x6 color cube.
+constexpr std::uint8_t xtermCubeLevels [] = { 0, 95, 135, 175, 215, 255 };
+
+// the first sixteen colors of xterm's palette.
+constexpr std::uint32_t xtermSystemColors [] = {
+        0x000000, 0xcd0000, 0x00cd00, 0xcdcd00, 0x0000ee, 0xcd00cd,
+        0x00cdcd, 0xe5e5e5, 0x7f7f7f, 0xff0000, 0x00ff00, 0xffff00,
+        0x5c5cff, 0xff00ff, 0x00ffff, 0xffffff,
+};
+
+std::uint32_t io::console::internal::xtermColor (
+        std::uint8_t const &index ) noexcept
+{
+    if ( index < 16 )
+    {
+        return xtermSystemColors [ index ];
+    } else if ( index < 232 )
+    {
+        std::uint8_t const cube = index - 16;
+        return std::uint32_t ( xtermCubeLevels [ cube / 36 ] ) << 16
+             | std::uint32_t ( xtermCubeLevels [ cube / 6 % 6 ] ) << 8
+             | xtermCubeLevels [ cube % 6 ];
+    } else
+    {
+        std::uint32_t const gray = 8 + 10 * ( index - 232 );
+        return gray << 16 | gray << 8 | gray;
+    }
+}
+
+// how far apart two colors look, weighing red and blue by how red they are,
+// which is much closer to what the eye sees than the plain distance.
+std::uint32_t downconvertDistance ( std::uint32_t const &a,
+                                    std::uint32_t const &b ) noexcept
+{
+    std::int32_t const mean = ( std::int32_t ( a >> 16 & 0xff )
+                                + std::int32_t ( b >> 16 & 0xff ) )
+                            / 2;
+    std::int32_t const red =
+            std::int32_t ( a >> 16 & 0xff ) - std::int32_t ( b >> 16 & 0xff );
+    std::int32_t const green =
+            std::int32_t ( a >> 8 & 0xff ) - std::int32_t ( b >> 8 & 0xff );
+    std::int32_t const blue =
+            std::int32_t ( a & 0xff ) - std::int32_t ( b & 0xff );
+    return std::uint32_t ( ( ( 512 + mean ) * red * red >> 8 )
+                           + 4 * green * green
+                           + ( ( 767 - mean ) * blue * blue >> 8 ) );
+}
+
+// which of xterm's colors from first up to (but not including) last is
+// nearest the middle of each box. The palette colors are measured against
+// xterm's too, since the animation recolors them as it likes, and what they
+// start as says nothing of what they show later.
+DownconvertTable buildDownconvertTable ( std::uint32_t const &first,
+                                         std::uint32_t const &last ) noexcept
+{
+    constexpr std::uint32_t shift = 8 - downconvertBits;
+    constexpr std::uint32_t half  = 1 << ( shift - 1 );
+    std::uint32_t           candidates [ 256 ];
+    for ( std::uint32_t i = first; i < last; i++ )
+    {
+        candidates [ i ] = xtermColor ( std::uint8_t ( i ) );
+    }
+    DownconvertTable table;
+    for ( std::uint32_t box = 0; box < table.size ( ); box++ )
+    {
+        std::uint32_t const middle =
+                ( ( box >> 2 * downconvertBits ) << shift | half ) << 16
+                | ( ( box >> downconvertBits & ( downconvertSide - 1 ) )
+                            << shift
+                    | half ) << 8
+                | ( ( box & ( downconvertSide - 1 ) ) << shift | half );
+        std::uint32_t best     = std::numeric_limits< std::uint32_t >::max ( );
+        for ( std::uint32_t i = first; i < last; i++ )
+        {
+            std::uint32_t const distance =
+                    downconvertDistance ( middle, candidates [ i ] );
+            if ( distance < best )
+            {
+                best         = distance;
+                table [ box ] = std::uint8_t ( i );
+            }
+        }
+    }
+    return table;
+}
+
+// the table for the depth, filled the first time it is asked for.
+DownconvertTable const &downconvertTable ( ColorDepth const &depth ) noexcept
+{
+    switch ( depth )
+    {
+        case ColorDepth::EIGHT:
+            {
+                static DownconvertTable const eight =
+                        buildDownconvertTable ( 0, 8 );
+                return eight;
+            }
+        case ColorDepth::SIXTEEN:
+            {
+                static DownconvertTable const sixteen =
+                        buildDownconvertTable ( 0, 16 );
+                return sixteen;
+            }
+        default:
+            {
+                static DownconvertTable const xterm =
+                        buildDownconvertTable ( 16, 256 );
+                return xterm;
+            }
+    }
+}
+
+std::uint32_t io::console::internal::downconvert (
+        std::uint32_t const &color,
+        ColorDepth const    &depth ) noexcept
+{
+    std::uint32_t const kind = color & 0xff;
+    if ( kind <= 8 || depth == ColorDepth::TRUECOLOR )
+    {
+        return color;
+    }
+    std::uint32_t rgb;
+    if ( kind == 9 )
+    {
+        std::uint8_t const index = color >> 8 & 0xff;
+        // what the depth has already.
+        if ( depth == ColorDepth::XTERM_256
+             || index < ( depth == ColorDepth::SIXTEEN ? 16 : 8 ) )
+        {
+            return index < 8 ? index : color & 0xffff;
+        }
+        rgb = xtermColor ( index );
+    } else
+    {
+        rgb = color >> 8;
+    }
+    constexpr std::uint32_t shift = 8 - downconvertBits;
+    std::uint32_t const     box   = ( rgb >> ( 16 + shift ) )
+                                     << 2 * downconvertBits
+                            | ( rgb >> ( 8 + shift ) & ( downconvertSide - 1 ) )
+                                      << downconvertBits
+                            | ( rgb >> shift & ( downconvertSide - 1 ) );
+    std::uint32_t const     index = downconvertTable ( depth ) [ box ];
+    return index < 8 ? index : index << 8 | 9;
+}
+
+Pen io::console::internal::downconvert ( Pen const        &pen,
+                                         ColorDepth const &depth ) noexcept
+{
+    Pen out        = pen;
+    out.foreground = downconvert ( pen.foreground, depth );
+    out.background = downconvert ( pen.background, depth );
+    return out;
+}
+
+bool testDownconvert ( std::ostream &stream )
+{
+    using io::console::internal::downconvert;
+    stream << "Beginning color downconversion unittest.\n";
+    ColorDepth const depths [] = { ColorDepth::EIGHT,
+                                   ColorDepth::SIXTEEN,
+                                   ColorDepth::XTERM_256,
+                                   ColorDepth::TRUECOLOR };
+
+    stream << "Ensuring that xterm's palette is laid out as xterm has it...\n";
+    if ( xtermColor ( 9 ) != 0xff0000 || xtermColor ( 16 ) != 0
+         || xtermColor ( 67 ) != 0x5f87af || xtermColor ( 231 ) != 0xffffff
+         || xtermColor ( 232 ) != 0x080808 || xtermColor ( 255 ) != 0xeeeeee )
+    {
+        BASIC_UNIT_FAIL ( stream, "The palette is laid out wrongly" )
+    }
+
+    stream << "Ensuring that what a depth has is left alone...\n";
+    for ( ColorDepth const &depth : depths )
+    {
+        for ( std::uint32_t kind = 0; kind <= 8; kind++ )
+        {
+            if ( downconvert ( kind, depth ) != kind )
+            {
+                BASIC_UNIT_FAIL ( stream, "Color " << kind << " was changed" )
+            }
+        }
+    }
+    if ( downconvert ( 0x1020300a, ColorDepth::TRUECOLOR ) != 0x1020300a
+         || downconvert ( 0x2a09, ColorDepth::XTERM_256 ) != 0x2a09
+         || downconvert ( 0x0c09, ColorDepth::SIXTEEN ) != 0x0c09 )
+    {
+        BASIC_UNIT_FAIL ( stream, "A color the depth has was changed" )
+    }
+
+    stream << "Ensuring that colors come down to the nearest...\n";
+    std::pair< std::uint32_t, std::uint32_t > const expected [] = {
+            { downconvert ( 0xff00000a, ColorDepth::XTERM_256 ), 0xc409 },
+            { downconvert ( 0x0000000a, ColorDepth::XTERM_256 ), 0x1009 },
+            { downconvert ( 0xffffff0a, ColorDepth::XTERM_256 ), 0xe709 },
+            { downconvert ( 0x5f87af0a, ColorDepth::XTERM_256 ), 0x4309 },
+            { downconvert ( 0x0c0c0c0a, ColorDepth::XTERM_256 ), 0xe809 },
+            { downconvert ( 0xff00000a, ColorDepth::SIXTEEN ), 0x0909 },
+            { downconvert ( 0x7f00000a, ColorDepth::SIXTEEN ), 1 },
+            { downconvert ( 0xc409, ColorDepth::SIXTEEN ), 0x0909 },
+            { downconvert ( 0xff00000a, ColorDepth::EIGHT ), 1 },
+            { downconvert ( 0xffffff0a, ColorDepth::EIGHT ), 7 },
+            { downconvert ( 0x0909, ColorDepth::EIGHT ), 1 },
+            { downconvert ( 0x0309, ColorDepth::EIGHT ), 3 },
+    };
+    for ( auto const &[ got, want ] : expected )
+    {
+        if ( got != want )
+        {
+            BASIC_UNIT_FAIL ( stream,
+                              "Expected " << std::hex << want << " but got "
+                                          << got << std::dec )
+        }
+    }
+
+    stream << "Ensuring that the palette is measured as xterm has it...\n";
+    // the console starts blue at 0x00007f, xterm at 0x0000ee.
+    if ( downconvert ( 0x0000600a, ColorDepth::EIGHT ) != 0
+         || downconvert ( 0x0000600a, ColorDepth::SIXTEEN ) != 0 )
+    {
+        BASIC_UNIT_FAIL ( stream, "A dark blue came down to the blue" )
+    }
+
+    stream << "Ensuring that 256 colors stay out of the palette...\n";
+    for ( std::uint32_t rgb = 0; rgb < 0x1000000; rgb += 0x010203 )
+    {
+        std::uint32_t const color =
+                downconvert ( rgb << 8 | 10, ColorDepth::XTERM_256 );
+        if ( ( color & 0xff ) != 9 || ( color >> 8 ) < 16 )
+        {
+            BASIC_UNIT_FAIL ( stream, "Got " << std::hex << color << std::dec )
+        }
+    }
+
+    stream << "Ensuring that a pen's colors both come down...\n";
+    Pen pen;
+    pen.attributes = 5;
+    pen.foreground = 0x00ff000a;
+    pen.background = 0xc409;
+    Pen const down = downconvert ( pen, ColorDepth::EIGHT );
+    if ( down.attributes != 5 || down.foreground != 2 || down.background != 1 )
+    {
+        BASIC_UNIT_FAIL ( stream, "The pen came down wrongly" )
+    }
+    return true;
+}
+
+test::Unittest downconvertTest { &testDownconvert };
@@ -0,0 +1,45 @@
+/**
+ * @file downconvert.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Bringing colors down to what the terminal can show
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <io/console/backend.h++>
+#include <io/console/internal/sgr.h++>
+
+#include <cstdint>
+
+namespace io::console::internal
+{
+    /**
+     * @brief The red, green and blue that xterm gives the color in its
+     * 256-color palette.
+     */
+    std::uint32_t xtermColor ( std::uint8_t const &index ) noexcept;
+
+    /**
+     * @brief The nearest color the depth has to a color as a pen holds it.
+     * @details Palette colors and the default are left alone. At 256 colors,
+     * a true color becomes the nearest of the colors past the first sixteen,
+     * which the palette animation does not touch. At eight or sixteen, any
+     * other color becomes the nearest of the first eight or sixteen, which
+     * are palette colors under eight and 256-color colors from there on.
+     * Since the palette animation recolors the first eight, all sixteen are
+     * measured as xterm shows them rather than as the console starts them.
+     * Each depth looks colors up in a table it fills the first time it is
+     * needed.
+     */
+    std::uint32_t downconvert ( std::uint32_t const &color,
+                                ColorDepth const    &depth ) noexcept;
+    /**
+     * @brief The pen with both of its colors brought down to the depth.
+     */
+    Pen           downconvert ( Pen const &, ColorDepth const & ) noexcept;
+} // namespace io::console::internal
@@ -0,0 +1,363 @@
+/**
+ * @file keydecoder.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of the key decoder
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/console/internal/keydecoder.h++>
+
+#include <defines/macros.h++>
+#include <test/unittester.h++>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using io::console::Key;
+using io::console::internal::KeyDecoder;
+
+// a sequence that runs on longer than this is garbage, not a key that is
+// still arriving.
+constexpr std::size_t longestKeySequence = 32;
+
+Key makeKey ( Key::Code const    &code,
+              std::uint8_t const &modifiers = 0,
+              std::uint8_t const &number    = 0 )
+{
+    Key key;
+    key.code      = code;
+    key.modifiers = modifiers;
+    key.number    = number;
+    return key;
+}
+
+// the key a final byte stands for after CSI or SS3, such as A for up.
+Key keyForFinal ( char const &final )
+{
+    switch ( final )
+    {
+    case 'A': return makeKey ( Key::Code::UP );
+    case 'B': return makeKey ( Key::Code::DOWN );
+    case 'C': return makeKey ( Key::Code::RIGHT );
+    case 'D': return makeKey ( Key::Code::LEFT );
+    case 'H': return makeKey ( Key::Code::HOME );
+    case 'F': return makeKey ( Key::Code::END );
+    case 'P': return makeKey ( Key::Code::FUNCTION, 0, 1 );
+    case 'Q': return makeKey ( Key::Code::FUNCTION, 0, 2 );
+    case 'R': return makeKey ( Key::Code::FUNCTION, 0, 3 );
+    case 'S': return makeKey ( Key::Code::FUNCTION, 0, 4 );
+    case 'Z': return makeKey ( Key::Code::TAB, Key::SHIFT );
+    default: return makeKey ( Key::Code::UNKNOWN );
+    }
+}
+
+// the key for CSI n ~, where the function keys skip 16 and 22.
+Key keyForTilde ( std::uint32_t const &number )
+{
+    switch ( number )
+    {
+    case 1:
+    case 7: return makeKey ( Key::Code::HOME );
+    case 2: return makeKey ( Key::Code::INSERT );
+    case 3: return makeKey ( Key::Code::DEL );
+    case 4:
+    case 8: return makeKey ( Key::Code::END );
+    case 5: return makeKey ( Key::Code::PAGE_UP );
+    case 6: return makeKey ( Key::Code::PAGE_DOWN );
+    }
+    if ( number >= 11 && number <= 15 )
+    {
+        return makeKey ( Key::Code::FUNCTION, 0, std::uint8_t ( number - 10 ) );
+    }
+    if ( number >= 17 && number <= 21 )
+    {
+        return makeKey ( Key::Code::FUNCTION, 0, std::uint8_t ( number - 11 ) );
+    }
+    if ( number == 23 || number == 24 )
+    {
+        return makeKey ( Key::Code::FUNCTION, 0, std::uint8_t ( number - 12 ) );
+    }
+    return makeKey ( Key::Code::UNKNOWN );
+}
+
+// decodes the CSI sequence at the start of the bytes, returning how many
+// bytes it took, or zero if they stop partway through it.
+std::size_t decodeKeyCSI ( std::string_view const &bytes,
+                           KeyDecoder::Decoded    &decoded )
+{
+    // the Linux console sends F1 through F5 as CSI [ and a letter.
+    if ( bytes.size ( ) > 2 && bytes [ 2 ] == '[' )
+    {
+        if ( bytes.size ( ) < 4 )
+        {
+            return 0;
+        }
+        decoded.key = bytes [ 3 ] >= 'A' && bytes [ 3 ] <= 'E'
+                            ? makeKey ( Key::Code::FUNCTION,
+                                        0,
+                                        std::uint8_t ( bytes [ 3 ] - 'A' + 1 ) )
+                            : makeKey ( Key::Code::UNKNOWN );
+        return 4;
+    }
+    std::vector< std::uint32_t > parameters { 0 };
+    // private markers and intermediate bytes, which no key we know has.
+    bool                         known = true;
+    std::size_t                  at    = 2;
+    for ( ; at < bytes.size ( ); at++ )
+    {
+        char const byte = bytes [ at ];
+        if ( byte >= '0' && byte <= '9' )
+        {
+            parameters.back ( ) = parameters.back ( ) * 10 + ( byte - '0' );
+        } else if ( byte == ';' )
+        {
+            parameters.push_back ( 0 );
+        } else if ( byte >= 0x20 && byte <= 0x3F )
+        {
+            known = false;
+        } else
+        {
+            break;
+        }
+    }
+    if ( at == bytes.size ( ) )
+    {
+        if ( bytes.size ( ) < longestKeySequence )
+        {
+            return 0;
+        }
+        decoded.key = makeKey ( Key::Code::UNKNOWN );
+        return bytes.size ( );
+    }
+    char const final = bytes [ at ];
+    // a control byte cut the sequence short, and is a key of its own.
+    if ( final < 0x40 || final > 0x7E )
+    {
+        decoded.key = makeKey ( Key::Code::UNKNOWN );
+        return at;
+    }
+    if ( !known )
+    {
+        decoded.key = makeKey ( Key::Code::UNKNOWN );
+    } else if ( final == 'R' && parameters.size ( ) == 2 )
+    {
+        decoded.isCursor = true;
+        decoded.cursor   = { parameters [ 0 ], parameters [ 1 ] };
+    } else
+    {
+        decoded.key = final == '~' ? keyForTilde ( parameters [ 0 ] )
+                                   : keyForFinal ( final );
+        // the second parameter is one more than the modifier bits.
+        if ( parameters.size ( ) > 1 && parameters [ 1 ] > 1
+             && decoded.key.code != Key::Code::UNKNOWN )
+        {
+            decoded.key.modifiers |= std::uint8_t ( parameters [ 1 ] - 1 );
+        }
+    }
+    return at + 1;
+}
+
+// decodes the key at the start of the bytes, returning how many bytes it
+// took, or zero if they stop partway through it.
+std::size_t decodeKeyAt ( std::string_view const &bytes,
+                          KeyDecoder::Decoded    &decoded )
+{
+    unsigned char const first = bytes [ 0 ];
+    decoded                   = KeyDecoder::Decoded ( );
+    if ( first == 0x1B )
+    {
+        if ( bytes.size ( ) < 2 )
+        {
+            return 0;
+        }
+        if ( bytes [ 1 ] == '[' )
+        {
+            return decodeKeyCSI ( bytes, decoded );
+        }
+        if ( bytes [ 1 ] == 'O' )
+        {
+            if ( bytes.size ( ) < 3 )
+            {
+                return 0;
+            }
+            decoded.key = keyForFinal ( bytes [ 2 ] );
+            return 3;
+        }
+        // escape before a key is how terminals send alt with it.
+        std::size_t const taken = decodeKeyAt ( bytes.substr ( 1 ), decoded );
+        decoded.key.modifiers |= Key::ALT;
+        return taken ? taken + 1 : 0;
+    }
+    switch ( first )
+    {
+    case '\r':
+    case '\n': decoded.key = makeKey ( Key::Code::ENTER ); return 1;
+    case '\t': decoded.key = makeKey ( Key::Code::TAB ); return 1;
+    case 0x08:
+    case 0x7F: decoded.key = makeKey ( Key::Code::BACKSPACE ); return 1;
+    }
+    if ( first >= 0x01 && first <= 0x1A )
+    {
+        decoded.key      = makeKey ( Key::Code::CHARACTER, Key::CONTROL );
+        decoded.key.text = char ( 'a' + first - 1 );
+        return 1;
+    }
+    std::size_t length = 0;
+    if ( first >= 0x20 && first < 0x80 )
+    {
+        length = 1;
+    } else if ( ( first & 0xE0 ) == 0xC0 )
+    {
+        length = 2;
+    } else if ( ( first & 0xF0 ) == 0xE0 )
+    {
+        length = 3;
+    } else if ( ( first & 0xF8 ) == 0xF0 )
+    {
+        length = 4;
+    }
+    decoded.key = makeKey ( Key::Code::UNKNOWN );
+    if ( !length )
+    {
+        return 1;
+    }
+    for ( std::size_t i = 1; i < length && i < bytes.size ( ); i++ )
+    {
+        if ( ( bytes [ i ] & 0xC0 ) != 0x80 )
+        {
+            return i;
+        }
+    }
+    if ( bytes.size ( ) < length )
+    {
+        return 0;
+    }
+    decoded.key.code = Key::Code::CHARACTER;
+    decoded.key.text = bytes.substr ( 0, length );
+    return length;
+}
+
+void io::console::internal::KeyDecoder::feed ( std::string_view const &bytes,
+                                               std::vector< Decoded > &out )
+{
+    pending += bytes;
+    std::size_t at = 0;
+    while ( at < pending.size ( ) )
+    {
+        Decoded           decoded;
+        std::size_t const taken =
+                decodeKeyAt ( std::string_view ( pending ).substr ( at ),
+                              decoded );
+        if ( !taken )
+        {
+            break;
+        }
+        if ( !afterReturn || pending [ at ] != '\n' )
+        {
+            out.push_back ( decoded );
+        }
+        afterReturn = pending [ at ] == '\r';
+        at += taken;
+    }
+    pending.erase ( 0, at );
+}
+
+void io::console::internal::KeyDecoder::flush ( std::vector< Decoded > &out )
+{
+    while ( !pending.empty ( ) )
+    {
+        // whatever is left starts with an escape or a cut-off character.
+        Decoded decoded;
+        decoded.key = makeKey ( pending [ 0 ] == 0x1B ? Key::Code::ESCAPE
+                                                      : Key::Code::UNKNOWN );
+        out.push_back ( decoded );
+        pending.erase ( 0, 1 );
+        afterReturn = false;
+        feed ( "", out );
+    }
+}
+
+bool io::console::internal::KeyDecoder::waiting ( ) const noexcept
+{
+    return !pending.empty ( );
+}
+
+bool testKeyDecoder ( std::ostream &stream )
+{
+    stream << "Beginning key decoder unittest.\n";
+    auto character = [ & ] ( std::string const  &text,
+                             std::uint8_t const &modifiers = 0 ) {
+        Key key  = makeKey ( Key::Code::CHARACTER, modifiers );
+        key.text = text;
+        return key;
+    };
+    struct
+    {
+        std::string_view bytes;
+        Key              key;
+    } const cases [] = {
+            { "a", character ( "a" ) },
+            { "\u00e9", character ( "\u00e9" ) },
+            { "\r", makeKey ( Key::Code::ENTER ) },
+            { "\x7f", makeKey ( Key::Code::BACKSPACE ) },
+            { "\x01", character ( "a", Key::CONTROL ) },
+            { "\u001b[A", makeKey ( Key::Code::UP ) },
+            { "\u001b[1;5C", makeKey ( Key::Code::RIGHT, Key::CONTROL ) },
+            { "\u001b[3~", makeKey ( Key::Code::DEL ) },
+            { "\u001b[15~", makeKey ( Key::Code::FUNCTION, 0, 5 ) },
+            { "\u001bOP", makeKey ( Key::Code::FUNCTION, 0, 1 ) },
+            { "\u001b[[B", makeKey ( Key::Code::FUNCTION, 0, 2 ) },
+            { "\u001b[Z", makeKey ( Key::Code::TAB, Key::SHIFT ) },
+            { "\u001bx", character ( "x", Key::ALT ) },
+            { "\u001b", makeKey ( Key::Code::ESCAPE ) },
+            { "\u001b[?1;2c", makeKey ( Key::Code::UNKNOWN ) },
+    };
+    stream << "Ensuring that keys decode, whole and a byte at a time...\n";
+    for ( auto const &[ bytes, key ] : cases )
+    {
+        for ( std::size_t const step : { bytes.size ( ), std::size_t ( 1 ) } )
+        {
+            KeyDecoder                        decoder;
+            std::vector< KeyDecoder::Decoded > out;
+            for ( std::size_t at = 0; at < bytes.size ( ); at += step )
+            {
+                decoder.feed ( bytes.substr ( at, step ), out );
+            }
+            decoder.flush ( out );
+            if ( out.size ( ) != 1 || out [ 0 ].isCursor
+                 || !( out [ 0 ].key == key ) )
+            {
+                BASIC_UNIT_FAIL ( stream,
+                                  "Decoded \"" << bytes.substr ( 1 )
+                                               << "\" wrongly" )
+            }
+        }
+    }
+
+    stream << "Ensuring that cursor reports and line ends decode...\n";
+    KeyDecoder                        decoder;
+    std::vector< KeyDecoder::Decoded > out;
+    decoder.feed ( "\u001b[12;40Rb\r\n", out );
+    if ( decoder.waiting ( ) || out.size ( ) != 3 || !out [ 0 ].isCursor
+         || !( out [ 0 ].cursor == io::console::CursorPosition { 12, 40 } )
+         || !( out [ 1 ].key == character ( "b" ) )
+         || out [ 2 ].key.code != Key::Code::ENTER )
+    {
+        BASIC_UNIT_FAIL ( stream, "Decoded " << out.size ( ) << " keys" )
+    }
+    decoder.feed ( "\r", out );
+    if ( out.size ( ) != 4 )
+    {
+        BASIC_UNIT_FAIL ( stream, "A second return was not a second enter" )
+    }
+    return true;
+}
+
+test::Unittest keyDecoderTest { &testKeyDecoder };
@@ -0,0 +1,54 @@
+/**
+ * @file keydecoder.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Turns what the terminal says into keys
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <io/console/input.h++>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace io::console::internal
+{
+    /**
+     * @brief Decodes the bytes a raw-mode terminal sends into keys and cursor
+     * reports. It understands UTF-8, control keys, the CSI and SS3 sequences
+     * of xterm and the Linux console, and escape before a key as alt.
+     * Sequences may be cut anywhere between feeds.
+     */
+    class KeyDecoder
+    {
+        // the start of a sequence, waiting for the rest of it.
+        std::string pending;
+        // a return followed by a newline is one enter.
+        bool        afterReturn = false;
+    public:
+        struct Decoded
+        {
+            bool           isCursor = false;
+            Key            key;
+            CursorPosition cursor;
+        };
+
+        void feed ( std::string_view const &, std::vector< Decoded > & );
+        /**
+         * @brief Gives up on the rest of a sequence, for when it has not come
+         * in time. A lone escape is then the escape key.
+         */
+        void flush ( std::vector< Decoded > & );
+        /**
+         * @brief Whether the last feed ended partway through a sequence.
+         */
+        bool waiting ( ) const noexcept;
+    };
+} // namespace io::console::internal
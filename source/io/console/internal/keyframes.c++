@@ -0,0 +1,157 @@
+/**
+ * @file keyframes.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of the keyframe tables
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/console/internal/keyframes.h++>
+
+#include <defines/macros.h++>
+#include <io/console/colors/color.h++>
+#include <io/console/colors/direct.h++>
+#include <io/console/colors/indirect.h++>
+#include <io/console/colors/value.h++>
+#include <io/console/internal/colorgraph.h++>
+#include <test/unittester.h++>
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <vector>
+
+using io::console::internal::Keyframes;
+
+// how far apart two samples may be and still count as the same, which only
+// has to cover rounding. Comparing the bound colors would not do, since a
+// slow enough animation never moves a whole step in a tick.
+constexpr defines::UnboundColor keyframeTolerance = 1e-6;
+
+// whether the samples a period apart match, from the first on.
+bool keyframesRepeat ( std::vector< io::console::colors::ColorValue > const
+                                         &samples,
+                       std::size_t const &roots,
+                       std::size_t const &period )
+{
+    for ( std::size_t i = period * roots; i < samples.size ( ); i++ )
+    {
+        for ( std::size_t j = 0; j < 4; j++ )
+        {
+            if ( std::abs ( samples [ i ][ j ]
+                            - samples [ i - period * roots ][ j ] )
+                 > keyframeTolerance )
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+io::console::internal::Keyframes::Keyframes ( ColorGraph        &graph,
+                                              std::size_t const &roots,
+                                              double const      &step,
+                                              std::size_t const &limit ) :
+        width ( 4 * roots )
+{
+    // twice the limit, so that even the longest loop is seen to repeat.
+    std::size_t const                 ticks = 2 * limit;
+    std::vector< colors::ColorValue > samples ( ticks * roots );
+    for ( std::size_t i = 0; i < ticks; i++ )
+    {
+        graph.evaluate ( step * double ( i ),
+                         std::span ( samples.data ( ) + i * roots, roots ) );
+    }
+    for ( std::size_t candidate = 1; candidate <= limit; candidate++ )
+    {
+        if ( keyframesRepeat ( samples, roots, candidate ) )
+        {
+            period = candidate;
+            break;
+        }
+    }
+    frames.resize ( period * width );
+    colors::bind ( std::span ( samples.data ( ), period * roots ), frames );
+}
+
+bool io::console::internal::Keyframes::periodic ( ) const noexcept
+{
+    return period != 0;
+}
+
+std::size_t io::console::internal::Keyframes::getPeriod ( ) const noexcept
+{
+    return period;
+}
+
+std::span< defines::BoundColor const >
+        io::console::internal::Keyframes::frame (
+                std::size_t const &tick ) const noexcept
+{
+    return std::span ( frames.data ( ) + ( tick % period ) * width, width );
+}
+
+bool testKeyframes ( std::ostream &stream )
+{
+    using namespace io::console;
+    using colors::IColor;
+    stream << "Beginning keyframe unittest.\n";
+    // swinging once a second, at ten ticks a second.
+    auto once  = std::make_shared< colors::RGBAColor > ( 1, 1, 1, 0 );
+    auto swing = std::make_shared< colors::RGBAColor > ( 100, 50, 0, 0 );
+    auto black = std::make_shared< colors::RGBAColor > ( 0, 0, 0, 0 );
+    std::shared_ptr< IColor > roots [] = {
+            std::make_shared< colors::IndirectColor > (
+                    128, 128, 128, 0, swing, once, black, black ),
+            black,
+    };
+    internal::ColorGraph graph ( roots );
+
+    stream << "Ensuring that a loop is found...\n";
+    internal::Keyframes loop ( graph, 2, 0.1, 100 );
+    if ( !loop.periodic ( ) || loop.getPeriod ( ) != 10 )
+    {
+        BASIC_UNIT_FAIL ( stream, "Found a period of " << loop.getPeriod ( ) )
+    }
+
+    stream << "Ensuring that the frames are what the colors give...\n";
+    colors::ColorValue  raw [ 2 ];
+    defines::BoundColor live [ 8 ];
+    for ( std::size_t tick = 0; tick < 35; tick++ )
+    {
+        graph.evaluate ( 0.1 * double ( tick ), raw );
+        colors::bind ( raw, live );
+        auto const frame = loop.frame ( tick );
+        for ( std::size_t i = 0; i < 8; i++ )
+        {
+            // rounding can tip a component over a step either way.
+            if ( std::abs ( int ( frame [ i ] ) - int ( live [ i ] ) ) > 1 )
+            {
+                BASIC_UNIT_FAIL ( stream, "Tick " << tick << " is wrong" )
+            }
+        }
+    }
+
+    stream << "Ensuring that a loop too long is not kept...\n";
+    internal::Keyframes tooLong ( graph, 2, 0.1, 9 );
+    if ( tooLong.periodic ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Kept a loop of " << tooLong.getPeriod ( ) )
+    }
+    // under a step a tick, which bound colors would take for holding still.
+    once->setBasicComponent ( 0, 0.001 );
+    once->setBasicComponent ( 1, 0.001 );
+    internal::Keyframes slow ( graph, 2, 0.1, 100 );
+    if ( slow.periodic ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Kept a loop of " << slow.getPeriod ( ) )
+    }
+    return true;
+}
+
+test::Unittest keyframesTest { &testKeyframes };
@@ -0,0 +1,60 @@
+/**
+ * @file keyframes.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief A palette animation, worked out ahead of time
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <io/console/internal/colorgraph.h++>
+
+#include <defines/types.h++>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace io::console::internal
+{
+    /**
+     * @brief The colors a graph gives at every tick of one loop of its
+     * animation, bound and ready to send, so that playing it back is only a
+     * matter of looking up the tick. Only kept if the colors repeat soon
+     * enough.
+     *
+     */
+    class Keyframes
+    {
+        // every frame's colors, four components to a color.
+        std::vector< defines::BoundColor > frames;
+        std::size_t                        width  = 0;
+        // how many ticks before the colors repeat, or zero if they do not.
+        std::size_t                        period = 0;
+    public:
+        Keyframes ( ) noexcept = default;
+        /**
+         * @brief Samples the graph's roots once a step from time zero, for
+         * long enough to see whether they repeat within limit ticks.
+         */
+        Keyframes ( ColorGraph &,
+                    std::size_t const &roots,
+                    double const      &step,
+                    std::size_t const &limit );
+
+        /**
+         * @brief Whether the colors repeat, so that frame can be used.
+         */
+        bool        periodic ( ) const noexcept;
+        std::size_t getPeriod ( ) const noexcept;
+        /**
+         * @brief The colors at the tick, which is at the step times the tick.
+         */
+        std::span< defines::BoundColor const >
+                frame ( std::size_t const &tick ) const noexcept;
+    };
+} // namespace io::console::internal
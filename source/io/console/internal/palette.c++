@@ -0,0 +1,135 @@
+/**
+ * @file palette.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of the palette tracker
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/console/internal/palette.h++>
+
+#include <defines/constants.h++>
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <test/unittester.h++>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+using io::console::internal::Palette;
+
+// the two digits of every byte, one after the other.
+constexpr std::array< char, 512 > hexByteDigits = [ ] ( ) {
+    char const              digits [] = "0123456789abcdef";
+    std::array< char, 512 > table {};
+    for ( std::size_t i = 0; i < 256; i++ )
+    {
+        table [ 2 * i ]     = digits [ i >> 4 ];
+        table [ 2 * i + 1 ] = digits [ i & 15 ];
+    }
+    return table;
+}( );
+
+void io::console::internal::appendHexByte ( std::string        &out,
+                                            std::uint8_t const &byte )
+{
+    out.append ( &hexByteDigits [ 2 * std::size_t ( byte ) ], 2 );
+}
+
+io::console::internal::Palette::Palette ( ) noexcept { forget ( ); }
+
+bool io::console::internal::Palette::change (
+        std::string               &out,
+        std::size_t const         &slot,
+        defines::BoundColor const &red,
+        defines::BoundColor const &green,
+        defines::BoundColor const &blue )
+{
+    std::uint32_t const color = std::uint32_t ( red ) << 16
+                              | std::uint32_t ( green ) << 8 | blue;
+    if ( slots [ slot ] == color )
+    {
+        return false;
+    }
+    slots [ slot ] = color;
+    // TODO #63 This code works on VS-Code's integrated terminal to its
+    // full effect, but for some reason fails on the Windows Terminal.
+    out += "\u001b]";
+    out += defines::paletteChangePrefix;
+    // one digit, which reads the same in hex and decimal.
+    out += char ( '0' + slot );
+    out += defines::paletteChangeSpecif;
+    appendHexByte ( out, red );
+    out += defines::paletteChangeDelimt;
+    appendHexByte ( out, green );
+    out += defines::paletteChangeDelimt;
+    appendHexByte ( out, blue );
+    out += "\u001b\\";
+    return true;
+}
+
+void io::console::internal::Palette::forget ( ) noexcept
+{
+    std::fill ( std::begin ( slots ), std::end ( slots ), unsent );
+}
+
+bool testPalette ( std::ostream &stream )
+{
+    using namespace io::console::internal;
+    stream << "Beginning palette unittest.\n";
+    stream << "Ensuring that bytes format as two hex digits...\n";
+    std::string hex;
+    for ( std::uint8_t const byte : { 0x00, 0x07, 0xa0, 0x3c, 0xff } )
+    {
+        appendHexByte ( hex, byte );
+    }
+    if ( hex != "0007a03cff" )
+    {
+        BASIC_UNIT_FAIL ( stream, "Bytes formatted as \"" << hex << "\"" )
+    }
+
+    stream << "Ensuring that a slot goes out only when it changes...\n";
+    Palette     palette;
+    std::string out;
+    if ( !palette.change ( out, 1, 0xff, 0x00, 0x80 ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "The first color did not go out" )
+    }
+    std::string const expected = std::string ( "\u001b]" )
+                               + defines::paletteChangePrefix + "1"
+                               + defines::paletteChangeSpecif + "ff"
+                               + defines::paletteChangeDelimt + "00"
+                               + defines::paletteChangeDelimt + "80"
+                               + "\u001b\\";
+    if ( out != expected )
+    {
+        BASIC_UNIT_FAIL ( stream,
+                          "Got \"" << out.substr ( 1 ) << "\" instead of \""
+                                   << expected.substr ( 1 ) << "\"" )
+    }
+    out.clear ( );
+    if ( palette.change ( out, 1, 0xff, 0x00, 0x80 ) || !out.empty ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "An unchanged slot went out again" )
+    }
+    if ( !palette.change ( out, 2, 0xff, 0x00, 0x80 )
+         || !palette.change ( out, 1, 0xff, 0x00, 0x81 ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "A changed slot did not go out" )
+    }
+    palette.forget ( );
+    if ( !palette.change ( out, 1, 0xff, 0x00, 0x81 ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "A forgotten slot did not go out" )
+    }
+    return true;
+}
+
+test::Unittest paletteTest { &testPalette };
@@ -0,0 +1,57 @@
+/**
+ * @file palette.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief What the terminal's palette was last set to
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <defines/constants.h++>
+#include <defines/types.h++>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace io::console::internal
+{
+    /**
+     * @brief Appends the byte as two lowercase hex digits.
+     */
+    void appendHexByte ( std::string &, std::uint8_t const & );
+
+    /**
+     * @brief The colors the terminal's palette was last told to show, so
+     * that a color only goes out when it changes.
+     *
+     */
+    class Palette
+    {
+        // each slot as 0xRRGGBB, or unsent if the terminal's is not known.
+        static constexpr std::uint32_t unsent = 0xffffffff;
+        std::uint32_t slots [ defines::consolePaletteLength ];
+    public:
+        Palette ( ) noexcept;
+
+        /**
+         * @brief Appends the command that sets the slot to the color, unless
+         * the slot already shows it.
+         *
+         * @return whether anything was appended.
+         */
+        bool change ( std::string               &out,
+                      std::size_t const         &slot,
+                      defines::BoundColor const &red,
+                      defines::BoundColor const &green,
+                      defines::BoundColor const &blue );
+        /**
+         * @brief Forgets every slot, so that each goes out on its next change.
+         */
+        void forget ( ) noexcept;
+    };
+} // namespace io::console::internal
@@ -0,0 +1,473 @@
+/**
+ * @file sgr.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of the SGR encoder
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/console/internal/sgr.h++>
+
+#include <defines/constants.h++>
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <io/console/backend.h++>
+#include <io/console/internal/downconvert.h++>
+#include <test/unittester.h++>
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+using io::console::internal::Pen;
+using io::console::internal::sgrAttributes;
+using io::console::internal::sgrBit;
+using io::console::internal::sgrFonts;
+
+/**
+ * @brief A code that turns attributes off, and the attributes it turns off.
+ */
+struct SGROff
+{
+    std::uint8_t  code;
+    std::uint32_t clears;
+};
+
+constexpr SGROff sgrOffs [] = {
+        {10, sgrFonts                                                        },
+        { 22, sgrBit ( 1 ) | sgrBit ( 2 )                                    },
+        { 23, sgrBit ( 3 ) | sgrBit ( 20 )                                   },
+        { 24, sgrBit ( 4 ) | sgrBit ( 21 )                                   },
+        { 25, sgrBit ( 5 ) | sgrBit ( 6 )                                    },
+        { 27, sgrBit ( 7 )                                                   },
+        { 28, sgrBit ( 8 )                                                   },
+        { 29, sgrBit ( 9 )                                                   },
+        { 50, sgrBit ( 26 )                                                  },
+        { 54, sgrBit ( 51 ) | sgrBit ( 52 )                                  },
+        { 55, sgrBit ( 53 )                                                  },
+        { 65,
+         sgrBit ( 60 ) | sgrBit ( 61 ) | sgrBit ( 62 ) | sgrBit ( 63 )
+                  | sgrBit ( 64 )                                            },
+};
+
+/**
+ * @brief Appends a parameter to those already in the string.
+ */
+void appendSGRParameter ( std::string &out, std::uint32_t value )
+{
+    char        digits [ 10 ];
+    std::size_t count = 0;
+    do {
+        digits [ count++ ] = char ( '0' + value % 10 );
+        value /= 10;
+    } while ( value );
+    if ( !out.empty ( ) )
+    {
+        out += ';';
+    }
+    while ( count )
+    {
+        out += digits [ --count ];
+    }
+}
+
+/**
+ * @brief Appends the parameters that select the color, where base is 30 for
+ * the foreground and 40 for the background.
+ */
+void appendSGRColor ( std::string         &out,
+                      std::uint32_t const &color,
+                      std::uint32_t const &base )
+{
+    std::uint32_t const kind = color & 0xff;
+    if ( kind < 8 )
+    {
+        appendSGRParameter ( out, base + kind );
+    } else if ( kind == 8 )
+    {
+        appendSGRParameter ( out, base + 9 );
+    } else if ( kind == 9 && ( color >> 8 & 0xf8 ) == 8 )
+    {
+        // the bright colors, which every terminal that has them can take
+        // without the 256-color palette.
+        appendSGRParameter ( out, base + 60 + ( ( color >> 8 ) & 7 ) );
+    } else if ( kind == 9 )
+    {
+        appendSGRParameter ( out, base + 8 );
+        appendSGRParameter ( out, 5 );
+        appendSGRParameter ( out, ( color >> 8 ) & 0xff );
+    } else
+    {
+        appendSGRParameter ( out, base + 8 );
+        appendSGRParameter ( out, 2 );
+        appendSGRParameter ( out, ( color >> 24 ) & 0xff );
+        appendSGRParameter ( out, ( color >> 16 ) & 0xff );
+        appendSGRParameter ( out, ( color >> 8 ) & 0xff );
+    }
+}
+
+/**
+ * @brief The parameters that take a reset terminal to the pen.
+ */
+std::string sgrParameters ( Pen const &pen )
+{
+    std::string out;
+    for ( std::size_t i = 0; i < std::size ( sgrAttributes ); i++ )
+    {
+        if ( pen.attributes & ( std::uint32_t ( 1 ) << i ) )
+        {
+            appendSGRParameter ( out, sgrAttributes [ i ] );
+        }
+    }
+    if ( pen.foreground != 8 )
+    {
+        appendSGRColor ( out, pen.foreground, 30 );
+    }
+    if ( pen.background != 8 )
+    {
+        appendSGRColor ( out, pen.background, 40 );
+    }
+    return out;
+}
+
+void io::console::internal::Pen::set ( std::uint32_t const &code,
+                                       bool const          &value ) noexcept
+{
+    if ( code == 0 )
+    {
+        if ( value )
+        {
+            *this = Pen ( );
+        }
+        return;
+    }
+    if ( std::uint32_t const bit = sgrBit ( code ) )
+    {
+        if ( value && ( bit & sgrFonts ) )
+        {
+            attributes &= ~sgrFonts;
+        }
+        attributes = value ? attributes | bit : attributes & ~bit;
+        return;
+    }
+    for ( auto const &off : sgrOffs )
+    {
+        if ( off.code == code )
+        {
+            if ( value )
+            {
+                attributes &= ~off.clears;
+            }
+            return;
+        }
+    }
+    // the colors, where turning one off that is not in use does nothing.
+    auto color = [ & ] ( std::uint32_t &which, std::uint32_t const &base ) {
+        if ( code >= base && code < base + 8 )
+        {
+            if ( value )
+            {
+                which = code - base;
+            } else if ( which == code - base )
+            {
+                which = 8;
+            }
+        } else if ( code >= base + 60 && code < base + 68 )
+        {
+            std::uint32_t const bright = ( code - base - 60 + 8 ) << 8 | 9;
+            if ( value )
+            {
+                which = bright;
+            } else if ( which == bright )
+            {
+                which = 8;
+            }
+        } else if ( code == base + 9 && value )
+        {
+            which = 8;
+        }
+    };
+    color ( foreground, 30 );
+    color ( background, 40 );
+}
+
+bool io::console::internal::Pen::apply (
+        std::string_view const &parameters ) noexcept
+{
+    // enough for any sequence this sends and most that anything else does.
+    std::array< std::uint32_t, 32 > codes;
+    std::size_t                     count = 1;
+    codes [ 0 ]                           = 0;
+    for ( char const &c : parameters )
+    {
+        if ( c == ';' )
+        {
+            if ( count == codes.size ( ) )
+            {
+                return false;
+            }
+            codes [ count++ ] = 0;
+        } else if ( c >= '0' && c <= '9' )
+        {
+            codes [ count - 1 ] =
+                    std::min< std::uint32_t > ( codes [ count - 1 ] * 10
+                                                        + ( c - '0' ),
+                                                0xffff );
+        } else
+        {
+            return false;
+        }
+    }
+    Pen result = *this;
+    for ( std::size_t i = 0; i < count; i++ )
+    {
+        std::uint32_t const code = codes [ i ];
+        if ( code == 38 || code == 48 )
+        {
+            std::uint32_t color;
+            if ( i + 2 < count && codes [ i + 1 ] == 5 )
+            {
+                color = 9 | ( codes [ i + 2 ] & 0xff ) << 8;
+                i += 2;
+            } else if ( i + 4 < count && codes [ i + 1 ] == 2 )
+            {
+                color = 10 | ( codes [ i + 2 ] & 0xff ) << 24
+                      | ( codes [ i + 3 ] & 0xff ) << 16
+                      | ( codes [ i + 4 ] & 0xff ) << 8;
+                i += 4;
+            } else
+            {
+                return false;
+            }
+            ( code == 38 ? result.foreground : result.background ) = color;
+        } else
+        {
+            result.set ( code, true );
+        }
+    }
+    *this = result;
+    return true;
+}
+
+std::uint32_t io::console::internal::canonicalColor (
+        std::uint32_t const &color ) noexcept
+{
+    std::uint32_t const kind = color & 0xff;
+    if ( kind <= 8 )
+    {
+        return kind;
+    } else if ( kind == 9 )
+    {
+        return color & 0xffff;
+    } else
+    {
+        return ( color & 0xffffff00 ) | 10;
+    }
+}
+
+void io::console::internal::appendPen ( std::string      &out,
+                                        Pen const        &pen,
+                                        ColorDepth const &depth )
+{
+    std::string const parameters =
+            sgrParameters ( downconvert ( pen, depth ) );
+    out += parameters.empty ( ) ? "\u001b[m" : "\u001b[0;" + parameters + "m";
+}
+
+void io::console::internal::appendTransition ( std::string      &out,
+                                               Pen const        &wasFrom,
+                                               Pen const        &wasTo,
+                                               ColorDepth const &depth )
+{
+    Pen const from = downconvert ( wasFrom, depth );
+    Pen const to   = downconvert ( wasTo, depth );
+    if ( from == to )
+    {
+        return;
+    }
+    std::string   changes;
+    std::uint32_t on  = to.attributes & ~from.attributes;
+    std::uint32_t off = from.attributes & ~to.attributes;
+    // a new font replaces the old one by itself.
+    if ( to.attributes & sgrFonts )
+    {
+        off &= ~sgrFonts;
+    }
+    for ( auto const &[ code, clears ] : sgrOffs )
+    {
+        if ( off & clears )
+        {
+            appendSGRParameter ( changes, code );
+            // what it turns off that should stay on goes back on.
+            on |= to.attributes & clears;
+        }
+    }
+    for ( std::size_t i = 0; i < std::size ( sgrAttributes ); i++ )
+    {
+        if ( on & ( std::uint32_t ( 1 ) << i ) )
+        {
+            appendSGRParameter ( changes, sgrAttributes [ i ] );
+        }
+    }
+    if ( from.foreground != to.foreground )
+    {
+        appendSGRColor ( changes, to.foreground, 30 );
+    }
+    if ( from.background != to.background )
+    {
+        appendSGRColor ( changes, to.background, 40 );
+    }
+    std::string const everything = sgrParameters ( to );
+    // a reset is one parameter, plus a separator if anything follows it.
+    std::size_t const resetSize =
+            everything.empty ( ) ? 0 : everything.size ( ) + 2;
+    if ( resetSize < changes.size ( ) )
+    {
+        appendPen ( out, to );
+    } else
+    {
+        out += "\u001b[" + changes + "m";
+    }
+}
+
+bool testSGR ( std::ostream &stream )
+{
+    using namespace io::console::internal;
+    stream << "Beginning SGR encoder unittest.\n";
+    auto transition = [ & ] ( Pen const        &from,
+                              Pen const        &to,
+                              io::console::ColorDepth const &depth =
+                                      io::console::ColorDepth::TRUECOLOR ) {
+        std::string out;
+        appendTransition ( out, from, to, depth );
+        return out;
+    };
+    Pen plain;
+    Pen bold;
+    bold.set ( 1, true );
+    Pen boldItalic = bold;
+    boldItalic.set ( 3, true );
+    Pen faint;
+    faint.set ( 2, true );
+    Pen boldFaint = bold;
+    boldFaint.set ( 2, true );
+    Pen styled = faint;
+    styled.set ( 3, true );
+    styled.set ( 4, true );
+    Pen boldStyled = styled;
+    boldStyled.set ( 1, true );
+    Pen fontOne;
+    fontOne.set ( 11, true );
+    Pen fontTwo = fontOne;
+    fontTwo.set ( 12, true );
+    Pen colored;
+    colored.foreground = canonicalColor ( 0x0102030a );
+    colored.background = canonicalColor ( 0x00002a09 );
+    Pen bright;
+    bright.foreground = 0x0909;
+    bright.background = 0x0f09;
+    Pen vivid;
+    vivid.foreground = 0xff00000a;
+    vivid.background = 0x00ff000a;
+
+    stream << "Ensuring that transitions take the shortest way...\n";
+    Pen boldFont = fontTwo;
+    boldFont.set ( 1, true );
+    std::pair< std::string, std::string > const expected [] = {
+            { transition ( plain, boldItalic ), "\u001b[1;3m" },
+            { transition ( bold, boldItalic ), "\u001b[3m" },
+            { transition ( boldFaint, faint ), "\u001b[0;2m" },
+            { transition ( boldStyled, styled ), "\u001b[22;2m" },
+            { transition ( fontOne, fontTwo ), "\u001b[12m" },
+            { transition ( boldFont, bold ), "\u001b[10m" },
+            { transition ( fontTwo, plain ), "\u001b[m" },
+            { transition ( boldItalic, plain ), "\u001b[m" },
+            { transition ( plain, colored ), "\u001b[38;2;1;2;3;48;5;42m" },
+            { transition ( colored, colored ), "" },
+            { transition ( plain, bright ), "\u001b[91;107m" },
+            { transition ( plain, vivid, io::console::ColorDepth::SIXTEEN ),
+              "\u001b[91;102m" },
+            { transition ( plain, vivid, io::console::ColorDepth::EIGHT ),
+              "\u001b[31;42m" },
+            { transition ( bright, vivid, io::console::ColorDepth::EIGHT ),
+              "\u001b[42m" },
+    };
+    for ( auto const &[ got, want ] : expected )
+    {
+        if ( got != want )
+        {
+            BASIC_UNIT_FAIL ( stream,
+                              "Expected \"" << want.substr ( 1 )
+                                            << "\" but got \""
+                                            << got.substr ( 1 ) << "\"" )
+        }
+    }
+
+    stream << "Ensuring that parameters apply as a terminal would...\n";
+    Pen parsed = boldItalic;
+    if ( !parsed.apply ( "4;38;5;200;23" ) || parsed.attributes != (
+                 sgrBit ( 1 ) | sgrBit ( 4 ) ) || parsed.foreground != 0xc809 )
+    {
+        BASIC_UNIT_FAIL ( stream, "Parameters applied wrongly" )
+    }
+    if ( !parsed.apply ( "" ) || !( parsed == plain ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Empty parameters did not reset the pen" )
+    }
+    if ( parsed.apply ( "?1" ) || parsed.apply ( "38;2;1" ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Parameters were wrongly understood" )
+    }
+    if ( !parsed.apply ( "91;107" ) || !( parsed == bright ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Bright colors applied wrongly" )
+    }
+
+    stream << "Ensuring that transitions between random pens arrive...\n";
+    std::mt19937        random ( 14 );
+    std::uint32_t const colors [] = { 0, 3, 7, 8, 0x2a09, 0x0c09, 0x1020300a };
+    auto                randomPen = [ & ] ( ) {
+        Pen pen;
+        for ( std::size_t i = random ( ) % 6; i; i-- )
+        {
+            std::size_t const which = random ( ) % std::size ( sgrAttributes );
+            pen.set ( sgrAttributes [ which ], true );
+        }
+        pen.foreground = colors [ random ( ) % std::size ( colors ) ];
+        pen.background = colors [ random ( ) % std::size ( colors ) ];
+        return pen;
+    };
+    for ( std::size_t i = 0; i < 0x4000; i++ )
+    {
+        auto const  depth = io::console::ColorDepth ( i % 4 );
+        Pen const   from  = randomPen ( );
+        Pen const   to    = randomPen ( );
+        std::string out   = transition ( from, to, depth );
+        std::string full;
+        appendPen ( full, to, depth );
+        // the terminal is only ever left with colors it has.
+        Pen arrived = downconvert ( from, depth );
+        if ( !out.empty ( )
+             && !arrived.apply ( std::string_view ( out ).substr (
+                     2,
+                     out.size ( ) - 3 ) ) )
+        {
+            BASIC_UNIT_FAIL ( stream, "A transition was not understood" )
+        }
+        if ( !( arrived == downconvert ( to, depth ) )
+             || out.size ( ) > full.size ( ) )
+        {
+            BASIC_UNIT_FAIL ( stream, "The transition \"" << out.substr ( 1 )
+                                                           << "\" is wrong" )
+        }
+    }
+    return true;
+}
+
+test::Unittest sgrTest { &testSGR };
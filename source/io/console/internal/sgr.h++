@@ -0,0 +1,116 @@
+/**
+ * @file sgr.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Attribute state and the SGR sequences that move between states
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <io/console/backend.h++>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+namespace io::console::internal
+{
+    /**
+     * @brief The SGR codes that turn an attribute on, in the order of their
+     * bits in a pen's attributes.
+     */
+    constexpr std::uint8_t sgrAttributes [] = {
+            1,  2,  3,  4,  5,  6,  7,  8,  9,  11, 12, 13, 14, 15,
+            16, 17, 18, 19, 20, 21, 26, 51, 52, 53, 60, 61, 62, 63, 64,
+    };
+
+    /**
+     * @brief The bit that stands for the SGR code in a pen's attributes, or
+     * zero if the code does not turn an attribute on.
+     */
+    constexpr std::uint32_t sgrBit ( std::uint32_t const &code ) noexcept
+    {
+        for ( std::size_t i = 0; i < std::size ( sgrAttributes ); i++ )
+        {
+            if ( sgrAttributes [ i ] == code )
+            {
+                return std::uint32_t ( 1 ) << i;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief The alternate fonts, which replace each other.
+     */
+    constexpr std::uint32_t sgrFonts = sgrBit ( 11 ) | sgrBit ( 12 )
+                                     | sgrBit ( 13 ) | sgrBit ( 14 )
+                                     | sgrBit ( 15 ) | sgrBit ( 16 )
+                                     | sgrBit ( 17 ) | sgrBit ( 18 )
+                                     | sgrBit ( 19 );
+
+    /**
+     * @brief The attributes and colors that text goes out with.
+     *
+     */
+    struct Pen
+    {
+        // which of the codes in sgrAttributes are on.
+        std::uint32_t attributes = 0;
+        // colors as a screen's YAML gives them: 0 through 7 for the palette,
+        // 8 for the default, 9 for the 256-color color in the second lowest
+        // byte, and 10 for the true color in the upper three bytes.
+        std::uint32_t foreground = 8;
+        std::uint32_t background = 8;
+
+        bool operator== ( Pen const & ) const noexcept = default;
+
+        /**
+         * @brief Turns a single SGR code (numbered as in SGRCommand) on or
+         * off. Turning off a code that itself turns things off, such as
+         * normal intensity, does nothing. The bright colors from 90 and 100
+         * on are the 256-color colors 8 through 15. Codes that are not
+         * attributes or one of the CGA, bright or default colors are ignored.
+         */
+        void set ( std::uint32_t const &code, bool const &value ) noexcept;
+        /**
+         * @brief Does what a terminal does with the parameters of an SGR
+         * sequence, that is, the part between "ESC [" and "m".
+         *
+         * @return false, leaving the pen as it was, if the parameters are not
+         * ones this understands.
+         */
+        bool apply ( std::string_view const &parameters ) noexcept;
+    };
+
+    /**
+     * @brief Gives each color one representation, so that two pens that
+     * look the same compare the same.
+     */
+    std::uint32_t canonicalColor ( std::uint32_t const & ) noexcept;
+
+    /**
+     * @brief Appends a sequence that sets the pen whatever state the terminal
+     * is in: a reset followed by everything the pen has, with its colors
+     * brought down to the depth.
+     */
+    void appendPen ( std::string &,
+                     Pen const &,
+                     ColorDepth const & = ColorDepth::TRUECOLOR );
+    /**
+     * @brief Appends the shortest sequence that takes the terminal from one
+     * pen to the other, which is nothing when they match at the depth.
+     */
+    void appendTransition ( std::string &,
+                            Pen const        &from,
+                            Pen const        &to,
+                            ColorDepth const &depth = ColorDepth::TRUECOLOR );
+} // namespace io::console::internal
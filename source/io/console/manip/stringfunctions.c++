@@ -12,6 +12,7 @@
 
 #include <io/console/manip/stringfunctions.h++>
 
+#include <io/console/manip/tokenizer.h++>
 #include <io/unicode/character.h++>
 
 #include <defines/constants.h++>
@@ -22,306 +23,218 @@
 
 #include <io/base/syncstream.h++>
 
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
+#include <random>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
+// x86-64 always has SSE2. AVX2 is only used when the processor running the
+// program has it.
+#if defined( __GNUC__ ) && defined( __x86_64__ )
+#    define MANIP_SSE2
+#    define MANIP_AVX2
+#    include <immintrin.h>
+#endif
+
 using io::unicode::BreakingProperties;
 using io::unicode::CharacterProperties;
 using io::unicode::characterProperties;
 
 using namespace io::console::manip;
 
-/**
- * @brief Type of a code point.
- *
- */
-enum class CodePointType
-{
-    TERMINAL, // ansi escape sequence or control character, [0x00 - 0x20]
-    UTF1BYTE, // one byte utf-8 starts with [0x20 - 0x7f]
-    UTF2BYTE, // two byte utf-8 starts with [0xC0 - 0xDF]
-    UTF3BYTE, // three byte utf-8 starts with [0xE0 - 0xEf]
-    UTF4BYTE, // four byte utf-8 starts with [0xF0 - 0xF8]
-    UTFNBYTE, // unknown, but it's probably unicode? perhaps 5-byte?
-    INVALID_, // we know we errored out and found a character we know to be
-              // invalid. includes characters outside the range of unicode.
-    _MAX,     // maximum value
-};
-
 std::size_t const utf8SequenceLength ( defines::ChrPString const );
 
 /**
  * @brief Identifies what CodePointType the first character of a sequence is
- * @note This function might need to be removed? Lots of changes happened
- * recently in the IO system.
  * @param string the string
  * @return A CodePointType corresponding to the code point.
  */
 CodePointType identifyFirst ( defines::ChrString const &string )
 {
-    defines::U32Char total = 0;
-    try
+    // stop at the first null, like widen does.
+    return readCodePoint ( std::string_view ( string.c_str ( ) ) ).type;
+}
+
+io::console::manip::CodePoint
+        io::console::manip::readCodePoint ( std::string_view const &text )
+{
+    CodePoint result;
+    if ( text.empty ( ) )
     {
-        total = widen ( string.c_str ( ) );
-    } catch ( std::runtime_error &notReallyAnError )
+        // an empty string reads like the null that ends a C-string.
+        return result;
+    }
+    unsigned const front = ( unsigned char ) text.front ( );
+    result.value         = front;
+    result.bytes         = text.substr ( 0, 1 );
+    result.type          = CodePointType::INVALID_;
+
+    if ( front <= ( unsigned char ) defines::maximumASCII )
     {
-        return CodePointType::INVALID_;
+        // characters before space are all control characters
+        if ( front < ( unsigned char ) defines::space )
+        {
+            result.type = CodePointType::TERMINAL;
+            if ( front == '\u001b' )
+            {
+                result.bytes = text.substr ( 0, sequenceLength ( text ) );
+            }
+        } else
+        {
+            result.type = CodePointType::UTF1BYTE;
+        }
+        return result;
     }
 
     std::size_t length = 0;
-    try
+    if ( front < ( unsigned char ) defines::minimumTwoByte )
     {
-        length = utf8SequenceLength ( string.c_str ( ) );
-    } catch ( std::runtime_error &notReallyAnError )
+        // unexpected following byte or overlong encoding
+        return result;
+    } else if ( front < ( unsigned char ) defines::minimumThreeByte )
+    {
+        length = 2;
+        result.value &= ~( unsigned char ) defines::minimumThreeByte;
+    } else if ( front < ( unsigned char ) defines::minimumFourByte )
+    {
+        length = 3;
+        result.value &= ~( unsigned char ) defines::minimumFourByte;
+    } else if ( front <= ( unsigned char ) defines::maximumFirstByte )
+    {
+        length = 4;
+        result.value &= ~( unsigned char ) defines::fourByteMask;
+    } else
+    {
+        // UTF out of range
+        return result;
+    }
+    if ( text.size ( ) < length )
     {
-        return CodePointType::INVALID_;
+        // string too short
+        result.value = front;
+        return result;
+    }
+    for ( std::size_t i = 1; i < length; i++ )
+    {
+        unsigned following = ( unsigned char ) text [ i ];
+        // if the character is not a valid following byte, the sequence is
+        // invalid.
+        if ( following > ( unsigned char ) defines::maximumFollowing
+             || following <= ( unsigned char ) defines::maximumASCII )
+        {
+            result.value = front;
+            return result;
+        }
+        result.value <<= 6;
+        result.value += following & ~( unsigned char ) defines::firstTwoByte;
     }
 
+    CodePointType type = CodePointType::INVALID_;
     switch ( length )
     {
-        case 1:
-            // characters before space are all control characters
-            if ( total < defines::space )
-            {
-                return CodePointType::TERMINAL;
-            } else
-            { // if it's not a control character...
-                return CodePointType::UTF1BYTE;
-            }
-        case 2:
-            if ( total <= ( unsigned char ) defines::maximumASCII )
-            {
-                // overlong encodings (when it can be made shorter) are
-                // officially an error condition
-                return CodePointType::INVALID_;
-            } else
-            {
-                // valid UTF-8 sequence (two bytes)
-                return CodePointType::UTF2BYTE;
-            }
+        case 2: type = CodePointType::UTF2BYTE; break;
         case 3:
-            if ( total < defines::maximumTwoByteEncoded )
-            {
-                // overlong encoding (it can be made shorter). Which makes this
-                // sequence illegal.
-                return CodePointType::INVALID_;
-            } else if ( total >= defines::ucs2Deadzone [ 0 ]
-                        && total <= defines::ucs2Deadzone [ 1 ] )
-            {
-                // invalid UTF-8 encoding because we cannot express it in
-                // UTF-16.
-                return CodePointType::INVALID_;
-            } else
+            // overlong encodings (when it can be made shorter) are officially
+            // an error condition, as are the code points UTF-16 cannot express
+            if ( result.value >= defines::maximumTwoByteEncoded
+                 && ( result.value < defines::ucs2Deadzone [ 0 ]
+                      || result.value > defines::ucs2Deadzone [ 1 ] ) )
             {
-                // valid UTF-8 sequence (three bytes)
-                return CodePointType::UTF3BYTE;
+                type = CodePointType::UTF3BYTE;
             }
+            break;
         case 4:
-            if ( total < defines::maximumThreeByteEncoded )
-            {
-                // overlong encoding -- we can make it shorter.
-                return CodePointType::INVALID_;
-            } else if ( total > defines::maxUnicode )
-            {
-                // out of bounds. Since UTF-16 has a maximum value of
-                // defines::maxUnicode, we cannot support this character.
-                return CodePointType::INVALID_;
-            } else
+            // overlong or out of the bounds of unicode.
+            if ( result.value >= defines::maximumThreeByteEncoded
+                 && result.value <= defines::maxUnicode )
             {
-                // valid 4-byte UTF-8 sequence
-                return CodePointType::UTF4BYTE;
+                type = CodePointType::UTF4BYTE;
             }
-            // we fell through somehow because we got a length outside the
-            // range [1, 4]. This is an error condition -- so we'll describe the
-            // character as invalid
-        default: return CodePointType::INVALID_;
+            break;
+        default: break;
     }
-}
-/**
- * @brief Whether a character ends a variable-length ESC sequence.
- * @note the variable length sequences are:
- *  - SOS (Start Of String)
- *  - OSC (Operating System Command)
- *  - APC (Application Program Command)
- *  - PM ( Privacy Message).
- * However, this function should only be dealing with OSC, as most of
- * our sequences are Control Sequences or an Operating System Command to change
- * the pallette
- * @param character the character to check against
- * @return true when the character ends the sequence
- * @return false when the character does not end the sequence
- */
-bool endsVariableLengthCode ( defines::ChrChar const &character )
-{
-    // if the character is outside the range [0x09, 0x7E]
-    if ( character < 0x08 || character >= defines::maximumASCII )
-    {
-        return true;
-        // if the character is a control character and greater than 0x0D
-    } else if ( character < defines::space && character > '\x0d' )
+    if ( type == CodePointType::INVALID_ )
     {
-        return true;
-    } else
-    {
-        // if the character satisfies none of the requirements, it does not end
-        // the sequence
-        return false;
+        result.value = front;
+        return result;
     }
+    result.type  = type;
+    result.bytes = text.substr ( 0, length );
+    return result;
 }
-/**
- * @brief If the character ends specifically a CSI sequence.
- *
- * @param character the character to check against
- * @return true ends a CSI sequence
- * @return false does not end a CSI sequence
- */
-bool endsCSI ( defines::ChrChar const &character )
+
+static_assert ( std::forward_iterator< CodePointIterator > );
+
+io::console::manip::CodePointIterator::CodePointIterator (
+        std::string_view const &text ) :
+        rest ( text )
 {
-    // if our character is an alphabetic character
-    // or one if @, [, ], _, /, etc.
-    // the characters which end CSI continue from the @ sign to the ~, which
-    // is right before the last character (tilde is 0x7E, ascii ends at 0x7F)
-    return character >= '@' && character < defines::maximumASCII;
+    read ( );
 }
 
-/**
- * @brief (Destructively) Grabs the first code point of a given string
- * @note Takes at least one character. Given the nature of terminal sequences,
- * there is no upper bound on the amount of characters  taken.
- * @throw std::runtime_error if the sequence seems to be a unicode sequence, but
- * has an indication of being longer than four bytes
- * @throw std::runtime_error if the character sequence is invalid.
- * @throw std::runtime_error if the sequence is a private-use sequence
- * @param string the string to grab from
- * @return the first code point
- */
-defines::ChrString grabCodePoint ( defines::ChrString &string )
+void io::console::manip::CodePointIterator::read ( )
 {
-    // our return value
-    defines::ChrString result       = CHR_STRINGIZE ( );
-    // anticipated error message.
-    defines::ChrString errorMessage = "Unknown (UTF-8?) Sequence!";
-    switch ( identifyFirst ( string ) )
+    if ( rest.empty ( ) )
+    {
+        // compares equal to the default-constructed (end) iterator
+        current = CodePoint ( );
+        return;
+    }
+    current = readCodePoint ( rest );
+    switch ( current.type )
     {
         case CodePointType::INVALID_:
-            // change the error message to reflect the actual error and fall
-            // through to the next case, where we throw the runtime error
-            errorMessage = "Invalid Character Sequence!";
         case CodePointType::UTFNBYTE:
-            RUNTIME_ERROR ( errorMessage,
-                            ": in decimal, U+",
-                            widen ( string.c_str ( ) ),
-                            ", \"",
-                            string.substr ( 0, 4 ),
-                            "\"" );
+            RUNTIME_ERROR ( "Invalid Character Sequence!",
+                            ": 0x" << std::hex
+                                   << std::uint32_t ( current.value ) << ", \""
+                                   << rest.substr ( 0, 4 ) << "\"" )
         case CodePointType::TERMINAL:
-            // process the escape sequence.
-            result += string.front ( );
-            string = string.substr ( 1 );
-            // check for an escape sequence.
-            if ( result.starts_with ( '\u001b' ) )
+            // PU1 and PU2 are subject to prior agreement on meaning between us
+            // and the terminal. We can't know the length here without more
+            // documentation on the windows / linux terminals.
+            if ( current.bytes.starts_with ( "\u001bQ" )
+                 || current.bytes.starts_with ( "\u001bR" ) )
             {
-                result += string.front ( );
-                string = string.substr ( 1 );
-                // what type of sequence do we have?
-                // some are only two bytes long (incl. esc)
-                // others can be infinitely long.
-                switch ( result.back ( ) )
-                {
-                        // SS2 and SS3 require one more character. Exactly one
-                        // more character (as the name "single shift" implies)
-                    case 'N': // ss2
-                    case 'O': // ss3
-                        result += string.front ( );
-                        string = string.substr ( 1 );
-                        break;
-                        // PU1 and PU2 are subject to prior agreement on meaning
-                        // between us and the terminal. We can't know the length
-                        // here without more documentation on the windows /
-                        // linux terminals.
-                    case 'Q':
-                    case 'R':
-                        RUNTIME_ERROR (
-                                "Encountered Private Use Sequence (don't do "
-                                "that!)" )
-                        // these four commands are terminated by the string
-                        // terminator (or, on xterm and windows terminal, BEL),
-                        // and can contain the character in the range [\x08,
-                        // \x0D] U [\x20, \x7E]
-                    case 'P': // DCS
-                    case ']': // OSC
-                    case '^': // PM
-                    case '_': // APC
-                        do {
-                            if ( string.empty ( ) )
-                                break;
-                            result += string.front ( );
-                            string = string.substr ( 1 );
-                        } while (
-                                // while the result does not end with the string
-                                // terminator and while the character does not
-                                // end a variable length code.
-                                !result.ends_with ( defines::ChrString (
-                                                            { '\u001b', '\0' } )
-                                                    + defines::backwardSlash )
-                                && !endsVariableLengthCode (
-                                        result.back ( ) ) );
-                        break;
-                        // SOS is different from the four above in that it only
-                        // ends with either SOS or ST
-                    case 'X': // SOS
-                        do {
-                            if ( string.empty ( ) )
-                                break;
-                            result += string.front ( );
-                            string = string.substr ( 1 );
-                        } while (
-                                !result.ends_with ( defines::ChrString (
-                                                            { '\u001b', '\0' } )
-                                                    + "X" )
-                                && !result.ends_with (
-                                        defines::ChrString (
-                                                { '\u001b', '\0' } )
-                                        + defines::backwardSlash ) );
-                        break;
-                    case '[': // CSI
-                        // CSI can be terminated by a byte in the range [0x40,
-                        // 0x7E] the sequences that use a control character in
-                        // this range have undefined behavior, so we'll assume
-                        // that we know what we're doing and not terminate the
-                        // sequence.
-                        do {
-                            if ( string.empty ( ) )
-                                break;
-                            result += string.front ( );
-                            string = string.substr ( 1 );
-                        } while ( !endsCSI ( result.back ( ) ) );
-                        break;
-                    default: break;
-                }
+                RUNTIME_ERROR (
+                        "Encountered Private Use Sequence (don't do that!)" )
             }
             break;
-            // use implicit fallthroughs to get the right amount of characters.
-        case CodePointType::UTF4BYTE:
-            result += string.front ( );
-            string = string.substr ( 1 );
-        case CodePointType::UTF3BYTE:
-            result += string.front ( );
-            string = string.substr ( 1 );
-        case CodePointType::UTF2BYTE:
-            result += string.front ( );
-            string = string.substr ( 1 );
-        case CodePointType::UTF1BYTE:
-            result += string.front ( );
-            string = string.substr ( 1 );
         default: break;
     }
+    rest.remove_prefix ( current.bytes.size ( ) );
+}
+
+io::console::manip::CodePointIterator &
+        io::console::manip::CodePointIterator::operator++ ( )
+{
+    read ( );
+    return *this;
+}
+
+io::console::manip::CodePointIterator
+        io::console::manip::CodePointIterator::operator++ ( int )
+{
+    CodePointIterator result = *this;
+    read ( );
     return result;
 }
 
+bool io::console::manip::CodePointIterator::operator== (
+        CodePointIterator const &that ) const noexcept
+{
+    return current.bytes.data ( ) == that.current.bytes.data ( )
+        && current.bytes.size ( ) == that.current.bytes.size ( );
+}
+
 // split text by UTF-8 code point
 std::vector< defines::ChrString >
         io::console::manip::splitByCodePoint ( defines::ChrString string )
@@ -329,9 +242,9 @@ std::vector< defines::ChrString >
     // our result. Holds an empty string by default to ensure that we don't
     // accidentally attempt to make a string with nullptr.
     std::vector< defines::ChrString > result = { CHR_STRINGIZE ( ) };
-    while ( !string.empty ( ) )
+    for ( auto const &codePoint : CodePoints ( string ) )
     {
-        result.push_back ( grabCodePoint ( string ) );
+        result.emplace_back ( codePoint.bytes );
     }
     return result;
 }
@@ -358,112 +271,146 @@ std::vector< defines::ChrString >
 
 BreakingProperties getBreakingPropertiesFrom ( defines::U32Char const & );
 
+/**
+ * @brief What the rules need to know about the segment of text built so far.
+ * Kept up to date as code points are added so that no rule has to look
+ * through the segment itself.
+ */
+struct Segment
+{
+    // the last code point in the segment
+    defines::U32Char   last         = 0;
+    // the code point before the last one, or U+0000 if there is none
+    defines::U32Char   beforeLast   = 0;
+    // the class of the last code point that is not a space, or SP if there
+    // are only spaces.
+    BreakingProperties beforeSpaces = BreakingProperties::SP;
+
+    void add ( defines::U32Char const &code )
+    {
+        beforeLast    = last;
+        last          = code;
+        auto breaking = getBreakingPropertiesFrom ( code );
+        if ( breaking != BreakingProperties::SP )
+        {
+            beforeSpaces = breaking;
+        }
+    }
+};
+
 // bool ruleApplies(std::string const &line, std::string const &code)
-bool rule3Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule4Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule5Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule6Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule7Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule8Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule9Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule10Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule11Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule12Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule13Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule14Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule15Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule16Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule17Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule18Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule19Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule20Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule21Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule22Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule23Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule24Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule25Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule26Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule27Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule28Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule29Applies ( defines::ChrString const &, defines::ChrString const & );
-bool rule30Applies ( defines::ChrString const &, defines::ChrString const & );
+bool rule3Applies ( Segment const &, defines::U32Char const & );
+bool rule4Applies ( Segment const &, defines::U32Char const & );
+bool rule5Applies ( Segment const &, defines::U32Char const & );
+bool rule6Applies ( Segment const &, defines::U32Char const & );
+bool rule7Applies ( Segment const &, defines::U32Char const & );
+bool rule8Applies ( Segment const &, defines::U32Char const & );
+bool rule9Applies ( Segment const &, defines::U32Char const & );
+bool rule10Applies ( Segment const &, defines::U32Char const & );
+bool rule11Applies ( Segment const &, defines::U32Char const & );
+bool rule12Applies ( Segment const &, defines::U32Char const & );
+bool rule13Applies ( Segment const &, defines::U32Char const & );
+bool rule14Applies ( Segment const &, defines::U32Char const & );
+bool rule15Applies ( Segment const &, defines::U32Char const & );
+bool rule16Applies ( Segment const &, defines::U32Char const & );
+bool rule17Applies ( Segment const &, defines::U32Char const & );
+bool rule18Applies ( Segment const &, defines::U32Char const & );
+bool rule19Applies ( Segment const &, defines::U32Char const & );
+bool rule20Applies ( Segment const &, defines::U32Char const & );
+bool rule21Applies ( Segment const &, defines::U32Char const & );
+bool rule22Applies ( Segment const &, defines::U32Char const & );
+bool rule23Applies ( Segment const &, defines::U32Char const & );
+bool rule24Applies ( Segment const &, defines::U32Char const & );
+bool rule25Applies ( Segment const &, defines::U32Char const & );
+bool rule26Applies ( Segment const &, defines::U32Char const & );
+bool rule27Applies ( Segment const &, defines::U32Char const & );
+bool rule28Applies ( Segment const &, defines::U32Char const & );
+bool rule29Applies ( Segment const &, defines::U32Char const & );
+bool rule30Applies ( Segment const &, defines::U32Char const & );
 
 bool isBreakingPropertyTailorable ( defines::U32Char const & );
 
-void removeCodePoint ( std::vector< defines::ChrString > & );
-
+// the rules one at a time, as UAX #14 writes them. The pair table below
+// decides the same way, so this only remains to test it against.
 std::vector< defines::ChrString >
-        io::console::manip::generateTextInseperables ( defines::ChrString str )
+        inseperablesByRules ( defines::ChrString const &str )
 {
-    // output lines. Contains an empty string to ensure that we never try to
-    // initialize a string with nullptr.
-    std::vector< defines::ChrString > output     = { CHR_STRINGIZE ( ) };
-    std::vector< defines::ChrString > codePoints = splitByCodePoint ( str );
+    std::vector< defines::ChrString > output;
+    CodePoints                        codePoints ( str );
+    auto                              codePoint = codePoints.begin ( );
+    if ( codePoint == codePoints.end ( ) )
+    {
+        return output;
+    }
+    Segment segment;
+    // the code point at codePoint starts a new element
+    auto breakBefore = [ & ] ( ) {
+        output.emplace_back ( codePoint->bytes );
+        segment = Segment ( );
+        segment.add ( codePoint->value );
+    };
+    // the code point at codePoint joins the last element
+    auto join = [ & ] ( ) {
+        output.back ( ).append ( codePoint->bytes );
+        segment.add ( codePoint->value );
+    };
     // rule 1: never break at start of text. Add a new element
     // which simply contains the first code point.
-    output.push_back ( codePoints.front ( ) );
-    removeCodePoint ( codePoints );
-    while ( !codePoints.empty ( ) )
+    breakBefore ( );
+    for ( codePoint++; codePoint != codePoints.end ( ); codePoint++ )
     {
+        defines::U32Char const &code = codePoint->value;
         // our line breaking routine
         // rule 3: always break after hard line breaks
-        if ( rule3Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule3Applies ( segment, code ) )
         {
             // line break. Add a new element.
-            output.push_back ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            breakBefore ( );
             continue;
         }
         // rule 4: CRLF, CR, LF, and NL are also hard line breaks
-        if ( rule4Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule4Applies ( segment, code ) )
         {
             // line break. Add a new element
-            output.push_back ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            breakBefore ( );
             continue;
         }
         // rule 5: do not break before hard line breaks
-        if ( rule5Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule5Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 6: Do not break before spaces or zero width spacce
-        if ( rule6Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule6Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 7: break before any character following a zero-width space, even
         // if one or more spaces intervene unless the zero-width space is a ZWJ
-        if ( rule7Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule7Applies ( segment, code ) )
         {
-            output.push_back ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            breakBefore ( );
             continue;
         }
         // rule 8: do not break a character in a combining sequence, treat ZWJ
         // as CM
-        if ( rule8Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule8Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 10: do not break before or after WJ
-        if ( rule10Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule10Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 11: Do not break after GL characters
-        if ( rule11Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule11Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // /\/\/\ non-tailorable rules / tailorable rules \/\/\/
@@ -472,142 +419,125 @@ std::vector< defines::ChrString >
 
         // rule 12: Do not break before CL, CP, EX, IS, or SY. We have tailored
         // this rule to ignore spaces. So, [ this ] allows line breaks.
-        if ( rule12Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule12Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 13: do not break after OP. We have tailored this rule to break
         // if there are spaces.
-        if ( rule13Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule13Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 14: do not break between QU and OP, we have tailored this rule
         // to break if there are spaces.
-        if ( rule14Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule14Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 15: do not break between CL | CP and NS.
-        if ( rule15Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule15Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 16: do not break within B2...B2 even with intervening spaces.
         // However, due to our own limitations, we have to eliminate this rule.
         // So. it never applies
-        if ( rule16Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule16Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 17: break after spaces
-        if ( rule17Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule17Applies ( segment, code ) )
         {
-            output.push_back ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            breakBefore ( );
             continue;
         }
         // rule 18: do not break before or after quotation marks
-        if ( rule18Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule18Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 19: break before and after unresolved CB
-        if ( rule19Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule19Applies ( segment, code ) )
         {
-            output.push_back ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            breakBefore ( );
             continue;
         }
         // rule 20: do not break before BA, HY, NS, or BB
         // rule 20a: do not break after HL (HY | BA)
         // rule 20b: do not break between SY and HL
-        if ( rule20Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule20Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 21: do not break before IN
-        if ( rule21Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule21Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 22: do not break between digits and letters
         // rule 22a: do not break between numeric prefixes and letters or
         // between ideographs and numeric postfixes
-        if ( rule22Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule22Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 23: do not break between numeric prefix / postfix and letters or
         //  between letters and numeric prefix / postfix
-        if ( rule23Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule23Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 24: do not break between the following
         // pairs of classes: CL PO, CP PO, CL PR, CP PR, NU PO, NO PR, PO OP, PO
         // NU, PR OP, PR NU, HY NU, IS NU, NU NU, SY NU
-        if ( rule24Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule24Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 25: do not break korean syllables: JL (JL | JV | H2 | H3 ) or
         // (JV | H2) (JV | JT) or (JT | H3) JT
-        if ( rule25Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule25Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 9: Any and all remaining ZWJ / CM are AL
         // rule 27: do not break between alphabetics (AL|HL)(AL|HL)
-        if ( rule27Applies ( output.back ( ), codePoints.front ( ) )
-             || ( rule9Applies ( output.back ( ), codePoints.front ( ) ) ) )
+        if ( rule27Applies ( segment, code )
+             || ( rule9Applies ( segment, code ) ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 26: treat an entire korean syllable as an ID character.
         // rule 28: do not break between numeric punctuation and alphabetics
         // IS(AL|HL)
-        if ( rule26Applies ( output.back ( ), codePoints.front ( ) )
-             || rule28Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule26Applies ( segment, code )
+             || rule28Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // rule 29: do not brek between letters, numbers, or ordinary symbols
         // and opening or closing parentheses unless the break is before an
         // east asian character or after an east asian character
         // rule 29b: do not break between emoji bases and emoji modifiers.
-        if ( rule29Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule29Applies ( segment, code ) )
         {
-            output.back ( ).append ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            join ( );
             continue;
         }
         // we don't follow rule 29a
@@ -616,10 +546,9 @@ std::vector< defines::ChrString >
         // position of the break.
 
         // rule 30: if no other rules apply, break
-        if ( rule30Applies ( output.back ( ), codePoints.front ( ) ) )
+        if ( rule30Applies ( segment, code ) )
         {
-            output.push_back ( codePoints.front ( ) );
-            removeCodePoint ( codePoints );
+            breakBefore ( );
             continue;
         }
     }
@@ -630,6 +559,368 @@ std::vector< defines::ChrString >
     return output;
 }
 
+/**
+ * @brief What the segment holds before its trailing spaces, which is all that
+ * rules 7 and 8 need to know about it.
+ */
+enum class SpaceContext : std::uint8_t
+{
+    ONLY_SPACES, // nothing but spaces (or nothing at all)
+    ZERO_WIDTH,  // a zero width space
+    OTHER,       // anything else
+    _MAX,        // maximum value
+};
+
+/**
+ * @brief The one thing beyond the two classes that a pair may depend on. At
+ * most one rule on the way to a decision asks.
+ */
+enum class PairCondition : std::uint8_t
+{
+    NONE,          // the classes decide
+    HEBREW_BEFORE, // rule 20a: the code point before the last one is HL
+    NARROW_AFTER,  // rule 29: the code point after the break is narrow
+    NARROW_BEFORE, // rule 29: the code point before the break is narrow
+};
+
+struct PairRule
+{
+    PairCondition condition = PairCondition::NONE;
+    // whether to join when the condition holds (or there is none)
+    bool          join      = false;
+    // whether to join when the condition does not hold
+    bool          otherwise = false;
+};
+
+constexpr std::size_t breakingCount = std::size_t ( BreakingProperties::_MAX );
+constexpr std::size_t contextCount  = std::size_t ( SpaceContext::_MAX );
+
+/**
+ * @brief Runs rules 3 through 30 for a pair of classes, tailored the same way
+ * as the ruleNApplies functions.
+ * @param condition the answer to any condition asked
+ * @param asked set to the condition asked, if any
+ * @return true to join the pair, false to break between them
+ */
+constexpr bool pairJoins ( BreakingProperties const &before,
+                           BreakingProperties const &after,
+                           SpaceContext const       &context,
+                           bool const               &condition,
+                           PairCondition            &asked )
+{
+    using B      = BreakingProperties;
+    auto isOneOf = [] ( B const &b, std::initializer_list< B > const &set ) {
+        for ( B const &member : set )
+        {
+            if ( b == member )
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+    asked = PairCondition::NONE;
+    // rules 3 and 4: break after hard line breaks (but not within CRLF)
+    if ( before == B::BK || ( before == B::CR && after != B::LF )
+         || before == B::LF || before == B::NL )
+    {
+        return false;
+    }
+    // rules 5 and 6: do not break before hard line breaks or spaces
+    if ( isOneOf ( after, { B::BK, B::CR, B::LF, B::NL, B::SP, B::ZW } ) )
+    {
+        return true;
+    }
+    // rule 7: break after a zero width space and any spaces after it
+    if ( context == SpaceContext::ZERO_WIDTH )
+    {
+        return false;
+    }
+    // rule 8: do not break within combining sequences
+    if ( context != SpaceContext::ONLY_SPACES
+         && isOneOf ( after, { B::CM, B::ZWJ } ) )
+    {
+        return true;
+    }
+    // rules 10 and 11: word joiners and glue
+    if ( before == B::WJ || after == B::WJ || before == B::GL )
+    {
+        return true;
+    }
+    // rule 12 (tailored to ignore spaces), 13, 14, and 15
+    if ( isOneOf ( after, { B::CL, B::CP, B::EX, B::IS, B::SY } )
+         || before == B::OP || ( before == B::QU && after == B::OP )
+         || ( before == B::CP && isOneOf ( after, { B::NS, B::CJ } ) ) )
+    {
+        return true;
+    }
+    // rule 17: break after spaces
+    if ( before == B::SP )
+    {
+        return false;
+    }
+    // rule 18: quotation marks
+    if ( before == B::QU || after == B::QU )
+    {
+        return true;
+    }
+    // rule 19: contingent breaks
+    if ( before == B::CB || after == B::CB )
+    {
+        return false;
+    }
+    // rules 20, 20a, and 20b
+    if ( isOneOf ( after, { B::BA, B::HY, B::NS, B::CJ } ) )
+    {
+        return true;
+    } else if ( after == B::HL )
+    {
+        if ( before == B::SY )
+        {
+            return true;
+        }
+    } else if ( isOneOf ( before, { B::HY, B::BA } ) )
+    {
+        asked = PairCondition::HEBREW_BEFORE;
+        if ( condition )
+        {
+            return true;
+        }
+    } else if ( before == B::BB )
+    {
+        return true;
+    }
+    // rule 21: infixes
+    if ( after == B::IN )
+    {
+        return true;
+    }
+    // rules 22 and 23: letters, digits, ideographs, prefixes, and postfixes
+    bool const letterBefore = isOneOf ( before, { B::AL, B::HL } );
+    bool const letterAfter  = isOneOf ( after, { B::AL, B::HL } );
+    bool const fixBefore    = isOneOf ( before, { B::PR, B::PO } );
+    bool const fixAfter     = isOneOf ( after, { B::PR, B::PO } );
+    if ( ( letterBefore && after == B::NU )
+         || ( before == B::NU && letterAfter )
+         || ( before == B::PR && isOneOf ( after, { B::ID, B::EB, B::EM } ) )
+         || ( isOneOf ( before, { B::ID, B::EB, B::EM } ) && after == B::PO )
+         || ( fixBefore && letterAfter ) || ( letterBefore && fixAfter ) )
+    {
+        return true;
+    }
+    // rule 24: numbers
+    if ( ( isOneOf ( before, { B::CL, B::CP } ) && fixAfter )
+         || ( isOneOf ( before, { B::HY, B::IS, B::SY } ) && after == B::NU )
+         || ( before == B::NU && ( after == B::NU || fixAfter ) )
+         || ( fixBefore && isOneOf ( after, { B::NU, B::OP } ) ) )
+    {
+        return true;
+    }
+    // rule 25: korean syllables
+    if ( ( before == B::JL
+           && isOneOf ( after, { B::JL, B::JV, B::H2, B::H3 } ) )
+         || ( isOneOf ( before, { B::JV, B::H2 } )
+              && isOneOf ( after, { B::JV, B::JT } ) )
+         || ( isOneOf ( before, { B::JT, B::H3 } ) && after == B::JT ) )
+    {
+        return true;
+    }
+    // rule 27 and rule 9 (stray combining marks are alphabetic)
+    if ( ( letterBefore && letterAfter )
+         || isOneOf ( after, { B::CM, B::ZWJ } ) )
+    {
+        return true;
+    }
+    // rules 26 and 28
+    bool const hangulBefore
+            = isOneOf ( before, { B::JL, B::JV, B::JT, B::H2, B::H3 } );
+    bool const hangulAfter
+            = isOneOf ( after, { B::JL, B::JV, B::JT, B::H2, B::H3 } );
+    if ( ( hangulBefore && after == B::PO )
+         || ( before == B::PR && hangulAfter )
+         || ( before == B::IS && letterAfter ) )
+    {
+        return true;
+    }
+    // rule 29: parentheses, unless they are wide
+    if ( isOneOf ( before, { B::AL, B::HL, B::NU } ) && after == B::OP )
+    {
+        asked = PairCondition::NARROW_AFTER;
+        return condition;
+    }
+    if ( before == B::CP && isOneOf ( after, { B::AL, B::HL, B::NU } ) )
+    {
+        asked = PairCondition::NARROW_BEFORE;
+        return condition;
+    }
+    // rule 30: break everywhere else
+    return false;
+}
+
+using PairTable = std::array<
+        std::array< std::array< PairRule, breakingCount >, breakingCount >,
+        contextCount >;
+
+// pairTable [ context ][ before ][ after ]
+constexpr PairTable pairTable = [] ( ) {
+    PairTable result {};
+    for ( std::size_t context = 0; context < contextCount; context++ )
+    {
+        for ( std::size_t before = 0; before < breakingCount; before++ )
+        {
+            for ( std::size_t after = 0; after < breakingCount; after++ )
+            {
+                PairRule     &rule  = result [ context ][ before ][ after ];
+                PairCondition asked = PairCondition::NONE;
+                auto          joins = [ & ] ( bool const     &condition,
+                                     PairCondition &into ) {
+                    return pairJoins ( BreakingProperties ( before ),
+                                       BreakingProperties ( after ),
+                                       SpaceContext ( context ),
+                                       condition,
+                                       into );
+                };
+                rule.join      = joins ( true, rule.condition );
+                rule.otherwise = joins ( false, asked );
+            }
+        }
+    }
+    return result;
+}( );
+
+struct io::console::manip::LineBreaker::impl_s
+{
+    // holds onto code points and sequences cut off between feeds
+    Tokenizer                 tokenizer;
+    std::deque< Inseperable > ready;
+    // the part that the next code point may join
+    Inseperable               part;
+
+    // what the pair table needs to know about the part so far
+    SpaceContext       context  = SpaceContext::ONLY_SPACES;
+    BreakingProperties last     = BreakingProperties::XX;
+    bool               lastWide = false;
+    // whether the code point before the last one is in the part and HL
+    bool               hebrew   = false;
+
+    void add ( CodePoint const & );
+    void finishPart ( );
+};
+
+void io::console::manip::LineBreaker::impl_s::add ( CodePoint const &code )
+{
+    auto const properties = characterProperties ( ).lookup ( code.value );
+    auto const next = BreakingProperties ( properties.lineBreaking );
+    // rule 1: never break at the start of text.
+    bool join       = false;
+    if ( !part.text.empty ( ) )
+    {
+        PairRule const &rule = pairTable [ std::size_t ( context ) ]
+                                         [ std::size_t ( last ) ]
+                                         [ std::size_t ( next ) ];
+        bool holds = true;
+        switch ( rule.condition )
+        {
+            case PairCondition::NONE: break;
+            case PairCondition::HEBREW_BEFORE: holds = hebrew; break;
+            case PairCondition::NARROW_AFTER:
+                holds = !properties.columns;
+                break;
+            case PairCondition::NARROW_BEFORE: holds = !lastWide; break;
+        }
+        join = holds ? rule.join : rule.otherwise;
+    }
+    if ( join )
+    {
+        hebrew = last == BreakingProperties::HL;
+    } else
+    {
+        finishPart ( );
+    }
+    part.text.append ( code.bytes );
+    if ( next == BreakingProperties::ZW )
+    {
+        context = SpaceContext::ZERO_WIDTH;
+    } else if ( next != BreakingProperties::SP )
+    {
+        context = SpaceContext::OTHER;
+    }
+    last     = next;
+    lastWide = properties.columns;
+}
+
+void io::console::manip::LineBreaker::impl_s::finishPart ( )
+{
+    if ( !part.text.empty ( ) )
+    {
+        switch ( last )
+        {
+            case BreakingProperties::BK:
+            case BreakingProperties::CR:
+            case BreakingProperties::LF:
+            case BreakingProperties::NL: part.mandatory = true; break;
+            default: break;
+        }
+        ready.push_back ( std::move ( part ) );
+    }
+    part    = Inseperable ( );
+    context = SpaceContext::ONLY_SPACES;
+    hebrew  = false;
+}
+
+io::console::manip::LineBreaker::LineBreaker ( ) : pimpl ( new impl_s ( ) ) { }
+io::console::manip::LineBreaker::~LineBreaker ( ) = default;
+
+void io::console::manip::LineBreaker::feed ( std::string_view const &text )
+{
+    pimpl->tokenizer.feed ( text, [ & ] ( Token const &token ) {
+        for ( auto const &code : CodePoints ( token.bytes ) )
+        {
+            pimpl->add ( code );
+        }
+    } );
+}
+
+void io::console::manip::LineBreaker::finish ( )
+{
+    pimpl->tokenizer.flush ( [ & ] ( Token const &token ) {
+        for ( auto const &code : CodePoints ( token.bytes ) )
+        {
+            pimpl->add ( code );
+        }
+    } );
+    // rule 2: always break at the end of text.
+    pimpl->finishPart ( );
+    pimpl->last     = BreakingProperties::XX;
+    pimpl->lastWide = false;
+}
+
+bool io::console::manip::LineBreaker::pull ( Inseperable &into )
+{
+    if ( pimpl->ready.empty ( ) )
+    {
+        return false;
+    }
+    into = std::move ( pimpl->ready.front ( ) );
+    pimpl->ready.pop_front ( );
+    return true;
+}
+
+std::vector< defines::ChrString >
+        io::console::manip::generateTextInseperables ( defines::ChrString str )
+{
+    std::vector< defines::ChrString > output;
+    LineBreaker                       breaker;
+    Inseperable                       part;
+    breaker.feed ( str );
+    breaker.finish ( );
+    while ( breaker.pull ( part ) )
+    {
+        output.push_back ( std::move ( part.text ) );
+    }
+    return output;
+}
+
 // #61 can also be addressed here by replacing adding spaces with the
 // appropriate cursor-movement command.
 defines::ChrString io::console::manip::centerTextOn ( defines::ChrString string,
@@ -662,16 +953,14 @@ defines::ChrString io::console::manip::centerTextOn ( defines::ChrString string,
         defines::ChrString result = CHR_STRINGIZE ( );
         defines::U32String asU32  = U32_STRINGIZE ( );
         // populate the utf-32 string.
-        for ( auto const &cp : splitByCodePoint ( string ) )
+        for ( auto const &codePoint : CodePoints ( string ) )
         {
-            asU32 += widen ( cp.c_str ( ) );
+            asU32 += codePoint.value;
         }
 
         // convenient lambda function to convert back to UTF-8
         auto backToUTF8 = [ & ] ( ) {
-            defines::ChrString output = CHR_STRINGIZE ( );
-            for ( auto &cp : asU32 ) { output += narrow ( cp ); }
-            return output;
+            return convert< defines::ChrChar, defines::U32Char > ( asU32 );
         };
 
         // returns true if it succeeded.
@@ -808,13 +1097,14 @@ std::uint32_t io::console::manip::columnsLong ( std::string const &string )
 {
     std::uint32_t  result = 0;
     std::u32string asU32  = U"";
-    for ( auto &cp : splitByCodePoint ( string ) )
+    for ( auto const &codePoint : CodePoints ( string ) )
     {
-        asU32 += widen ( cp.c_str ( ) );
+        asU32 += codePoint.value;
     }
-    for ( auto &cp : asU32 )
+    std::vector< CharacterProperties > allProperties ( asU32.size ( ) );
+    characterProperties ( ).lookup ( asU32, allProperties );
+    for ( auto &properties : allProperties )
     {
-        auto properties = characterProperties ( ).at ( cp );
         result += properties.control
                         ? 0
                         : ( 1 + ( properties.columns | properties.emoji ) );
@@ -824,8 +1114,9 @@ std::uint32_t io::console::manip::columnsLong ( std::string const &string )
 
 BreakingProperties getBreakingPropertiesFrom ( char32_t const &c )
 {
-    CharacterProperties properties = characterProperties ( ).at ( c );
-    return ( BreakingProperties ) properties.lineBreaking;
+    return ( BreakingProperties ) characterProperties ( )
+            .lookup ( c )
+            .lineBreaking;
 }
 
 bool isBreakingPropertyTailorable ( char32_t const &c )
@@ -847,32 +1138,18 @@ bool isBreakingPropertyTailorable ( char32_t const &c )
     }
 }
 
-void removeCodePoint ( std::vector< std::string > &points )
-{
-    points.erase ( points.begin ( ) );
-}
-
-bool rule3Applies ( std::string const &line, std::string const & )
+bool rule3Applies ( Segment const &line, defines::U32Char const & )
 {
     // rule 3 says that if the output currently ends in a hard line break,
     // then we have to perform a line break.
-    std::string last     = splitByCodePoint ( line ).back ( );
-    char32_t    point    = widen ( last.c_str ( ) );
-    auto        breaking = getBreakingPropertiesFrom ( point );
+    auto breaking = getBreakingPropertiesFrom ( line.last );
     return breaking == BreakingProperties::BK;
 }
-bool rule4Applies ( std::string const &line, std::string const &code )
+bool rule4Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 4 says to treat CR, LF, CRLF, and NL as line breaks
-    std::string lastLine = splitByCodePoint ( line ).back ( );
-    // the front because line << code
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t linePoint = widen ( lastLine.c_str ( ) );
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto lineBreaking = getBreakingPropertiesFrom ( linePoint );
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
 
     switch ( lineBreaking )
     {
@@ -883,16 +1160,12 @@ bool rule4Applies ( std::string const &line, std::string const &code )
         default: return false;
     }
 }
-bool rule5Applies ( std::string const &, std::string const &code )
+bool rule5Applies ( Segment const &, defines::U32Char const &code )
 {
     // rule 5 says to prohibit line breaks before hard line breaks.
     // so we just check if code contains BK, CR, LF, or NL since all
     // of those lead to a line break
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
     switch ( codeBreaking )
     {
         case BreakingProperties::BK:
@@ -902,14 +1175,10 @@ bool rule5Applies ( std::string const &, std::string const &code )
         default: return false;
     }
 }
-bool rule6Applies ( std::string const &, std::string const &code )
+bool rule6Applies ( Segment const &, defines::U32Char const &code )
 {
     // rule six says to not break before spaces or the zero width spaces
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
     switch ( codeBreaking )
     {
         case BreakingProperties::SP:
@@ -917,49 +1186,23 @@ bool rule6Applies ( std::string const &, std::string const &code )
         default: return false;
     }
 }
-bool rule7Applies ( std::string const &line, std::string const &code )
+bool rule7Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 7 says to break before any character following a zero-width space,
     // but after any spaces between the character and the 0 width character.
     // So, implicitly, not after the space.
     // first, we need to check if line either ends in a ZW or there are only
     // spaces to the next ZW
-
-    std::vector< std::string > linePoints          = splitByCodePoint ( line );
-    bool                       beforePartSatisfied = true;
-    bool                       foundZeroWidth      = false;
-    for ( auto i = linePoints.rbegin ( ); i != linePoints.rend ( ); i++ )
-    {
-        // get the properties of this item
-        std::string linePoint         = *i;
-        char32_t    widened           = widen ( linePoint.c_str ( ) );
-        auto        linePointBreaking = getBreakingPropertiesFrom ( widened );
-        if ( linePointBreaking == BreakingProperties::SP )
-        {
-            beforePartSatisfied &= true;
-        } else if ( linePointBreaking == BreakingProperties::ZW )
-        {
-            beforePartSatisfied &= true;
-            foundZeroWidth = true;
-            break;
-        } else
-        {
-            beforePartSatisfied = false;
-            break;
-        }
-    }
-    if ( beforePartSatisfied && foundZeroWidth )
+    if ( line.beforeSpaces == BreakingProperties::ZW )
     {
         // now check if we have a character **other** than the space, which,
         // as the rule is written, implicitly does not lead to a break
-        std::string lastCode     = splitByCodePoint ( code ).front ( );
-        char32_t    codePoint    = widen ( lastCode.c_str ( ) );
-        auto        codeBreaking = getBreakingPropertiesFrom ( codePoint );
+        auto codeBreaking = getBreakingPropertiesFrom ( code );
         return codeBreaking != BreakingProperties::SP;
     }
     return false;
 }
-bool rule8Applies ( std::string const &line, std::string const &code )
+bool rule8Applies ( Segment const &line, defines::U32Char const &code )
 {
     // this rule applies if we have a character X and it is followed by
     // at least one CM | ZWJ. So, we have to check all the previously added
@@ -968,74 +1211,43 @@ bool rule8Applies ( std::string const &line, std::string const &code )
 
     // step 1. check for our character X. X cannot be a space, but the other
     // checks are implicit within our currently defined splitting-rules
-    std::vector< std::string > linePoints = splitByCodePoint ( line );
-    bool                       foundX     = false;
-    for ( auto i = linePoints.rbegin ( ); i != linePoints.rend ( ); i++ )
-    {
-        std::string linePoint         = *i;
-        char32_t    widened           = widen ( linePoint.c_str ( ) );
-        auto        linePointBreaking = getBreakingPropertiesFrom ( widened );
-        if ( linePointBreaking == BreakingProperties::SP )
-        {
-            continue;
-        } else
-        {
-            foundX = true;
-            break;
-        }
-    }
-    if ( foundX )
+    if ( line.beforeSpaces != BreakingProperties::SP )
     {
         // check against the last character.
-        std::string lastCode     = splitByCodePoint ( code ).front ( );
-        char32_t    codePoint    = widen ( lastCode.c_str ( ) );
-        auto        codeBreaking = getBreakingPropertiesFrom ( codePoint );
+        auto codeBreaking = getBreakingPropertiesFrom ( code );
         return codeBreaking == BreakingProperties::CM
             || codeBreaking == BreakingProperties::ZWJ;
     }
     return false;
 }
-bool rule9Applies ( std::string const &, std::string const &code )
+bool rule9Applies ( Segment const &, defines::U32Char const &code )
 {
     // this rule states that any stray combining mark should be treated as an
     // alphebetical character
-    std::string lastCode     = splitByCodePoint ( code ).front ( );
-    char32_t    codePoint    = widen ( lastCode.c_str ( ) );
-    auto        codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
     return codeBreaking == BreakingProperties::CM
         || codeBreaking == BreakingProperties::ZWJ;
 }
-bool rule10Applies ( std::string const &line, std::string const &code )
+bool rule10Applies ( Segment const &line, defines::U32Char const &code )
 {
     // this rule bans line breaks before / after word joiner characters
-    std::string lastLine = splitByCodePoint ( line ).back ( );
-    // the front because line << code
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t linePoint = widen ( lastLine.c_str ( ) );
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto lineBreaking = getBreakingPropertiesFrom ( linePoint );
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
 
     return lineBreaking == BreakingProperties::WJ
         || codeBreaking == BreakingProperties::WJ;
 }
-bool rule11Applies ( std::string const &line, std::string const & )
+bool rule11Applies ( Segment const &line, defines::U32Char const & )
 {
     // this rule bans breaking after glue characters
-    std::string lastLine     = splitByCodePoint ( line ).back ( );
-    char32_t    linePoint    = widen ( lastLine.c_str ( ) );
-    auto        lineBreaking = getBreakingPropertiesFrom ( linePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
     return lineBreaking == BreakingProperties::GL;
 }
-bool rule12Applies ( std::string const &, std::string const &code )
+bool rule12Applies ( Segment const &, defines::U32Char const &code )
 {
     // this rule prohibits breaking before close punctuation, sentence
     // terminators, etc. Characters like ], ), ;, ., ,, and 」
-    std::string lastCode     = splitByCodePoint ( code ).front ( );
-    char32_t    codePoint    = widen ( lastCode.c_str ( ) );
-    auto        codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
     switch ( codeBreaking )
     {
         case BreakingProperties::CL:
@@ -1046,48 +1258,38 @@ bool rule12Applies ( std::string const &, std::string const &code )
         default: return false;
     }
 }
-bool rule13Applies ( std::string const &line, std::string const & )
+bool rule13Applies ( Segment const &line, defines::U32Char const & )
 {
     // rule 13 is like rule 12, but specifies with opening punctuation only,
     // so characters like [, (, and {.
-    std::string lastLine     = splitByCodePoint ( line ).back ( );
-    char32_t    linePoint    = widen ( lastLine.c_str ( ) );
-    auto        lineBreaking = getBreakingPropertiesFrom ( linePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
     return lineBreaking == BreakingProperties::OP;
 }
-bool rule14Applies ( std::string const &line, std::string const &code )
+bool rule14Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 14 is a special case that prevents "[ and other quotation mark-
     // characters followed by an open punctuation from allowing a line-break.
-    std::string lastLine     = splitByCodePoint ( line ).back ( );
-    char32_t    linePoint    = widen ( lastLine.c_str ( ) );
-    auto        lineBreaking = getBreakingPropertiesFrom ( linePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
 
-    std::string lastCode     = splitByCodePoint ( code ).front ( );
-    char32_t    codePoint    = widen ( lastCode.c_str ( ) );
-    auto        codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
 
     return lineBreaking == BreakingProperties::QU
         && codeBreaking == BreakingProperties::OP;
 }
-bool rule15Applies ( std::string const &line, std::string const &code )
+bool rule15Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 15 prevents a break between a close punctuation and a nonstarter.
     // even with intervening spaces.
-    std::string lastLine     = splitByCodePoint ( line ).back ( );
-    char32_t    linePoint    = widen ( lastLine.c_str ( ) );
-    auto        lineBreaking = getBreakingPropertiesFrom ( linePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
 
-    std::string lastCode     = splitByCodePoint ( code ).front ( );
-    char32_t    codePoint    = widen ( lastCode.c_str ( ) );
-    auto        codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
 
     return lineBreaking == BreakingProperties::CP
         && ( codeBreaking == BreakingProperties::NS
              // strict breaking
              || codeBreaking == BreakingProperties::CJ );
 }
-bool rule16Applies ( std::string const &line, std::string const &code )
+bool rule16Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 16 prevents a break between two "break before and after" characters
     // even if spaces intervene.
@@ -1096,51 +1298,35 @@ bool rule16Applies ( std::string const &line, std::string const &code )
     // future, and we can't do that with our current setup.
     return false;
 }
-bool rule17Applies ( std::string const &line, std::string const & )
+bool rule17Applies ( Segment const &line, defines::U32Char const & )
 {
     // rule 17 states that a break should occur after a space
-    std::string lastLine     = splitByCodePoint ( line ).back ( );
-    char32_t    linePoint    = widen ( lastLine.c_str ( ) );
-    auto        lineBreaking = getBreakingPropertiesFrom ( linePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
     return lineBreaking == BreakingProperties::SP;
 }
-bool rule18Applies ( std::string const &line, std::string const &code )
+bool rule18Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 18 prevents line breaks immediately before or after quotation marks.
     // this rule bans line breaks before / after word joiner characters
-    std::string lastLine = splitByCodePoint ( line ).back ( );
-    // the front because line << code
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t linePoint = widen ( lastLine.c_str ( ) );
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto lineBreaking = getBreakingPropertiesFrom ( linePoint );
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
 
     return lineBreaking == BreakingProperties::QU
         || codeBreaking == BreakingProperties::QU;
 }
-bool rule19Applies ( std::string const &line, std::string const &code )
+bool rule19Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 19 states that if we see a CB character now, we should treat it as a
     // break opportunity for both before and after
     // rule 18 prevents line breaks immediately before or after quotation marks.
     // this rule bans line breaks before / after word joiner characters
-    std::string lastLine = splitByCodePoint ( line ).back ( );
-    // the front because line << code
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t linePoint = widen ( lastLine.c_str ( ) );
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto lineBreaking = getBreakingPropertiesFrom ( linePoint );
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
 
     return lineBreaking == BreakingProperties::CB
         || codeBreaking == BreakingProperties::CB;
 }
-bool rule20Applies ( std::string const &line, std::string const &code )
+bool rule20Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 20 states that we should:
     // 1. not break before a BA character
@@ -1152,16 +1338,8 @@ bool rule20Applies ( std::string const &line, std::string const &code )
     // 5. Do not break after a Hebrew Letter followed by a hyphen or break after
     // character.
     // 6. do not break between an SY and a Hebrew letter
-
-    std::string lastLine = splitByCodePoint ( line ).back ( );
-    // the front because line << code
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t linePoint = widen ( lastLine.c_str ( ) );
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto lineBreaking = getBreakingPropertiesFrom ( linePoint );
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
     switch ( codeBreaking )
     {
         case BreakingProperties::BA:
@@ -1177,55 +1355,28 @@ bool rule20Applies ( std::string const &line, std::string const &code )
                 case BreakingProperties::BA:
                     // check if the code point immediately before ours
                     // is a hebrew letter
-                    {
-                        std::vector< std::string > linePoints =
-                                splitByCodePoint ( line );
-                        if ( linePoints.size ( ) > 1 )
-                        {
-                            // if there is a previous letter
-                            std::string pointOfInterest =
-                                    linePoints.at ( linePoints.size ( ) - 2 );
-                            char32_t widened =
-                                    widen ( pointOfInterest.c_str ( ) );
-                            auto props = getBreakingPropertiesFrom ( widened );
-                            // we apply if the letter is a hebrew letter
-                            return props == BreakingProperties::HL;
-                        } else
-                        {
-                            // if there is no previous letter, then we do
-                            // not apply
-                            return false;
-                        }
-                    }
+                    return getBreakingPropertiesFrom ( line.beforeLast )
+                        == BreakingProperties::HL;
                     // don't break after a break before.
                 case BreakingProperties::BB: return true;
                 default: return false;
             }
     }
 }
-bool rule21Applies ( std::string const &, std::string const &code )
+bool rule21Applies ( Segment const &, defines::U32Char const &code )
 {
     // rule 21 states that we should not break before an infix character, such
     // as ellipses.
-    std::string lastCode     = splitByCodePoint ( code ).front ( );
-    char32_t    codePoint    = widen ( lastCode.c_str ( ) );
-    auto        codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
     return codeBreaking == BreakingProperties::IN;
 }
-bool rule22Applies ( std::string const &line, std::string const &code )
+bool rule22Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 22 states that we should not break between digits and letters or
     // between ideographs and numeric prefixes / postfixes. Here, ideographs
-    // include emoji.
-    std::string lastLine = splitByCodePoint ( line ).back ( );
-    // the front because line << code
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t linePoint = widen ( lastLine.c_str ( ) );
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto lineBreaking = getBreakingPropertiesFrom ( linePoint );
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    // include emoji.
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
 
     switch ( lineBreaking )
     {
@@ -1246,18 +1397,11 @@ bool rule22Applies ( std::string const &line, std::string const &code )
         default: return false;
     }
 }
-bool rule23Applies ( std::string const &line, std::string const &code )
+bool rule23Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 23 is like rule 22's case for ideographs, except its for letters.
-    std::string lastLine = splitByCodePoint ( line ).back ( );
-    // the front because line << code
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t linePoint = widen ( lastLine.c_str ( ) );
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto lineBreaking = getBreakingPropertiesFrom ( linePoint );
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
     switch ( lineBreaking )
     {
         case BreakingProperties::PR:
@@ -1271,7 +1415,7 @@ bool rule23Applies ( std::string const &line, std::string const &code )
         default: return false;
     }
 }
-bool rule24Applies ( std::string const &line, std::string const &code )
+bool rule24Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 24 prohibits line breaks according to this pattern where 'x' is
     // the possible location of the line break:
@@ -1289,15 +1433,8 @@ bool rule24Applies ( std::string const &line, std::string const &code )
     // PRxOP
     // PRxNU
     // SYxNU
-    std::string lastLine = splitByCodePoint ( line ).back ( );
-    // the front because line << code
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t linePoint = widen ( lastLine.c_str ( ) );
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto lineBreaking = getBreakingPropertiesFrom ( linePoint );
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
     switch ( lineBreaking )
     {
         case BreakingProperties::CL:
@@ -1319,23 +1456,15 @@ bool rule24Applies ( std::string const &line, std::string const &code )
         default: return false;
     }
 }
-bool rule25Applies ( std::string const &line, std::string const &code )
+bool rule25Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 25 prohibits breaks within a korean syllable.
     // a korean syllable is defined by:
     // 1. JL followed by one of JL, JV, H2, or H3
     // 2. JV or H2 followed by one of JV or JT
     // 3. JT or H3 followed by JT.
-
-    std::string lastLine = splitByCodePoint ( line ).back ( );
-    // the front because line << code
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t linePoint = widen ( lastLine.c_str ( ) );
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto lineBreaking = getBreakingPropertiesFrom ( linePoint );
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
 
     switch ( lineBreaking )
     {
@@ -1354,7 +1483,7 @@ bool rule25Applies ( std::string const &line, std::string const &code )
         default: return false;
     }
 }
-bool rule26Applies ( std::string const &line, std::string const &code )
+bool rule26Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 26 states that korean syllables are ideographs.
     // So, each character in 안녕하세요 (google translated "hello") allows a
@@ -1363,15 +1492,8 @@ bool rule26Applies ( std::string const &line, std::string const &code )
     //
     // unicode writes this as preventing a break between hangul characters iff
     // followed by a PO character or preceeded by a PR character.
-    std::string lastLine = splitByCodePoint ( line ).back ( );
-    // the front because line << code
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t linePoint = widen ( lastLine.c_str ( ) );
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto lineBreaking = getBreakingPropertiesFrom ( linePoint );
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
 
     switch ( lineBreaking )
     {
@@ -1390,18 +1512,11 @@ bool rule26Applies ( std::string const &line, std::string const &code )
         default: return false;
     }
 }
-bool rule27Applies ( std::string const &line, std::string const &code )
+bool rule27Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 27 prevents line breaks between alphabetic characters.
-    std::string lastLine = splitByCodePoint ( line ).back ( );
-    // the front because line << code
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t linePoint = widen ( lastLine.c_str ( ) );
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto lineBreaking = getBreakingPropertiesFrom ( linePoint );
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
 
     if ( lineBreaking == BreakingProperties::AL )
     {
@@ -1416,19 +1531,12 @@ bool rule27Applies ( std::string const &line, std::string const &code )
         return false;
     }
 }
-bool rule28Applies ( std::string const &line, std::string const &code )
+bool rule28Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 28 prevents line breaks between numeric invixes (eg, ".")
     // and alphabetic characters.
-    std::string lastLine = splitByCodePoint ( line ).back ( );
-    // the front because line << code
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t linePoint = widen ( lastLine.c_str ( ) );
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto lineBreaking = getBreakingPropertiesFrom ( linePoint );
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
 
     if ( lineBreaking == BreakingProperties::IS )
     {
@@ -1437,20 +1545,13 @@ bool rule28Applies ( std::string const &line, std::string const &code )
     }
     return false;
 }
-bool rule29Applies ( std::string const &line, std::string const &code )
+bool rule29Applies ( Segment const &line, defines::U32Char const &code )
 {
     // rule 29 states that letters, numbers, or ordinary symbols followed by
     // an opening or closing parentheses should not break unless the opening or
     // closing parenthesis is a wide character.
-    std::string lastLine = splitByCodePoint ( line ).back ( );
-    // the front because line << code
-    std::string lastCode = splitByCodePoint ( code ).front ( );
-
-    char32_t linePoint = widen ( lastLine.c_str ( ) );
-    char32_t codePoint = widen ( lastCode.c_str ( ) );
-
-    auto lineBreaking = getBreakingPropertiesFrom ( linePoint );
-    auto codeBreaking = getBreakingPropertiesFrom ( codePoint );
+    auto lineBreaking = getBreakingPropertiesFrom ( line.last );
+    auto codeBreaking = getBreakingPropertiesFrom ( code );
 
     switch ( lineBreaking )
     {
@@ -1459,8 +1560,9 @@ bool rule29Applies ( std::string const &line, std::string const &code )
         case BreakingProperties::NU:
             if ( codeBreaking == BreakingProperties::OP )
             {
-                return characterProperties ( ).at ( codePoint ).columns ? false
-                                                                        : true;
+                return characterProperties ( ).lookup ( code ).columns
+                             ? false
+                             : true;
             } else
             {
                 return false;
@@ -1471,7 +1573,7 @@ bool rule29Applies ( std::string const &line, std::string const &code )
                 case BreakingProperties::AL:
                 case BreakingProperties::HL:
                 case BreakingProperties::NU:
-                    return characterProperties ( ).at ( linePoint ).columns
+                    return characterProperties ( ).lookup ( line.last ).columns
                                  ? false
                                  : true;
                 default: return false;
@@ -1481,131 +1583,328 @@ bool rule29Applies ( std::string const &line, std::string const &code )
 }
 // rule 30, the "base case" always applies since we only check for it if none
 // of the other rules apply.
-bool rule30Applies ( std::string const &, std::string const & ) { return true; }
+bool rule30Applies ( Segment const &, defines::U32Char const & )
+{
+    return true;
+}
 
-/**
- * @brief Takes a C-string and widens it to a UTF-32 character sequence.
- * @note Useful for querying the properties of a sequence.
- *
- * @param cstr
- * @return char32_t
- */
-defines::U32Char io::console::manip::widen ( defines::ChrPString const cstr )
+// the bulk conversions handle runs of ASCII with these kernels and leave
+// everything else to readCodePoint and encode. Each kernel stops at the first
+// character that is not ASCII and returns how many characters it handled.
+using AsciiPrefixKernel = std::size_t ( * ) ( char const *, std::size_t );
+using WidenKernel = std::size_t ( * ) ( char const *, std::size_t, char32_t * );
+using NarrowKernel =
+        std::size_t ( * ) ( char32_t const *, std::size_t, char * );
+
+std::size_t asciiPrefixScalar ( char const *in, std::size_t size )
 {
-    if ( !cstr )
+    std::size_t i = 0;
+    while ( i < size && ( unsigned char ) in [ i ] < 0x80 ) { i++; }
+    return i;
+}
+
+std::size_t widenScalar ( char const *in, std::size_t size, char32_t *out )
+{
+    std::size_t i = 0;
+    for ( ; i < size && ( unsigned char ) in [ i ] < 0x80; i++ )
     {
-        RUNTIME_ERROR ( "Invalid Sequence: \"sequence\" was nullptr" )
+        out [ i ] = ( unsigned char ) in [ i ];
     }
-    defines::ChrString temp { cstr };
+    return i;
+}
 
-    std::uint32_t total  = 0;
-    unsigned      length = 1;
-    unsigned      front  = ( unsigned char ) temp.front ( );
+std::size_t narrowScalar ( char32_t const *in, std::size_t size, char *out )
+{
+    std::size_t i = 0;
+    for ( ; i < size && in [ i ] < 0x80; i++ )
+    {
+        out [ i ] = char ( in [ i ] );
+    }
+    return i;
+}
 
-    auto addMultiByteSequence = [ & ] ( unsigned mask ) {
-        // error out if we have to short a string.
-        if ( temp.size ( ) < length )
+#ifdef MANIP_SSE2
+std::size_t asciiPrefixSSE2 ( char const *in, std::size_t size )
+{
+    std::size_t i = 0;
+    for ( ; i + 16 <= size; i += 16 )
+    {
+        __m128i bytes = _mm_loadu_si128 ( ( __m128i const * ) ( in + i ) );
+        // the top bit of each byte is only set outside of ASCII
+        if ( int mask = _mm_movemask_epi8 ( bytes ) )
         {
-            RUNTIME_ERROR ( "Invalid Sequence: string too short" )
+            return i + __builtin_ctz ( mask );
         }
-        // if not, then add the first byte
-        total = front & mask;
-        // add the characters.
-        for ( std::size_t i = 1; i < length; i++ )
+    }
+    return i + asciiPrefixScalar ( in + i, size - i );
+}
+
+std::size_t widenSSE2 ( char const *in, std::size_t size, char32_t *out )
+{
+    __m128i const zero = _mm_setzero_si128 ( );
+    std::size_t   i    = 0;
+    for ( ; i + 16 <= size; i += 16 )
+    {
+        __m128i bytes = _mm_loadu_si128 ( ( __m128i const * ) ( in + i ) );
+        if ( _mm_movemask_epi8 ( bytes ) )
         {
-            front = ( unsigned char ) temp.at ( i );
-            // if the character is not a valid following byte, indicate
-            // that the sequence is invalid. Otherwise, continue with
-            // the parsing.
-            if ( front > ( unsigned char ) defines::maximumFollowing
-                 || front <= ( unsigned char ) defines::maximumASCII )
-            {
-                RUNTIME_ERROR ( "Invalid Sequence: missing following byte" )
-            } else
-            {
-                front &= ~( defines::minimumTwoByte - 2 );
-                total <<= 6;
-                total += front;
-            }
+            break;
         }
-    };
+        __m128i low  = _mm_unpacklo_epi8 ( bytes, zero );
+        __m128i high = _mm_unpackhi_epi8 ( bytes, zero );
+        __m128i *to  = ( __m128i * ) ( out + i );
+        _mm_storeu_si128 ( to + 0, _mm_unpacklo_epi16 ( low, zero ) );
+        _mm_storeu_si128 ( to + 1, _mm_unpackhi_epi16 ( low, zero ) );
+        _mm_storeu_si128 ( to + 2, _mm_unpacklo_epi16 ( high, zero ) );
+        _mm_storeu_si128 ( to + 3, _mm_unpackhi_epi16 ( high, zero ) );
+    }
+    return i + widenScalar ( in + i, size - i, out + i );
+}
 
-    if ( front <= defines::maximumASCII )
+std::size_t narrowSSE2 ( char32_t const *in, std::size_t size, char *out )
+{
+    __m128i const notASCII = _mm_set1_epi32 ( ~0x7F );
+    __m128i const zero     = _mm_setzero_si128 ( );
+    std::size_t   i        = 0;
+    for ( ; i + 16 <= size; i += 16 )
     {
-        total += front;
-    } else
+        __m128i const *from = ( __m128i const * ) ( in + i );
+        __m128i        a    = _mm_loadu_si128 ( from + 0 );
+        __m128i        b    = _mm_loadu_si128 ( from + 1 );
+        __m128i        c    = _mm_loadu_si128 ( from + 2 );
+        __m128i        d    = _mm_loadu_si128 ( from + 3 );
+        __m128i        any  = _mm_or_si128 ( _mm_or_si128 ( a, b ),
+                                     _mm_or_si128 ( c, d ) );
+        any = _mm_cmpeq_epi32 ( _mm_and_si128 ( any, notASCII ), zero );
+        if ( _mm_movemask_epi8 ( any ) != 0xFFFF )
+        {
+            break;
+        }
+        __m128i bytes = _mm_packus_epi16 ( _mm_packs_epi32 ( a, b ),
+                                           _mm_packs_epi32 ( c, d ) );
+        _mm_storeu_si128 ( ( __m128i * ) ( out + i ), bytes );
+    }
+    return i + narrowScalar ( in + i, size - i, out + i );
+}
+#endif // ifdef MANIP_SSE2
+
+#ifdef MANIP_AVX2
+__attribute__ ( ( target ( "avx2" ) ) ) std::size_t
+        asciiPrefixAVX2 ( char const *in, std::size_t size )
+{
+    std::size_t i = 0;
+    for ( ; i + 32 <= size; i += 32 )
     {
-        length = utf8SequenceLength ( temp.c_str ( ) );
-        switch ( length )
+        __m256i bytes = _mm256_loadu_si256 ( ( __m256i const * ) ( in + i ) );
+        if ( unsigned mask = _mm256_movemask_epi8 ( bytes ) )
         {
-            case 2: addMultiByteSequence ( ~defines::minimumThreeByte ); break;
-            case 3: addMultiByteSequence ( ~defines::minimumFourByte ); break;
-            case 4: addMultiByteSequence ( ~defines::fourByteMask ); break;
-            default:
-                RUNTIME_ERROR ( "Unexpected Result from utf8SequenceLength: ",
-                                length )
+            return i + __builtin_ctz ( mask );
         }
     }
-    return total;
+    return i + asciiPrefixScalar ( in + i, size - i );
 }
 
-defines::ChrPString const
-        io::console::manip::narrow ( defines::U32Char const &c )
+__attribute__ ( ( target ( "avx2" ) ) ) std::size_t
+        widenAVX2 ( char const *in, std::size_t size, char32_t *out )
 {
-    // explicitly unsigned char to prevent subtraction from trying to
-    // kill us.
-    unsigned char *result =
-            ( unsigned char * ) new defines::ChrChar [ 5 ] { 0, 0, 0, 0, 0 };
+    std::size_t i = 0;
+    for ( ; i + 32 <= size; i += 32 )
+    {
+        __m256i bytes = _mm256_loadu_si256 ( ( __m256i const * ) ( in + i ) );
+        if ( _mm256_movemask_epi8 ( bytes ) )
+        {
+            break;
+        }
+        __m256i *to = ( __m256i * ) ( out + i );
+        for ( int part = 0; part < 4; part++ )
+        {
+            __m128i eight = _mm_loadl_epi64 (
+                    ( __m128i const * ) ( in + i + 8 * part ) );
+            _mm256_storeu_si256 ( to + part, _mm256_cvtepu8_epi32 ( eight ) );
+        }
+    }
+    return i + widenScalar ( in + i, size - i, out + i );
+}
 
-    if ( c <= ( unsigned char ) defines::maximumASCII )
+__attribute__ ( ( target ( "avx2" ) ) ) std::size_t
+        narrowAVX2 ( char32_t const *in, std::size_t size, char *out )
+{
+    __m256i const notASCII = _mm256_set1_epi32 ( ~0x7F );
+    // packing works within each half of the register, this puts the four
+    // runs of four characters back in order.
+    __m256i const order    = _mm256_setr_epi32 ( 0, 4, 1, 5, 2, 6, 3, 7 );
+    std::size_t   i        = 0;
+    for ( ; i + 32 <= size; i += 32 )
     {
-        result [ 0 ] = ( defines::ChrChar ) c;
-    } else if ( c < defines::maximumTwoByteEncoded )
+        __m256i const *from = ( __m256i const * ) ( in + i );
+        __m256i        a    = _mm256_loadu_si256 ( from + 0 );
+        __m256i        b    = _mm256_loadu_si256 ( from + 1 );
+        __m256i        c    = _mm256_loadu_si256 ( from + 2 );
+        __m256i        d    = _mm256_loadu_si256 ( from + 3 );
+        __m256i        any  = _mm256_or_si256 ( _mm256_or_si256 ( a, b ),
+                                        _mm256_or_si256 ( c, d ) );
+        if ( !_mm256_testz_si256 ( any, notASCII ) )
+        {
+            break;
+        }
+        __m256i bytes = _mm256_packus_epi16 ( _mm256_packs_epi32 ( a, b ),
+                                              _mm256_packs_epi32 ( c, d ) );
+        bytes         = _mm256_permutevar8x32_epi32 ( bytes, order );
+        _mm256_storeu_si256 ( ( __m256i * ) ( out + i ), bytes );
+    }
+    return i + narrowScalar ( in + i, size - i, out + i );
+}
+#endif // ifdef MANIP_AVX2
+
+bool hasAVX2 ( )
+{
+#ifdef MANIP_AVX2
+    static bool const result = __builtin_cpu_supports ( "avx2" );
+    return result;
+#else
+    return false;
+#endif
+}
+
+AsciiPrefixKernel asciiPrefixKernel ( )
+{
+#ifdef MANIP_AVX2
+    if ( hasAVX2 ( ) )
+    {
+        return &asciiPrefixAVX2;
+    }
+#endif
+#ifdef MANIP_SSE2
+    return &asciiPrefixSSE2;
+#else
+    return &asciiPrefixScalar;
+#endif
+}
+
+WidenKernel widenKernel ( )
+{
+#ifdef MANIP_AVX2
+    if ( hasAVX2 ( ) )
+    {
+        return &widenAVX2;
+    }
+#endif
+#ifdef MANIP_SSE2
+    return &widenSSE2;
+#else
+    return &widenScalar;
+#endif
+}
+
+NarrowKernel narrowKernel ( )
+{
+#ifdef MANIP_AVX2
+    if ( hasAVX2 ( ) )
     {
-        result [ 1 ] = ( unsigned char ) defines::minimumFollowing;
-        result [ 0 ] = ( unsigned char ) defines::firstTwoByte;
+        return &narrowAVX2;
+    }
+#endif
+#ifdef MANIP_SSE2
+    return &narrowSSE2;
+#else
+    return &narrowScalar;
+#endif
+}
+
+std::size_t io::console::manip::validateUTF08 (
+        std::string_view const &text ) noexcept
+{
+    static AsciiPrefixKernel const asciiPrefix = asciiPrefixKernel ( );
+
+    std::size_t i = 0;
+    while ( i < text.size ( ) )
+    {
+        i += asciiPrefix ( text.data ( ) + i, text.size ( ) - i );
+        if ( i == text.size ( ) )
+        {
+            break;
+        }
+        // not ASCII, so readCodePoint won't treat it as an escape sequence.
+        CodePoint codePoint = readCodePoint ( text.substr ( i ) );
+        if ( codePoint.type == CodePointType::INVALID_ )
+        {
+            return i;
+        }
+        i += codePoint.bytes.size ( );
+    }
+    return i;
+}
 
-        result [ 1 ] +=
-                ( c >> 0x00 ) & ~( unsigned char ) defines::firstTwoByte;
-        result [ 0 ] +=
-                ( c >> 0x06 ) & ~( unsigned char ) defines::minimumThreeByte;
-    } else if ( c >= 0xD800 && c <= 0xDFFF )
+std::size_t io::console::manip::encode ( defines::U32Char const &c,
+                                         defines::ChrChar ( &buffer ) [ 4 ] )
+{
+    if ( c < 0x80 )
+    {
+        buffer [ 0 ] = defines::ChrChar ( c );
+        return 1;
+    } else if ( c < defines::maximumTwoByteEncoded )
+    {
+        buffer [ 0 ] = defines::ChrChar ( 0xC0 | ( c >> 0x06 ) );
+        buffer [ 1 ] = defines::ChrChar ( 0x80 | ( c & 0x3F ) );
+        return 2;
+    } else if ( c >= defines::ucs2Deadzone [ 0 ]
+                && c <= defines::ucs2Deadzone [ 1 ] )
     {
-        delete [] result;
         RUNTIME_ERROR ( "Illegal UTF-8 Sequence!" )
     } else if ( c < defines::maximumThreeByteEncoded )
     {
-        result [ 2 ] = ( unsigned char ) defines::minimumFollowing;
-        result [ 1 ] = ( unsigned char ) defines::minimumFollowing;
-        result [ 0 ] = ( unsigned char ) defines::minimumThreeByte;
-
-        result [ 2 ] +=
-                ( c >> 0x00 ) & ~( unsigned char ) defines::firstTwoByte;
-        result [ 1 ] +=
-                ( c >> 0x06 ) & ~( unsigned char ) defines::firstTwoByte;
-        result [ 0 ] +=
-                ( c >> 0x0C ) & ~( unsigned char ) defines::minimumFourByte;
-    } else if ( c < 0x10FFFF )
-    {
-        result [ 3 ] = ( unsigned char ) defines::minimumFollowing;
-        result [ 2 ] = ( unsigned char ) defines::minimumFollowing;
-        result [ 1 ] = ( unsigned char ) defines::minimumFollowing;
-        result [ 0 ] = ( unsigned char ) defines::minimumFourByte;
-
-        result [ 3 ] +=
-                ( c >> 0x00 ) & ~( unsigned char ) defines::firstTwoByte;
-        result [ 2 ] +=
-                ( c >> 0x06 ) & ~( unsigned char ) defines::firstTwoByte;
-        result [ 1 ] +=
-                ( c >> 0x0C ) & ~( unsigned char ) defines::firstTwoByte;
-        result [ 0 ] +=
-                ( c >> 0x12 ) & ~( unsigned char ) defines::fourByteMask;
+        buffer [ 0 ] = defines::ChrChar ( 0xE0 | ( c >> 0x0C ) );
+        buffer [ 1 ] = defines::ChrChar ( 0x80 | ( ( c >> 0x06 ) & 0x3F ) );
+        buffer [ 2 ] = defines::ChrChar ( 0x80 | ( c & 0x3F ) );
+        return 3;
+    } else if ( c <= defines::maxUnicode )
+    {
+        buffer [ 0 ] = defines::ChrChar ( 0xF0 | ( c >> 0x12 ) );
+        buffer [ 1 ] = defines::ChrChar ( 0x80 | ( ( c >> 0x0C ) & 0x3F ) );
+        buffer [ 2 ] = defines::ChrChar ( 0x80 | ( ( c >> 0x06 ) & 0x3F ) );
+        buffer [ 3 ] = defines::ChrChar ( 0x80 | ( c & 0x3F ) );
+        return 4;
     } else
     {
-        delete [] result;
-        RUNTIME_ERROR ( "Out of bounds UTF-8 sequence!" );
+        RUNTIME_ERROR ( "Out of bounds UTF-8 sequence!" )
+    }
+}
+
+/**
+ * @brief Takes a C-string and widens it to a UTF-32 character sequence.
+ * @note Useful for querying the properties of a sequence.
+ *
+ * @param cstr
+ * @return char32_t
+ */
+defines::U32Char io::console::manip::widen ( defines::ChrPString const cstr )
+{
+    if ( !cstr )
+    {
+        RUNTIME_ERROR ( "Invalid Sequence: \"sequence\" was nullptr" )
+    }
+    // a code point takes at most four bytes, so don't look for the end of the
+    // string any further than that.
+    std::size_t length = 0;
+    while ( length < 4 && cstr [ length ] ) { length++; }
+    CodePoint codePoint = readCodePoint ( std::string_view ( cstr, length ) );
+    if ( codePoint.type == CodePointType::INVALID_ )
+    {
+        RUNTIME_ERROR ( "Invalid Sequence: starting with 0x",
+                        std::hex << std::uint32_t ( codePoint.value ) )
     }
-    return ( defines::ChrPString ) result;
+    return codePoint.value;
+}
+
+defines::ChrPString const
+        io::console::manip::narrow ( defines::U32Char const &c )
+{
+    defines::ChrChar  buffer [ 4 ];
+    // encode throws before we allocate anything
+    std::size_t       length = encode ( c, buffer );
+    defines::ChrChar *result = new defines::ChrChar [ 5 ] { 0, 0, 0, 0, 0 };
+    std::copy_n ( buffer, length, result );
+    return result;
 }
 
 bool io::console::manip::validUTF08 ( defines::ChrPString const &str )
@@ -1708,21 +2007,65 @@ template <>
 defines::ChrString const
         io::console::manip::convert ( defines::U32String const str )
 {
-    defines::ChrString temp = "";
-    for ( auto &cp : str ) { temp += narrow ( cp ); }
-    return temp;
+    static NarrowKernel const narrowASCII = narrowKernel ( );
+    // one byte per character is enough for ASCII. Grow when it isn't.
+    defines::ChrString result ( str.size ( ), '\0' );
+    std::size_t        in  = 0;
+    std::size_t        out = 0;
+    while ( in < str.size ( ) )
+    {
+        std::size_t ascii = narrowASCII ( str.data ( ) + in,
+                                          str.size ( ) - in,
+                                          result.data ( ) + out );
+        in += ascii;
+        out += ascii;
+        if ( in == str.size ( ) )
+        {
+            break;
+        }
+        defines::ChrChar buffer [ 4 ];
+        std::size_t      length = encode ( str [ in++ ], buffer );
+        // every character after this one needs at least one more byte.
+        result.resize ( std::max ( result.size ( ),
+                                   out + length + str.size ( ) - in ) );
+        std::copy_n ( buffer, length, result.data ( ) + out );
+        out += length;
+    }
+    result.resize ( out );
+    return result;
 }
 template <>
 defines::U32String const
         io::console::manip::convert ( defines::ChrString const str )
 {
-    defines::U32String temp = U"";
-    for ( std::size_t i = 0; i < str.size ( );
-          i += utf8SequenceLength ( &str.c_str ( ) [ i ] ) )
+    static WidenKernel const widenASCII = widenKernel ( );
+    // never more characters than bytes.
+    defines::U32String result ( str.size ( ), U'\0' );
+    std::string_view   text ( str );
+    std::size_t        in  = 0;
+    std::size_t        out = 0;
+    while ( in < text.size ( ) )
     {
-        temp += widen ( &str.c_str ( ) [ i ] );
+        std::size_t ascii = widenASCII ( text.data ( ) + in,
+                                         text.size ( ) - in,
+                                         result.data ( ) + out );
+        in += ascii;
+        out += ascii;
+        if ( in == text.size ( ) )
+        {
+            break;
+        }
+        // not ASCII, so readCodePoint won't treat it as an escape sequence.
+        CodePoint codePoint = readCodePoint ( text.substr ( in ) );
+        if ( codePoint.type == CodePointType::INVALID_ )
+        {
+            RUNTIME_ERROR ( "Invalid UTF-8 Sequence at byte ", in )
+        }
+        result [ out++ ] = codePoint.value;
+        in += codePoint.bytes.size ( );
     }
-    return temp;
+    result.resize ( out );
+    return result;
 }
 
 #define INCORRECT_SEQUENCE( TRANS, EXPECT, ... )                               \
@@ -1952,4 +2295,326 @@ bool testIdentification ( std::ostream &stream )
     return true;
 }
 
-test::Unittest identification ( testIdentification );
\ No newline at end of file
+test::Unittest identification ( testIdentification );
+bool testCodePoints ( std::ostream &stream )
+{
+    stream << "Beginning code point iteration unittest.\n";
+    defines::ChrString const text = "aé中\U0001F600\u001b[38;5;1mX"
+                                    "\u001b]4;1;rgb:ff/00/00\a\n";
+    struct Expected
+    {
+        defines::U32Char value;
+        std::size_t      length;
+        CodePointType    type;
+    };
+    std::vector< Expected > const expected = {
+            { U'a', 1, CodePointType::UTF1BYTE },
+            { U'é', 2, CodePointType::UTF2BYTE },
+            { U'中', 3, CodePointType::UTF3BYTE },
+            { 0x1F600, 4, CodePointType::UTF4BYTE },
+            { 0x1B, 9, CodePointType::TERMINAL },
+            { U'X', 1, CodePointType::UTF1BYTE },
+            { 0x1B, 19, CodePointType::TERMINAL },
+            { U'\n', 1, CodePointType::TERMINAL },
+    };
+    stream << "Ensuring that code points and sequences are read in place...\n";
+    std::size_t index    = 0;
+    std::size_t position = 0;
+    for ( auto const &codePoint : CodePoints ( text ) )
+    {
+        if ( index == expected.size ( ) )
+        {
+            BASIC_UNIT_FAIL ( stream, "Read too many code points" )
+        }
+        auto const &want = expected [ index++ ];
+        if ( codePoint.value != want.value
+             || codePoint.bytes.size ( ) != want.length
+             || codePoint.type != want.type
+             || codePoint.bytes.data ( ) != text.data ( ) + position )
+        {
+            CHAR_UNITTEST_FAIL ( stream,
+                                 "Misread code point",
+                                 "Code point " << index - 1 << " was U+"
+                                               << std::hex
+                                               << std::uint32_t (
+                                                          codePoint.value )
+                                               << std::dec << " with "
+                                               << codePoint.bytes.size ( )
+                                               << " bytes" )
+            END_UNIT_FAIL ( stream )
+        }
+        position += codePoint.bytes.size ( );
+    }
+    if ( index != expected.size ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Read too few code points" )
+    }
+    stream << "Ensuring that splitByCodePoint agrees...\n";
+    auto split = splitByCodePoint ( text );
+    if ( split.size ( ) != expected.size ( ) + 1 || split [ 5 ].size ( ) != 9 )
+    {
+        BASIC_UNIT_FAIL ( stream, "splitByCodePoint split differently" )
+    }
+    stream << "Ensuring that invalid sequences throw...\n";
+    for ( defines::ChrString bad : { "ok\xc0\x80", "\xe0\x80", "\u001bQ" } )
+    {
+        try
+        {
+            for ( auto const &codePoint : CodePoints ( bad ) )
+            {
+                ( void ) codePoint;
+            }
+            BASIC_UNIT_FAIL ( stream, "An invalid sequence was accepted" )
+        } catch ( std::runtime_error const & )
+        { }
+    }
+    return true;
+}
+
+test::Unittest codePoints ( testCodePoints );
+
+bool testTranscoding ( std::ostream &stream )
+{
+    stream << "Beginning transcoding unittest.\n";
+    stream << "Ensuring that every character encodes and decodes...\n";
+    for ( defines::U32Char c = 0; c <= defines::maxUnicode; c++ )
+    {
+        if ( !validUTF32 ( c ) )
+        {
+            continue;
+        }
+        defines::ChrChar buffer [ 4 ];
+        std::size_t      length = encode ( c, buffer );
+        CodePoint read = readCodePoint ( std::string_view ( buffer, length ) );
+        if ( read.value != c || read.bytes.size ( ) != length
+             || read.type == CodePointType::INVALID_ )
+        {
+            CHAR_UNITTEST_FAIL ( stream,
+                                 "Round trip failed",
+                                 "U+" << std::uint32_t ( c ) )
+            END_UNIT_FAIL ( stream )
+        }
+    }
+
+    // ASCII runs of every length around the vector widths, broken up by
+    // characters of every length.
+    defines::U32String wide = U"";
+    for ( std::size_t run = 0; run < 70; run++ )
+    {
+        wide += defines::U32String ( run, U'a' + run % 26 );
+        wide += U"é中\U0001F600"[ run % 3 ];
+    }
+    defines::ChrString narrowed = CHR_STRINGIZE ( );
+    for ( auto const &c : wide )
+    {
+        defines::ChrChar buffer [ 4 ];
+        narrowed.append ( buffer, encode ( c, buffer ) );
+    }
+
+    stream << "Ensuring that the vector kernels match the scalar ones...\n";
+    std::vector< std::pair< WidenKernel, NarrowKernel > > kernels = {
+            { &widenScalar, &narrowScalar }
+    };
+    std::vector< AsciiPrefixKernel > prefixes = { &asciiPrefixScalar };
+#ifdef MANIP_SSE2
+    kernels.push_back ( { &widenSSE2, &narrowSSE2 } );
+    prefixes.push_back ( &asciiPrefixSSE2 );
+#endif
+#ifdef MANIP_AVX2
+    if ( hasAVX2 ( ) )
+    {
+        kernels.push_back ( { &widenAVX2, &narrowAVX2 } );
+        prefixes.push_back ( &asciiPrefixAVX2 );
+    }
+#endif
+    for ( std::size_t start = 0; start < 64; start++ )
+    {
+        std::string_view const bytes =
+                std::string_view ( narrowed ).substr ( start );
+        std::u32string_view const points =
+                std::u32string_view ( wide ).substr ( start );
+        defines::U32String expectWide ( bytes.size ( ), 0 );
+        defines::ChrString expectNarrow ( points.size ( ), 0 );
+        std::size_t const  expectWidened = widenScalar (
+                bytes.data ( ), bytes.size ( ), expectWide.data ( ) );
+        std::size_t const expectNarrowed = narrowScalar (
+                points.data ( ), points.size ( ), expectNarrow.data ( ) );
+        for ( std::size_t k = 0; k < kernels.size ( ); k++ )
+        {
+            defines::U32String gotWide ( bytes.size ( ), 0 );
+            defines::ChrString gotNarrow ( points.size ( ), 0 );
+            std::size_t const  widened = kernels [ k ].first (
+                    bytes.data ( ), bytes.size ( ), gotWide.data ( ) );
+            std::size_t const narrowedCount = kernels [ k ].second (
+                    points.data ( ), points.size ( ), gotNarrow.data ( ) );
+            std::size_t const prefix =
+                    prefixes [ k ] ( bytes.data ( ), bytes.size ( ) );
+            if ( widened != expectWidened || prefix != expectWidened
+                 || gotWide != expectWide || narrowedCount != expectNarrowed
+                 || gotNarrow != expectNarrow )
+            {
+                CHAR_UNITTEST_FAIL ( stream,
+                                     "Kernels disagree",
+                                     "Kernel " << k << " at offset "
+                                               << start )
+                END_UNIT_FAIL ( stream )
+            }
+        }
+    }
+
+    stream << "Ensuring that whole strings convert both ways...\n";
+    if ( convert< defines::ChrChar, defines::U32Char > ( wide ) != narrowed
+         || convert< defines::U32Char, defines::ChrChar > ( narrowed ) != wide )
+    {
+        BASIC_UNIT_FAIL ( stream, "Whole string conversion failed" )
+    }
+
+    stream << "Ensuring that validation finds the first invalid byte...\n";
+    if ( validateUTF08 ( narrowed ) != narrowed.size ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Valid text was marked invalid" )
+    }
+    for ( std::size_t at : { std::size_t ( 0 ), std::size_t ( 40 ),
+                             narrowed.size ( ) - 1 } )
+    {
+        defines::ChrString broken = narrowed;
+        // skip to the start of a code point
+        while ( ( ( unsigned char ) broken [ at ] & 0xC0 ) == 0x80 ) { at--; }
+        broken [ at ] = ( defines::ChrChar ) 0xFF;
+        if ( validateUTF08 ( broken ) != at )
+        {
+            CHAR_UNITTEST_FAIL ( stream,
+                                 "Invalid byte missed",
+                                 "Expected 0x" << at << " but got 0x"
+                                               << validateUTF08 ( broken ) )
+            END_UNIT_FAIL ( stream )
+        }
+    }
+    return true;
+}
+
+test::Unittest transcoding ( testTranscoding );
+
+bool testLineBreaking ( std::ostream &stream )
+{
+    stream << "Beginning line breaking unittest.\n";
+    // the first narrow and wide code point of each class, where there is one
+    std::vector< defines::U32Char > samples;
+    std::vector< std::uint8_t >     seen ( breakingCount, 0 );
+    for ( defines::U32Char c = 0; c <= defines::maxUnicode; c++ )
+    {
+        auto const properties = characterProperties ( ).lookup ( c );
+        std::uint8_t const bit  = properties.columns ? 2 : 1;
+        if ( !validUTF32 ( c ) || ( seen [ properties.lineBreaking ] & bit ) )
+        {
+            continue;
+        }
+        seen [ properties.lineBreaking ] |= bit;
+        samples.push_back ( c );
+    }
+    auto compare = [ & ] ( defines::U32String const &text ) {
+        defines::ChrString const narrowed =
+                convert< defines::ChrChar, defines::U32Char > ( text );
+        return generateTextInseperables ( narrowed )
+            == inseperablesByRules ( narrowed );
+    };
+
+    stream << "Ensuring that the pair table agrees with the rules for 0x"
+           << samples.size ( ) << " sample characters...\n";
+    // every pair and every pair after a space, a zero width space, or a
+    // letter and spaces, which covers each context the table has.
+    defines::U32String const prefixes [] = {
+            U"", U" ", U"​", U"​  ", U"a  ", U"א-" };
+    for ( auto const &prefix : prefixes )
+    {
+        for ( auto const &before : samples )
+        {
+            for ( auto const &after : samples )
+            {
+                defines::U32String text = prefix;
+                text += before;
+                text += after;
+                if ( !compare ( text ) )
+                {
+                    CHAR_UNITTEST_FAIL ( stream,
+                                         "Line breaking changed",
+                                         "Between U+"
+                                                 << std::uint32_t ( before )
+                                                 << " and U+"
+                                                 << std::uint32_t ( after ) )
+                    END_UNIT_FAIL ( stream )
+                }
+            }
+        }
+    }
+    stream << "Ensuring that the pair table agrees with the rules on longer "
+              "text...\n";
+    std::mt19937 generator ( 14 );
+    for ( std::size_t i = 0; i < 0x4000; i++ )
+    {
+        defines::U32String text;
+        for ( std::size_t j = 0; j < 12; j++ )
+        {
+            text += samples [ generator ( ) % samples.size ( ) ];
+        }
+        if ( !compare ( text ) )
+        {
+            BASIC_UNIT_FAIL ( stream, "Line breaking changed on longer text" )
+        }
+    }
+
+    stream << "Ensuring that text can stream into the line breaker...\n";
+    defines::ChrString const text = "Hello \u001b[1mthere\u001b[m, "
+                                    "\u001b]0;a title\a(wörld) 中文\r\n"
+                                    "x\u200b  y";
+    auto const expected = inseperablesByRules ( text );
+    for ( std::size_t size = 1; size <= text.size ( ); size++ )
+    {
+        LineBreaker                       breaker;
+        Inseperable                       part;
+        std::vector< defines::ChrString > parts;
+        for ( std::size_t at = 0; at < text.size ( ); at += size )
+        {
+            breaker.feed ( std::string_view ( text ).substr ( at, size ) );
+            while ( breaker.pull ( part ) )
+            {
+                parts.push_back ( part.text );
+            }
+        }
+        // every part but the last is ready before the text ends
+        if ( parts.size ( ) + 1 != expected.size ( ) )
+        {
+            CHAR_UNITTEST_FAIL ( stream,
+                                 "Line breaker held onto too much",
+                                 "Feeding 0x" << size << " bytes at a time" )
+            END_UNIT_FAIL ( stream )
+        }
+        breaker.finish ( );
+        while ( breaker.pull ( part ) )
+        {
+            parts.push_back ( part.text );
+        }
+        if ( parts != expected )
+        {
+            CHAR_UNITTEST_FAIL ( stream,
+                                 "Streamed line breaking changed",
+                                 "Feeding 0x" << size << " bytes at a time" )
+            END_UNIT_FAIL ( stream )
+        }
+    }
+    LineBreaker breaker;
+    Inseperable part;
+    breaker.feed ( "one\ntwo " );
+    if ( !breaker.pull ( part ) || !part.mandatory || part.text != "one\n" )
+    {
+        BASIC_UNIT_FAIL ( stream, "A hard line break was not marked" )
+    }
+    breaker.finish ( );
+    if ( !breaker.pull ( part ) || part.mandatory || part.text != "two " )
+    {
+        BASIC_UNIT_FAIL ( stream, "A soft line break was marked as hard" )
+    }
+    return true;
+}
+
+test::Unittest lineBreaking ( testLineBreaking );
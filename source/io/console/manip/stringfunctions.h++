@@ -16,8 +16,12 @@
 #include <defines/manip.h++>
 #include <defines/types.h++>
 
+#include <cstddef>
+#include <iterator>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace io::console::manip
@@ -65,9 +69,96 @@ namespace io::console::manip
                 convert< defines::ChrChar, defines::U08Char > ( str ) );
     }
 
+    /**
+     * @brief Type of a code point.
+     *
+     */
+    enum class CodePointType
+    {
+        TERMINAL, // ansi escape sequence or control character, [0x00 - 0x20]
+        UTF1BYTE, // one byte utf-8 starts with [0x20 - 0x7f]
+        UTF2BYTE, // two byte utf-8 starts with [0xC0 - 0xDF]
+        UTF3BYTE, // three byte utf-8 starts with [0xE0 - 0xEf]
+        UTF4BYTE, // four byte utf-8 starts with [0xF0 - 0xF8]
+        UTFNBYTE, // unknown, but it's probably unicode? perhaps 5-byte?
+        INVALID_, // we know we errored out and found a character we know to be
+                  // invalid. includes characters outside the range of unicode.
+        _MAX,     // maximum value
+    };
+
+    /**
+     * @brief One code point of a string, or one whole terminal sequence. A
+     * terminal sequence uses its first byte as its value.
+     */
+    struct CodePoint
+    {
+        defines::U32Char value = 0;
+        // the bytes of the code point in the string it came from.
+        std::string_view bytes;
+        CodePointType    type = CodePointType::TERMINAL;
+    };
+
+    /**
+     * @brief Reads the code point at the start of the text without
+     * allocating. An invalid sequence comes back as its first byte with a type
+     * of CodePointType::INVALID_.
+     *
+     * @return CodePoint
+     */
+    CodePoint readCodePoint ( std::string_view const & );
+
+    /**
+     * @brief Walks over the code points of a string in place.
+     * @throw std::runtime_error when it reaches an invalid sequence or a
+     * private use sequence, just as splitByCodePoint does.
+     */
+    class CodePointIterator
+    {
+        // what comes after current.
+        std::string_view rest;
+        CodePoint        current;
+
+        void read ( );
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = CodePoint;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = CodePoint const *;
+        using reference         = CodePoint const &;
+
+        CodePointIterator ( ) noexcept = default;
+        CodePointIterator ( std::string_view const & );
+
+        reference operator* ( ) const noexcept { return current; }
+        pointer   operator->( ) const noexcept { return &current; }
+
+        CodePointIterator &operator++ ( );
+        CodePointIterator  operator++ ( int );
+
+        bool operator== ( CodePointIterator const & ) const noexcept;
+    };
+
+    /**
+     * @brief The code points of a string, for use in a range-based for loop.
+     * The string must outlive the range.
+     */
+    class CodePoints
+    {
+        std::string_view text;
+    public:
+        CodePoints ( std::string_view const &text ) noexcept : text ( text ) { }
+
+        CodePointIterator begin ( ) const { return CodePointIterator ( text ); }
+        CodePointIterator end ( ) const noexcept
+        {
+            return CodePointIterator ( );
+        }
+    };
+
     /**
      *
      * @brief Splits the string into a vector of its code-points.
+     * @note Copies every code point. Prefer iterating over CodePoints.
      * @param std::string the string to split
      * @throw Throws std::runtime_error if there is an invalid / unknown code
      * point.
@@ -87,6 +178,48 @@ namespace io::console::manip
     std::vector< defines::ChrString >
             generateTextInseperables ( defines::ChrString );
 
+    /**
+     * @brief A part of text which is not allowed to be split across lines.
+     */
+    struct Inseperable
+    {
+        defines::ChrString text;
+        // whether the text ends in a hard line break, so that whatever comes
+        // next must start a new line.
+        bool               mandatory = false;
+    };
+
+    /**
+     * @brief Finds the same parts as generateTextInseperables while the text
+     * streams in. No rule looks further ahead than the next code point, so a
+     * part is ready as soon as the code point after it arrives. Text may be
+     * cut anywhere, even in the middle of a code point or terminal sequence.
+     */
+    class LineBreaker
+    {
+        struct impl_s;
+        std::unique_ptr< impl_s > pimpl;
+    public:
+        LineBreaker ( );
+        virtual ~LineBreaker ( );
+
+        /**
+         * @throw std::runtime_error on an invalid or private use sequence,
+         * just as CodePointIterator does.
+         */
+        void feed ( std::string_view const & );
+        /**
+         * @brief Marks the end of the text, which readies the last part.
+         * Afterwards, the breaker starts over on the next text fed to it.
+         */
+        void finish ( );
+        /**
+         * @brief Takes the next part that is ready.
+         * @return whether there was a part ready.
+         */
+        bool pull ( Inseperable & );
+    };
+
     /**
      * @brief (Attempts to) Center text on a line of the specified size.
      * Attempts to make the parity of columns occupied by the string identical
@@ -117,12 +250,32 @@ namespace io::console::manip
      * @brief Narrows a UTF-32 sequence into the equivalent UTF-8 sequence.
      * Always allocates 5-bytes, unless it throws (it deallocates before
      * throwing)
+     * @note The caller must delete[] the result. Prefer encode.
      *
      * @param c
      * @return char* const
      */
     defines::ChrPString const narrow ( defines::U32Char const &c );
 
+    /**
+     * @brief Encodes one UTF-32 character as UTF-8 into the buffer.
+     * @throw std::runtime_error if the character is a surrogate or lies
+     * beyond unicode.
+     *
+     * @return how many bytes of the buffer were used, from one to four.
+     */
+    std::size_t encode ( defines::U32Char const &,
+                         defines::ChrChar ( & ) [ 4 ] );
+
+    /**
+     * @brief Checks a whole buffer of UTF-8, skipping over runs of ASCII with
+     * vector instructions when the processor has them.
+     *
+     * @return the offset of the first byte that does not start a valid
+     * sequence, or the size of the text if all of it is valid.
+     */
+    std::size_t validateUTF08 ( std::string_view const & ) noexcept;
+
     /**
      * @brief Checks if a string starts with a valid UTF-8 code point
      *
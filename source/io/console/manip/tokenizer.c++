@@ -0,0 +1,512 @@
+/**
+ * @file tokenizer.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of the tokenizer
+ * @version 1
+ * @date 2022-03-04
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/console/manip/tokenizer.h++>
+
+#include <defines/constants.h++>
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <test/unittester.h++>
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace io::console::manip;
+
+/**
+ * @brief What the state machine needs to know about a byte.
+ *
+ */
+enum class ByteClass : std::uint8_t
+{
+    INTERMEDIATE, // [0x20, 0x2F], may come between ESC and its final byte
+    PARAMETER,    // [0x30, 0x3F], the parameters of a CSI
+    FINAL,        // [0x40, 0x7E], other than those below
+    OPEN_CSI,     // [
+    OPEN_STRING,  // ], P, ^, and _
+    OPEN_SOS,     // X
+    SHIFT,        // N and O, the single shifts
+    BACKSLASH,    // \, which finishes the string terminator
+    HIGH,         // [0x80, 0xFF], part of a UTF-8 sequence
+    ESCAPE,       // ESC
+    BELL,         // BEL, which xterm accepts in place of the string terminator
+    FORMAT,       // [0x08, 0x0D], allowed in the middle of a string
+    CONTROL,      // the other control characters, and DEL
+    _MAX,         // maximum value
+};
+
+enum class State : std::uint8_t
+{
+    GROUND,        // in text
+    ESCAPE,        // after ESC
+    INTERMEDIATE,  // after ESC and at least one intermediate byte
+    SHIFT,         // after a single shift, which takes one more character
+    CSI,           // in a control sequence
+    STRING,        // in an OSC, DCS, PM, or APC
+    STRING_ESCAPE, // after an ESC in one of those
+    SOS,           // in a SOS
+    SOS_ESCAPE,    // after an ESC in a SOS
+    _MAX,          // maximum value
+};
+
+enum class Action : std::uint8_t
+{
+    TEXT,     // the byte belongs to a run of text
+    CONTROL,  // the byte is a token of its own
+    START,    // the byte starts a sequence
+    CONTINUE, // the byte continues the sequence
+    END,      // the byte ends the sequence
+    ABORT,    // the sequence ended before the byte, which is read again
+    RESTART,  // the sequence ended before the ESC preceding the byte. That ESC
+              // starts another sequence and the byte is read again.
+};
+
+struct Transition
+{
+    State  next   = State::GROUND;
+    Action action = Action::TEXT;
+};
+
+constexpr std::size_t classCount = std::size_t ( ByteClass::_MAX );
+constexpr std::size_t stateCount = std::size_t ( State::_MAX );
+
+constexpr std::array< ByteClass, 256 > byteClasses = [] ( ) {
+    std::array< ByteClass, 256 > result {};
+    for ( std::size_t b = 0; b < result.size ( ); b++ )
+    {
+        if ( b < 0x08 || ( b > 0x0D && b < 0x20 ) || b == 0x7F )
+        {
+            result [ b ] = ByteClass::CONTROL;
+        } else if ( b < 0x20 )
+        {
+            result [ b ] = ByteClass::FORMAT;
+        } else if ( b < 0x30 )
+        {
+            result [ b ] = ByteClass::INTERMEDIATE;
+        } else if ( b < 0x40 )
+        {
+            result [ b ] = ByteClass::PARAMETER;
+        } else if ( b < 0x7F )
+        {
+            result [ b ] = ByteClass::FINAL;
+        } else
+        {
+            result [ b ] = ByteClass::HIGH;
+        }
+    }
+    result [ 0x07 ] = ByteClass::BELL;
+    result [ 0x1B ] = ByteClass::ESCAPE;
+    result [ '[' ]  = ByteClass::OPEN_CSI;
+    result [ ']' ]  = ByteClass::OPEN_STRING;
+    result [ 'P' ]  = ByteClass::OPEN_STRING;
+    result [ '^' ]  = ByteClass::OPEN_STRING;
+    result [ '_' ]  = ByteClass::OPEN_STRING;
+    result [ 'X' ]  = ByteClass::OPEN_SOS;
+    result [ 'N' ]  = ByteClass::SHIFT;
+    result [ 'O' ]  = ByteClass::SHIFT;
+    result [ '\\' ] = ByteClass::BACKSLASH;
+    return result;
+}( );
+
+constexpr std::array< std::array< Transition, classCount >, stateCount >
+        transitions = [] ( ) {
+            using C = ByteClass;
+            using S = State;
+            using A = Action;
+            std::array< std::array< Transition, classCount >, stateCount >
+                    result {};
+            auto set = [ & ] ( S from, C on, S to, A action ) {
+                result [ std::size_t ( from ) ][ std::size_t ( on ) ] = {
+                        to,
+                        action };
+            };
+            auto setAll = [ & ] ( S from, S to, A action ) {
+                for ( std::size_t on = 0; on < classCount; on++ )
+                {
+                    set ( from, C ( on ), to, action );
+                }
+            };
+            // bytes that cannot appear in the short sequences
+            constexpr C breaking [] = {
+                    C::ESCAPE, C::BELL, C::FORMAT, C::CONTROL, C::HIGH };
+
+            // text, where every control character stands on its own
+            setAll ( S::GROUND, S::GROUND, A::TEXT );
+            set ( S::GROUND, C::BELL, S::GROUND, A::CONTROL );
+            set ( S::GROUND, C::FORMAT, S::GROUND, A::CONTROL );
+            set ( S::GROUND, C::CONTROL, S::GROUND, A::CONTROL );
+            set ( S::GROUND, C::ESCAPE, S::ESCAPE, A::START );
+
+            // ESC and one more byte, unless that byte introduces something
+            // longer
+            setAll ( S::ESCAPE, S::GROUND, A::END );
+            set ( S::ESCAPE, C::INTERMEDIATE, S::INTERMEDIATE, A::CONTINUE );
+            set ( S::ESCAPE, C::OPEN_CSI, S::CSI, A::CONTINUE );
+            set ( S::ESCAPE, C::OPEN_STRING, S::STRING, A::CONTINUE );
+            set ( S::ESCAPE, C::OPEN_SOS, S::SOS, A::CONTINUE );
+            set ( S::ESCAPE, C::SHIFT, S::SHIFT, A::CONTINUE );
+            for ( C on : breaking )
+            {
+                set ( S::ESCAPE, on, S::GROUND, A::ABORT );
+            }
+
+            // sequences like ESC ( B, which picks a character set
+            setAll ( S::INTERMEDIATE, S::GROUND, A::END );
+            set ( S::INTERMEDIATE,
+                  C::INTERMEDIATE,
+                  S::INTERMEDIATE,
+                  A::CONTINUE );
+            for ( C on : breaking )
+            {
+                set ( S::INTERMEDIATE, on, S::GROUND, A::ABORT );
+            }
+
+            // single shifts take exactly one more character
+            setAll ( S::SHIFT, S::GROUND, A::END );
+            for ( C on : breaking )
+            {
+                set ( S::SHIFT, on, S::GROUND, A::ABORT );
+            }
+
+            // control sequences run until a final byte
+            setAll ( S::CSI, S::GROUND, A::END );
+            set ( S::CSI, C::INTERMEDIATE, S::CSI, A::CONTINUE );
+            set ( S::CSI, C::PARAMETER, S::CSI, A::CONTINUE );
+            set ( S::CSI, C::BELL, S::CSI, A::CONTINUE );
+            set ( S::CSI, C::FORMAT, S::CSI, A::CONTINUE );
+            set ( S::CSI, C::CONTROL, S::CSI, A::CONTINUE );
+            set ( S::CSI, C::HIGH, S::CSI, A::CONTINUE );
+            set ( S::CSI, C::ESCAPE, S::GROUND, A::ABORT );
+
+            // strings run until BEL or the string terminator (ESC \). Any
+            // other control character cuts them short.
+            setAll ( S::STRING, S::STRING, A::CONTINUE );
+            set ( S::STRING, C::BELL, S::GROUND, A::END );
+            set ( S::STRING, C::CONTROL, S::GROUND, A::END );
+            set ( S::STRING, C::ESCAPE, S::STRING_ESCAPE, A::CONTINUE );
+            setAll ( S::STRING_ESCAPE, S::ESCAPE, A::RESTART );
+            set ( S::STRING_ESCAPE, C::BACKSLASH, S::GROUND, A::END );
+
+            // SOS may hold anything but ESC X or the string terminator
+            setAll ( S::SOS, S::SOS, A::CONTINUE );
+            set ( S::SOS, C::ESCAPE, S::SOS_ESCAPE, A::CONTINUE );
+            setAll ( S::SOS_ESCAPE, S::SOS, A::CONTINUE );
+            set ( S::SOS_ESCAPE, C::ESCAPE, S::SOS_ESCAPE, A::CONTINUE );
+            set ( S::SOS_ESCAPE, C::BACKSLASH, S::GROUND, A::END );
+            set ( S::SOS_ESCAPE, C::OPEN_SOS, S::GROUND, A::END );
+            return result;
+        }( );
+
+inline Transition const &transition ( State const &state, char const &byte )
+{
+    return transitions [ std::size_t ( state ) ][ std::size_t (
+            byteClasses [ ( unsigned char ) byte ] ) ];
+}
+
+// what a sequence is, from its introducer.
+TokenType typeOf ( std::string_view const &sequence )
+{
+    if ( sequence.size ( ) < 2 )
+    {
+        return TokenType::ESCAPE;
+    }
+    switch ( sequence [ 1 ] )
+    {
+        case '[': return TokenType::CSI;
+        case ']': return TokenType::OSC;
+        case 'P': return TokenType::DCS;
+        case 'X': return TokenType::SOS;
+        case '^': return TokenType::PM;
+        case '_': return TokenType::APC;
+        default: return TokenType::ESCAPE;
+    }
+}
+
+// how many bytes the UTF-8 sequence starting with this byte takes.
+std::size_t utf8Length ( char const &lead )
+{
+    unsigned const byte = ( unsigned char ) lead;
+    return byte >= 0xF0 ? 4 : byte >= 0xE0 ? 3 : byte >= 0xC0 ? 2 : 1;
+}
+
+bool isContinuation ( char const &byte )
+{
+    return ( ( unsigned char ) byte & 0xC0 ) == 0x80;
+}
+
+// how many bytes at the end of the text belong to a UTF-8 sequence that the
+// text cuts off.
+std::size_t incompleteTail ( std::string_view const &text )
+{
+    for ( std::size_t back = 1; back <= 3 && back <= text.size ( ); back++ )
+    {
+        char const &byte = text [ text.size ( ) - back ];
+        if ( !isContinuation ( byte ) )
+        {
+            return utf8Length ( byte ) > back ? back : 0;
+        }
+    }
+    return 0;
+}
+
+struct io::console::manip::Tokenizer::impl_s
+{
+    State       state = State::GROUND;
+    // the start of a token that the last chunk cut off.
+    std::string held;
+};
+
+io::console::manip::Tokenizer::Tokenizer ( ) : pimpl ( new impl_s ( ) ) { }
+io::console::manip::Tokenizer::~Tokenizer ( ) = default;
+
+void io::console::manip::Tokenizer::feed ( std::string_view const &chunk,
+                                           TokenHandler const     &handler )
+{
+    State       &state = pimpl->state;
+    std::string &held  = pimpl->held;
+    std::size_t  i     = 0;
+    if ( state == State::GROUND && !held.empty ( ) )
+    {
+        // finish the UTF-8 character the last chunk cut off, unless this chunk
+        // shows that it was broken.
+        std::size_t const needed = utf8Length ( held.front ( ) );
+        while ( held.size ( ) < needed && i < chunk.size ( )
+                && isContinuation ( chunk [ i ] ) )
+        {
+            held += chunk [ i++ ];
+        }
+        if ( held.size ( ) < needed && i == chunk.size ( ) )
+        {
+            return;
+        }
+        handler ( Token { TokenType::TEXT, held } );
+        held.clear ( );
+    }
+
+    // where the token being read starts in this chunk
+    std::size_t start = i;
+
+    auto endText = [ & ] ( std::size_t const &end ) {
+        if ( end > start )
+        {
+            handler ( Token { TokenType::TEXT,
+                              chunk.substr ( start, end - start ) } );
+        }
+        start = end;
+    };
+    auto endSequence = [ & ] ( std::size_t const &end ) {
+        if ( held.empty ( ) )
+        {
+            std::string_view bytes = chunk.substr ( start, end - start );
+            handler ( Token { typeOf ( bytes ), bytes } );
+        } else
+        {
+            held.append ( chunk.substr ( start, end - start ) );
+            handler ( Token { typeOf ( held ), held } );
+            held.clear ( );
+        }
+        start = end;
+    };
+
+    while ( i < chunk.size ( ) )
+    {
+        Transition const &next = transition ( state, chunk [ i ] );
+        state                  = next.next;
+        switch ( next.action )
+        {
+            case Action::TEXT:
+            case Action::CONTINUE: i++; break;
+            case Action::CONTROL:
+                endText ( i );
+                handler ( Token { TokenType::CONTROL, chunk.substr ( i, 1 ) } );
+                start = ++i;
+                break;
+            case Action::START:
+                endText ( i );
+                i++;
+                break;
+            case Action::END: endSequence ( ++i ); break;
+            case Action::ABORT:
+                // read the byte again, now in text.
+                endSequence ( i );
+                break;
+            case Action::RESTART:
+                if ( i > start )
+                {
+                    endSequence ( i - 1 );
+                } else
+                {
+                    // the ESC was the last byte of the last chunk
+                    held.pop_back ( );
+                    handler ( Token { typeOf ( held ), held } );
+                    held.assign ( 1, '\u001b' );
+                }
+                break;
+        }
+    }
+
+    if ( state == State::GROUND )
+    {
+        endText ( chunk.size ( ) - incompleteTail ( chunk.substr ( start ) ) );
+    }
+    held.append ( chunk.substr ( start ) );
+}
+
+void io::console::manip::Tokenizer::flush ( TokenHandler const &handler )
+{
+    if ( !pimpl->held.empty ( ) )
+    {
+        TokenType type = pimpl->state == State::GROUND
+                               ? TokenType::TEXT
+                               : typeOf ( pimpl->held );
+        handler ( Token { type, pimpl->held } );
+    }
+    pimpl->held.clear ( );
+    pimpl->state = State::GROUND;
+}
+
+bool io::console::manip::Tokenizer::pending ( ) const noexcept
+{
+    return !pimpl->held.empty ( );
+}
+
+std::size_t io::console::manip::sequenceLength (
+        std::string_view const &text ) noexcept
+{
+    State state = State::GROUND;
+    for ( std::size_t i = 0; i < text.size ( ); i++ )
+    {
+        Transition const &next = transition ( state, text [ i ] );
+        state                  = next.next;
+        switch ( next.action )
+        {
+            case Action::START:
+            case Action::CONTINUE: break;
+            case Action::ABORT: return i;
+            case Action::RESTART: return i - 1;
+            // a sequence that has ended, or the text did not start with ESC
+            default: return i + 1;
+        }
+    }
+    return text.size ( );
+}
+
+struct TokenizerTestCase
+{
+    defines::ChrString              text;
+    std::vector< TokenType >        types;
+    std::vector< defines::ChrString > tokens;
+};
+
+bool testTokenizer ( std::ostream &stream )
+{
+    stream << "Beginning tokenizer unittest.\n";
+    std::vector< TokenizerTestCase > const cases = {
+            { "plain é中\U0001F600 text\n",
+              { TokenType::TEXT, TokenType::CONTROL },
+              { "plain é中\U0001F600 text", "\n" } },
+            { "\u001b[38;5;1mred\u001b[m",
+              { TokenType::CSI, TokenType::TEXT, TokenType::CSI },
+              { "\u001b[38;5;1m", "red", "\u001b[m" } },
+            { "\u001b]4;1;rgb:ff/00/00\a\u001b]0;title\u001b\\",
+              { TokenType::OSC, TokenType::OSC },
+              { "\u001b]4;1;rgb:ff/00/00\a", "\u001b]0;title\u001b\\" } },
+            { "\u001b]0;cut\u001b[m",
+              { TokenType::OSC, TokenType::CSI },
+              { "\u001b]0;cut", "\u001b[m" } },
+            { "\u001bPq#0\u001b\\\u001bX\u001b[not csi\u001b\\",
+              { TokenType::DCS, TokenType::SOS },
+              { "\u001bPq#0\u001b\\", "\u001bX\u001b[not csi\u001b\\" } },
+            { "\u001b(B\u001bOP\u001b\u001b7",
+              { TokenType::ESCAPE,
+                TokenType::ESCAPE,
+                TokenType::ESCAPE,
+                TokenType::ESCAPE },
+              { "\u001b(B", "\u001bOP", "\u001b", "\u001b7" } },
+    };
+    for ( auto const &test : cases )
+    {
+        // every way of cutting the text in two, along with one byte at a time
+        for ( std::size_t cut = 0; cut <= test.text.size ( ) + 1; cut++ )
+        {
+            std::vector< TokenType >          types;
+            std::vector< defines::ChrString > tokens;
+            TokenHandler handler = [ & ] ( Token const &token ) {
+                // runs of text may come in pieces
+                if ( token.type == TokenType::TEXT && !types.empty ( )
+                     && types.back ( ) == TokenType::TEXT )
+                {
+                    tokens.back ( ).append ( token.bytes );
+                } else
+                {
+                    types.push_back ( token.type );
+                    tokens.emplace_back ( token.bytes );
+                }
+            };
+            Tokenizer        tokenizer;
+            std::string_view text = test.text;
+            if ( cut > text.size ( ) )
+            {
+                for ( auto const &byte : text )
+                {
+                    tokenizer.feed ( std::string_view ( &byte, 1 ), handler );
+                }
+            } else
+            {
+                tokenizer.feed ( text.substr ( 0, cut ), handler );
+                tokenizer.feed ( text.substr ( cut ), handler );
+            }
+            if ( tokenizer.pending ( ) )
+            {
+                BASIC_UNIT_FAIL ( stream, "Text was left in the tokenizer" )
+            }
+            if ( types != test.types || tokens != test.tokens )
+            {
+                CHAR_UNITTEST_FAIL ( stream,
+                                     "Incorrect tokens",
+                                     "Cutting at 0x"
+                                             << cut << " gave 0x"
+                                             << tokens.size ( )
+                                             << " tokens for the text \""
+                                             << test.text << "\"" )
+                END_UNIT_FAIL ( stream )
+            }
+        }
+        if ( sequenceLength ( test.text ) != test.tokens.front ( ).size ( )
+             && test.types.front ( ) != TokenType::TEXT )
+        {
+            BASIC_UNIT_FAIL ( stream,
+                              "sequenceLength disagrees with the tokenizer" )
+        }
+    }
+    stream << "Ensuring that cut off sequences are held and flushed...\n";
+    Tokenizer                         tokenizer;
+    std::vector< defines::ChrString > tokens;
+    TokenHandler                      handler = [ & ] ( Token const &token ) {
+        tokens.emplace_back ( token.bytes );
+    };
+    tokenizer.feed ( "ab\u001b]0;ti", handler );
+    if ( !tokenizer.pending ( ) || tokens.size ( ) != 1 )
+    {
+        BASIC_UNIT_FAIL ( stream, "A cut off OSC was not held" )
+    }
+    tokenizer.flush ( handler );
+    if ( tokenizer.pending ( ) || tokens.back ( ) != "\u001b]0;ti" )
+    {
+        BASIC_UNIT_FAIL ( stream, "A cut off OSC was not flushed" )
+    }
+    return true;
+}
+
+test::Unittest tokenizerTest { &testTokenizer };
@@ -0,0 +1,90 @@
+/**
+ * @file tokenizer.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Splits text into runs of text and terminal sequences as it streams in
+ * @version 1
+ * @date 2022-03-04
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <defines/constants.h++>
+#include <defines/macros.h++>
+#include <defines/types.h++>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+namespace io::console::manip
+{
+    /**
+     * @brief What a token holds.
+     *
+     */
+    enum class TokenType : std::uint8_t
+    {
+        TEXT,    // a run of text, never splitting a UTF-8 sequence
+        CONTROL, // a single control character, such as a line feed
+        ESCAPE,  // ESC followed by up to one final byte, or a single shift
+        CSI,     // Control Sequence Introducer: ESC [ ... final byte
+        OSC,     // Operating System Command: ESC ] ... BEL or ST
+        DCS,     // Device Control String: ESC P ... BEL or ST
+        SOS,     // Start Of String: ESC X ... ST
+        PM,      // Privacy Message: ESC ^ ... BEL or ST
+        APC,     // Application Program Command: ESC _ ... BEL or ST
+        _MAX,    // maximum value
+    };
+
+    /**
+     * @brief One token. The bytes belong to the text given to the tokenizer,
+     * or, for a token that spans more than one chunk, to the tokenizer itself,
+     * in which case they only last until the handler returns.
+     */
+    struct Token
+    {
+        TokenType        type = TokenType::TEXT;
+        std::string_view bytes;
+    };
+
+    using TokenHandler = std::function< void ( Token const & ) >;
+
+    /**
+     * @brief Splits text into tokens with a state machine driven by a table
+     * of byte classes. Text can arrive in chunks of any size: a sequence (or
+     * a UTF-8 character) cut off at the end of a chunk is held until the chunk
+     * that finishes it arrives.
+     */
+    class Tokenizer
+    {
+        struct impl_s;
+        std::unique_ptr< impl_s > pimpl;
+    public:
+        Tokenizer ( );
+        virtual ~Tokenizer ( );
+
+        void feed ( std::string_view const &, TokenHandler const & );
+        /**
+         * @brief Hands over whatever the tokenizer holds as it is and starts
+         * over.
+         */
+        void flush ( TokenHandler const & );
+        /**
+         * @brief Whether the tokenizer holds the start of a token.
+         */
+        bool pending ( ) const noexcept;
+    };
+
+    /**
+     * @brief How many bytes the sequence at the start of the text takes, using
+     * the same rules as the Tokenizer. A sequence that the text cuts off takes
+     * the rest of the text.
+     *
+     * @return std::size_t
+     */
+    std::size_t sequenceLength ( std::string_view const & ) noexcept;
+} // namespace io::console::manip
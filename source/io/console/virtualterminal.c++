@@ -0,0 +1,807 @@
+/**
+ * @file virtualterminal.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of the virtual terminal
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/console/virtualterminal.h++>
+
+#include <defines/constants.h++>
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <io/console/conmanip.h++>
+#include <io/console/console.h++>
+#include <io/console/manip/stringfunctions.h++>
+#include <io/console/manip/tokenizer.h++>
+#include <io/unicode/character.h++>
+#include <test/unittester.h++>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using io::console::internal::Cell;
+using io::console::internal::Pen;
+
+// enough for the sixteen colors a Linux console lets us change.
+constexpr std::size_t virtualPaletteLength = 16;
+
+struct io::console::VirtualTerminal::impl_s
+{
+    mutable std::mutex        mutex;
+    // what the terminal says back, and a signal for when it says more, is
+    // interrupted or hangs up.
+    std::string               replies;
+    std::condition_variable   replied;
+    bool                      interrupted = false;
+    bool                      hungUp      = false;
+    bool                      isRaw       = false;
+
+    std::uint32_t             rows;
+    std::uint32_t             cols;
+    std::vector< Cell >       cells;
+    Pen                       pen;
+    std::uint32_t             row      = 0;
+    std::uint32_t             col      = 0;
+    // whether the last column was just written, leaving the cursor on it
+    // until the next character wraps.
+    bool                      pending  = false;
+    Pen                       savedPen;
+    std::uint32_t             savedRow = 0;
+    std::uint32_t             savedCol = 0;
+    std::uint32_t             palette [ virtualPaletteLength ];
+
+    // holds a sequence that one write cuts off for the next.
+    manip::Tokenizer          tokenizer;
+    std::uint64_t             written   = 0;
+    std::uint64_t             wrapped   = 0;
+    std::uint64_t             surprised = 0;
+    // whether the size changed since the console last asked.
+    std::atomic_bool          changed   = true;
+    std::atomic< ColorDepth > depth     = ColorDepth::TRUECOLOR;
+
+    impl_s ( std::uint32_t const &rows, std::uint32_t const &cols );
+
+    Cell &at ( std::uint32_t const &r, std::uint32_t const &c )
+    {
+        return cells [ std::size_t ( r ) * cols + c ];
+    }
+
+    // what erased cells become: blank, in the current background.
+    Cell blank ( ) const noexcept
+    {
+        Cell cell;
+        cell.pen.background = pen.background;
+        return cell;
+    }
+
+    void reset ( );
+    void erase ( std::size_t const &from, std::size_t const &to );
+    // the position moved by the amount, stopping at the edge.
+    std::uint32_t move ( std::uint32_t const &from,
+                         std::int64_t const  &by,
+                         std::uint32_t const &limit );
+    void lineFeed ( );
+    void handle ( manip::Token const & );
+    void control ( char const & );
+    void escape ( std::string_view const & );
+    void controlSequence ( std::string_view const & );
+    void operatingSystemCommand ( std::string_view const & );
+    void print ( manip::CodePoint const & );
+};
+
+io::console::VirtualTerminal::impl_s::impl_s ( std::uint32_t const &rows,
+                                               std::uint32_t const &cols ) :
+        rows ( std::max ( rows, 1u ) ), cols ( std::max ( cols, 1u ) )
+{
+    reset ( );
+}
+
+void io::console::VirtualTerminal::impl_s::reset ( )
+{
+    pen      = Pen ( );
+    savedPen = Pen ( );
+    row = col = savedRow = savedCol = 0;
+    pending                         = false;
+    cells.assign ( std::size_t ( rows ) * cols, Cell ( ) );
+    // the bright colors start out as their dim counterparts.
+    for ( std::size_t i = 0; i < virtualPaletteLength; i++ )
+    {
+        auto const &color = defines::defaultConsoleColors
+                [ i % defines::consolePaletteLength ];
+        palette [ i ] = std::uint32_t ( color [ 0 ] ) << 16
+                      | std::uint32_t ( color [ 1 ] ) << 8 | color [ 2 ];
+    }
+}
+
+void io::console::VirtualTerminal::impl_s::erase ( std::size_t const &from,
+                                                   std::size_t const &to )
+{
+    std::fill ( cells.begin ( ) + from, cells.begin ( ) + to, blank ( ) );
+}
+
+std::uint32_t io::console::VirtualTerminal::impl_s::move (
+        std::uint32_t const &from,
+        std::int64_t const  &by,
+        std::uint32_t const &limit )
+{
+    std::int64_t const to = std::int64_t ( from ) + by;
+    if ( to < 0 || to >= limit )
+    {
+        surprised++;
+        return to < 0 ? 0 : limit - 1;
+    }
+    return std::uint32_t ( to );
+}
+
+void io::console::VirtualTerminal::impl_s::lineFeed ( )
+{
+    if ( row + 1 < rows )
+    {
+        row++;
+        return;
+    }
+    // scroll up a line.
+    std::move ( cells.begin ( ) + cols, cells.end ( ), cells.begin ( ) );
+    erase ( cells.size ( ) - cols, cells.size ( ) );
+}
+
+void io::console::VirtualTerminal::impl_s::handle (
+        manip::Token const &token )
+{
+    switch ( token.type )
+    {
+        case manip::TokenType::TEXT:
+            for ( auto const &codePoint : manip::CodePoints ( token.bytes ) )
+            {
+                print ( codePoint );
+            }
+            break;
+        case manip::TokenType::CONTROL: control ( token.bytes [ 0 ] ); break;
+        case manip::TokenType::ESCAPE: escape ( token.bytes ); break;
+        case manip::TokenType::CSI: controlSequence ( token.bytes ); break;
+        case manip::TokenType::OSC:
+            operatingSystemCommand ( token.bytes );
+            break;
+        // strings meant for the terminal itself change nothing on screen.
+        default: break;
+    }
+}
+
+void io::console::VirtualTerminal::impl_s::control ( char const &c )
+{
+    switch ( c )
+    {
+        case '\a': break;
+        case '\b':
+            pending = false;
+            col     = col ? col - 1 : 0;
+            break;
+        case '\t':
+            pending = false;
+            col     = std::min ( cols - 1, ( col / 8 + 1 ) * 8 );
+            break;
+        case '\n':
+        case '\v':
+        case '\f':
+            pending = false;
+            lineFeed ( );
+            break;
+        case '\r':
+            pending = false;
+            col     = 0;
+            break;
+        default: surprised++; break;
+    }
+}
+
+void io::console::VirtualTerminal::impl_s::escape (
+        std::string_view const &bytes )
+{
+    if ( bytes == "\u001b7" )
+    {
+        savedPen = pen;
+        savedRow = row;
+        savedCol = col;
+    } else if ( bytes == "\u001b8" )
+    {
+        pending = false;
+        pen     = savedPen;
+        row     = savedRow;
+        col     = savedCol;
+    } else if ( bytes == "\u001bc" )
+    {
+        reset ( );
+    } else
+    {
+        surprised++;
+    }
+}
+
+void io::console::VirtualTerminal::impl_s::controlSequence (
+        std::string_view const &bytes )
+{
+    std::string_view const parameters = bytes.substr ( 2, bytes.size ( ) - 3 );
+    char const             final      = bytes.back ( );
+    // private modes, such as hiding the cursor, change nothing on screen.
+    if ( !parameters.empty ( )
+         && std::string_view ( "<=>?" ).find ( parameters [ 0 ] )
+                    != std::string_view::npos )
+    {
+        if ( final != 'h' && final != 'l' )
+        {
+            surprised++;
+        }
+        return;
+    }
+    if ( final == 'm' )
+    {
+        if ( !pen.apply ( parameters ) )
+        {
+            surprised++;
+        }
+        return;
+    }
+    std::vector< std::uint32_t > numbers ( 1, 0 );
+    for ( char const &c : parameters )
+    {
+        if ( c == ';' )
+        {
+            numbers.push_back ( 0 );
+        } else if ( c >= '0' && c <= '9' )
+        {
+            numbers.back ( ) = numbers.back ( ) * 10 + ( c - '0' );
+        } else
+        {
+            surprised++;
+            return;
+        }
+    }
+    std::uint32_t const first = numbers [ 0 ];
+    // how far to move, where zero means one.
+    std::int64_t const  n     = std::max ( first, 1u );
+    std::size_t const   here  = std::size_t ( row ) * cols + col;
+    std::size_t const   line  = std::size_t ( row ) * cols;
+    pending                   = false;
+    switch ( final )
+    {
+        case 'A': row = move ( row, -n, rows ); break;
+        case 'B': row = move ( row, n, rows ); break;
+        case 'C': col = move ( col, n, cols ); break;
+        case 'D': col = move ( col, -n, cols ); break;
+        case 'E':
+            row = move ( row, n, rows );
+            col = 0;
+            break;
+        case 'F':
+            row = move ( row, -n, rows );
+            col = 0;
+            break;
+        case 'G': col = move ( 0, n - 1, cols ); break;
+        case 'd': row = move ( 0, n - 1, rows ); break;
+        case 'H':
+        case 'f':
+            row = move ( 0, n - 1, rows );
+            col = move ( 0,
+                         std::int64_t ( std::max (
+                                 numbers.size ( ) > 1 ? numbers [ 1 ] : 1u,
+                                 1u ) )
+                                 - 1,
+                         cols );
+            break;
+        case 'J':
+            switch ( first )
+            {
+                case 0: erase ( here, cells.size ( ) ); break;
+                case 1: erase ( 0, here + 1 ); break;
+                case 2:
+                case 3: erase ( 0, cells.size ( ) ); break;
+                default: surprised++; break;
+            }
+            break;
+        case 'K':
+            switch ( first )
+            {
+                case 0: erase ( here, line + cols ); break;
+                case 1: erase ( line, here + 1 ); break;
+                case 2: erase ( line, line + cols ); break;
+                default: surprised++; break;
+            }
+            break;
+        case 'n':
+            if ( first == 6 )
+            {
+                replies += "\u001b[" + std::to_string ( row + 1 ) + ";"
+                         + std::to_string ( col + 1 ) + "R";
+                replied.notify_all ( );
+            } else if ( first == 5 )
+            {
+                replies += "\u001b[0n";
+                replied.notify_all ( );
+            } else
+            {
+                surprised++;
+            }
+            break;
+        case 's':
+            savedRow = row;
+            savedCol = col;
+            break;
+        case 'u':
+            row = savedRow;
+            col = savedCol;
+            break;
+        default: surprised++; break;
+    }
+}
+
+// the value of up to four hex digits, or -1 if they are not hex.
+std::int32_t virtualTerminalHex ( std::string_view const &digits )
+{
+    if ( digits.empty ( ) || digits.size ( ) > 4 )
+    {
+        return -1;
+    }
+    std::int32_t value = 0;
+    for ( char const &c : digits )
+    {
+        std::int32_t digit;
+        if ( c >= '0' && c <= '9' )
+        {
+            digit = c - '0';
+        } else if ( c >= 'a' && c <= 'f' )
+        {
+            digit = c - 'a' + 10;
+        } else if ( c >= 'A' && c <= 'F' )
+        {
+            digit = c - 'A' + 10;
+        } else
+        {
+            return -1;
+        }
+        value = value * 16 + digit;
+    }
+    return value;
+}
+
+void io::console::VirtualTerminal::impl_s::operatingSystemCommand (
+        std::string_view const &bytes )
+{
+    // leave off the introducer and whichever terminator ends it.
+    std::string_view body = bytes.substr ( 2 );
+    if ( body.ends_with ( "\u001b\\" ) )
+    {
+        body.remove_suffix ( 2 );
+    } else if ( body.ends_with ( '\a' ) )
+    {
+        body.remove_suffix ( 1 );
+    }
+    // the Linux console's: P, the index, then rrggbb.
+    if ( body.size ( ) == 8 && body [ 0 ] == 'P' )
+    {
+        std::int32_t const index = virtualTerminalHex ( body.substr ( 1, 1 ) );
+        std::int32_t const red   = virtualTerminalHex ( body.substr ( 2, 2 ) );
+        std::int32_t const green = virtualTerminalHex ( body.substr ( 4, 2 ) );
+        std::int32_t const blue  = virtualTerminalHex ( body.substr ( 6, 2 ) );
+        if ( index < 0 || red < 0 || green < 0 || blue < 0 )
+        {
+            surprised++;
+            return;
+        }
+        palette [ index ] = std::uint32_t ( red ) << 16
+                               | std::uint32_t ( green ) << 8
+                               | std::uint32_t ( blue );
+        return;
+    }
+    // xterm's: 4;index;rgb:rr/gg/bb.
+    if ( body.starts_with ( "4;" ) )
+    {
+        body.remove_prefix ( 2 );
+        std::size_t const split = body.find ( ";rgb:" );
+        std::size_t       index = 0;
+        for ( char const &c : body.substr ( 0, split ) )
+        {
+            index = c >= '0' && c <= '9' ? index * 10 + std::size_t ( c - '0' )
+                                         : virtualPaletteLength;
+        }
+        std::int32_t components [ 3 ] = { -1, -1, -1 };
+        if ( split != std::string_view::npos )
+        {
+            std::string_view rest = body.substr ( split + 5 );
+            for ( auto &component : components )
+            {
+                std::size_t const      end    = rest.find ( '/' );
+                std::string_view const digits = rest.substr ( 0, end );
+                // xterm scales each component from however many digits it
+                // has.
+                std::int32_t const     most =
+                        ( std::int32_t ( 1 ) << ( 4 * digits.size ( ) ) ) - 1;
+                component = virtualTerminalHex ( digits );
+                if ( component >= 0 )
+                {
+                    component = ( component * 255 + most / 2 ) / most;
+                }
+                rest = end == std::string_view::npos
+                                  ? std::string_view ( )
+                                  : rest.substr ( end + 1 );
+            }
+        }
+        if ( split == 0 || index >= virtualPaletteLength
+             || components [ 0 ] < 0 || components [ 1 ] < 0
+             || components [ 2 ] < 0 )
+        {
+            surprised++;
+            return;
+        }
+        palette [ index ] = std::uint32_t ( components [ 0 ] ) << 16
+                          | std::uint32_t ( components [ 1 ] ) << 8
+                          | std::uint32_t ( components [ 2 ] );
+        return;
+    }
+    // titles and the like change nothing on screen.
+    if ( body.starts_with ( "0;" ) || body.starts_with ( "1;" )
+         || body.starts_with ( "2;" ) )
+    {
+        return;
+    }
+    surprised++;
+}
+
+void io::console::VirtualTerminal::impl_s::print (
+        manip::CodePoint const &codePoint )
+{
+    auto const properties =
+            io::unicode::characterProperties ( ).lookup ( codePoint.value );
+    if ( properties.control )
+    {
+        return;
+    }
+    std::uint32_t const width = std::min ( 1u + properties.columns, cols );
+    // a character that does not fit goes on the next line.
+    if ( pending || col + width > cols )
+    {
+        wrapped++;
+        pending = false;
+        col     = 0;
+        lineFeed ( );
+    }
+    // like a real terminal, blank what is left of a wide character written
+    // over.
+    for ( std::uint32_t c = col; c < col + width; c++ )
+    {
+        if ( !at ( row, c ).width && c > 0 && c == col )
+        {
+            at ( row, c - 1 ).codePoint = U' ';
+            at ( row, c - 1 ).width     = 1;
+        }
+        if ( at ( row, c ).width == 2 && c + 1 == col + width && c + 1 < cols )
+        {
+            at ( row, c + 1 ).codePoint = U' ';
+            at ( row, c + 1 ).width     = 1;
+        }
+    }
+    Cell written;
+    written.pen       = pen;
+    written.codePoint = codePoint.value;
+    written.width     = std::uint8_t ( width );
+    at ( row, col )   = written;
+    if ( width == 2 )
+    {
+        written.codePoint   = 0;
+        written.width       = 0;
+        at ( row, col + 1 ) = written;
+    }
+    col += width;
+    if ( col == cols )
+    {
+        col     = cols - 1;
+        pending = true;
+    }
+}
+
+io::console::VirtualTerminal::VirtualTerminal ( std::uint32_t const &rows,
+                                                std::uint32_t const &cols ) :
+        pimpl ( new impl_s ( rows, cols ) )
+{ }
+io::console::VirtualTerminal::~VirtualTerminal ( ) = default;
+
+void io::console::VirtualTerminal::write ( std::string_view const &bytes )
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    pimpl->written += bytes.size ( );
+    pimpl->tokenizer.feed ( bytes, [ & ] ( manip::Token const &token ) {
+        pimpl->handle ( token );
+    } );
+}
+
+bool io::console::VirtualTerminal::read (
+        std::string                     &bytes,
+        std::chrono::milliseconds const &timeout )
+{
+    std::unique_lock< std::mutex > lock ( pimpl->mutex );
+    auto const said = [ & ] ( ) {
+        return !pimpl->replies.empty ( ) || pimpl->interrupted
+            || pimpl->hungUp;
+    };
+    if ( timeout.count ( ) < 0 )
+    {
+        pimpl->replied.wait ( lock, said );
+    } else
+    {
+        pimpl->replied.wait_for ( lock, timeout, said );
+    }
+    pimpl->interrupted = false;
+    bytes += pimpl->replies;
+    pimpl->replies.clear ( );
+    return !pimpl->hungUp;
+}
+
+void io::console::VirtualTerminal::interrupt ( ) noexcept
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    pimpl->interrupted = true;
+    pimpl->replied.notify_all ( );
+}
+
+void io::console::VirtualTerminal::setRaw ( bool const &raw )
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    pimpl->isRaw = raw;
+}
+
+void io::console::VirtualTerminal::type ( std::string_view const &bytes )
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    pimpl->replies += bytes;
+    pimpl->replied.notify_all ( );
+}
+
+void io::console::VirtualTerminal::hangUp ( ) noexcept
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    pimpl->hungUp = true;
+    pimpl->replied.notify_all ( );
+}
+
+bool io::console::VirtualTerminal::raw ( ) const noexcept
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    return pimpl->isRaw;
+}
+
+bool io::console::VirtualTerminal::size ( std::uint32_t &rows,
+                                          std::uint32_t &cols )
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    rows = pimpl->rows;
+    cols = pimpl->cols;
+    return true;
+}
+
+bool io::console::VirtualTerminal::resized ( ) noexcept
+{
+    return pimpl->changed.exchange ( false );
+}
+
+io::console::ColorDepth
+        io::console::VirtualTerminal::colorDepth ( ) const noexcept
+{
+    return pimpl->depth.load ( );
+}
+
+void io::console::VirtualTerminal::setColorDepth (
+        ColorDepth const &depth ) noexcept
+{
+    pimpl->depth.store ( depth );
+}
+
+void io::console::VirtualTerminal::resize ( std::uint32_t const &rows,
+                                            std::uint32_t const &cols )
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    std::uint32_t const newRows = std::max ( rows, 1u );
+    std::uint32_t const newCols = std::max ( cols, 1u );
+    std::vector< Cell > cells ( std::size_t ( newRows ) * newCols );
+    for ( std::uint32_t r = 0; r < std::min ( newRows, pimpl->rows ); r++ )
+    {
+        for ( std::uint32_t c = 0; c < std::min ( newCols, pimpl->cols ); c++ )
+        {
+            cells [ std::size_t ( r ) * newCols + c ] = pimpl->at ( r, c );
+        }
+    }
+    pimpl->rows    = newRows;
+    pimpl->cols    = newCols;
+    pimpl->cells   = std::move ( cells );
+    pimpl->row     = std::min ( pimpl->row, newRows - 1 );
+    pimpl->col     = std::min ( pimpl->col, newCols - 1 );
+    pimpl->pending = false;
+    pimpl->changed.store ( true );
+    // as a terminal's signal would, so that a reader hears of it.
+    pimpl->interrupted = true;
+    pimpl->replied.notify_all ( );
+}
+
+Cell io::console::VirtualTerminal::cell ( std::uint32_t const &row,
+                                          std::uint32_t const &col ) const
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    if ( row >= pimpl->rows || col >= pimpl->cols )
+    {
+        RUNTIME_ERROR ( "Cell " << row << ", " << col << " is off the "
+                                << pimpl->rows << " by " << pimpl->cols
+                                << " screen" )
+    }
+    return pimpl->at ( row, col );
+}
+
+std::string
+        io::console::VirtualTerminal::text ( std::uint32_t const &row ) const
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    if ( row >= pimpl->rows )
+    {
+        RUNTIME_ERROR ( "Row " << row << " is off the screen" )
+    }
+    std::string line;
+    std::size_t used = 0;
+    for ( std::uint32_t c = 0; c < pimpl->cols; c++ )
+    {
+        Cell const &cell = pimpl->at ( row, c );
+        if ( cell.width )
+        {
+            char bytes [ 4 ];
+            line.append ( bytes, manip::encode ( cell.codePoint, bytes ) );
+            if ( cell.codePoint != U' ' )
+            {
+                used = line.size ( );
+            }
+        }
+    }
+    line.resize ( used );
+    return line;
+}
+
+std::uint32_t io::console::VirtualTerminal::cursorRow ( ) const noexcept
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    return pimpl->row;
+}
+
+std::uint32_t io::console::VirtualTerminal::cursorCol ( ) const noexcept
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    return pimpl->col;
+}
+
+Pen io::console::VirtualTerminal::pen ( ) const noexcept
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    return pimpl->pen;
+}
+
+std::uint32_t io::console::VirtualTerminal::paletteColor (
+        std::size_t const &index ) const
+{
+    if ( index >= virtualPaletteLength )
+    {
+        RUNTIME_ERROR ( "Palette entry " << index << " does not exist" )
+    }
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    return pimpl->palette [ index ];
+}
+
+std::uint64_t io::console::VirtualTerminal::bytesWritten ( ) const noexcept
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    return pimpl->written;
+}
+
+std::uint64_t io::console::VirtualTerminal::wraps ( ) const noexcept
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    return pimpl->wrapped;
+}
+
+std::uint64_t io::console::VirtualTerminal::surprises ( ) const noexcept
+{
+    std::scoped_lock< std::mutex > lock ( pimpl->mutex );
+    return pimpl->surprised;
+}
+
+bool testVirtualTerminal ( std::ostream &stream )
+{
+    using io::console::VirtualTerminal;
+    stream << "Beginning virtual terminal unittest.\n";
+
+    stream << "Ensuring that text wraps and scrolls...\n";
+    VirtualTerminal terminal ( 3, 4 );
+    terminal.write ( "abcd" );
+    if ( terminal.text ( 0 ) != "abcd" || terminal.cursorCol ( ) != 3
+         || terminal.wraps ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "A full row wrapped too soon" )
+    }
+    terminal.write ( "ef\r\nghi" );
+    if ( terminal.text ( 1 ) != "ef" || terminal.text ( 2 ) != "ghi"
+         || terminal.wraps ( ) != 1 )
+    {
+        BASIC_UNIT_FAIL ( stream, "Text wrapped wrongly" )
+    }
+    terminal.write ( "\nj" );
+    if ( terminal.text ( 0 ) != "ef" || terminal.text ( 1 ) != "ghi"
+         || terminal.text ( 2 ) != "   j" )
+    {
+        BASIC_UNIT_FAIL ( stream, "The screen scrolled wrongly" )
+    }
+
+    stream << "Ensuring that the cursor moves and the screen erases...\n";
+    terminal.write ( "\u001b[2J\u001b[2;3H\u001b[1;31mX\u001b[A\u001b[DY" );
+    Pen red;
+    red.set ( 1, true );
+    red.foreground = 1;
+    if ( terminal.cell ( 1, 2 ).codePoint != U'X'
+         || !( terminal.cell ( 1, 2 ).pen == red )
+         || terminal.cell ( 0, 2 ).codePoint != U'Y' || terminal.surprises ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "The cursor or the pen went wrong" )
+    }
+    terminal.write ( "\u001b[2;1H\u001b[K\u001b[99B" );
+    if ( !terminal.text ( 1 ).empty ( ) || terminal.cursorRow ( ) != 2
+         || terminal.surprises ( ) != 1 )
+    {
+        BASIC_UNIT_FAIL ( stream, "Erasing or running into the edge failed" )
+    }
+
+    stream << "Ensuring that the palette changes...\n";
+    terminal.write ( "\u001b]P1ff0080\u001b\\" );
+    terminal.write ( "\u001b]4;2;rgb:12/34/56\a" );
+    if ( terminal.paletteColor ( 1 ) != 0xff0080
+         || terminal.paletteColor ( 2 ) != 0x123456 )
+    {
+        BASIC_UNIT_FAIL ( stream, "The palette did not change" )
+    }
+
+    stream << "Ensuring that cursor reports are answered...\n";
+    terminal.write ( "\u001b[2;4H\u001b[6" );
+    terminal.write ( "n" );
+    std::string report;
+    terminal.read ( report, std::chrono::milliseconds ( 0 ) );
+    if ( report != "\u001b[2;4R" )
+    {
+        BASIC_UNIT_FAIL ( stream,
+                          "Reported \"" << report.substr ( 1 ) << "\"" )
+    }
+
+    stream << "Ensuring that a console can run on it...\n";
+    auto shared = std::make_shared< VirtualTerminal > ( 5, 20 );
+    {
+        using namespace io::console;
+        Console console ( shared );
+        console << textDelay ( 0 ) << doWaitForText << "Hello, "
+                << doSGR ( SGRCommand::BOLD ) << "world!";
+    }
+    Pen bold;
+    bold.set ( 1, true );
+    if ( shared->text ( 0 ) != "Hello, world!"
+         || !( shared->cell ( 0, 7 ).pen == bold )
+         || !( shared->cell ( 0, 6 ).pen == Pen ( ) ) || shared->surprises ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream,
+                          "The console showed \"" << shared->text ( 0 )
+                                                  << "\"" )
+    }
+    return true;
+}
+
+test::Unittest virtualTerminalTest { &testVirtualTerminal };
@@ -0,0 +1,98 @@
+/**
+ * @file virtualterminal.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief A terminal that lives in memory
+ * @version 1
+ * @date 2022-03-06
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <io/console/backend.h++>
+#include <io/console/internal/buffer.h++>
+#include <io/console/internal/sgr.h++>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace io::console
+{
+    /**
+     * @brief A backend that works out what a terminal would show instead of
+     * showing it, so that the console can run at full speed without a
+     * terminal and its output can be checked.
+     *
+     * It understands the cursor movements, erasing, saving and restoring,
+     * SGR and palette changes that the console uses, wraps and scrolls like
+     * a VT100, and answers cursor reports. Everything else counts as a
+     * surprise, as does a cursor movement that runs into the edge. Keys can
+     * be typed into it for whoever reads it.
+     */
+    class VirtualTerminal : public Backend
+    {
+        struct impl_s;
+        std::unique_ptr< impl_s > pimpl;
+    public:
+        VirtualTerminal ( std::uint32_t const &rows,
+                          std::uint32_t const &cols );
+        virtual ~VirtualTerminal ( );
+
+        void write ( std::string_view const & ) override;
+        bool read ( std::string                     &bytes,
+                    std::chrono::milliseconds const &timeout ) override;
+        void interrupt ( ) noexcept override;
+        void setRaw ( bool const & ) override;
+        bool size ( std::uint32_t &rows, std::uint32_t &cols ) override;
+        bool resized ( ) noexcept override;
+
+        // true color, unless told otherwise.
+        ColorDepth colorDepth ( ) const noexcept override;
+        void       setColorDepth ( ColorDepth const & ) noexcept;
+
+        /**
+         * @brief Has the terminal say the bytes, as if they were typed, after
+         * whatever it has not yet said.
+         */
+        void type ( std::string_view const & );
+        /**
+         * @brief Makes reads fail once they have everything typed so far, as
+         * they would once a terminal has gone away.
+         */
+        void hangUp ( ) noexcept;
+        bool raw ( ) const noexcept;
+
+        /**
+         * @brief Changes the size, keeping what fits.
+         */
+        void resize ( std::uint32_t const &rows, std::uint32_t const &cols );
+
+        /**
+         * @throw std::runtime_error if the cell is off the screen.
+         */
+        internal::Cell cell ( std::uint32_t const &row,
+                              std::uint32_t const &col ) const;
+        /**
+         * @brief The characters on the row as UTF-8, with the blanks at its
+         * end left off.
+         */
+        std::string    text ( std::uint32_t const &row ) const;
+        std::uint32_t  cursorRow ( ) const noexcept;
+        std::uint32_t  cursorCol ( ) const noexcept;
+        internal::Pen  pen ( ) const noexcept;
+        /**
+         * @brief The palette entry as 0xRRGGBB.
+         */
+        std::uint32_t  paletteColor ( std::size_t const &index ) const;
+
+        std::uint64_t  bytesWritten ( ) const noexcept;
+        std::uint64_t  wraps ( ) const noexcept;
+        std::uint64_t  surprises ( ) const noexcept;
+    };
+} // namespace io::console
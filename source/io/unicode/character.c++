@@ -14,209 +14,290 @@
 #include <defines/constants.h++>
 #include <defines/macros.h++>
 #include <defines/types.h++>
+#include <io/base/mappedfile.h++>
+#include <io/unicode/database.h++>
+#include <io/unicode/table.h++>
 #include <test/unittester.h++>
 
+#include <algorithm>
 #include <cstdint>
+#include <exception>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 
-#include <rapidxml-1.13/rapidxml.hpp>
-
 using namespace io::unicode;
 using namespace defines;
 
-#define LINE_BREAKING_CASE( val )                                              \
-    if ( temp == ES ( #val ) )                                                 \
-    {                                                                          \
-        result.lineBreaking = ( std::uint8_t ) BreakingProperties::val;        \
-    }
+PropertyStore  properties;
+std::once_flag propertiesLoaded;
+std::once_flag prewarmStarted;
+// joined when the program exits, so a prewarm in progress finishes first.
+std::jthread   prewarmThread;
 
-std::vector< CharacterProperties > properties = { };
+std::vector< PropertyRun > initializeProperties ( );
 
-void initializeProperties ( );
+io::unicode::PropertyStore::PropertyStore ( ) noexcept :
+        blocks ( ( defines::maxUnicode >> blockBits ) + 1, 0 ),
+        indices ( blockMask + 1, 0 ),
+        values ( 1 )
+{ }
 
-std::vector< CharacterProperties > const &io::unicode::characterProperties ( )
+io::unicode::PropertyStore::PropertyStore (
+        std::span< PropertyRun const > const &runs ) :
+        values ( 1 )
 {
-    if ( properties.empty ( ) )
+    if ( runs.empty ( ) || runs.front ( ).first != 0 )
     {
-        initializeProperties ( );
+        RUNTIME_ERROR ( "Property runs must start at U+0!" )
     }
-    return properties;
-}
+    // index into values for each distinct packed value
+    std::map< std::uint16_t, std::uint8_t > valueIndex = {
+            { pack ( values.front ( ) ), 0 }
+    };
+    // block number for each distinct block
+    std::map< std::string, std::uint16_t > blockIndex;
+    std::string                            block ( blockMask + 1, 0 );
 
-void initializeProperties ( )
-{
-    defines::EXMLDocument document;
-    defines::EFileStream  file ( defines::ucdDataName );
-    defines::EString      contents = ES ( "" );
-    while ( !file.eof ( ) )
+    std::size_t run = 0;
+    for ( std::uint32_t c = 0; c <= defines::maxUnicode; c++ )
     {
-        defines::EString temp;
-        std::getline ( file, temp );
-        contents += temp;
-    }
-    file.close ( );
-    document.parse< 0 > ( ( defines::ECString ) contents.c_str ( ) );
-    defines::EXMLNode *group = document.first_node ( "ucd" )
-                                       ->first_node ( "repertoire" )
-                                       ->first_node ( "group" );
-    auto parseCharacterProperties = [ & ] ( defines::EXMLNode *node ) {
-        auto getField =
-                [ & ] ( defines::EXMLNode *p,
-                        defines::EXMLNode *c,
-                        defines::ECString  n ) -> defines::EXMLAttribute * {
-            if ( c->first_attribute ( ES ( n ) ) )
-            {
-                return c->first_attribute ( ES ( n ) );
-            } else if ( p->first_attribute ( ES ( n ) ) )
+        while ( run + 1 < runs.size ( ) && runs [ run + 1 ].first <= c )
+        {
+            run++;
+        }
+        auto found = valueIndex.find ( runs [ run ].packed );
+        if ( found == valueIndex.end ( ) )
+        {
+            if ( values.size ( ) > 0xFF )
             {
-                return p->first_attribute ( ES ( n ) );
-            } else
+                RUNTIME_ERROR ( "Too many distinct character properties!" )
+            }
+            found = valueIndex
+                            .emplace ( runs [ run ].packed,
+                                       std::uint8_t ( values.size ( ) ) )
+                            .first;
+            values.push_back ( unpack ( runs [ run ].packed ) );
+        }
+        block [ c & blockMask ] = char ( found->second );
+        if ( ( c & blockMask ) == blockMask )
+        {
+            auto existing = blockIndex.find ( block );
+            if ( existing == blockIndex.end ( ) )
             {
-                RUNTIME_ERROR (
-                        "Failed to find field ",
-                        n,
-                        " for unicode character ",
-                        ( c->first_attribute ( "cp" )
-                                  ? c->first_attribute ( "cp" )->value ( )
-                                  : " in group" ) )
+                existing = blockIndex
+                                   .emplace ( block,
+                                              std::uint16_t (
+                                                      blockIndex.size ( ) ) )
+                                   .first;
+                indices.insert ( indices.end ( ),
+                                 block.begin ( ),
+                                 block.end ( ) );
             }
-        };
-        CharacterProperties result;
-        defines::EString    temp = ES ( "" );
+            blocks.push_back ( existing->second );
+        }
+    }
+}
 
-        defines::ECString ea =
-                getField ( node->parent ( ), node, ES ( "ea" ) )->value ( );
-        temp = ea;
-        if ( temp == ES ( "A" ) || temp == ES ( "F" ) || temp == ES ( "W" ) )
+void io::unicode::PropertyStore::lookup (
+        std::span< char32_t const > const         &codePoints,
+        std::span< CharacterProperties > const &results ) const
+{
+    if ( results.size ( ) < codePoints.size ( ) )
+    {
+        RUNTIME_ERROR ( "Not enough room for the looked up properties!" )
+    }
+    for ( std::size_t i = 0; i < codePoints.size ( ); i++ )
+    {
+        results [ i ] = lookup ( codePoints [ i ] );
+    }
+}
+
+std::size_t io::unicode::PropertyStore::footprint ( ) const noexcept
+{
+    return blocks.size ( ) * sizeof ( std::uint16_t )
+         + indices.size ( ) * sizeof ( std::uint8_t )
+         + values.size ( ) * sizeof ( CharacterProperties );
+}
+
+std::vector< io::unicode::PropertyRun >
+        io::unicode::PropertyStore::runs ( ) const
+{
+    std::vector< PropertyRun > result;
+    for ( std::uint32_t c = 0; c <= defines::maxUnicode; c++ )
+    {
+        std::uint16_t packed = pack ( lookup ( c ) );
+        if ( result.empty ( ) || result.back ( ).packed != packed )
         {
-            result.columns = 1;
+            result.push_back ( PropertyRun { c, packed } );
+        }
+    }
+    return result;
+}
+
+io::unicode::PropertyStore const &io::unicode::characterProperties ( )
+{
+    // if loading throws, the next caller tries again (and likely throws too)
+    std::call_once ( propertiesLoaded, [ & ] ( ) {
+        if ( std::filesystem::exists ( defines::ucdTableName ) )
+        {
+            MappedPropertyTable table ( defines::ucdTableName );
+            properties = PropertyStore ( table.runs ( ) );
         } else
         {
-            result.columns = 0;
+            properties = PropertyStore ( initializeProperties ( ) );
         }
-        temp = "";
+    } );
+    return properties;
+}
 
-        defines::ECString emoji =
-                getField ( node->parent ( ), node, ES ( "Emoji" ) )->value ( );
+void io::unicode::prewarmProperties ( )
+{
+    std::call_once ( prewarmStarted, [ & ] ( ) {
+        prewarmThread = std::jthread ( [] ( ) {
+            try
+            {
+                characterProperties ( );
+            } catch ( std::exception const & )
+            {
+                // whoever needs the properties first will see the error when
+                // they try loading them again.
+            }
+        } );
+    } );
+}
+
+void io::unicode::compileProperties ( )
+{
+    std::vector< PropertyRun > runs = initializeProperties ( );
+    writePropertyTable ( defines::ucdTableName, runs );
+    std::call_once ( propertiesLoaded,
+                     [ & ] ( ) { properties = PropertyStore ( runs ); } );
+}
+
+// collects the ranges read from (part of) the UCD into runs, making sure that
+// the ranges follow each other.
+struct RunBuilder
+{
+    std::vector< PropertyRun > runs;
+    // the first code point seen
+    std::uint32_t              first   = 0;
+    // the next code point we should see
+    std::uint32_t              next    = 0;
+    bool                       started = false;
 
-        temp = std::string ( emoji );
-        if ( temp == ES ( "Y" ) )
+    void add ( std::uint32_t const       &from,
+               std::uint32_t const       &to,
+               CharacterProperties const &value )
+    {
+        if ( !started )
         {
-            result.emoji = 1;
-        } else if ( temp == ES ( "N" ) )
+            first   = from;
+            started = true;
+        } else if ( from != next )
         {
-            result.emoji = 0;
-        } else
+            RUNTIME_ERROR ( "The UCD skips or repeats code points before U+",
+                            std::hex << from )
+        }
+        std::uint16_t packed = pack ( value );
+        if ( runs.empty ( ) || runs.back ( ).packed != packed )
         {
-            RUNTIME_ERROR ( "Yes / No field was not yes or no!" )
+            runs.push_back ( PropertyRun { from, packed } );
         }
+        next = to + 1;
+    }
+};
 
-        // determine whether a line break is preferred and / or required.
-        defines::ECString lineBreak =
-                getField ( node->parent ( ), node, ES ( "lb" ) )->value ( );
-        temp = lineBreak;
-        // non-tailorable line-breaking classes
-        LINE_BREAKING_CASE ( BK )
-        LINE_BREAKING_CASE ( CR )
-        LINE_BREAKING_CASE ( LF )
-        LINE_BREAKING_CASE ( CM )
-        LINE_BREAKING_CASE ( NL )
-        LINE_BREAKING_CASE ( SG )
-        LINE_BREAKING_CASE ( WJ )
-        LINE_BREAKING_CASE ( ZW )
-        LINE_BREAKING_CASE ( GL )
-        LINE_BREAKING_CASE ( SP )
-        LINE_BREAKING_CASE ( ZWJ )
-        // break opportunities
-        LINE_BREAKING_CASE ( B2 )
-        LINE_BREAKING_CASE ( BA )
-        LINE_BREAKING_CASE ( BB )
-        LINE_BREAKING_CASE ( HY )
-        LINE_BREAKING_CASE ( CB )
-        // characters prohibiting certain breaks
-        LINE_BREAKING_CASE ( CL )
-        LINE_BREAKING_CASE ( CP )
-        LINE_BREAKING_CASE ( EX )
-        LINE_BREAKING_CASE ( IN )
-        LINE_BREAKING_CASE ( NS )
-        LINE_BREAKING_CASE ( OP )
-        LINE_BREAKING_CASE ( QU )
-        // numeric context
-#pragma push_macro( "IS" ) // conflicts wiht the define "IS"
-#undef IS
-        LINE_BREAKING_CASE ( IS )
-#pragma pop_macro( "IS" )
-        LINE_BREAKING_CASE ( NU )
-        LINE_BREAKING_CASE ( PO )
-        LINE_BREAKING_CASE ( PR )
-        LINE_BREAKING_CASE ( SY )
-        // other characters
-        LINE_BREAKING_CASE ( AI )
-        LINE_BREAKING_CASE ( AL )
-        LINE_BREAKING_CASE ( CL )
-        LINE_BREAKING_CASE ( CJ )
-        LINE_BREAKING_CASE ( EB )
-        LINE_BREAKING_CASE ( EM )
-        LINE_BREAKING_CASE ( H2 )
-        LINE_BREAKING_CASE ( H3 )
-        LINE_BREAKING_CASE ( HL )
-        LINE_BREAKING_CASE ( ID )
-        LINE_BREAKING_CASE ( JL )
-        LINE_BREAKING_CASE ( JV )
-        LINE_BREAKING_CASE ( JT )
-        LINE_BREAKING_CASE ( RI )
-        LINE_BREAKING_CASE ( SA )
-        LINE_BREAKING_CASE ( XX )
-
-        properties.push_back ( result );
-    };
-    while ( group )
+std::vector< PropertyRun > initializeProperties ( )
+{
+    // the groups are independent, so each worker reads its own share of them
+    // into its own slot. The slots are stitched together afterwards.
+    std::size_t const         workers = std::thread::hardware_concurrency ( );
+    std::vector< RunBuilder > slots;
+    if ( workers < 2 )
     {
-        defines::EXMLNode *child = group->first_node ( );
-        while ( child )
+        // read in chunks since there is no point in mapping the whole file.
+        slots.resize ( 1 );
+        readDatabase ( defines::ucdDataName,
+                       [ & ] ( std::uint32_t const       &first,
+                               std::uint32_t const       &last,
+                               CharacterProperties const &value ) {
+                           slots.front ( ).add ( first, last, value );
+                       } );
+    } else
+    {
+        io::base::MappedFile file ( defines::ucdDataName );
+        auto pieces = splitDatabase ( file.contents ( ), workers );
+        slots.resize ( pieces.size ( ) );
+        std::vector< std::exception_ptr > errors ( pieces.size ( ) );
         {
-            if ( child->first_attribute ( "cp" ) )
+            std::vector< std::jthread > pool;
+            for ( std::size_t i = 0; i < pieces.size ( ); i++ )
             {
-                // push back one character
-                parseCharacterProperties ( child );
-            } else if ( child->first_attribute ( "first-cp" ) )
+                pool.emplace_back ( [ &, i ] ( ) {
+                    try
+                    {
+                        DatabaseReader reader (
+                                [ & ] ( std::uint32_t const       &first,
+                                        std::uint32_t const       &last,
+                                        CharacterProperties const &value ) {
+                                    slots [ i ].add ( first, last, value );
+                                },
+                                i != 0 );
+                        reader.feed ( pieces [ i ].data ( ),
+                                      pieces [ i ].size ( ) );
+                        reader.finish ( );
+                    } catch ( ... )
+                    {
+                        errors [ i ] = std::current_exception ( );
+                    }
+                } );
+            }
+        } // the pool joins here
+        for ( auto &error : errors )
+        {
+            if ( error )
             {
-                if ( !child->first_attribute ( "last-cp" ) )
-                {
-                    RUNTIME_ERROR (
-                            "Found the first code point, but the last "
-                            "code point is missing!" )
-                }
-                // parse code point
-                auto parseCodePoint =
-                        [ & ] ( defines::ECString field ) -> std::uint32_t {
-                    defines::EStringStream stream (
-                            child->first_attribute ( field )->value ( ) );
-                    std::uint32_t result = 0;
-                    stream >> std::hex >> result;
-                    return result;
-                };
+                std::rethrow_exception ( error );
+            }
+        }
+    }
 
-                std::uint32_t first, last;
-                first = parseCodePoint ( ES ( "first-cp" ) );
-                last  = parseCodePoint ( ES ( "last-cp" ) );
-                for ( std::uint32_t i = first; i <= last; i++ )
-                {
-                    parseCharacterProperties ( child );
-                }
-            } else
+    std::vector< PropertyRun > runs;
+    std::uint32_t              next = 0;
+    for ( auto &slot : slots )
+    {
+        if ( !slot.started )
+        {
+            continue;
+        }
+        if ( slot.first != next )
+        {
+            RUNTIME_ERROR ( "The UCD skips or repeats code points before U+",
+                            std::hex << slot.first )
+        }
+        for ( auto &run : slot.runs )
+        {
+            if ( runs.empty ( ) || runs.back ( ).packed != run.packed )
             {
-                RUNTIME_ERROR (
-                        "Cannot parse node: it's not a single "
-                        "character nor a range of them!" )
+                runs.push_back ( run );
             }
-            child = child->next_sibling ( );
         }
-        group = group->next_sibling ( );
+        next = slot.next;
+    }
+    if ( next != defines::maxUnicode + 1 )
+    {
+        RUNTIME_ERROR ( "The UCD describes 0x",
+                        std::hex << next << " code points instead of 0x"
+                                 << defines::maxUnicode + 1 )
     }
+    return runs;
 }
 
 bool propertyInitializationTest ( std::ostream &stream )
@@ -234,25 +315,35 @@ bool propertyInitializationTest ( std::ostream &stream )
             U"français.";
     stream << "Beginning test of character properties structure...\n";
     characterProperties ( );
-    stream << "Ensuring that the size of character properties is 0x10FFFF "
-              "characters...\n";
-    if ( characterProperties ( ).size ( ) != defines::maxUnicode + 1 )
+    stream << "Ensuring that character properties cover [U+0, U+10FFFF] in "
+              "0x"
+           << std::hex << characterProperties ( ).footprint ( ) << std::dec
+           << " bytes...\n";
+    PropertyStore rebuilt ( characterProperties ( ).runs ( ) );
+    for ( char32_t c = 0; c <= defines::maxUnicode; c++ )
+    {
+        if ( pack ( rebuilt.lookup ( c ) )
+             != pack ( characterProperties ( ).lookup ( c ) ) )
+        {
+            CHAR_UNITTEST_FAIL ( stream,
+                                 "Missing or extra characters detected",
+                                 "Rebuilding the properties from their runs "
+                                 "changed U+"
+                                         << std::uint32_t ( c ) )
+            END_UNIT_FAIL ( stream )
+        }
+    }
+    if ( characterProperties ( ).lookup ( defines::maxUnicode + 1 ).lineBreaking
+         != std::uint8_t ( BreakingProperties::XX ) )
     {
-        CHAR_UNITTEST_FAIL ( stream,
-                             "Missing or extra characters detected",
-                             "Character properties has invalid size: 0x",
-                             characterProperties ( ).size ( ),
-                             " which indicates a Unicode range of [U+0, U+",
-                             characterProperties ( ).size ( ) - 1,
-                             "] instead of the expected range [U+0, U+",
-                             defines::maxUnicode )
-        END_UNIT_FAIL ( stream )
+        BASIC_UNIT_FAIL ( stream,
+                          "Code points beyond U+10FFFF must be unknown (XX)" )
     }
 
     stream << "Ensuring that CJK characters have a width of two columns...\n";
     for ( auto &u : cjk )
     {
-        if ( !characterProperties ( ).at ( u ).columns && u > 0x7F )
+        if ( !characterProperties ( ).lookup ( u ).columns && u > 0x7F )
         {
             CHAR_UNITTEST_FAIL ( stream,
                                  "Invalid Column width detected",
@@ -266,7 +357,7 @@ bool propertyInitializationTest ( std::ostream &stream )
               "column...\n";
     for ( auto &u : latin )
     {
-        if ( characterProperties ( ).at ( u ).columns )
+        if ( characterProperties ( ).lookup ( u ).columns )
         {
             CHAR_UNITTEST_FAIL (
                     stream,
@@ -278,9 +369,12 @@ bool propertyInitializationTest ( std::ostream &stream )
         }
     }
     stream << "Ensuring that emoji are marked as emoji...\n";
-    for ( auto &u : emoji )
+    std::vector< CharacterProperties > emojiProperties ( emoji.size ( ) );
+    characterProperties ( ).lookup ( emoji, emojiProperties );
+    for ( std::size_t i = 0; i < emoji.size ( ); i++ )
     {
-        if ( !characterProperties ( ).at ( u ).emoji )
+        auto &u = emoji [ i ];
+        if ( !emojiProperties [ i ].emoji )
         {
             stream << "For some reason the character U+" << std::hex
                    << std::uint32_t ( u )
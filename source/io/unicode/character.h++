@@ -16,7 +16,9 @@
 #include <defines/manip.h++>
 #include <defines/types.h++>
 
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 namespace io::unicode
@@ -87,8 +89,91 @@ namespace io::unicode
                 ( std::uint8_t ) BreakingProperties::XX;
         CharacterProperties ( ) noexcept                             = default;
         CharacterProperties ( CharacterProperties const & ) noexcept = default;
-        CharacterProperties ( CharacterProperties && )               = delete;
+        CharacterProperties ( CharacterProperties && ) noexcept      = default;
+        CharacterProperties &
+                operator= ( CharacterProperties const & ) noexcept = default;
+        CharacterProperties &
+                operator= ( CharacterProperties && ) noexcept = default;
     };
 
-    std::vector< CharacterProperties > const &characterProperties ( );
+    /**
+     * @brief A range of code points sharing the same properties. The range
+     * starts at first and ends right before the first code point of the next
+     * run (or at maxUnicode for the last run).
+     */
+    struct PropertyRun
+    {
+        std::uint32_t first;
+        std::uint16_t packed;
+        std::uint16_t padding = 0;
+    };
+
+    /**
+     * @brief Properties of every code point in [U+0, maxUnicode], stored as a
+     * two-level table: the top bits of a code point select a block, blocks
+     * with the same contents are stored once, and each block entry indexes a
+     * small table of the distinct properties. The whole thing is a few
+     * hundred kilobytes at most instead of two bytes per code point.
+     */
+    class PropertyStore
+    {
+        static constexpr std::uint32_t blockBits = 7;
+        static constexpr std::uint32_t blockMask = ( 1 << blockBits ) - 1;
+
+        // block number for each block of code points
+        std::vector< std::uint16_t >       blocks;
+        // the unique blocks, each entry indexing values
+        std::vector< std::uint8_t >        indices;
+        // the distinct properties. The first entry is the default value,
+        // given for anything outside of the Unicode range.
+        std::vector< CharacterProperties > values;
+    public:
+        PropertyStore ( ) noexcept;
+        PropertyStore ( std::span< PropertyRun const > const & );
+
+        CharacterProperties const &lookup ( char32_t const &c ) const noexcept
+        {
+            if ( c > defines::maxUnicode )
+            {
+                return values.front ( );
+            }
+            std::size_t block = blocks [ c >> blockBits ];
+            return values [ indices [ ( block << blockBits )
+                                      | ( c & blockMask ) ] ];
+        }
+
+        /**
+         * @brief Looks up each code point in the first span, writing its
+         * properties to the same position in the second span. Throws if the
+         * second span is shorter than the first.
+         */
+        void lookup ( std::span< char32_t const > const  &,
+                      std::span< CharacterProperties > const & ) const;
+
+        // bytes used by the tables.
+        std::size_t footprint ( ) const noexcept;
+
+        std::vector< PropertyRun > runs ( ) const;
+    };
+
+    /**
+     * @brief Properties of every code point. Loaded from the compiled table
+     * (ucdTableName) when there is one, otherwise from the UCD itself. The
+     * first call loads the properties; any other thread calling at the same
+     * time waits for that load instead of starting its own.
+     */
+    PropertyStore const &characterProperties ( );
+
+    /**
+     * @brief Starts loading the properties on a background thread, so that
+     * whoever calls characterProperties first does not wait as long. Safe to
+     * call any number of times.
+     */
+    void prewarmProperties ( );
+
+    /**
+     * @brief Parses the UCD (ucdDataName) and writes the compiled table
+     * (ucdTableName) so that later runs never have to parse the UCD.
+     */
+    void compileProperties ( );
 } // namespace io::unicode
\ No newline at end of file
@@ -0,0 +1,611 @@
+/**
+ * @file database.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of the streaming UCD reader
+ * @version 1
+ * @date 2022-03-02
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/unicode/database.h++>
+
+#include <defines/constants.h++>
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <test/unittester.h++>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace io::unicode;
+
+// size of the chunks read from the file.
+constexpr std::size_t databaseChunkSize = 1 << 16;
+
+// packs up to three characters into one number so that property values can
+// be switched on.
+constexpr std::uint32_t propertyKey ( std::string_view const &value ) noexcept
+{
+    if ( value.size ( ) > 3 )
+    {
+        return 0;
+    }
+    std::uint32_t result = 0;
+    for ( char c : value )
+    {
+        result = ( result << 8 ) | std::uint8_t ( c );
+    }
+    return result;
+}
+
+bool lineBreakingFrom ( std::string_view const &value, defines::Flag &result )
+{
+    BreakingProperties property;
+    switch ( propertyKey ( value ) )
+    {
+        case propertyKey ( "BK" ): property = BreakingProperties::BK; break;
+        case propertyKey ( "CR" ): property = BreakingProperties::CR; break;
+        case propertyKey ( "LF" ): property = BreakingProperties::LF; break;
+        case propertyKey ( "CM" ): property = BreakingProperties::CM; break;
+        case propertyKey ( "NL" ): property = BreakingProperties::NL; break;
+        case propertyKey ( "SG" ): property = BreakingProperties::SG; break;
+        case propertyKey ( "WJ" ): property = BreakingProperties::WJ; break;
+        case propertyKey ( "ZW" ): property = BreakingProperties::ZW; break;
+        case propertyKey ( "GL" ): property = BreakingProperties::GL; break;
+        case propertyKey ( "SP" ): property = BreakingProperties::SP; break;
+        case propertyKey ( "ZWJ" ): property = BreakingProperties::ZWJ; break;
+        case propertyKey ( "B2" ): property = BreakingProperties::B2; break;
+        case propertyKey ( "BA" ): property = BreakingProperties::BA; break;
+        case propertyKey ( "BB" ): property = BreakingProperties::BB; break;
+        case propertyKey ( "HY" ): property = BreakingProperties::HY; break;
+        case propertyKey ( "CB" ): property = BreakingProperties::CB; break;
+        case propertyKey ( "CL" ): property = BreakingProperties::CL; break;
+        case propertyKey ( "CP" ): property = BreakingProperties::CP; break;
+        case propertyKey ( "EX" ): property = BreakingProperties::EX; break;
+        case propertyKey ( "IN" ): property = BreakingProperties::IN; break;
+        case propertyKey ( "NS" ): property = BreakingProperties::NS; break;
+        case propertyKey ( "OP" ): property = BreakingProperties::OP; break;
+        case propertyKey ( "QU" ): property = BreakingProperties::QU; break;
+        case propertyKey ( "IS" ): property = BreakingProperties::IS; break;
+        case propertyKey ( "NU" ): property = BreakingProperties::NU; break;
+        case propertyKey ( "PO" ): property = BreakingProperties::PO; break;
+        case propertyKey ( "PR" ): property = BreakingProperties::PR; break;
+        case propertyKey ( "SY" ): property = BreakingProperties::SY; break;
+        case propertyKey ( "AI" ): property = BreakingProperties::AI; break;
+        case propertyKey ( "AL" ): property = BreakingProperties::AL; break;
+        case propertyKey ( "CJ" ): property = BreakingProperties::CJ; break;
+        case propertyKey ( "EB" ): property = BreakingProperties::EB; break;
+        case propertyKey ( "EM" ): property = BreakingProperties::EM; break;
+        case propertyKey ( "H2" ): property = BreakingProperties::H2; break;
+        case propertyKey ( "H3" ): property = BreakingProperties::H3; break;
+        case propertyKey ( "HL" ): property = BreakingProperties::HL; break;
+        case propertyKey ( "ID" ): property = BreakingProperties::ID; break;
+        case propertyKey ( "JL" ): property = BreakingProperties::JL; break;
+        case propertyKey ( "JV" ): property = BreakingProperties::JV; break;
+        case propertyKey ( "JT" ): property = BreakingProperties::JT; break;
+        case propertyKey ( "RI" ): property = BreakingProperties::RI; break;
+        case propertyKey ( "SA" ): property = BreakingProperties::SA; break;
+        case propertyKey ( "XX" ): property = BreakingProperties::XX; break;
+        default: return false;
+    }
+    result = defines::Flag ( property );
+    return true;
+}
+
+bool columnsFrom ( std::string_view const &value, defines::Flag &result )
+{
+    switch ( propertyKey ( value ) )
+    {
+        // ambiguous, fullwidth, and wide characters take two columns.
+        case propertyKey ( "A" ):
+        case propertyKey ( "F" ):
+        case propertyKey ( "W" ): result = 1; return true;
+        case propertyKey ( "H" ):
+        case propertyKey ( "N" ):
+        case propertyKey ( "Na" ): result = 0; return true;
+        default: return false;
+    }
+}
+
+bool yesNoFrom ( std::string_view const &value, defines::Flag &result )
+{
+    switch ( propertyKey ( value ) )
+    {
+        case propertyKey ( "Y" ): result = 1; return true;
+        case propertyKey ( "N" ): result = 0; return true;
+        default: return false;
+    }
+}
+
+std::uint32_t codePointFrom ( std::string_view const &value )
+{
+    std::uint32_t result = 0;
+    if ( value.empty ( ) || value.size ( ) > 6 )
+    {
+        RUNTIME_ERROR ( "Invalid code point in the UCD: ", value )
+    }
+    for ( char c : value )
+    {
+        result <<= 4;
+        if ( c >= '0' && c <= '9' )
+        {
+            result |= c - '0';
+        } else if ( c >= 'A' && c <= 'F' )
+        {
+            result |= c - 'A' + 10;
+        } else if ( c >= 'a' && c <= 'f' )
+        {
+            result |= c - 'a' + 10;
+        } else
+        {
+            RUNTIME_ERROR ( "Invalid code point in the UCD: ", value )
+        }
+    }
+    if ( result > defines::maxUnicode )
+    {
+        RUNTIME_ERROR ( "Code point out of range in the UCD: ", value )
+    }
+    return result;
+}
+
+// the attributes we care about in one element. Values point into the tag
+// currently being read, except for the group's, which are copied.
+struct ElementAttributes
+{
+    std::string_view cp;
+    std::string_view firstCP;
+    std::string_view lastCP;
+    std::string_view ea;
+    std::string_view lb;
+    std::string_view emoji;
+};
+
+struct io::unicode::DatabaseReader::impl_s
+{
+    RangeHandler handler;
+
+    enum class State
+    {
+        TEXT,
+        TAG,
+        QUOTED,
+        COMMENT,
+    } state = State::TEXT;
+    char        quote = 0;
+    // the tag currently being read, without the angle brackets.
+    std::string tag;
+
+    bool inRepertoire = false;
+    bool inGroup      = false;
+    // inherited attributes of the current group.
+    std::string groupEA;
+    std::string groupLB;
+    std::string groupEmoji;
+
+    void process ( );
+    void processElement ( std::string_view const &name,
+                          ElementAttributes const &attributes );
+};
+
+// splits "name attr="value" ..." into the name and the attributes we need.
+std::string_view parseTag ( std::string_view const &tag,
+                            ElementAttributes       &attributes )
+{
+    std::size_t i = 0;
+    while ( i < tag.size ( ) && !std::isspace ( ( unsigned char ) tag [ i ] )
+            && tag [ i ] != '/' )
+    {
+        i++;
+    }
+    std::string_view name = tag.substr ( 0, i );
+    while ( i < tag.size ( ) )
+    {
+        while ( i < tag.size ( )
+                && ( std::isspace ( ( unsigned char ) tag [ i ] )
+                     || tag [ i ] == '/' ) )
+        {
+            i++;
+        }
+        std::size_t nameStart = i;
+        while ( i < tag.size ( ) && tag [ i ] != '=' )
+        {
+            i++;
+        }
+        std::string_view attribute = tag.substr ( nameStart, i - nameStart );
+        while ( !attribute.empty ( )
+                && std::isspace ( ( unsigned char ) attribute.back ( ) ) )
+        {
+            attribute.remove_suffix ( 1 );
+        }
+        // skip to the opening quote
+        while ( i < tag.size ( ) && tag [ i ] != '"' && tag [ i ] != '\'' )
+        {
+            i++;
+        }
+        if ( i >= tag.size ( ) )
+        {
+            break;
+        }
+        char        quote      = tag [ i++ ];
+        std::size_t valueStart = i;
+        while ( i < tag.size ( ) && tag [ i ] != quote )
+        {
+            i++;
+        }
+        std::string_view value = tag.substr ( valueStart, i - valueStart );
+        i++;
+
+        if ( attribute == "cp" )
+        {
+            attributes.cp = value;
+        } else if ( attribute == "first-cp" )
+        {
+            attributes.firstCP = value;
+        } else if ( attribute == "last-cp" )
+        {
+            attributes.lastCP = value;
+        } else if ( attribute == "ea" )
+        {
+            attributes.ea = value;
+        } else if ( attribute == "lb" )
+        {
+            attributes.lb = value;
+        } else if ( attribute == "Emoji" )
+        {
+            attributes.emoji = value;
+        }
+    }
+    return name;
+}
+
+void io::unicode::DatabaseReader::impl_s::process ( )
+{
+    // processing instructions and declarations carry nothing for us.
+    if ( tag.empty ( ) || tag.front ( ) == '?' || tag.front ( ) == '!' )
+    {
+        return;
+    }
+    ElementAttributes attributes;
+    std::string_view  name = parseTag ( tag, attributes );
+    if ( name == "repertoire" )
+    {
+        inRepertoire = true;
+    } else if ( name == "/repertoire" )
+    {
+        inRepertoire = false;
+    } else if ( !inRepertoire )
+    {
+        return;
+    } else if ( name == "group" )
+    {
+        inGroup    = true;
+        groupEA    = attributes.ea;
+        groupLB    = attributes.lb;
+        groupEmoji = attributes.emoji;
+        // a self-closing group has no children to inherit anything.
+        if ( tag.back ( ) == '/' )
+        {
+            inGroup = false;
+        }
+    } else if ( name == "/group" )
+    {
+        inGroup = false;
+        groupEA.clear ( );
+        groupLB.clear ( );
+        groupEmoji.clear ( );
+    } else if ( name == "char" || name == "reserved" || name == "noncharacter"
+                || name == "surrogate" )
+    {
+        processElement ( name, attributes );
+    }
+}
+
+void io::unicode::DatabaseReader::impl_s::processElement (
+        std::string_view const  &name,
+        ElementAttributes const &attributes )
+{
+    auto inherit = [ & ] ( std::string_view const &own,
+                           std::string const      &inherited,
+                           char const *const      &field ) -> std::string_view {
+        if ( !own.empty ( ) )
+        {
+            return own;
+        } else if ( inGroup && !inherited.empty ( ) )
+        {
+            return inherited;
+        }
+        RUNTIME_ERROR ( "Failed to find field ",
+                        field << " for unicode " << name << " "
+                              << ( attributes.cp.empty ( ) ? attributes.firstCP
+                                                           : attributes.cp ) )
+    };
+
+    std::uint32_t first, last;
+    if ( !attributes.cp.empty ( ) )
+    {
+        first = last = codePointFrom ( attributes.cp );
+    } else if ( !attributes.firstCP.empty ( ) )
+    {
+        if ( attributes.lastCP.empty ( ) )
+        {
+            RUNTIME_ERROR ( "Found the first code point, but the last "
+                            "code point is missing!" )
+        }
+        first = codePointFrom ( attributes.firstCP );
+        last  = codePointFrom ( attributes.lastCP );
+        if ( last < first )
+        {
+            RUNTIME_ERROR ( "Code point range ends before it starts: ",
+                            attributes.firstCP << ".." << attributes.lastCP )
+        }
+    } else
+    {
+        RUNTIME_ERROR ( "Cannot parse node: it's not a single "
+                        "character nor a range of them!" )
+    }
+
+    CharacterProperties result;
+    defines::Flag       value = 0;
+    std::string_view    ea    = inherit ( attributes.ea, groupEA, "ea" );
+    if ( !columnsFrom ( ea, value ) )
+    {
+        RUNTIME_ERROR ( "Unknown east asian width: ", ea )
+    }
+    result.columns         = value;
+    std::string_view emoji = inherit ( attributes.emoji, groupEmoji, "Emoji" );
+    if ( !yesNoFrom ( emoji, value ) )
+    {
+        RUNTIME_ERROR ( "Yes / No field was not yes or no!" )
+    }
+    result.emoji        = value;
+    std::string_view lb = inherit ( attributes.lb, groupLB, "lb" );
+    if ( !lineBreakingFrom ( lb, value ) )
+    {
+        // values we do not know of are left unknown (XX).
+        value = defines::Flag ( BreakingProperties::XX );
+    }
+    result.lineBreaking = value;
+    handler ( first, last, result );
+}
+
+io::unicode::DatabaseReader::DatabaseReader ( RangeHandler const &handler,
+                                              bool const &inRepertoire ) :
+        pimpl ( new impl_s ( ) )
+{
+    pimpl->handler      = handler;
+    pimpl->inRepertoire = inRepertoire;
+}
+
+io::unicode::DatabaseReader::~DatabaseReader ( ) = default;
+
+void io::unicode::DatabaseReader::feed ( char const *const  &data,
+                                         std::size_t const &size )
+{
+    using State = impl_s::State;
+    for ( std::size_t i = 0; i < size; i++ )
+    {
+        char const c = data [ i ];
+        switch ( pimpl->state )
+        {
+            case State::TEXT:
+                // character data never matters to us.
+                if ( c == '<' )
+                {
+                    pimpl->state = State::TAG;
+                    pimpl->tag.clear ( );
+                }
+                break;
+            case State::TAG:
+                if ( c == '>' )
+                {
+                    pimpl->state = State::TEXT;
+                    pimpl->process ( );
+                } else
+                {
+                    pimpl->tag += c;
+                    if ( c == '"' || c == '\'' )
+                    {
+                        pimpl->quote = c;
+                        pimpl->state = State::QUOTED;
+                    } else if ( pimpl->tag == "!--" )
+                    {
+                        pimpl->state = State::COMMENT;
+                    }
+                }
+                break;
+            case State::QUOTED:
+                pimpl->tag += c;
+                if ( c == pimpl->quote )
+                {
+                    pimpl->state = State::TAG;
+                }
+                break;
+            case State::COMMENT:
+                // only remember enough to spot the end of the comment.
+                if ( c == '>' && pimpl->tag.ends_with ( "--" ) )
+                {
+                    pimpl->state = State::TEXT;
+                } else
+                {
+                    pimpl->tag = pimpl->tag.substr ( pimpl->tag.size ( ) - 1 );
+                    pimpl->tag += c;
+                }
+                break;
+        }
+    }
+}
+
+void io::unicode::DatabaseReader::finish ( )
+{
+    if ( pimpl->state != impl_s::State::TEXT )
+    {
+        RUNTIME_ERROR ( "The UCD ended in the middle of a tag!" )
+    }
+}
+
+void io::unicode::readDatabase ( std::filesystem::path const &path,
+                                 RangeHandler const          &handler )
+{
+    std::ifstream file ( path, std::ios::binary );
+    if ( !file.is_open ( ) )
+    {
+        RUNTIME_ERROR ( "Could not open the UCD at ",
+                        path.string ( ) << ". Unicode properties are "
+                                           "unavailable." )
+    }
+    DatabaseReader    reader ( handler );
+    std::vector< char > chunk ( databaseChunkSize );
+    while ( file )
+    {
+        file.read ( chunk.data ( ), chunk.size ( ) );
+        reader.feed ( chunk.data ( ), std::size_t ( file.gcount ( ) ) );
+    }
+    reader.finish ( );
+}
+
+std::vector< std::string_view >
+        io::unicode::splitDatabase ( std::string_view const &document,
+                                     std::size_t const      &pieces )
+{
+    constexpr std::string_view groupTag = "<group";
+    std::size_t const          start    = document.find ( "<repertoire" );
+    std::size_t const          end      = document.find ( "</repertoire" );
+    if ( pieces < 2 || start == document.npos || end == document.npos )
+    {
+        return { document };
+    }
+    std::vector< std::string_view > result;
+    std::size_t const               step      = ( end - start ) / pieces;
+    std::size_t                     lastSplit = 0;
+    for ( std::size_t i = 1; i < pieces; i++ )
+    {
+        std::size_t split = document.find ( groupTag, start + i * step );
+        // a tag only starting with "group", like <groups, does not count.
+        auto longerName   = [ & ] ( ) -> bool {
+            char next = document [ split + groupTag.size ( ) ];
+            return std::isalnum ( ( unsigned char ) next ) || next == '-';
+        };
+        while ( split < end && longerName ( ) )
+        {
+            split = document.find ( groupTag, split + 1 );
+        }
+        if ( split >= end )
+        {
+            break;
+        }
+        if ( split > lastSplit )
+        {
+            result.push_back (
+                    document.substr ( lastSplit, split - lastSplit ) );
+            lastSplit = split;
+        }
+    }
+    result.push_back ( document.substr ( lastSplit ) );
+    return result;
+}
+
+bool databaseReaderTest ( std::ostream &stream )
+{
+    static constexpr char const *document =
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<ucd xmlns=\"http://www.unicode.org/ns/2003/ucd/1.0\">\n"
+            "<!-- a comment with a <group> in it -->\n"
+            "<description>Unicode 14.0.0</description>\n"
+            "<repertoire>\n"
+            "<group ea=\"N\" lb=\"CM\" Emoji=\"N\" na=\"a > b\">\n"
+            "<char cp=\"0000\"><name-alias alias=\"NULL\"/></char>\n"
+            "<char cp=\"0001\" lb=\"ZWJ\" ea='W'/>\n"
+            "</group>\n"
+            "<group ea=\"W\" lb=\"ID\" Emoji=\"N\">\n"
+            "<reserved first-cp=\"0002\" last-cp=\"0005\" Emoji=\"Y\"/>\n"
+            "</group>\n"
+            "</repertoire>\n"
+            "<blocks><block first-cp=\"0000\" last-cp=\"007F\"/></blocks>\n"
+            "</ucd>\n";
+    struct Range
+    {
+        std::uint32_t first, last;
+        std::uint16_t columns, emoji, lineBreaking;
+        bool          operator== ( Range const & ) const = default;
+    };
+    static Range const expected [] = {
+            { 0, 0, 0, 0, std::uint16_t ( BreakingProperties::CM ) },
+            { 1, 1, 1, 0, std::uint16_t ( BreakingProperties::ZWJ ) },
+            { 2, 5, 1, 1, std::uint16_t ( BreakingProperties::ID ) },
+    };
+    stream << "Beginning test of the streaming UCD reader...\n";
+    std::string_view const text { document };
+    // every chunk size from one byte to the whole document at once.
+    for ( std::size_t chunk = 1; chunk <= text.size ( ); chunk++ )
+    {
+        std::vector< Range > ranges;
+        DatabaseReader       reader ( [ & ] ( std::uint32_t const       &first,
+                                        std::uint32_t const       &last,
+                                        CharacterProperties const &p ) {
+            ranges.push_back ( Range { first,
+                                       last,
+                                       p.columns,
+                                       p.emoji,
+                                       p.lineBreaking } );
+        } );
+        for ( std::size_t i = 0; i < text.size ( ); i += chunk )
+        {
+            std::string_view piece = text.substr ( i, chunk );
+            reader.feed ( piece.data ( ), piece.size ( ) );
+        }
+        reader.finish ( );
+        if ( ranges.size ( ) != std::size ( expected )
+             || !std::equal ( ranges.begin ( ), ranges.end ( ), expected ) )
+        {
+            CHAR_UNITTEST_FAIL ( stream,
+                                 "Streaming reader misread the UCD",
+                                 "Wrong ranges when reading in chunks of 0x"
+                                         << chunk << " bytes." )
+            END_UNIT_FAIL ( stream )
+        }
+    }
+    stream << "Ensuring that the UCD can be read in separate pieces...\n";
+    for ( std::size_t pieces = 1; pieces < 5; pieces++ )
+    {
+        std::vector< Range > ranges;
+        auto                 split = splitDatabase ( text, pieces );
+        for ( std::size_t i = 0; i < split.size ( ); i++ )
+        {
+            DatabaseReader reader (
+                    [ & ] ( std::uint32_t const       &first,
+                            std::uint32_t const       &last,
+                            CharacterProperties const &p ) {
+                        ranges.push_back ( Range { first,
+                                                   last,
+                                                   p.columns,
+                                                   p.emoji,
+                                                   p.lineBreaking } );
+                    },
+                    i != 0 );
+            reader.feed ( split [ i ].data ( ), split [ i ].size ( ) );
+            reader.finish ( );
+        }
+        if ( ranges.size ( ) != std::size ( expected )
+             || !std::equal ( ranges.begin ( ), ranges.end ( ), expected ) )
+        {
+            CHAR_UNITTEST_FAIL ( stream,
+                                 "Split reading misread the UCD",
+                                 "Wrong ranges when splitting into 0x"
+                                         << pieces << " pieces." )
+            END_UNIT_FAIL ( stream )
+        }
+    }
+    stream << "No information indicates failure, returning...\n";
+    return true;
+}
+
+test::Unittest databaseReaderUnittest { &databaseReaderTest };
@@ -0,0 +1,77 @@
+/**
+ * @file database.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Streaming reader for the UCD's XML representation
+ * @version 1
+ * @date 2022-03-02
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <defines/constants.h++>
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <io/unicode/character.h++>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace io::unicode
+{
+    /**
+     * @brief Receives each element of the repertoire as the inclusive range of
+     * code points it describes along with their properties.
+     */
+    using RangeHandler = std::function< void ( std::uint32_t const &,
+                                               std::uint32_t const &,
+                                               CharacterProperties const & ) >;
+
+    /**
+     * @brief Reads ucd.all.grouped.xml (or any of its flat variants) without
+     * building a document. Feed it the file in chunks of any size; it only
+     * holds onto the tag it is in the middle of and the inherited attributes
+     * of the current group.
+     */
+    class DatabaseReader
+    {
+        struct impl_s;
+        std::unique_ptr< impl_s > pimpl;
+    public:
+        /**
+         * @brief Creates a reader. A reader given a piece from splitDatabase
+         * (other than the first) starts inside the repertoire, since the
+         * piece does not include the opening tag.
+         */
+        DatabaseReader ( RangeHandler const &,
+                         bool const &inRepertoire = false );
+        virtual ~DatabaseReader ( );
+
+        void feed ( char const *const &, std::size_t const & );
+        /**
+         * @brief Call after the last chunk. Throws if the file ended in the
+         * middle of a tag.
+         */
+        void finish ( );
+    };
+
+    /**
+     * @brief Reads the file at the path through a DatabaseReader in
+     * fixed-size chunks.
+     */
+    void readDatabase ( std::filesystem::path const &, RangeHandler const & );
+
+    /**
+     * @brief Splits a whole UCD into at most the given number of consecutive
+     * pieces, each after the first starting at a group in the repertoire, so
+     * that the pieces can be read by separate readers at the same time.
+     */
+    std::vector< std::string_view > splitDatabase ( std::string_view const &,
+                                                    std::size_t const & );
+} // namespace io::unicode
@@ -0,0 +1,202 @@
+/**
+ * @file table.c++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief Implementation of the compiled character property table
+ * @version 1
+ * @date 2022-03-01
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#include <io/unicode/table.h++>
+
+#include <defines/constants.h++>
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <io/base/mappedfile.h++>
+#include <test/unittester.h++>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+std::uint16_t
+        io::unicode::pack ( CharacterProperties const &properties ) noexcept
+{
+    std::uint16_t result = 0;
+    result |= properties.columns << 0;
+    result |= properties.control << 1;
+    result |= properties.emoji << 2;
+    result |= properties.reserved1 << 3;
+    result |= properties.reserved2 << 4;
+    result |= properties.reserved3 << 5;
+    result |= properties.reserved4 << 6;
+    result |= properties.reserved5 << 7;
+    result |= std::uint16_t ( properties.lineBreaking ) << 8;
+    return result;
+}
+
+io::unicode::CharacterProperties
+        io::unicode::unpack ( std::uint16_t const &packed ) noexcept
+{
+    CharacterProperties result;
+    result.columns      = ( packed >> 0 ) & 1;
+    result.control      = ( packed >> 1 ) & 1;
+    result.emoji        = ( packed >> 2 ) & 1;
+    result.reserved1    = ( packed >> 3 ) & 1;
+    result.reserved2    = ( packed >> 4 ) & 1;
+    result.reserved3    = ( packed >> 5 ) & 1;
+    result.reserved4    = ( packed >> 6 ) & 1;
+    result.reserved5    = ( packed >> 7 ) & 1;
+    result.lineBreaking = ( packed >> 8 ) & 0x3F;
+    return result;
+}
+
+void io::unicode::writePropertyTable ( std::filesystem::path const    &path,
+                                       std::vector< PropertyRun > const &runs )
+{
+    PropertyTableHeader header;
+    header.runCount = std::uint32_t ( runs.size ( ) );
+
+    // write to a temporary file first so that a reader never maps a
+    // half-written table.
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file ( temporary, std::ios::binary | std::ios::trunc );
+        if ( !file.is_open ( ) )
+        {
+            RUNTIME_ERROR ( "Could not open " << temporary.string ( ),
+                            " to write the character property table!" )
+        }
+        file.write ( ( char const * ) &header, sizeof ( header ) );
+        file.write ( ( char const * ) runs.data ( ),
+                     runs.size ( ) * sizeof ( PropertyRun ) );
+        if ( !file.good ( ) )
+        {
+            RUNTIME_ERROR ( "Failed writing the character property table to ",
+                            temporary.string ( ) )
+        }
+    }
+    std::filesystem::rename ( temporary, path );
+}
+
+struct io::unicode::MappedPropertyTable::impl_s
+{
+    io::base::MappedFile           file;
+    std::span< PropertyRun const > runs;
+
+    impl_s ( std::filesystem::path const &path ) : file ( path ) { }
+
+    void validate ( std::filesystem::path const & );
+};
+
+void io::unicode::MappedPropertyTable::impl_s::validate (
+        std::filesystem::path const &path )
+{
+    PropertyTableHeader const expected;
+    char const               *address = file.contents ( ).data ( );
+    std::size_t               length  = file.contents ( ).size ( );
+    if ( length < sizeof ( PropertyTableHeader ) )
+    {
+        RUNTIME_ERROR ( path.string ( ),
+                        " is too short to be a property table!" )
+    }
+    PropertyTableHeader header;
+    std::memcpy ( &header, address, sizeof ( header ) );
+    if ( std::memcmp ( header.magic, expected.magic, sizeof ( header.magic ) )
+         || header.version != expected.version
+         || header.byteOrder != expected.byteOrder )
+    {
+        RUNTIME_ERROR ( path.string ( ),
+                        " is not a property table this build can read. "
+                        "Recompile it with --compile-ucd." )
+    }
+    if ( length
+                 != sizeof ( PropertyTableHeader )
+                            + header.runCount * sizeof ( PropertyRun )
+         || !header.runCount )
+    {
+        RUNTIME_ERROR ( path.string ( ), " is truncated or corrupt!" )
+    }
+    runs = std::span< PropertyRun const > (
+            ( PropertyRun const * ) ( address + sizeof ( header ) ),
+            header.runCount );
+    if ( runs.front ( ).first != 0 )
+    {
+        RUNTIME_ERROR ( path.string ( ), " does not start at U+0!" )
+    }
+    for ( std::size_t i = 1; i < runs.size ( ); i++ )
+    {
+        if ( runs [ i ].first <= runs [ i - 1 ].first
+             || runs [ i ].first > defines::maxUnicode )
+        {
+            RUNTIME_ERROR ( path.string ( ),
+                            " has out-of-order runs at run " << i )
+        }
+    }
+}
+
+io::unicode::MappedPropertyTable::MappedPropertyTable (
+        std::filesystem::path const &path ) :
+        pimpl ( new impl_s ( path ) )
+{
+    pimpl->validate ( path );
+}
+
+io::unicode::MappedPropertyTable::~MappedPropertyTable ( ) = default;
+
+std::span< io::unicode::PropertyRun const >
+        io::unicode::MappedPropertyTable::runs ( ) const noexcept
+{
+    return pimpl->runs;
+}
+
+bool propertyTableTest ( std::ostream &stream )
+{
+    using namespace io::unicode;
+    stream << "Beginning test of the compiled property table...\n";
+    stream << "Ensuring that properties survive packing...\n";
+    std::vector< PropertyRun > runs;
+    for ( std::uint32_t i = 0; i < 0x80; i++ )
+    {
+        CharacterProperties p;
+        p.columns      = i & 1;
+        p.control      = ( i >> 1 ) & 1;
+        p.emoji        = ( i >> 2 ) & 1;
+        p.lineBreaking = std::uint8_t ( i % 43 );
+        if ( pack ( unpack ( pack ( p ) ) ) != pack ( p ) )
+        {
+            BASIC_UNIT_FAIL ( stream, "Packing lost information!" )
+        }
+        runs.push_back ( PropertyRun { i * 0x100, pack ( p ) } );
+    }
+    stream << "Ensuring that the table maps back identically...\n";
+    std::filesystem::path path = std::filesystem::temp_directory_path ( )
+                               / "videogame.propertytabletest.bin";
+    writePropertyTable ( path, runs );
+    bool passed = true;
+    {
+        MappedPropertyTable table ( path );
+        auto                mapped = table.runs ( );
+        passed = mapped.size ( ) == runs.size ( );
+        for ( std::size_t i = 0; passed && i < runs.size ( ); i++ )
+        {
+            passed = mapped [ i ].first == runs [ i ].first
+                  && mapped [ i ].packed == runs [ i ].packed;
+        }
+    }
+    std::filesystem::remove ( path );
+    if ( !passed )
+    {
+        BASIC_UNIT_FAIL ( stream, "The mapped table differs from the runs!" )
+    }
+    stream << "No information indicates failure, returning...\n";
+    return true;
+}
+
+test::Unittest propertyTableUnittest { &propertyTableTest };
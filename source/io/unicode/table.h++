@@ -0,0 +1,61 @@
+/**
+ * @file table.h++
+ * @author Joshua Buchanan (joshuarobertbuchanan@gmail.com)
+ * @brief The compiled, binary form of the character properties.
+ * @version 1
+ * @date 2022-03-01
+ *
+ * @copyright Copyright (C) 2022. Intellectual property of the author(s) listed
+ * above.
+ *
+ */
+#pragma once
+
+#include <defines/constants.h++>
+#include <defines/macros.h++>
+#include <defines/types.h++>
+#include <io/unicode/character.h++>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace io::unicode
+{
+    /**
+     * @brief Layout of the start of a compiled table. The runs immediately
+     * follow the header. The table is written in the native byte order since
+     * it is generated on the machine that uses it.
+     */
+    struct PropertyTableHeader
+    {
+        char          magic [ 8 ] = { 'V', 'G', 'U', 'C', 'D', 'T', 'B', 'L' };
+        std::uint32_t version     = 1;
+        std::uint32_t byteOrder   = 0x01020304;
+        std::uint32_t runCount    = 0;
+        std::uint32_t padding     = 0;
+    };
+
+    std::uint16_t       pack ( CharacterProperties const & ) noexcept;
+    CharacterProperties unpack ( std::uint16_t const & ) noexcept;
+
+    void writePropertyTable ( std::filesystem::path const &,
+                              std::vector< PropertyRun > const & );
+
+    /**
+     * @brief A compiled table mapped into memory. Throws if the file does not
+     * look like a table that this build wrote.
+     */
+    class MappedPropertyTable
+    {
+        struct impl_s;
+        std::unique_ptr< impl_s > pimpl;
+    public:
+        MappedPropertyTable ( std::filesystem::path const & );
+        virtual ~MappedPropertyTable ( );
+
+        std::span< PropertyRun const > runs ( ) const noexcept;
+    };
+} // namespace io::unicode
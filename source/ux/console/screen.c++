@@ -24,11 +24,16 @@
 #include <ux/serialization/strings.h++>
 
 #include <io/base/syncstream.h++>
+#include <io/console/virtualterminal.h++>
+#include <test/unittester.h++>
 
+#include <chrono>
 #include <functional>
 #include <iostream>
 #include <list>
 #include <map>
+#include <memory>
+#include <string>
 #include <variant>
 
 using namespace io::console::manip;
@@ -56,153 +61,212 @@ void parseColor ( Console &,
                   ConsoleColor24B const &,
                   std::uint8_t const & );
 
+// sets the console's attributes, wrapping and centering as the line has them.
+void applyLineStyle ( Console &console, Line const &line )
+{
+    console << resetSGR;
+    if ( line.centered )
+    {
+        console << doTextCenter;
+    } else
+    {
+        console << noTextCenter;
+        if ( line.wrapped )
+        {
+            console << doTextWrapping;
+        } else
+        {
+            console << noTextWrapping;
+        }
+    }
+    // iterate through the possble choices for the SGR
+    // attributes
+    if ( line.bold )
+    {
+        console << doSGR ( SGRCommand::BOLD );
+    }
+    if ( line.faint )
+    {
+        console << doSGR ( SGRCommand::FAINT );
+    }
+    if ( line.italic )
+    {
+        console << doSGR ( SGRCommand::ITALIC );
+    }
+    if ( line.underline )
+    {
+        console << doSGR ( SGRCommand::UNDERLINE );
+    }
+    if ( line.slowBlink )
+    {
+        console << doSGR ( SGRCommand::SLOW_BLINK );
+    }
+    if ( line.fastBlink )
+    {
+        console << doSGR ( SGRCommand::FAST_BLINK );
+    }
+    if ( line.invert )
+    {
+        console << doSGR ( SGRCommand::INVERT );
+    }
+    if ( line.hide )
+    {
+        console << doSGR ( SGRCommand::HIDE );
+    }
+    if ( line.strike )
+    {
+        console << doSGR ( SGRCommand::STRIKE );
+    }
+    if ( line.fraktur )
+    {
+        console << doSGR ( SGRCommand::FRAKTUR );
+    }
+    if ( line.doubleUnderline )
+    {
+        console << doSGR ( SGRCommand::DOUBLE_UNDERLINE );
+    }
+    // font
+    switch ( line.font )
+    {
+        case 9: console << doSGR ( SGRCommand::ALT_FONT_9 ); break;
+        case 8: console << doSGR ( SGRCommand::ALT_FONT_8 ); break;
+        case 7: console << doSGR ( SGRCommand::ALT_FONT_7 ); break;
+        case 6: console << doSGR ( SGRCommand::ALT_FONT_6 ); break;
+        case 5: console << doSGR ( SGRCommand::ALT_FONT_5 ); break;
+        case 4: console << doSGR ( SGRCommand::ALT_FONT_4 ); break;
+        case 3: console << doSGR ( SGRCommand::ALT_FONT_3 ); break;
+        case 2: console << doSGR ( SGRCommand::ALT_FONT_2 ); break;
+        case 1: console << doSGR ( SGRCommand::ALT_FONT_1 ); break;
+        case 0: console << doSGR ( SGRCommand::PRIMARY_FONT ); break;
+        default: console << doSGR ( SGRCommand::PRIMARY_FONT ); break;
+    }
+
+    parseColor ( console,
+                 line.foreground,
+                 doSGR,
+                 setForeground256,
+                 setForegroundTrue,
+                 0 );
+    parseColor ( console,
+                 line.background,
+                 doSGR,
+                 setBackground256,
+                 setBackgroundTrue,
+                 10 );
+}
+
 ConsoleManipulator
         ux::console::Screen::output ( ExternalizedStrings const  &strings,
                                       defines::IString const     &locale,
                                       TransliterationLevel const &level )
 {
     return [ =, *this ] ( Console &console ) -> Console & {
-        auto getID = [ & ] ( defines::IString id ) -> ExternalID {
-            ExternalID       result = { CHR_STRINGIZE ( ) };
-            defines::IString temp   = CHR_STRINGIZE ( );
-            temp       = defines::rtToString< TransliterationLevel > ( level );
-            result.key = locale + "." + id + "." + temp;
-            return result;
-        };
-
-        auto outputLine = [ & ] ( Line const &line ) {
-            console << resetSGR;
-            console << textDelay ( line.txtRate );
-            console << commandDelay ( line.cmdRate );
-            if ( line.centered )
-            {
-                console << doTextCenter;
-            } else
-            {
-                console << noTextCenter;
-                if ( line.wrapped )
-                {
-                    console << doTextWrapping;
-                } else
-                {
-                    console << noTextWrapping;
-                }
-            }
-            // iterate through the possble choices for the SGR
-            // attributes
-            if ( line.bold )
-            {
-                console << doSGR ( SGRCommand::BOLD );
-            }
-            if ( line.faint )
-            {
-                console << doSGR ( SGRCommand::FAINT );
-            }
-            if ( line.italic )
-            {
-                console << doSGR ( SGRCommand::ITALIC );
-            }
-            if ( line.underline )
-            {
-                console << doSGR ( SGRCommand::UNDERLINE );
-            }
-            if ( line.slowBlink )
-            {
-                console << doSGR ( SGRCommand::SLOW_BLINK );
-            }
-            if ( line.fastBlink )
-            {
-                console << doSGR ( SGRCommand::FAST_BLINK );
-            }
-            if ( line.invert )
-            {
-                console << doSGR ( SGRCommand::INVERT );
-            }
-            if ( line.hide )
-            {
-                console << doSGR ( SGRCommand::HIDE );
-            }
-            if ( line.strike )
-            {
-                console << doSGR ( SGRCommand::STRIKE );
-            }
-            if ( line.fraktur )
-            {
-                console << doSGR ( SGRCommand::FRAKTUR );
-            }
-            if ( line.doubleUnderline )
-            {
-                console << doSGR ( SGRCommand::DOUBLE_UNDERLINE );
-            }
-            // font
-            switch ( line.font )
-            {
-                case 9: console << doSGR ( SGRCommand::ALT_FONT_9 ); break;
-                case 8: console << doSGR ( SGRCommand::ALT_FONT_8 ); break;
-                case 7: console << doSGR ( SGRCommand::ALT_FONT_7 ); break;
-                case 6: console << doSGR ( SGRCommand::ALT_FONT_6 ); break;
-                case 5: console << doSGR ( SGRCommand::ALT_FONT_5 ); break;
-                case 4: console << doSGR ( SGRCommand::ALT_FONT_4 ); break;
-                case 3: console << doSGR ( SGRCommand::ALT_FONT_3 ); break;
-                case 2: console << doSGR ( SGRCommand::ALT_FONT_2 ); break;
-                case 1: console << doSGR ( SGRCommand::ALT_FONT_1 ); break;
-                case 0: console << doSGR ( SGRCommand::PRIMARY_FONT ); break;
-                default: console << doSGR ( SGRCommand::PRIMARY_FONT ); break;
-            }
+        compile ( console, strings, locale, level ).play ( console );
+        ask ( console );
+        return console;
+    };
+}
 
-            parseColor ( console,
-                         line.foreground,
-                         doSGR,
-                         setForeground256,
-                         setForegroundTrue,
-                         0 );
-            parseColor ( console,
-                         line.background,
-                         doSGR,
-                         setBackground256,
-                         setBackgroundTrue,
-                         10 );
+CompiledScreen
+        ux::console::Screen::compile ( Console                    &console,
+                                       ExternalizedStrings const  &strings,
+                                       defines::IString const     &locale,
+                                       TransliterationLevel const &level ) const
+{
+    auto getID = [ & ] ( defines::IString id ) -> ExternalID {
+        ExternalID       result = { CHR_STRINGIZE ( ) };
+        defines::IString temp   = CHR_STRINGIZE ( );
+        temp       = defines::rtToString< TransliterationLevel > ( level );
+        result.key = locale + "." + id + "." + temp;
+        return result;
+    };
 
+    CompiledScreen result;
+    result.palette = console.compilePalette ( palette );
+    // the lines borrow the console's style to encode with, and give it back
+    // so that compiling leaves no trace on the console.
+    Console::Style const saved = console.getStyle ( );
+    try
+    {
+        for ( auto const &line : lines )
+        {
+            applyLineStyle ( console, line );
             auto string = strings.get ( std::shared_ptr< ExternalID > (
                     new ExternalID ( getID ( line.textID ) ) ) );
             assert ( !string.empty ( ) );
-            // wait until we have finished outputting the line.
-            console << doWaitForText;
-            if (!string.ends_with("\n"))
+            if ( !string.ends_with ( "\n" ) )
             {
                 string += "\n";
             }
-            console << string;
-        };
-        // set our palette
-        for ( auto &color : palette )
-        {
-            if ( color.first > 7 )
-            {
-                console.setCalculationColor ( color.first, color.second );
-            } else
-            {
-                console.setScreenColor ( color.first, color.second );
-            }
+            result.lines.push_back (
+                    { line.txtRate, line.cmdRate, console.encode ( string ) } );
         }
+    } catch ( ... )
+    {
+        console.setStyle ( saved );
+        throw;
+    }
+    console.setStyle ( saved );
+    return result;
+}
 
-        for ( auto const &line : lines ) { outputLine ( line ); }
-        // get input
-        bool matches = false;
-        do {
-            std::cin.clear ( );
-            defines::ChrString input = "";
-            std::getline ( std::cin, input );
+void ux::console::Screen::ask ( Console &console ) const
+{
+    bool matches = false;
+    do {
+        defines::ChrString input = console.getLine ( );
 
-            // check against input
-            // get the input
-            matches =
-                    parseInputMode ( inputPrompt.mode ) ( inputPrompt.result );
+        // check against input
+        // get the input
+        matches = parseInputMode ( inputPrompt.mode ) ( inputPrompt.result );
 
-        } while ( !matches );
+    } while ( !matches );
+}
 
-        return console;
-    };
+void ux::console::CompiledScreen::play ( Console &console ) const
+{
+    console.setPalette ( palette );
+
+    console << doSkipOnKey;
+    for ( auto const &line : lines )
+    {
+        console << textDelay ( line.txtRate );
+        console << commandDelay ( line.cmdRate );
+        // wait until we have finished outputting the line.
+        console << doWaitForText;
+        console.push ( line.text );
+    }
+}
+
+std::shared_ptr< CompiledScreen const > ux::console::ScreenCache::get (
+        Console                    &console,
+        defines::IString const     &id,
+        Screen const               &screen,
+        ExternalizedStrings const  &strings,
+        defines::IString const     &locale,
+        TransliterationLevel const &level )
+{
+    Key const key { id, locale, level, console.getCols ( ) };
+    {
+        std::scoped_lock< std::mutex > lock ( mutex );
+        auto const                     found = compiled.find ( key );
+        if ( found != compiled.end ( ) )
+        {
+            return found->second;
+        }
+    }
+    // compiled without the lock, since compiling may notice a resize and
+    // tell a listener that clears the cache.
+    auto const program = std::make_shared< CompiledScreen const > (
+            screen.compile ( console, strings, locale, level ) );
+    std::scoped_lock< std::mutex > lock ( mutex );
+    return compiled.emplace ( key, program ).first->second;
+}
+
+void ux::console::ScreenCache::clear ( ) noexcept
+{
+    std::scoped_lock< std::mutex > lock ( mutex );
+    compiled.clear ( );
 }
 
 // the input modes.
@@ -259,4 +323,108 @@ void parseColor ( Console               &console,
         c [ 2 ]              = ( color >> 8 ) & 0xff;  // blue
         console << bmpColor ( c [ 0 ], c [ 1 ], c [ 2 ] );
     }
-}
\ No newline at end of file
+}
+
+// strings given straight as YAML, for the unittest.
+class ScreenTestStrings : public ExternalizedStrings
+{
+public:
+    void load ( defines::ChrString const &yaml ) { _parse ( yaml ); }
+};
+
+bool testCompiledScreen ( std::ostream &stream )
+{
+    using namespace std::chrono_literals;
+    stream << "Beginning compiled screen unittest.\n";
+    ScreenTestStrings strings;
+    strings.load ( "Language: en-US\n"
+                   "Transliteration: ['NOT']\n"
+                   "Text:\n"
+                   "  -\n"
+                   "    Styled: 'plain words here'\n"
+                   "    Wrapped: 'a line long enough that it has to wrap'\n"
+                   "    Centered: 'in the middle'\n" );
+    Screen screen;
+    Line   styled;
+    styled.textID     = "Styled";
+    styled.bold       = 1;
+    styled.foreground = 0x00ff000a;
+    Line wrapped;
+    wrapped.textID    = "Wrapped";
+    wrapped.wrapped   = 1;
+    wrapped.underline = 1;
+    Line centered;
+    centered.textID     = "Centered";
+    centered.centered   = 1;
+    centered.background = 4;
+    for ( Line *line : { &styled, &wrapped, &centered } )
+    {
+        line->txtRate = 0;
+        screen.lines.push_back ( *line );
+    }
+    auto sent     = std::make_shared< VirtualTerminal > ( 8, 20 );
+    auto compiled = std::make_shared< VirtualTerminal > ( 8, 20 );
+    Console sender ( sent );
+    Console player ( compiled );
+    for ( Console *console : { &sender, &player } )
+    {
+        console->setTxtRate ( 0s );
+        console->setWaitOnText ( true );
+    }
+
+    stream << "Ensuring that compiling leaves the console as it was...\n";
+    player << doSGR ( SGRCommand::ITALIC ) << doTextWrapping;
+    Console::Style const       before = player.getStyle ( );
+    ScreenCache                cache;
+    TransliterationLevel const level  = TransliterationLevel::NOT;
+    auto const                 program =
+            cache.get ( player, "Test", screen, strings, "en-US", level );
+    if ( !( player.getStyle ( ) == before ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "Compiling changed the console's style" )
+    }
+
+    stream << "Ensuring that a compiled screen shows as sending it would...\n";
+    for ( Line const &line : screen.lines )
+    {
+        applyLineStyle ( sender, line );
+        sender << strings.get ( std::make_shared< ExternalID > ( ExternalID {
+                          "en-US." + line.textID + ".NOT" } ) )
+                          + "\n";
+    }
+    program->play ( player );
+    sender.getCursorPosition ( ).get ( );
+    player.getCursorPosition ( ).get ( );
+    for ( std::uint32_t row = 0; row < 8; row++ )
+    {
+        for ( std::uint32_t col = 0; col < 20; col++ )
+        {
+            if ( !( sent->cell ( row, col ) == compiled->cell ( row, col ) ) )
+            {
+                BASIC_UNIT_FAIL ( stream, "Row " << row << " showed \""
+                                                 << compiled->text ( row )
+                                                 << "\" instead of \""
+                                                 << sent->text ( row )
+                                                 << "\"" )
+            }
+        }
+    }
+    if ( sent->text ( 1 ).empty ( ) || sent->text ( 2 ).empty ( ) )
+    {
+        BASIC_UNIT_FAIL ( stream, "The long line did not wrap" )
+    }
+
+    stream << "Ensuring that the cache keeps a screen for its width...\n";
+    auto const again =
+            cache.get ( player, "Test", screen, strings, "en-US", level );
+    compiled->resize ( 8, 30 );
+    auto const wider =
+            cache.get ( player, "Test", screen, strings, "en-US", level );
+    if ( again != program || wider == program )
+    {
+        BASIC_UNIT_FAIL ( stream, "The cache kept the wrong screens" )
+    }
+    return true;
+}
+
+test::Unittest compiledScreenTest { &testCompiledScreen };
@@ -29,7 +29,11 @@
 #include <iostream>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
 #include <variant>
+#include <vector>
 
 namespace ux::console
 {
@@ -60,8 +64,9 @@ namespace ux::console
     struct Line
     {
         defines::IString textID              = "";
-        std::uint64_t    txtRate             = 17;
-        std::uint64_t    cmdRate             = 100;
+        // milliseconds between units, which may be fractional.
+        double           txtRate             = 17;
+        double           cmdRate             = 100;
         defines::Flag    centered        : 1 = 0;
         defines::Flag    wrapped         : 1 = 0;
         defines::Flag    bold            : 1 = 0;
@@ -112,6 +117,30 @@ namespace ux::console
         }
     };
 
+    /**
+     * @brief A screen made ready for one console: its strings looked up,
+     * wrapped to the console's width and cut into units, so that showing it
+     * only copies bytes into the text channel and paces them.
+     */
+    struct CompiledScreen
+    {
+        struct Line
+        {
+            double                            txtRate = 17;
+            double                            cmdRate = 100;
+            io::console::Console::EncodedText text;
+        };
+
+        io::console::Console::CompiledPalette palette;
+        std::vector< Line >                   lines;
+
+        /**
+         * @brief Sets the palette and sends each line at its own rate, waiting
+         * for each line to finish. A key sends the rest of the screen at once.
+         */
+        void play ( io::console::Console & ) const;
+    };
+
     struct Screen
     {
         // the lines to draw
@@ -132,6 +161,45 @@ namespace ux::console
                    output ( serialization::ExternalizedStrings const  &strings,
                             defines::IString const                    &locale,
                             serialization::TransliterationLevel const &level );
+        /**
+         * @brief Readies the screen for the console as it is now, leaving the
+         * console's attributes, wrapping and centering as they were.
+         */
+        CompiledScreen
+                compile ( io::console::Console                      &console,
+                          serialization::ExternalizedStrings const  &strings,
+                          defines::IString const                    &locale,
+                          serialization::TransliterationLevel const &level )
+                        const;
+        /**
+         * @brief Waits until the input prompt is answered on the console.
+         */
+        void ask ( io::console::Console & ) const;
         bool operator== ( Screen const &screen ) const noexcept = default;
     };
+
+    /**
+     * @brief Screens already compiled, by their ID, the locale and
+     * transliteration of their strings, and the console's width. Clear it
+     * when the console changes size to drop the screens compiled for the old
+     * one, which a resize listener may do from another thread.
+     */
+    class ScreenCache
+    {
+        using Key = std::tuple< defines::IString,
+                                defines::IString,
+                                serialization::TransliterationLevel,
+                                std::uint32_t >;
+        std::map< Key, std::shared_ptr< CompiledScreen const > > compiled;
+        std::mutex                                               mutex;
+    public:
+        std::shared_ptr< CompiledScreen const >
+                get ( io::console::Console                      &console,
+                      defines::IString const                    &id,
+                      Screen const                              &screen,
+                      serialization::ExternalizedStrings const  &strings,
+                      defines::IString const                    &locale,
+                      serialization::TransliterationLevel const &level );
+        void clear ( ) noexcept;
+    };
 } // namespace ux::console
\ No newline at end of file
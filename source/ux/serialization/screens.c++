@@ -22,6 +22,8 @@
 #include <defines/types.h++>
 
 #include <io/console/colors/color.h++>
+#include <io/console/colors/expression.h++>
+#include <io/console/colors/indirect.h++>
 #include <io/console/conmanip.h++>
 #include <io/console/console.h++>
 
@@ -57,8 +59,8 @@ void ux::serialization::ExternalizedScreens::_parse (
         auto parseLine = [ & ] ( YAML::Node const &line ) -> Line {
             Line parse      = { };
             parse.textID    = line [ "Id" ].as< defines::ChrString > ( );
-            parse.txtRate   = line [ "TextRate" ].as< std::uint64_t > ( );
-            parse.cmdRate   = line [ "CommandRate" ].as< std::uint64_t > ( );
+            parse.txtRate   = line [ "TextRate" ].as< double > ( );
+            parse.cmdRate   = line [ "CommandRate" ].as< double > ( );
             parse.centered  = line [ "Centered" ].as< bool > ( ) ? 1 : 0;
             parse.wrapped   = line [ "Wrapped" ].as< bool > ( ) ? 1 : 0;
             parse.bold      = line [ "Bold" ].as< bool > ( ) ? 1 : 0;
@@ -156,9 +158,12 @@ std::shared_ptr< IColor > parseSingleColor ( YAML::Node const &node,
                     node [ i ][ "Function" ].as< defines::ChrString > ( ) );
         } catch ( YAML::InvalidNode &invalid )
         {
-            std::cout << "Warning: "
-                      << "Function"
-                      << " cannot be found within node " << i << ".\n";
+            if ( !node [ i ][ "Expression" ] )
+            {
+                std::cout << "Warning: "
+                          << "Function"
+                          << " cannot be found within node " << i << ".\n";
+            }
             blending = blend_functions::IndirectColorBlendingFunctions::_MAX;
         }
         switch ( blending )
@@ -175,6 +180,12 @@ std::shared_ptr< IColor > parseSingleColor ( YAML::Node const &node,
             default:
                 color.setBlendFunction ( blend_functions::defaultBlending );
         }
+        // an expression, if given, blends instead of the function.
+        if ( node [ i ][ "Expression" ] )
+        {
+            color.setBlendExpression ( std::make_shared< BlendExpression > (
+                    node [ i ][ "Expression" ].as< defines::ChrString > ( ) ) );
+        }
         // parse the numbers that make up the color's parameters.
         // #60 We catch the access to "Function" throwing, but then this throws.
         for ( std::size_t j = 0; j < 4; j++ )